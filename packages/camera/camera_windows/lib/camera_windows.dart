@@ -4,12 +4,24 @@
 
 import 'dart:async';
 import 'dart:math';
+import 'dart:typed_data';
 
 import 'package:camera_platform_interface/camera_platform_interface.dart';
 import 'package:flutter/services.dart';
 import 'package:flutter/widgets.dart';
 import 'package:stream_transform/stream_transform.dart';
 
+import 'src/burst.dart';
+import 'src/camera_preview_stats.dart';
+import 'src/image_stream.dart';
+import 'src/media_type_preferences.dart';
+
+export 'src/burst.dart';
+export 'src/camera_preview_stats.dart';
+export 'src/image_stream.dart'
+    show WindowsCameraImageStreamOptions, WindowsImageFormat;
+export 'src/media_type_preferences.dart';
+
 /// An implementation of [CameraPlatform] for Windows.
 class CameraWindows extends CameraPlatform {
   /// Registers the Windows implementation of CameraPlatform.
@@ -35,6 +47,15 @@ class CameraWindows extends CameraPlatform {
   final StreamController<CameraEvent> cameraEventStreamController =
       StreamController<CameraEvent>.broadcast();
 
+  /// The controller that broadcasts changes of the list of available
+  /// cameras, coming from handlePluginMethodCall.
+  ///
+  /// This is only exposed for test purposes. It shouldn't be used by clients of
+  /// the plugin as it may break or change at any time.
+  @visibleForTesting
+  final StreamController<void> availableCamerasChangedStreamController =
+      StreamController<void>.broadcast();
+
   /// Returns a stream of camera events for the given [cameraId].
   Stream<CameraEvent> _cameraEvents(int cameraId) =>
       cameraEventStreamController.stream
@@ -63,11 +84,47 @@ class CameraWindows extends CameraPlatform {
     }
   }
 
+  /// Returns a stream that fires when cameras are connected to or
+  /// disconnected from the system.
+  ///
+  /// The list returned by [availableCameras] is cached until then, so apps
+  /// can listen to this stream instead of polling [availableCameras].
+  /// Several changes in quick succession, such as a camera with several
+  /// interfaces being connected, fire once until [availableCameras] is
+  /// called again.
+  Stream<void> onAvailableCamerasChanged() {
+    pluginChannel.setMethodCallHandler(handlePluginMethodCall);
+    return availableCamerasChangedStreamController.stream;
+  }
+
   @override
   Future<int> createCamera(
     CameraDescription cameraDescription,
     ResolutionPreset? resolutionPreset, {
     bool enableAudio = false,
+  }) {
+    return createCameraWithMediaTypePreferences(
+      cameraDescription,
+      resolutionPreset,
+      enableAudio: enableAudio,
+    );
+  }
+
+  /// Creates an uninitialized camera like [createCamera], choosing the media
+  /// type it captures by the given [mediaTypePreferences].
+  ///
+  /// Without preferences, the largest and then fastest media type within the
+  /// resolution preset is used.
+  ///
+  /// If [lowLatency] is true, the camera driver and the capture engine are
+  /// asked to buffer as few frames as possible, which shortens the time
+  /// from capture to preview at the cost of frames dropped under load.
+  Future<int> createCameraWithMediaTypePreferences(
+    CameraDescription cameraDescription,
+    ResolutionPreset? resolutionPreset, {
+    bool enableAudio = false,
+    WindowsMediaTypePreferences? mediaTypePreferences,
+    bool lowLatency = false,
   }) async {
     try {
       // If resolutionPreset is not specified, plugin selects the highest resolution possible.
@@ -76,6 +133,9 @@ class CameraWindows extends CameraPlatform {
         'cameraName': cameraDescription.name,
         'resolutionPreset': _serializeResolutionPreset(resolutionPreset),
         'enableAudio': enableAudio,
+        if (mediaTypePreferences != null)
+          'mediaTypePreferences': mediaTypePreferences.toMap(),
+        if (lowLatency) 'lowLatency': true,
       });
 
       if (reply == null) {
@@ -209,6 +269,40 @@ class CameraWindows extends CameraPlatform {
     return XFile(path!);
   }
 
+  /// Captures a picture with the camera with the given [cameraId], and
+  /// returns it encoded as JPEG, without writing it to a file.
+  ///
+  /// The picture is encoded with the given [quality], from 0 to 1. If
+  /// [maxWidth] or [maxHeight] are given, the picture is scaled down to fit
+  /// them, keeping its aspect ratio.
+  ///
+  /// Throws a [CameraException] if the picture could not be taken.
+  Future<Uint8List> takePictureToMemory(
+    int cameraId, {
+    double quality = 0.9,
+    int? maxWidth,
+    int? maxHeight,
+  }) async {
+    assert(quality >= 0 && quality <= 1);
+    assert(maxWidth == null || maxWidth > 0);
+    assert(maxHeight == null || maxHeight > 0);
+    final Uint8List? image;
+    try {
+      image = await pluginChannel.invokeMethod<Uint8List>(
+        'takePictureToMemory',
+        <String, dynamic>{
+          'cameraId': cameraId,
+          'quality': quality,
+          if (maxWidth != null) 'maxWidth': maxWidth,
+          if (maxHeight != null) 'maxHeight': maxHeight,
+        },
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+    return image!;
+  }
+
   @override
   Future<void> prepareForVideoRecording() =>
       pluginChannel.invokeMethod<void>('prepareForVideoRecording');
@@ -333,14 +427,67 @@ class CameraWindows extends CameraPlatform {
   @override
   Future<double> getMaxZoomLevel(int cameraId) async {
     // TODO(jokerttu): Implement zoom level support, https://github.com/flutter/flutter/issues/97537.
-    // Value is returned to support existing implementations.
+    // Value is returned to support existing implementations. Photos and
+    // recordings cannot be zoomed; the preview alone is zoomed by
+    // [setPreviewCrop].
     return 1.0;
   }
 
   @override
   Future<void> setZoomLevel(int cameraId, double zoom) async {
     // TODO(jokerttu): Implement zoom level support, https://github.com/flutter/flutter/issues/97537.
-    throw UnimplementedError('setZoomLevel() is not implemented.');
+    throw UnimplementedError(
+        'setZoomLevel() is not implemented. Use setPreviewCrop() to zoom the '
+        'preview only.');
+  }
+
+  /// Returns the largest digital zoom of the preview of the camera with the
+  /// given [cameraId], for [setPreviewCrop].
+  ///
+  /// The preview can be zoomed in until it shows 120 rows of the camera
+  /// frames, so the limit depends on the resolution of the camera. It is 1.0
+  /// until the preview has started.
+  Future<double> getMaxPreviewZoom(int cameraId) async {
+    final double? maxZoom = await pluginChannel.invokeMethod<double>(
+      'getMaxPreviewZoom',
+      <String, dynamic>{'cameraId': cameraId},
+    );
+    return maxZoom!;
+  }
+
+  /// Shows only [crop] of the preview frames of the camera with the given
+  /// [cameraId], magnified by [zoom] around its center and scaled to the
+  /// preview.
+  ///
+  /// [crop] is in fractions of the frame size, as shown in the preview, from
+  /// `Rect.fromLTWH(0, 0, 1, 1)` for the whole frame, which is the default.
+  /// [zoom] is between 1.0, the default, and [getMaxPreviewZoom]. Values that
+  /// are not passed are kept. Only the visible pixels are converted, and the
+  /// change applies from the next frame without restarting the preview.
+  ///
+  /// This only changes the preview. Recordings, photos and image streams
+  /// still get whole frames, and [getMaxZoomLevel] stays 1.0.
+  ///
+  /// Throws a [CameraException] if [crop] is empty or not within the frame,
+  /// or if [zoom] is out of range.
+  Future<void> setPreviewCrop(int cameraId, {Rect? crop, double? zoom}) async {
+    try {
+      await pluginChannel.invokeMethod<void>(
+        'setPreviewCrop',
+        <String, dynamic>{
+          'cameraId': cameraId,
+          if (crop != null) ...<String, dynamic>{
+            'left': crop.left,
+            'top': crop.top,
+            'width': crop.width,
+            'height': crop.height,
+          },
+          if (zoom != null) 'zoom': zoom,
+        },
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
   }
 
   @override
@@ -359,6 +506,237 @@ class CameraWindows extends CameraPlatform {
     );
   }
 
+  /// Returns the frame counters and timings of the preview of the camera
+  /// with the given [cameraId].
+  ///
+  /// Throws a [CameraException] if the preview has not been started.
+  Future<CameraPreviewStats> getPreviewStats(int cameraId) async {
+    final Map<String, Object?>? stats;
+    try {
+      stats = await pluginChannel.invokeMapMethod<String, Object?>(
+        'getPreviewStats',
+        <String, dynamic>{'cameraId': cameraId},
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+    return CameraPreviewStats.fromMap(stats!);
+  }
+
+  /// Enables or disables zero-shutter-lag photos for the camera with the
+  /// given [cameraId].
+  ///
+  /// While enabled, the most recent preview frames are kept in memory, and
+  /// [takePicture] saves the frame closest to the time of the call instead
+  /// of waiting for a new capture. Photos then have the size of the preview
+  /// frames, and the preview is kept at the size of the resolution preset.
+  ///
+  /// Throws a [CameraException] if the preview has not been started.
+  Future<void> setZeroShutterLag(int cameraId, bool enabled) async {
+    try {
+      await pluginChannel.invokeMethod<void>(
+        'setZeroShutterLag',
+        <String, dynamic>{'cameraId': cameraId, 'enabled': enabled},
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Limits the preview of the camera with the given [cameraId] to
+  /// [maxFrameRate] frames per second.
+  ///
+  /// If [matchDisplayRefreshRate] is true, the preview is also kept to the
+  /// refresh rate of the display showing the app, following it as the
+  /// window moves between displays. Without either, every camera frame is
+  /// previewed.
+  ///
+  /// Frames over the limit are skipped before they are read or converted,
+  /// which saves CPU time with cameras running faster than the app needs.
+  /// Image streams, bursts and zero-shutter-lag photos still receive every
+  /// frame.
+  Future<void> setPreviewFrameRateLimit(
+    int cameraId, {
+    double? maxFrameRate,
+    bool matchDisplayRefreshRate = false,
+  }) async {
+    try {
+      await pluginChannel.invokeMethod<void>(
+        'setPreviewFrameRateLimit',
+        <String, dynamic>{
+          'cameraId': cameraId,
+          if (maxFrameRate != null) 'maxFrameRate': maxFrameRate,
+          'matchDisplayRefreshRate': matchDisplayRefreshRate,
+        },
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Sets the thread processing the preview frames of the camera with the
+  /// given [cameraId].
+  ///
+  /// If [dedicated] is true, frames are handed off to a thread of their own,
+  /// registered with the Multimedia Class Scheduler Service for capture, so
+  /// that busy app threads do not delay them. Only the newest frame waits
+  /// for the thread. [cpuAffinityMask] keeps the thread on the processors
+  /// whose bits are set. Otherwise, frames are processed on the thread of
+  /// the capture engine delivering them, which is the default.
+  ///
+  /// Compare the scheduling latency of the preview statistics to choose
+  /// between them.
+  Future<void> setCaptureThread(
+    int cameraId, {
+    required bool dedicated,
+    int? cpuAffinityMask,
+  }) async {
+    try {
+      await pluginChannel.invokeMethod<void>(
+        'setCaptureThread',
+        <String, dynamic>{
+          'cameraId': cameraId,
+          'dedicated': dedicated,
+          if (cpuAffinityMask != null) 'cpuAffinityMask': cpuAffinityMask,
+        },
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Takes a burst of [count] photos with the camera with the given
+  /// [cameraId], one every [interval], and returns a stream of the written
+  /// photos.
+  ///
+  /// The burst starts when the stream is listened to. Photos are taken from
+  /// preview frames and have their size, and the preview is kept at the size
+  /// of the resolution preset during the burst. Each photo is added to the
+  /// stream as soon as it is written, while the burst carries on, so photos
+  /// may arrive out of order; their files are numbered in burst order.
+  /// Photos that fail are added as [CameraException] errors. The stream
+  /// closes once every photo has been reported. Cancelling the subscription
+  /// stops the burst.
+  ///
+  /// Photos are delayed rather than queued when they cannot be encoded as
+  /// fast as they are taken, so the interval between photos may be longer
+  /// than [interval].
+  Stream<XFile> takeBurst(
+    int cameraId, {
+    required int count,
+    Duration interval = Duration.zero,
+  }) {
+    assert(count > 0);
+    assert(!interval.isNegative);
+    StreamSubscription<CameraEvent>? events;
+    bool completed = false;
+
+    late final StreamController<XFile> controller;
+    controller = StreamController<XFile>(
+      onListen: () async {
+        events = _cameraEvents(cameraId).listen((CameraEvent event) {
+          if (event is BurstPictureEvent) {
+            if (event.file != null) {
+              controller.add(event.file!);
+            } else {
+              controller.addError(
+                  CameraException(event.errorCode!, event.errorDescription));
+            }
+          } else if (event is BurstCompletedEvent) {
+            completed = true;
+            events?.cancel();
+            controller.close();
+          }
+        });
+        try {
+          await pluginChannel.invokeMethod<void>(
+            'startBurst',
+            <String, dynamic>{
+              'cameraId': cameraId,
+              'count': count,
+              'interval': interval.inMilliseconds,
+            },
+          );
+        } on PlatformException catch (e) {
+          completed = true;
+          await events?.cancel();
+          controller.addError(CameraException(e.code, e.message));
+          await controller.close();
+        }
+      },
+      onCancel: () async {
+        await events?.cancel();
+        if (!completed) {
+          await pluginChannel.invokeMethod<void>(
+            'stopBurst',
+            <String, dynamic>{'cameraId': cameraId},
+          );
+        }
+      },
+    );
+    return controller.stream;
+  }
+
+  /// Returns a stream of preview frames of the camera with the given
+  /// [cameraId].
+  ///
+  /// Pass [WindowsCameraImageStreamOptions] to choose the pixel format, a
+  /// maximum frame size and a maximum frame rate. Frames are sent as RGBA,
+  /// at the size of the preview, by default.
+  ///
+  /// Frames that arrive while the previous frames are still on their way to
+  /// the stream are dropped on the native side, so a slow listener receives
+  /// fewer frames instead of older ones. Pausing the stream is not
+  /// supported.
+  @override
+  Stream<CameraImageData> onStreamedFrameAvailable(int cameraId,
+      {CameraImageStreamOptions? options}) {
+    final String channelName =
+        'plugins.flutter.io/camera_windows/imageStream$cameraId';
+    final Map<String, Object> streamOptions =
+        options is WindowsCameraImageStreamOptions
+            ? options.toMap()
+            : WindowsCameraImageStreamOptions().toMap();
+    final BinaryMessenger messenger = pluginChannel.binaryMessenger;
+
+    late final StreamController<CameraImageData> controller;
+    controller = StreamController<CameraImageData>(
+      onListen: () async {
+        // Replying to a frame lets the native side send the next one.
+        messenger.setMessageHandler(channelName, (ByteData? message) async {
+          if (message != null) {
+            controller.add(cameraImageFromMessage(message));
+          }
+          return null;
+        });
+        try {
+          await pluginChannel.invokeMethod<void>(
+            'startImageStream',
+            <String, dynamic>{'cameraId': cameraId, ...streamOptions},
+          );
+        } on PlatformException catch (e) {
+          messenger.setMessageHandler(channelName, null);
+          controller.addError(CameraException(e.code, e.message));
+        }
+      },
+      onPause: _onFrameStreamPauseResume,
+      onResume: _onFrameStreamPauseResume,
+      onCancel: () async {
+        messenger.setMessageHandler(channelName, null);
+        await pluginChannel.invokeMethod<void>(
+          'stopImageStream',
+          <String, dynamic>{'cameraId': cameraId},
+        );
+      },
+    );
+    return controller.stream;
+  }
+
+  void _onFrameStreamPauseResume() {
+    throw CameraException('InvalidCall',
+        'Pause and resume are not supported for onStreamedFrameAvailable');
+  }
+
   @override
   Widget buildPreview(int cameraId) {
     return Texture(textureId: cameraId);
@@ -384,6 +762,22 @@ class CameraWindows extends CameraPlatform {
     }
   }
 
+  /// Converts messages received from the native platform on the plugin
+  /// channel into events.
+  ///
+  /// This is only exposed for test purposes. It shouldn't be used by clients
+  /// of the plugin as it may break or change at any time.
+  @visibleForTesting
+  Future<dynamic> handlePluginMethodCall(MethodCall call) async {
+    switch (call.method) {
+      case 'cameras_changed':
+        availableCamerasChangedStreamController.add(null);
+        break;
+      default:
+        throw UnimplementedError();
+    }
+  }
+
   /// Converts messages received from the native platform into camera events.
   ///
   /// This is only exposed for test purposes. It shouldn't be used by clients
@@ -411,6 +805,20 @@ class CameraWindows extends CameraPlatform {
           ),
         );
         break;
+      case 'burst_picture':
+        final Map<String, Object?> arguments =
+            (call.arguments as Map<Object?, Object?>).cast<String, Object?>();
+        cameraEventStreamController.add(
+          BurstPictureEvent.fromMap(cameraId, arguments),
+        );
+        break;
+      case 'burst_completed':
+        cameraEventStreamController.add(
+          BurstCompletedEvent(
+            cameraId,
+          ),
+        );
+        break;
       case 'error':
         final Map<String, Object?> arguments =
             (call.arguments as Map<Object?, Object?>).cast<String, Object?>();
@@ -0,0 +1,68 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'package:camera_platform_interface/camera_platform_interface.dart';
+
+/// An event fired when a photo of a burst has been written, or has failed.
+///
+/// Photos are reported as soon as each one is written, so they may arrive
+/// out of order.
+class BurstPictureEvent extends CameraEvent {
+  /// Creates an event for the photo at [index] in the burst, written to
+  /// [file], or failed with [errorCode] and [errorDescription].
+  const BurstPictureEvent(
+    super.cameraId,
+    this.index, {
+    this.file,
+    this.errorCode,
+    this.errorDescription,
+  });
+
+  /// Creates an event from the arguments of a `burst_picture` message sent
+  /// by the native platform.
+  BurstPictureEvent.fromMap(int cameraId, Map<String, Object?> arguments)
+      : this(
+          cameraId,
+          arguments['index']! as int,
+          file: arguments['path'] != null
+              ? XFile(arguments['path']! as String)
+              : null,
+          errorCode: arguments['code'] as String?,
+          errorDescription: arguments['description'] as String?,
+        );
+
+  /// Position of the photo in the burst, starting at 0.
+  final int index;
+
+  /// The written photo, or null if the photo failed.
+  final XFile? file;
+
+  /// Error code of the failed photo.
+  final String? errorCode;
+
+  /// Description of the error of the failed photo.
+  final String? errorDescription;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      super == other &&
+          other is BurstPictureEvent &&
+          index == other.index &&
+          file?.path == other.file?.path &&
+          errorCode == other.errorCode &&
+          errorDescription == other.errorDescription;
+
+  @override
+  int get hashCode => Object.hash(
+      super.hashCode, index, file?.path, errorCode, errorDescription);
+}
+
+/// An event fired once every photo of a burst has been reported, or the
+/// burst has been stopped.
+class BurstCompletedEvent extends CameraEvent {
+  /// Creates a completion event for the burst of the camera with the given
+  /// [cameraId].
+  const BurstCompletedEvent(super.cameraId);
+}
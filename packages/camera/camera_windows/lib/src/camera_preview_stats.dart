@@ -0,0 +1,121 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'package:flutter/foundation.dart';
+
+/// Frame counters and timings of the preview of a camera.
+///
+/// Counters start when the preview starts. Timings are percentiles over all
+/// frames since then, accurate to within 1/8 of their value.
+@immutable
+class CameraPreviewStats {
+  /// Creates preview statistics with the given values.
+  const CameraPreviewStats({
+    required this.framesDelivered,
+    required this.framesFailed,
+    required this.framesDropped,
+    required this.framesRendered,
+    required this.framesSkipped,
+    required this.frameIntervalP50,
+    required this.frameIntervalP99,
+    required this.schedulingLatencyP50,
+    required this.schedulingLatencyP99,
+    required this.conversionTimeP50,
+    required this.conversionTimeP99,
+    required this.captureToTextureP50,
+    required this.captureToTextureP99,
+    required this.captureLatencyP50,
+    required this.captureLatencyP99,
+    required this.textureHoldTimeP50,
+    required this.textureHoldTimeP99,
+  });
+
+  /// Creates preview statistics from a map sent by the native platform, with
+  /// durations in microseconds.
+  factory CameraPreviewStats.fromMap(Map<String, Object?> map) {
+    int count(String key) => map[key]! as int;
+    Duration duration(String key) => Duration(microseconds: map[key]! as int);
+    return CameraPreviewStats(
+      framesDelivered: count('framesDelivered'),
+      framesFailed: count('framesFailed'),
+      framesDropped: count('framesDropped'),
+      framesRendered: count('framesRendered'),
+      framesSkipped: count('framesSkipped'),
+      frameIntervalP50: duration('frameIntervalP50'),
+      frameIntervalP99: duration('frameIntervalP99'),
+      schedulingLatencyP50: duration('schedulingLatencyP50'),
+      schedulingLatencyP99: duration('schedulingLatencyP99'),
+      conversionTimeP50: duration('conversionTimeP50'),
+      conversionTimeP99: duration('conversionTimeP99'),
+      captureToTextureP50: duration('captureToTextureP50'),
+      captureToTextureP99: duration('captureToTextureP99'),
+      captureLatencyP50: duration('captureLatencyP50'),
+      captureLatencyP99: duration('captureLatencyP99'),
+      textureHoldTimeP50: duration('textureHoldTimeP50'),
+      textureHoldTimeP99: duration('textureHoldTimeP99'),
+    );
+  }
+
+  /// Number of camera frames handed to the preview.
+  final int framesDelivered;
+
+  /// Number of camera frames that could not be converted or decoded.
+  final int framesFailed;
+
+  /// Number of converted frames replaced by newer frames before Flutter
+  /// rendered them.
+  final int framesDropped;
+
+  /// Number of converted frames rendered by Flutter.
+  final int framesRendered;
+
+  /// Number of camera frames skipped before they were read, to keep to the
+  /// preview frame rate limit.
+  final int framesSkipped;
+
+  /// Median time between camera frames, from their presentation times.
+  final Duration frameIntervalP50;
+
+  /// 99th percentile of the time between camera frames.
+  final Duration frameIntervalP99;
+
+  /// Median time by which camera frames reached the preview later than
+  /// their presentation times predict, compared to the earliest frame.
+  final Duration schedulingLatencyP50;
+
+  /// 99th percentile of the time by which camera frames reached the preview
+  /// late.
+  final Duration schedulingLatencyP99;
+
+  /// Median time to convert or decode a camera frame.
+  final Duration conversionTimeP50;
+
+  /// 99th percentile of the time to convert or decode a camera frame.
+  final Duration conversionTimeP99;
+
+  /// Median time from the delivery of a camera frame until Flutter takes it
+  /// for rendering.
+  final Duration captureToTextureP50;
+
+  /// 99th percentile of the time from the delivery of a camera frame until
+  /// Flutter takes it for rendering.
+  final Duration captureToTextureP99;
+
+  /// Median time from the capture of a camera frame by the camera, by its
+  /// device timestamp, until Flutter takes it for rendering.
+  ///
+  /// Unlike [captureToTextureP50], this includes the frames buffered by the
+  /// camera driver and the capture engine.
+  final Duration captureLatencyP50;
+
+  /// 99th percentile of the time from the capture of a camera frame by the
+  /// camera until Flutter takes it for rendering.
+  final Duration captureLatencyP99;
+
+  /// Median time Flutter holds a frame before releasing it.
+  final Duration textureHoldTimeP50;
+
+  /// 99th percentile of the time Flutter holds a frame before releasing it.
+  final Duration textureHoldTimeP99;
+}
@@ -0,0 +1,126 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'package:camera_platform_interface/camera_platform_interface.dart';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Pixel formats of the frames of an image stream on Windows.
+///
+/// The order of the values matches the format identifiers sent by the
+/// native side.
+enum WindowsImageFormat {
+  /// Packed RGBA pixels, in a single plane.
+  rgba,
+
+  /// Packed BGRA pixels, in a single plane.
+  bgra,
+
+  /// A luma plane followed by an interleaved chroma plane at half the
+  /// resolution. Only available for cameras that deliver YUV frames.
+  nv12,
+
+  /// The luma plane of the frame only.
+  luma,
+}
+
+/// Options of an image stream on Windows.
+///
+/// Frames are taken from the preview, so they are at most the size of the
+/// preview frames.
+@immutable
+class WindowsCameraImageStreamOptions extends CameraImageStreamOptions {
+  /// Creates image stream options with the given values.
+  WindowsCameraImageStreamOptions({
+    this.format = WindowsImageFormat.rgba,
+    this.maxWidth,
+    this.maxHeight,
+    this.maxFrameRate,
+    this.maxPendingFrames = 1,
+  })  : assert(maxWidth == null || maxWidth > 0),
+        assert(maxHeight == null || maxHeight > 0),
+        assert(maxFrameRate == null || maxFrameRate > 0),
+        assert(maxPendingFrames > 0);
+
+  /// Pixel format of the frames.
+  final WindowsImageFormat format;
+
+  /// Largest width of the frames. Frames are scaled down to fit, keeping
+  /// their aspect ratio.
+  final int? maxWidth;
+
+  /// Largest height of the frames. Frames are scaled down to fit, keeping
+  /// their aspect ratio.
+  final int? maxHeight;
+
+  /// Highest number of frames per second. Every frame is sent if null.
+  final double? maxFrameRate;
+
+  /// Number of frames that may be on their way to the stream at once.
+  ///
+  /// While this many frames have not yet been received, new frames are
+  /// dropped on the native side instead of queuing up.
+  final int maxPendingFrames;
+
+  /// Returns the options as arguments of the `startImageStream` method.
+  Map<String, Object> toMap() {
+    return <String, Object>{
+      'format': format.name,
+      if (maxWidth != null) 'maxWidth': maxWidth!,
+      if (maxHeight != null) 'maxHeight': maxHeight!,
+      if (maxFrameRate != null) 'maxFrameRate': maxFrameRate!,
+      'maxPendingFrames': maxPendingFrames,
+    };
+  }
+}
+
+/// Size of the header in front of the pixel data of image stream messages.
+const int _headerSize = 64;
+
+/// Creates image data from a message sent on an image stream channel.
+///
+/// The message starts with a header of little-endian 32-bit fields: format,
+/// width, height, plane count, the presentation time in microseconds as two
+/// fields, and for each of two planes its offset, bytes per row, bytes per
+/// pixel, width and height. Planes are views of the message, so no pixels
+/// are copied.
+CameraImageData cameraImageFromMessage(ByteData message) {
+  assert(message.lengthInBytes >= _headerSize);
+  int field(int index) => message.getUint32(index * 4, Endian.little);
+
+  final WindowsImageFormat format = WindowsImageFormat.values[field(0)];
+  final List<CameraImagePlane> planes = <CameraImagePlane>[];
+  for (int i = 0; i < field(3); i++) {
+    final int plane = 6 + i * 5;
+    final int bytesPerRow = field(plane + 1);
+    final int height = field(plane + 4);
+    planes.add(CameraImagePlane(
+      bytes: message.buffer.asUint8List(
+          message.offsetInBytes + field(plane), bytesPerRow * height),
+      bytesPerRow: bytesPerRow,
+      bytesPerPixel: field(plane + 2),
+      width: field(plane + 3),
+      height: height,
+    ));
+  }
+
+  return CameraImageData(
+    format: CameraImageFormat(_getFormatGroup(format), raw: format.name),
+    planes: planes,
+    width: field(1),
+    height: field(2),
+  );
+}
+
+ImageFormatGroup _getFormatGroup(WindowsImageFormat format) {
+  switch (format) {
+    case WindowsImageFormat.bgra:
+      return ImageFormatGroup.bgra8888;
+    case WindowsImageFormat.nv12:
+      return ImageFormatGroup.yuv420;
+    case WindowsImageFormat.rgba:
+    case WindowsImageFormat.luma:
+      return ImageFormatGroup.unknown;
+  }
+}
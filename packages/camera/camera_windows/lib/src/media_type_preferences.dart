@@ -0,0 +1,83 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+import 'package:flutter/foundation.dart';
+
+/// Preferences for the media type a camera captures on Windows.
+///
+/// Cameras offer each frame size at a few frame rates and pixel formats.
+/// Without preferences, the largest and then fastest media type within the
+/// resolution preset is used, even if it is much slower than a smaller one.
+/// With preferences, every media type is scored by how close its frame size
+/// and rate come to the targets, and by the cost of its pixel format.
+@immutable
+class WindowsMediaTypePreferences {
+  /// Creates media type preferences with the given values.
+  const WindowsMediaTypePreferences({
+    this.targetWidth,
+    this.targetHeight,
+    this.minFrameRate = 15,
+    this.preferredFrameRate = 30,
+    this.nv12Cost = 0,
+    this.yuy2Cost = 0.05,
+    this.rgbCost = 0.1,
+    this.mjpgCost = 0.2,
+    this.otherCost = 0.3,
+  })  : assert((targetWidth == null) == (targetHeight == null)),
+        assert(targetWidth == null || targetWidth > 0),
+        assert(targetHeight == null || targetHeight > 0),
+        assert(minFrameRate >= 0),
+        assert(preferredFrameRate >= 0);
+
+  /// Width of the frame size to aim for, or null for the largest frame size.
+  ///
+  /// Smaller frame sizes lose detail, and score lower than larger ones,
+  /// which only cost time to scale down. The resolution preset still limits
+  /// the frame height.
+  final int? targetWidth;
+
+  /// Height of the frame size to aim for, or null for the largest frame size.
+  final int? targetHeight;
+
+  /// Media types slower than this number of frames per second are never
+  /// used.
+  final double minFrameRate;
+
+  /// Frame rate to aim for. Faster media types score no better, and frame
+  /// rates are not scored if zero.
+  final double preferredFrameRate;
+
+  /// Share of the score lost by NV12 media types, between 0 and 1.
+  final double nv12Cost;
+
+  /// Share of the score lost by YUY2 media types, between 0 and 1.
+  final double yuy2Cost;
+
+  /// Share of the score lost by RGB media types, between 0 and 1.
+  final double rgbCost;
+
+  /// Share of the score lost by MJPEG media types, between 0 and 1. MJPEG
+  /// frames are decoded on the CPU.
+  final double mjpgCost;
+
+  /// Share of the score lost by media types of other formats, between 0 and
+  /// 1. Such frames are converted by Media Foundation.
+  final double otherCost;
+
+  /// Returns the preferences as the `mediaTypePreferences` argument of the
+  /// `create` method.
+  Map<String, Object> toMap() {
+    return <String, Object>{
+      if (targetWidth != null) 'targetWidth': targetWidth!,
+      if (targetHeight != null) 'targetHeight': targetHeight!,
+      'minFrameRate': minFrameRate,
+      'preferredFrameRate': preferredFrameRate,
+      'nv12Cost': nv12Cost,
+      'yuy2Cost': yuy2Cost,
+      'rgbCost': rgbCost,
+      'mjpgCost': mjpgCost,
+      'otherCost': otherCost,
+    };
+  }
+}
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+import 'dart:typed_data';
+
 import 'package:async/async.dart';
 import 'package:camera_platform_interface/camera_platform_interface.dart';
 import 'package:camera_windows/camera_windows.dart';
@@ -56,6 +58,57 @@ void main() {
         expect(cameraId, 1);
       });
 
+      test('Should send media type preferences with creation data', () async {
+        // Arrange
+        final MethodChannelMock cameraMockChannel = MethodChannelMock(
+            channelName: pluginChannelName,
+            methods: <String, dynamic>{
+              'create': <String, dynamic>{'cameraId': 1},
+            });
+        final CameraWindows plugin = CameraWindows();
+
+        // Act
+        final int cameraId = await plugin.createCameraWithMediaTypePreferences(
+          const CameraDescription(
+              name: 'Test',
+              lensDirection: CameraLensDirection.front,
+              sensorOrientation: 0),
+          ResolutionPreset.max,
+          mediaTypePreferences: const WindowsMediaTypePreferences(
+            targetWidth: 1280,
+            targetHeight: 720,
+            preferredFrameRate: 60,
+            mjpgCost: 0.5,
+          ),
+          lowLatency: true,
+        );
+
+        // Assert
+        expect(cameraMockChannel.log, <Matcher>[
+          isMethodCall(
+            'create',
+            arguments: <String, Object?>{
+              'cameraName': 'Test',
+              'resolutionPreset': 'max',
+              'enableAudio': false,
+              'mediaTypePreferences': <String, Object>{
+                'targetWidth': 1280,
+                'targetHeight': 720,
+                'minFrameRate': 15.0,
+                'preferredFrameRate': 60.0,
+                'nv12Cost': 0.0,
+                'yuy2Cost': 0.05,
+                'rgbCost': 0.1,
+                'mjpgCost': 0.5,
+                'otherCost': 0.3,
+              },
+              'lowLatency': true,
+            },
+          ),
+        ]);
+        expect(cameraId, 1);
+      });
+
       test(
           'Should throw CameraException when create throws a PlatformException',
           () {
@@ -252,6 +305,25 @@ void main() {
         await streamQueue.cancel();
       });
 
+      test('Should receive available cameras changed events', () async {
+        // Act
+        final StreamQueue<void> streamQueue =
+            StreamQueue<void>(plugin.onAvailableCamerasChanged());
+
+        // Emit test events
+        await plugin
+            .handlePluginMethodCall(const MethodCall('cameras_changed'));
+        await plugin
+            .handlePluginMethodCall(const MethodCall('cameras_changed'));
+
+        // Assert
+        await streamQueue.next;
+        await streamQueue.next;
+
+        // Clean up
+        await streamQueue.cancel();
+      });
+
       test('Should receive camera error events', () async {
         // Act
         final Stream<CameraErrorEvent> errorStream =
@@ -391,6 +463,50 @@ void main() {
         expect(file.path, '/test/path.jpg');
       });
 
+      test('Should take a picture to memory and return its bytes', () async {
+        // Arrange
+        final Uint8List jpeg =
+            Uint8List.fromList(<int>[0xFF, 0xD8, 0xFF, 0xD9]);
+        final MethodChannelMock channel = MethodChannelMock(
+            channelName: pluginChannelName,
+            methods: <String, dynamic>{'takePictureToMemory': jpeg});
+
+        // Act
+        final Uint8List image = await plugin.takePictureToMemory(cameraId,
+            quality: 0.5, maxWidth: 640);
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall('takePictureToMemory', arguments: <String, Object?>{
+            'cameraId': cameraId,
+            'quality': 0.5,
+            'maxWidth': 640,
+          }),
+        ]);
+        expect(image, jpeg);
+      });
+
+      test('Should throw CameraException when taking a picture to memory fails',
+          () {
+        // Arrange
+        MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'takePictureToMemory': PlatformException(
+              code: 'camera_error',
+              message: 'Failed to take photo',
+            ),
+          },
+        );
+
+        // Act
+        expect(
+          () => plugin.takePictureToMemory(cameraId),
+          throwsA(isA<CameraException>()
+              .having((CameraException e) => e.code, 'code', 'camera_error')),
+        );
+      });
+
       test('Should prepare for video recording', () async {
         // Arrange
         final MethodChannelMock channel = MethodChannelMock(
@@ -609,7 +725,7 @@ void main() {
         expect(maxZoomLevel, 1.0);
       });
 
-      test('Should throw UnimplementedError when zoom level is set', () async {
+      test('Should throw UnimplementedError when zoom level is set', () {
         // Act
         expect(
           () => plugin.setZoomLevel(cameraId, 2.0),
@@ -617,12 +733,95 @@ void main() {
         );
       });
 
+      test('Should get the max preview zoom', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{'getMaxPreviewZoom': 9.0},
+        );
+
+        // Act
+        final double maxZoom = await plugin.getMaxPreviewZoom(cameraId);
+
+        // Assert
+        expect(maxZoom, 9.0);
+        expect(channel.log, <Matcher>[
+          isMethodCall('getMaxPreviewZoom', arguments: <String, Object?>{
+            'cameraId': cameraId,
+          }),
+        ]);
+      });
+
+      test('Should zoom the preview', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{'setPreviewCrop': null},
+        );
+
+        // Act
+        await plugin.setPreviewCrop(cameraId, zoom: 2.0);
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall('setPreviewCrop', arguments: <String, Object?>{
+            'cameraId': cameraId,
+            'zoom': 2.0,
+          }),
+        ]);
+      });
+
+      test('Should throw CameraException when the preview zoom is invalid',
+          () {
+        // Arrange
+        MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'setPreviewCrop': PlatformException(
+              code: 'argument_error',
+              message: 'Invalid preview crop',
+            ),
+          },
+        );
+
+        // Act
+        expect(
+          () => plugin.setPreviewCrop(cameraId, zoom: 1000.0),
+          throwsA(isA<CameraException>()
+              .having((CameraException e) => e.code, 'code', 'argument_error')),
+        );
+      });
+
+      test('Should set the preview crop', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{'setPreviewCrop': null},
+        );
+
+        // Act
+        await plugin.setPreviewCrop(cameraId,
+            crop: const Rect.fromLTWH(0.5, 0.25, 0.5, 0.5));
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall('setPreviewCrop', arguments: <String, Object?>{
+            'cameraId': cameraId,
+            'left': 0.5,
+            'top': 0.25,
+            'width': 0.5,
+            'height': 0.5,
+          }),
+        ]);
+      });
+
       test(
           'Should throw UnimplementedError when lock capture orientation is called',
           () async {
         // Act
         expect(
-          () => plugin.setZoomLevel(cameraId, 2.0),
+          () => plugin.lockCaptureOrientation(
+              cameraId, DeviceOrientation.portraitUp),
           throwsA(isA<UnimplementedError>()),
         );
       });
@@ -670,6 +869,339 @@ void main() {
               arguments: <String, Object?>{'cameraId': cameraId}),
         ]);
       });
+
+      test('Should get the camera preview stats', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'getPreviewStats': <String, Object?>{
+              'framesDelivered': 300,
+              'framesFailed': 1,
+              'framesDropped': 12,
+              'framesRendered': 287,
+              'framesSkipped': 150,
+              'frameIntervalP50': 33333,
+              'frameIntervalP99': 41000,
+              'schedulingLatencyP50': 200,
+              'schedulingLatencyP99': 2300,
+              'conversionTimeP50': 1500,
+              'conversionTimeP99': 4100,
+              'captureToTextureP50': 9000,
+              'captureToTextureP99': 30000,
+              'captureLatencyP50': 38000,
+              'captureLatencyP99': 61000,
+              'textureHoldTimeP50': 400,
+              'textureHoldTimeP99': 900,
+            }
+          },
+        );
+
+        // Act
+        final CameraPreviewStats stats = await plugin.getPreviewStats(cameraId);
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall('getPreviewStats',
+              arguments: <String, Object?>{'cameraId': cameraId}),
+        ]);
+        expect(stats.framesDelivered, 300);
+        expect(stats.framesDropped, 12);
+        expect(stats.framesSkipped, 150);
+        expect(stats.frameIntervalP50, const Duration(microseconds: 33333));
+        expect(stats.schedulingLatencyP99, const Duration(microseconds: 2300));
+        expect(stats.conversionTimeP99, const Duration(microseconds: 4100));
+        expect(stats.captureLatencyP99, const Duration(microseconds: 61000));
+        expect(stats.textureHoldTimeP99, const Duration(microseconds: 900));
+      });
+
+      test('Should throw CameraException when getting stats fails', () {
+        // Arrange
+        MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'getPreviewStats': PlatformException(
+              code: 'camera_error',
+              message: 'Preview not started',
+            ),
+          },
+        );
+
+        // Act
+        expect(
+          () => plugin.getPreviewStats(cameraId),
+          throwsA(isA<CameraException>()
+              .having((CameraException e) => e.code, 'code', 'camera_error')),
+        );
+      });
+
+      test('Should enable zero shutter lag', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{'setZeroShutterLag': null},
+        );
+
+        // Act
+        await plugin.setZeroShutterLag(cameraId, true);
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall('setZeroShutterLag', arguments: <String, Object?>{
+            'cameraId': cameraId,
+            'enabled': true,
+          }),
+        ]);
+      });
+
+      test('Should throw CameraException when enabling zero shutter lag fails',
+          () {
+        // Arrange
+        MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'setZeroShutterLag': PlatformException(
+              code: 'camera_error',
+              message: 'Preview not started',
+            ),
+          },
+        );
+
+        // Act
+        expect(
+          () => plugin.setZeroShutterLag(cameraId, true),
+          throwsA(isA<CameraException>()
+              .having((CameraException e) => e.code, 'code', 'camera_error')),
+        );
+      });
+
+      test('Should limit the preview frame rate', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{'setPreviewFrameRateLimit': null},
+        );
+
+        // Act
+        await plugin.setPreviewFrameRateLimit(cameraId,
+            maxFrameRate: 30, matchDisplayRefreshRate: true);
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall(
+            'setPreviewFrameRateLimit',
+            arguments: <String, Object?>{
+              'cameraId': cameraId,
+              'maxFrameRate': 30.0,
+              'matchDisplayRefreshRate': true,
+            },
+          ),
+        ]);
+      });
+
+      test('Should move frame processing to a dedicated thread', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{'setCaptureThread': null},
+        );
+
+        // Act
+        await plugin.setCaptureThread(cameraId,
+            dedicated: true, cpuAffinityMask: 0x6);
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall('setCaptureThread', arguments: <String, Object?>{
+            'cameraId': cameraId,
+            'dedicated': true,
+            'cpuAffinityMask': 0x6,
+          }),
+        ]);
+      });
+
+      test('Should throw CameraException when the affinity mask is invalid',
+          () {
+        // Arrange
+        MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'setCaptureThread': PlatformException(
+              code: 'argument_error',
+              message: 'Invalid CPU affinity mask',
+            ),
+          },
+        );
+
+        // Act
+        expect(
+          () => plugin.setCaptureThread(cameraId,
+              dedicated: true, cpuAffinityMask: 1 << 62),
+          throwsA(isA<CameraException>()
+              .having((CameraException e) => e.code, 'code', 'argument_error')),
+        );
+      });
+
+      test('Should take a burst and receive photos as they are written',
+          () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{'startBurst': null, 'stopBurst': null},
+        );
+
+        // Act
+        final StreamQueue<XFile> photos = StreamQueue<XFile>(plugin.takeBurst(
+            cameraId,
+            count: 2,
+            interval: const Duration(milliseconds: 200)));
+        final Future<XFile> firstPhoto = photos.next;
+        await plugin.handleCameraMethodCall(
+            const MethodCall('burst_picture',
+                <String, Object?>{'index': 1, 'path': 'BurstCapture_2.jpeg'}),
+            cameraId);
+        await plugin.handleCameraMethodCall(
+            const MethodCall('burst_picture',
+                <String, Object?>{'index': 0, 'path': 'BurstCapture_1.jpeg'}),
+            cameraId);
+        await plugin.handleCameraMethodCall(
+            const MethodCall('burst_completed'), cameraId);
+
+        // Assert
+        expect((await firstPhoto).path, 'BurstCapture_2.jpeg');
+        expect((await photos.next).path, 'BurstCapture_1.jpeg');
+        expect(await photos.hasNext, isFalse);
+        expect(channel.log, <Matcher>[
+          isMethodCall('startBurst', arguments: <String, Object?>{
+            'cameraId': cameraId,
+            'count': 2,
+            'interval': 200,
+          }),
+        ]);
+      });
+
+      test('Should throw CameraException when starting a burst fails',
+          () async {
+        // Arrange
+        MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'startBurst': PlatformException(
+              code: 'camera_error',
+              message: 'Preview not started or burst already running',
+            ),
+          },
+        );
+
+        // Act
+        final StreamQueue<XFile> photos =
+            StreamQueue<XFile>(plugin.takeBurst(cameraId, count: 3));
+
+        // Assert
+        await expectLater(
+          photos.next,
+          throwsA(isA<CameraException>()
+              .having((CameraException e) => e.code, 'code', 'camera_error')),
+        );
+        expect(await photos.hasNext, isFalse);
+      });
+
+      test('Should start an image stream and receive frames', () async {
+        // Arrange
+        final MethodChannelMock channel = MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'startImageStream': null,
+            'stopImageStream': null,
+          },
+        );
+        // A 4 x 2 NV12 frame: a luma plane followed by a chroma plane.
+        final ByteData message = ByteData(64 + 12);
+        final List<int> header = <int>[
+          2, 4, 2, 2, 1000, 0, //
+          64, 4, 1, 4, 2, //
+          72, 4, 2, 2, 1,
+        ];
+        for (int i = 0; i < header.length; i++) {
+          message.setUint32(i * 4, header[i], Endian.little);
+        }
+        for (int i = 0; i < 12; i++) {
+          message.setUint8(64 + i, i);
+        }
+
+        // Act
+        final StreamQueue<CameraImageData> frames =
+            StreamQueue<CameraImageData>(plugin.onStreamedFrameAvailable(
+          cameraId,
+          options: WindowsCameraImageStreamOptions(
+            format: WindowsImageFormat.nv12,
+            maxWidth: 640,
+            maxFrameRate: 15,
+          ),
+        ));
+        await Future<void>.delayed(Duration.zero);
+        await _ambiguate(TestDefaultBinaryMessengerBinding.instance)!
+            .defaultBinaryMessenger
+            .handlePlatformMessage(
+                'plugins.flutter.io/camera_windows/imageStream$cameraId',
+                message,
+                (ByteData? reply) {});
+        final CameraImageData frame = await frames.next;
+        await frames.cancel();
+
+        // Assert
+        expect(channel.log, <Matcher>[
+          isMethodCall('startImageStream', arguments: <String, Object?>{
+            'cameraId': cameraId,
+            'format': 'nv12',
+            'maxWidth': 640,
+            'maxFrameRate': 15.0,
+            'maxPendingFrames': 1,
+          }),
+          isMethodCall('stopImageStream',
+              arguments: <String, Object?>{'cameraId': cameraId}),
+        ]);
+        expect(frame.format.group, ImageFormatGroup.yuv420);
+        expect(frame.width, 4);
+        expect(frame.height, 2);
+        expect(frame.planes.length, 2);
+        expect(frame.planes[0].bytes, <int>[0, 1, 2, 3, 4, 5, 6, 7]);
+        expect(frame.planes[1].bytes, <int>[8, 9, 10, 11]);
+        expect(frame.planes[1].bytesPerPixel, 2);
+        expect(frame.planes[1].width, 2);
+      });
+
+      test('Should emit CameraException when starting an image stream fails',
+          () async {
+        // Arrange
+        MethodChannelMock(
+          channelName: pluginChannelName,
+          methods: <String, dynamic>{
+            'startImageStream': PlatformException(
+              code: 'camera_error',
+              message: 'Preview not started',
+            ),
+            'stopImageStream': null,
+          },
+        );
+
+        // Act
+        final Stream<CameraImageData> frames =
+            plugin.onStreamedFrameAvailable(cameraId);
+
+        // Assert
+        expect(
+          frames.first,
+          throwsA(isA<CameraException>()
+              .having((CameraException e) => e.code, 'code', 'camera_error')),
+        );
+      });
     });
   });
 }
+
+/// This allows a value of type T or T? to be treated as a value of type T?.
+///
+/// We use this so that APIs that have become non-nullable can still be used
+/// with `!` and `?` on the stable branch.
+T? _ambiguate<T>(T? value) => value;
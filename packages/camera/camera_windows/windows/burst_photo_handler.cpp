@@ -0,0 +1,110 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "burst_photo_handler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+#include <utility>
+
+#include "file_utils.h"
+
+namespace camera_windows {
+
+namespace {
+
+// Returns the number of threads encoding photos. Half of the cores are left
+// to capture and to the app.
+size_t GetEncoderThreadCount() {
+  const size_t cores = std::thread::hardware_concurrency();
+  return std::clamp<size_t>(cores / 2, 1, 4);
+}
+
+}  // namespace
+
+BurstPhotoHandler::BurstPhotoHandler(uint32_t frame_count,
+                                     uint64_t interval_us,
+                                     const std::string& file_path_prefix,
+                                     PhotoCallback photo_callback,
+                                     CompletedCallback completed_callback)
+    : frame_count_(frame_count),
+      file_path_prefix_(file_path_prefix),
+      photo_callback_(std::move(photo_callback)),
+      completed_callback_(std::move(completed_callback)),
+      // One frame more than there are threads, so a frame can be taken
+      // while every thread is encoding.
+      burst_(frame_count, interval_us, GetEncoderThreadCount() + 1,
+             [this](uint32_t index, FrameRef frame) {
+               worker_.Post([this, index, frame = std::move(frame)]() {
+                 WritePhoto(index, frame);
+               });
+             }),
+      worker_(GetEncoderThreadCount()) {
+  assert(photo_callback_);
+  assert(completed_callback_);
+}
+
+void BurstPhotoHandler::OnFrame(const FrameBufferView& source,
+                                uint64_t sample_time_us) {
+  burst_.OnFrame(frame_format_, source, frame_width_, frame_height_,
+                 sample_time_us);
+}
+
+void BurstPhotoHandler::Stop() { OnPhotoFinished(false); }
+
+std::string BurstPhotoHandler::GetFilePath(uint32_t index) const {
+  return file_path_prefix_ + "_" + std::to_string(index + 1) + ".jpeg";
+}
+
+void BurstPhotoHandler::WritePhoto(uint32_t index, const FrameRef& frame) {
+  std::unique_ptr<JpegEncoder> encoder = AcquireEncoder();
+  std::vector<uint8_t> jpeg;
+  HRESULT hr = encoder->Encode(*frame, JpegEncodeOptions(), &jpeg);
+  ReleaseEncoder(std::move(encoder));
+
+  const std::string file_path = GetFilePath(index);
+  if (SUCCEEDED(hr)) {
+    hr = WriteFileContents(file_path, jpeg);
+  }
+  photo_callback_(index, hr, file_path);
+  OnPhotoFinished(true);
+}
+
+void BurstPhotoHandler::OnPhotoFinished(bool photo_reported) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (photo_reported) {
+      finished_photo_count_++;
+    } else {
+      stopped_ = true;
+    }
+    const uint32_t expected_count =
+        stopped_ ? burst_.GetTakenFrameCount() : frame_count_;
+    if (completed_ || finished_photo_count_ < expected_count) {
+      return;
+    }
+    completed_ = true;
+  }
+  completed_callback_();
+}
+
+std::unique_ptr<JpegEncoder> BurstPhotoHandler::AcquireEncoder() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_encoders_.empty()) {
+      std::unique_ptr<JpegEncoder> encoder = std::move(free_encoders_.back());
+      free_encoders_.pop_back();
+      return encoder;
+    }
+  }
+  return std::make_unique<JpegEncoder>();
+}
+
+void BurstPhotoHandler::ReleaseEncoder(std::unique_ptr<JpegEncoder> encoder) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  free_encoders_.push_back(std::move(encoder));
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,125 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_BURST_PHOTO_HANDLER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_BURST_PHOTO_HANDLER_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "burst_capture.h"
+#include "com_worker_pool.h"
+#include "frame_buffer_view.h"
+#include "frame_conversion.h"
+#include "frame_pool.h"
+#include "jpeg_encoder.h"
+
+namespace camera_windows {
+
+// Takes a burst of photos from preview frames.
+//
+// Frames are picked by a |BurstCapture| on the capture thread, and encoded
+// and written to files on a pool of worker threads while capture carries
+// on. Each photo is reported as soon as its file is written, so photos may
+// be reported out of order, and the burst is reported as completed once the
+// last photo is reported.
+//
+// Photos have the size of the preview frames delivered by the camera, like
+// zero-shutter-lag photos.
+class BurstPhotoHandler {
+ public:
+  // Called from a worker thread with the result of the photo at |index| in
+  // the burst.
+  using PhotoCallback = std::function<void(uint32_t index, HRESULT hr,
+                                           const std::string& file_path)>;
+
+  // Called once, after the last photo of the burst has been reported.
+  using CompletedCallback = std::function<void()>;
+
+  // Creates a burst of |frame_count| photos, taken |interval_us| apart, and
+  // written to files named after |file_path_prefix|.
+  BurstPhotoHandler(uint32_t frame_count, uint64_t interval_us,
+                    const std::string& file_path_prefix,
+                    PhotoCallback photo_callback,
+                    CompletedCallback completed_callback);
+
+  // Waits for the photos that are being encoded.
+  virtual ~BurstPhotoHandler() = default;
+
+  // Prevent copying.
+  BurstPhotoHandler(BurstPhotoHandler const&) = delete;
+  BurstPhotoHandler& operator=(BurstPhotoHandler const&) = delete;
+
+  // Updates the format of frames passed to |OnFrame|.
+  void UpdateFrameFormat(const FrameFormat& frame_format) {
+    frame_format_ = frame_format;
+  }
+
+  // Updates the size of frames passed to |OnFrame|.
+  void UpdateFrameSize(uint32_t width, uint32_t height) {
+    frame_width_ = width;
+    frame_height_ = height;
+  }
+
+  // Takes the given locked frame, presented at |sample_time_us|, if the
+  // next photo of the burst is due.
+  //
+  // Called from the capture thread. |source| is only valid for the duration
+  // of the call.
+  void OnFrame(const FrameBufferView& source, uint64_t sample_time_us);
+
+  // Returns true while frames are still to be taken.
+  bool IsCapturing() const { return !burst_.IsComplete(); }
+
+  // Ends the burst without taking more frames. Photos already taken are
+  // still written and reported, followed by the completion.
+  //
+  // Must not be called while |OnFrame| may run.
+  void Stop();
+
+  // Returns the path of the file of the photo at |index|.
+  std::string GetFilePath(uint32_t index) const;
+
+ private:
+  // Encodes and writes the photo at |index|. Called from a worker thread.
+  void WritePhoto(uint32_t index, const FrameRef& frame);
+
+  // Reports the completion once the last expected photo has been reported.
+  void OnPhotoFinished(bool photo_reported);
+
+  std::unique_ptr<JpegEncoder> AcquireEncoder();
+  void ReleaseEncoder(std::unique_ptr<JpegEncoder> encoder);
+
+  const uint32_t frame_count_;
+  const std::string file_path_prefix_;
+  PhotoCallback photo_callback_;
+  CompletedCallback completed_callback_;
+
+  FrameFormat frame_format_;
+  uint32_t frame_width_ = 0;
+  uint32_t frame_height_ = 0;
+  BurstCapture burst_;
+
+  std::mutex mutex_;
+  // Encoders that are not in use, so that each worker thread reuses the
+  // buffers of an encoder between photos.
+  std::vector<std::unique_ptr<JpegEncoder>> free_encoders_;
+  uint32_t finished_photo_count_ = 0;
+  bool stopped_ = false;
+  bool completed_ = false;
+
+  // Declared last, so that its threads are joined before the members used
+  // by its tasks are destroyed.
+  ComWorkerPool worker_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_BURST_PHOTO_HANDLER_H_
@@ -15,6 +15,8 @@ constexpr char kCameraMethodChannelBaseName[] =
 constexpr char kVideoRecordedEvent[] = "video_recorded";
 constexpr char kCameraClosingEvent[] = "camera_closing";
 constexpr char kErrorEvent[] = "error";
+constexpr char kBurstPictureEvent[] = "burst_picture";
+constexpr char kBurstCompletedEvent[] = "burst_completed";
 
 // Camera error codes
 constexpr char kCameraAccessDenied[] = "CameraAccessDenied";
@@ -50,24 +52,31 @@ CameraImpl::~CameraImpl() {
 bool CameraImpl::InitCamera(flutter::TextureRegistrar* texture_registrar,
                             flutter::BinaryMessenger* messenger,
                             bool record_audio,
-                            ResolutionPreset resolution_preset) {
+                            ResolutionPreset resolution_preset,
+                            const std::optional<MediaTypePreferences>&
+                                media_type_preferences,
+                            bool low_latency) {
   auto capture_controller_factory =
       std::make_unique<CaptureControllerFactoryImpl>();
   return InitCamera(std::move(capture_controller_factory), texture_registrar,
-                    messenger, record_audio, resolution_preset);
+                    messenger, record_audio, resolution_preset,
+                    media_type_preferences, low_latency);
 }
 
 bool CameraImpl::InitCamera(
     std::unique_ptr<CaptureControllerFactory> capture_controller_factory,
     flutter::TextureRegistrar* texture_registrar,
     flutter::BinaryMessenger* messenger, bool record_audio,
-    ResolutionPreset resolution_preset) {
+    ResolutionPreset resolution_preset,
+    const std::optional<MediaTypePreferences>& media_type_preferences,
+    bool low_latency) {
   assert(!device_id_.empty());
   messenger_ = messenger;
   capture_controller_ =
       capture_controller_factory->CreateCaptureController(this);
   return capture_controller_->InitCaptureDevice(
-      texture_registrar, device_id_, record_audio, resolution_preset);
+      texture_registrar, device_id_, record_audio, resolution_preset,
+      media_type_preferences, low_latency);
 }
 
 bool CameraImpl::AddPendingResult(
@@ -246,6 +255,14 @@ void CameraImpl::OnTakePictureSucceeded(const std::string& file_path) {
   }
 };
 
+void CameraImpl::OnTakePictureToMemorySucceeded(
+    const std::vector<uint8_t>& image) {
+  auto pending_result = GetPendingResultByType(PendingResultType::kTakePicture);
+  if (pending_result) {
+    pending_result->Success(EncodableValue(image));
+  }
+};
+
 void CameraImpl::OnTakePictureFailed(CameraResult result,
                                      const std::string& error) {
   auto pending_take_picture_result =
@@ -256,6 +273,41 @@ void CameraImpl::OnTakePictureFailed(CameraResult result,
   }
 };
 
+void CameraImpl::OnBurstPictureTaken(uint32_t index,
+                                     const std::string& file_path) {
+  if (messenger_ && camera_id_ >= 0) {
+    auto channel = GetMethodChannel();
+
+    std::unique_ptr<EncodableValue> message_data =
+        std::make_unique<EncodableValue>(EncodableMap(
+            {{EncodableValue("index"), EncodableValue(static_cast<int>(index))},
+             {EncodableValue("path"), EncodableValue(file_path)}}));
+    channel->InvokeMethod(kBurstPictureEvent, std::move(message_data));
+  }
+}
+
+void CameraImpl::OnBurstPictureFailed(uint32_t index, CameraResult result,
+                                      const std::string& error) {
+  if (messenger_ && camera_id_ >= 0) {
+    auto channel = GetMethodChannel();
+
+    std::unique_ptr<EncodableValue> message_data =
+        std::make_unique<EncodableValue>(EncodableMap(
+            {{EncodableValue("index"), EncodableValue(static_cast<int>(index))},
+             {EncodableValue("code"), EncodableValue(GetErrorCode(result))},
+             {EncodableValue("description"), EncodableValue(error)}}));
+    channel->InvokeMethod(kBurstPictureEvent, std::move(message_data));
+  }
+}
+
+void CameraImpl::OnBurstCompleted() {
+  if (messenger_ && camera_id_ >= 0) {
+    auto channel = GetMethodChannel();
+    channel->InvokeMethod(kBurstCompletedEvent,
+                          std::make_unique<EncodableValue>());
+  }
+}
+
 void CameraImpl::OnVideoRecordSucceeded(const std::string& file_path,
                                         int64_t video_duration_ms) {
   if (messenger_ && camera_id_ >= 0) {
@@ -9,6 +9,7 @@
 #include <flutter/standard_method_codec.h>
 
 #include <functional>
+#include <optional>
 
 #include "capture_controller.h"
 
@@ -65,10 +66,12 @@ class Camera : public CaptureControllerListener {
   // Initializes this camera and its associated capture controller.
   //
   // Returns false if initialization fails.
-  virtual bool InitCamera(flutter::TextureRegistrar* texture_registrar,
-                          flutter::BinaryMessenger* messenger,
-                          bool record_audio,
-                          ResolutionPreset resolution_preset) = 0;
+  virtual bool InitCamera(
+      flutter::TextureRegistrar* texture_registrar,
+      flutter::BinaryMessenger* messenger, bool record_audio,
+      ResolutionPreset resolution_preset,
+      const std::optional<MediaTypePreferences>& media_type_preferences,
+      bool low_latency) = 0;
 };
 
 // Concrete implementation of the |Camera| interface.
@@ -105,8 +108,15 @@ class CameraImpl : public Camera {
   void OnStopRecordFailed(CameraResult result,
                           const std::string& error) override;
   void OnTakePictureSucceeded(const std::string& file_path) override;
+  void OnTakePictureToMemorySucceeded(
+      const std::vector<uint8_t>& image) override;
   void OnTakePictureFailed(CameraResult result,
                            const std::string& error) override;
+  void OnBurstPictureTaken(uint32_t index,
+                           const std::string& file_path) override;
+  void OnBurstPictureFailed(uint32_t index, CameraResult result,
+                            const std::string& error) override;
+  void OnBurstCompleted() override;
   void OnVideoRecordSucceeded(const std::string& file_path,
                               int64_t video_duration) override;
   void OnVideoRecordFailed(CameraResult result,
@@ -128,7 +138,10 @@ class CameraImpl : public Camera {
   }
   bool InitCamera(flutter::TextureRegistrar* texture_registrar,
                   flutter::BinaryMessenger* messenger, bool record_audio,
-                  ResolutionPreset resolution_preset) override;
+                  ResolutionPreset resolution_preset,
+                  const std::optional<MediaTypePreferences>&
+                      media_type_preferences,
+                  bool low_latency) override;
 
   // Initializes the camera and its associated capture controller.
   //
@@ -140,7 +153,9 @@ class CameraImpl : public Camera {
       std::unique_ptr<CaptureControllerFactory> capture_controller_factory,
       flutter::TextureRegistrar* texture_registrar,
       flutter::BinaryMessenger* messenger, bool record_audio,
-      ResolutionPreset resolution_preset);
+      ResolutionPreset resolution_preset,
+      const std::optional<MediaTypePreferences>& media_type_preferences,
+      bool low_latency);
 
  private:
   // Loops through all pending results and calls their error handler with given
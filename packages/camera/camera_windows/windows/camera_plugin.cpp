@@ -16,7 +16,10 @@
 
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <memory>
+#include <utility>
 
 #include "capture_device_info.h"
 #include "com_heap_ptr.h"
@@ -31,23 +34,71 @@ namespace {
 
 // Channel events
 constexpr char kChannelName[] = "plugins.flutter.io/camera_windows";
+constexpr char kCamerasChangedEvent[] = "cameras_changed";
 
 constexpr char kAvailableCamerasMethod[] = "availableCameras";
 constexpr char kCreateMethod[] = "create";
 constexpr char kInitializeMethod[] = "initialize";
 constexpr char kTakePictureMethod[] = "takePicture";
+constexpr char kTakePictureToMemoryMethod[] = "takePictureToMemory";
 constexpr char kStartVideoRecordingMethod[] = "startVideoRecording";
 constexpr char kStopVideoRecordingMethod[] = "stopVideoRecording";
 constexpr char kPausePreview[] = "pausePreview";
 constexpr char kResumePreview[] = "resumePreview";
+constexpr char kGetPreviewStatsMethod[] = "getPreviewStats";
+constexpr char kStartImageStreamMethod[] = "startImageStream";
+constexpr char kStopImageStreamMethod[] = "stopImageStream";
+constexpr char kSetZeroShutterLagMethod[] = "setZeroShutterLag";
+constexpr char kStartBurstMethod[] = "startBurst";
+constexpr char kStopBurstMethod[] = "stopBurst";
+constexpr char kSetPreviewFrameRateLimitMethod[] = "setPreviewFrameRateLimit";
+constexpr char kSetCaptureThreadMethod[] = "setCaptureThread";
+constexpr char kSetPreviewCropMethod[] = "setPreviewCrop";
+constexpr char kGetMaxPreviewZoomMethod[] = "getMaxPreviewZoom";
 constexpr char kDisposeMethod[] = "dispose";
 
 constexpr char kCameraNameKey[] = "cameraName";
 constexpr char kResolutionPresetKey[] = "resolutionPreset";
 constexpr char kEnableAudioKey[] = "enableAudio";
+constexpr char kMediaTypePreferencesKey[] = "mediaTypePreferences";
+constexpr char kLowLatencyKey[] = "lowLatency";
+constexpr char kTargetWidthKey[] = "targetWidth";
+constexpr char kTargetHeightKey[] = "targetHeight";
+constexpr char kMinFrameRateKey[] = "minFrameRate";
+constexpr char kPreferredFrameRateKey[] = "preferredFrameRate";
+constexpr char kNV12CostKey[] = "nv12Cost";
+constexpr char kYUY2CostKey[] = "yuy2Cost";
+constexpr char kRGBCostKey[] = "rgbCost";
+constexpr char kMJPGCostKey[] = "mjpgCost";
+constexpr char kOtherCostKey[] = "otherCost";
 
 constexpr char kCameraIdKey[] = "cameraId";
 constexpr char kMaxVideoDurationKey[] = "maxVideoDuration";
+constexpr char kImageFormatKey[] = "format";
+constexpr char kMaxWidthKey[] = "maxWidth";
+constexpr char kMaxHeightKey[] = "maxHeight";
+constexpr char kMaxFrameRateKey[] = "maxFrameRate";
+constexpr char kMaxPendingFramesKey[] = "maxPendingFrames";
+constexpr char kEnabledKey[] = "enabled";
+constexpr char kQualityKey[] = "quality";
+constexpr char kCountKey[] = "count";
+constexpr char kIntervalKey[] = "interval";
+constexpr char kMatchDisplayRefreshRateKey[] = "matchDisplayRefreshRate";
+constexpr char kDedicatedKey[] = "dedicated";
+constexpr char kCpuAffinityMaskKey[] = "cpuAffinityMask";
+constexpr char kLeftKey[] = "left";
+constexpr char kTopKey[] = "top";
+constexpr char kWidthKey[] = "width";
+constexpr char kHeightKey[] = "height";
+constexpr char kZoomKey[] = "zoom";
+
+constexpr char kImageFormatValueRGBA[] = "rgba";
+constexpr char kImageFormatValueBGRA[] = "bgra";
+constexpr char kImageFormatValueNV12[] = "nv12";
+constexpr char kImageFormatValueLuma[] = "luma";
+
+constexpr char kImageStreamChannelBaseName[] =
+    "plugins.flutter.io/camera_windows/imageStream";
 
 constexpr char kResolutionPresetValueLow[] = "low";
 constexpr char kResolutionPresetValueMedium[] = "medium";
@@ -88,6 +139,23 @@ std::optional<int64_t> GetInt64ValueOrNull(const EncodableMap& map,
   return *val64;
 }
 
+// Looks for the optional size or count |key| in |map|, storing its value in
+// |value| if it is present. |value| is left unchanged if it is not.
+//
+// Returns false if the value is negative or does not fit in 32 bits.
+bool GetUint32ValueIfPresent(const EncodableMap& map, const char* key,
+                             uint32_t* value) {
+  auto argument = GetInt64ValueOrNull(map, key);
+  if (!argument) {
+    return true;
+  }
+  if (*argument < 0 || *argument > UINT32_MAX) {
+    return false;
+  }
+  *value = static_cast<uint32_t>(*argument);
+  return true;
+}
+
 // Parses resolution preset argument to enum value.
 ResolutionPreset ParseResolutionPreset(const std::string& resolution_preset) {
   if (resolution_preset.compare(kResolutionPresetValueLow) == 0) {
@@ -106,6 +174,72 @@ ResolutionPreset ParseResolutionPreset(const std::string& resolution_preset) {
   return ResolutionPreset::kAuto;
 }
 
+// Parses image format argument to enum value.
+//
+// Returns false if |image_format| is not a known format.
+bool ParseImageStreamFormat(const std::string& image_format,
+                            ImageStreamFormat* format) {
+  if (image_format.compare(kImageFormatValueRGBA) == 0) {
+    *format = ImageStreamFormat::kRGBA;
+  } else if (image_format.compare(kImageFormatValueBGRA) == 0) {
+    *format = ImageStreamFormat::kBGRA;
+  } else if (image_format.compare(kImageFormatValueNV12) == 0) {
+    *format = ImageStreamFormat::kNV12;
+  } else if (image_format.compare(kImageFormatValueLuma) == 0) {
+    *format = ImageStreamFormat::kLuma;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Parses media type preferences argument. Missing values keep their
+// defaults.
+//
+// Returns false if a value is invalid.
+bool ParseMediaTypePreferences(const EncodableMap& map,
+                               MediaTypePreferences* preferences) {
+  if (!GetUint32ValueIfPresent(map, kTargetWidthKey,
+                               &preferences->target_width) ||
+      !GetUint32ValueIfPresent(map, kTargetHeightKey,
+                               &preferences->target_height)) {
+    return false;
+  }
+
+  // Frame rates must not be negative, while costs are clamped when used.
+  const std::pair<const char*, float*> frame_rates[] = {
+      {kMinFrameRateKey, &preferences->minimum_frame_rate},
+      {kPreferredFrameRateKey, &preferences->preferred_frame_rate},
+  };
+  for (const auto& [key, value] : frame_rates) {
+    const auto* argument = std::get_if<double>(ValueOrNull(map, key));
+    if (argument) {
+      if (!std::isfinite(*argument) || *argument < 0) {
+        return false;
+      }
+      *value = static_cast<float>(*argument);
+    }
+  }
+
+  const std::pair<const char*, float*> costs[] = {
+      {kNV12CostKey, &preferences->nv12_cost},
+      {kYUY2CostKey, &preferences->yuy2_cost},
+      {kRGBCostKey, &preferences->rgb32_cost},
+      {kMJPGCostKey, &preferences->mjpg_cost},
+      {kOtherCostKey, &preferences->other_cost},
+  };
+  for (const auto& [key, value] : costs) {
+    const auto* argument = std::get_if<double>(ValueOrNull(map, key));
+    if (argument) {
+      if (!std::isfinite(*argument)) {
+        return false;
+      }
+      *value = static_cast<float>(*argument);
+    }
+  }
+  return true;
+}
+
 // Builds CaptureDeviceInfo object from given device holding device name and id.
 std::unique_ptr<CaptureDeviceInfo> GetDeviceInfo(IMFActivate* device) {
   assert(device);
@@ -173,6 +307,20 @@ std::optional<std::string> GetFilePathForPicture() {
          kPictureCaptureExtension;
 }
 
+// Builds the prefix of the file paths of a burst of photos.
+std::optional<std::string> GetFilePathPrefixForBurst() {
+  ComHeapPtr<wchar_t> known_folder_path;
+  HRESULT hr = SHGetKnownFolderPath(FOLDERID_Pictures, KF_FLAG_CREATE, nullptr,
+                                    &known_folder_path);
+  if (FAILED(hr)) {
+    return std::nullopt;
+  }
+
+  std::string path = Utf8FromUtf16(std::wstring(known_folder_path));
+
+  return path + "\\" + "BurstCapture_" + GetCurrentTimeString();
+}
+
 // Builds file path for video capture.
 std::optional<std::string> GetFilePathForVideo() {
   ComHeapPtr<wchar_t> known_folder_path;
@@ -204,6 +352,28 @@ void CameraPlugin::RegisterWithRegistrar(
         plugin_pointer->HandleMethodCall(call, std::move(result));
       });
 
+  auto platform_task_runner =
+      std::make_unique<PlatformTaskRunnerImpl>(registrar);
+  if (platform_task_runner->Register()) {
+    plugin->platform_task_runner_ = std::move(platform_task_runner);
+  }
+
+  plugin->device_change_notifier_ = std::make_unique<DeviceChangeNotifier>(
+      registrar, [plugin_pointer = plugin.get()]() {
+        plugin_pointer->OnVideoCaptureDevicesChanged();
+      });
+  plugin->device_notifications_active_ =
+      plugin->device_change_notifier_->Register();
+
+  plugin->display_refresh_monitor_ = std::make_unique<DisplayRefreshMonitor>(
+      registrar, [plugin_pointer = plugin.get()](double refresh_rate) {
+        plugin_pointer->OnDisplayRefreshRateChanged(refresh_rate);
+      });
+  if (plugin->display_refresh_monitor_->Register()) {
+    plugin->display_refresh_rate_ =
+        plugin->display_refresh_monitor_->GetRefreshRate();
+  }
+
   registrar->AddPlugin(std::move(plugin));
 }
 
@@ -247,6 +417,12 @@ void CameraPlugin::HandleMethodCall(
     assert(arguments);
 
     return TakePictureMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kTakePictureToMemoryMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return TakePictureToMemoryMethodHandler(*arguments, std::move(result));
   } else if (method_name.compare(kStartVideoRecordingMethod) == 0) {
     const auto* arguments =
         std::get_if<flutter::EncodableMap>(method_call.arguments());
@@ -271,6 +447,67 @@ void CameraPlugin::HandleMethodCall(
     assert(arguments);
 
     return ResumePreviewMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kGetPreviewStatsMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return GetPreviewStatsMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kStartImageStreamMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return StartImageStreamMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kStopImageStreamMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return StopImageStreamMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kSetZeroShutterLagMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return SetZeroShutterLagMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kStartBurstMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return StartBurstMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kStopBurstMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return StopBurstMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kSetPreviewFrameRateLimitMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return SetPreviewFrameRateLimitMethodHandler(*arguments,
+                                                 std::move(result));
+  } else if (method_name.compare(kSetCaptureThreadMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return SetCaptureThreadMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kSetPreviewCropMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return SetPreviewCropMethodHandler(*arguments, std::move(result));
+  } else if (method_name.compare(kGetMaxPreviewZoomMethod) == 0) {
+    const auto* arguments =
+        std::get_if<flutter::EncodableMap>(method_call.arguments());
+    assert(arguments);
+
+    return GetMaxPreviewZoomMethodHandler(*arguments, std::move(result));
   } else if (method_name.compare(kDisposeMethod) == 0) {
     const auto* arguments =
         std::get_if<flutter::EncodableMap>(method_call.arguments());
@@ -309,30 +546,70 @@ void CameraPlugin::DisposeCameraByCameraId(int64_t camera_id) {
   }
 }
 
-void CameraPlugin::AvailableCamerasMethodHandler(
-    std::unique_ptr<flutter::MethodResult<>> result) {
-  // Enumerate devices.
+void CameraPlugin::OnVideoCaptureDevicesChanged() {
+  if (!device_list_cache_.OnDevicesChanged() || !messenger_) {
+    return;
+  }
+  GetPluginChannel()->InvokeMethod(kCamerasChangedEvent,
+                                   std::make_unique<EncodableValue>());
+}
+
+void CameraPlugin::OnDisplayRefreshRateChanged(double refresh_rate) {
+  display_refresh_rate_ = refresh_rate;
+  for (const std::unique_ptr<Camera>& camera : cameras_) {
+    if (auto cc = camera->GetCaptureController()) {
+      cc->SetDisplayRefreshRate(refresh_rate);
+    }
+  }
+}
+
+flutter::MethodChannel<>* CameraPlugin::GetPluginChannel() {
+  assert(messenger_);
+  if (!plugin_channel_) {
+    // Only used to send events; method calls are handled by the channel
+    // created at registration.
+    plugin_channel_ = std::make_unique<flutter::MethodChannel<>>(
+        messenger_, kChannelName,
+        &flutter::StandardMethodCodec::GetInstance());
+  }
+  return plugin_channel_.get();
+}
+
+bool CameraPlugin::EnumerateDeviceNames(
+    std::vector<std::string>* device_names) {
   ComHeapPtr<IMFActivate*> devices;
   UINT32 count = 0;
   if (!this->EnumerateVideoCaptureDeviceSources(&devices, &count)) {
-    result->Error("System error", "Failed to get available cameras");
     // No need to free devices here, cos allocation failed.
-    return;
+    return false;
   }
 
-  if (count == 0) {
-    result->Success(EncodableValue(EncodableList()));
-    return;
+  device_names->clear();
+  for (UINT32 i = 0; i < count; ++i) {
+    auto device_info = GetDeviceInfo(devices[i]);
+    device_names->push_back(device_info->GetUniqueDeviceName());
+  }
+  return true;
+}
+
+void CameraPlugin::AvailableCamerasMethodHandler(
+    std::unique_ptr<flutter::MethodResult<>> result) {
+  std::vector<std::string> device_names;
+  if (!device_notifications_active_ ||
+      !device_list_cache_.GetDeviceNames(&device_names)) {
+    // Enumerate devices.
+    if (!EnumerateDeviceNames(&device_names)) {
+      result->Error("System error", "Failed to get available cameras");
+      return;
+    }
+    device_list_cache_.Update(device_names);
   }
 
   // Format found devices to the response.
   EncodableList devices_list;
-  for (UINT32 i = 0; i < count; ++i) {
-    auto device_info = GetDeviceInfo(devices[i]);
-    auto deviceName = device_info->GetUniqueDeviceName();
-
+  for (const std::string& device_name : device_names) {
     devices_list.push_back(EncodableMap({
-        {EncodableValue("name"), EncodableValue(deviceName)},
+        {EncodableValue("name"), EncodableValue(device_name)},
         {EncodableValue("lensFacing"), EncodableValue("front")},
         {EncodableValue("sensorOrientation"), EncodableValue(0)},
     }));
@@ -371,6 +648,23 @@ void CameraPlugin::CreateMethodHandler(
         "camera_error", "Cannot parse argument " + std::string(kCameraNameKey));
   }
 
+  // Parse optional mediaTypePreferences argument.
+  std::optional<MediaTypePreferences> media_type_preferences;
+  const auto* media_type_preferences_argument =
+      std::get_if<EncodableMap>(ValueOrNull(args, kMediaTypePreferencesKey));
+  if (media_type_preferences_argument) {
+    media_type_preferences.emplace();
+    if (!ParseMediaTypePreferences(*media_type_preferences_argument,
+                                   &*media_type_preferences)) {
+      return result->Error("argument_error",
+                           "Invalid media type preferences");
+    }
+  }
+
+  // Parse optional lowLatency argument.
+  const auto* low_latency =
+      std::get_if<bool>(ValueOrNull(args, kLowLatencyKey));
+
   auto device_id = device_info->GetDeviceId();
   if (GetCameraByDeviceId(device_id)) {
     return result->Error("camera_error",
@@ -398,9 +692,16 @@ void CameraPlugin::CreateMethodHandler(
       resolution_preset = ResolutionPreset::kAuto;
     }
 
-    bool initialized = camera->InitCamera(texture_registrar_, messenger_,
-                                          *record_audio, resolution_preset);
+    bool initialized =
+        camera->InitCamera(texture_registrar_, messenger_, *record_audio,
+                           resolution_preset, media_type_preferences,
+                           low_latency && *low_latency);
     if (initialized) {
+      if (platform_task_runner_) {
+        if (auto cc = camera->GetCaptureController()) {
+          cc->SetPlatformTaskRunner(platform_task_runner_.get());
+        }
+      }
       cameras_.push_back(std::move(camera));
     }
   }
@@ -484,6 +785,334 @@ void CameraPlugin::ResumePreviewMethodHandler(
   }
 }
 
+void CameraPlugin::GetPreviewStatsMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  PreviewStatsSnapshot stats;
+  if (!cc || !cc->GetPreviewStats(&stats)) {
+    return result->Error("camera_error", "Preview not started");
+  }
+
+  // Counters and durations, in microseconds, fit in 64-bit integers.
+  auto value = [](uint64_t number) {
+    return EncodableValue(static_cast<int64_t>(number));
+  };
+  result->Success(EncodableValue(EncodableMap({
+      {EncodableValue("framesDelivered"), value(stats.frames_delivered)},
+      {EncodableValue("framesFailed"), value(stats.frames_failed)},
+      {EncodableValue("framesDropped"), value(stats.frames_dropped)},
+      {EncodableValue("framesRendered"), value(stats.frames_rendered)},
+      {EncodableValue("framesSkipped"), value(stats.frames_skipped)},
+      {EncodableValue("frameIntervalP50"), value(stats.frame_interval_p50_us)},
+      {EncodableValue("frameIntervalP99"), value(stats.frame_interval_p99_us)},
+      {EncodableValue("schedulingLatencyP50"),
+       value(stats.scheduling_latency_p50_us)},
+      {EncodableValue("schedulingLatencyP99"),
+       value(stats.scheduling_latency_p99_us)},
+      {EncodableValue("conversionTimeP50"),
+       value(stats.conversion_time_p50_us)},
+      {EncodableValue("conversionTimeP99"),
+       value(stats.conversion_time_p99_us)},
+      {EncodableValue("captureToTextureP50"),
+       value(stats.capture_to_texture_p50_us)},
+      {EncodableValue("captureToTextureP99"),
+       value(stats.capture_to_texture_p99_us)},
+      {EncodableValue("captureLatencyP50"),
+       value(stats.capture_latency_p50_us)},
+      {EncodableValue("captureLatencyP99"),
+       value(stats.capture_latency_p99_us)},
+      {EncodableValue("textureHoldTimeP50"),
+       value(stats.texture_hold_time_p50_us)},
+      {EncodableValue("textureHoldTimeP99"),
+       value(stats.texture_hold_time_p99_us)},
+  })));
+}
+
+void CameraPlugin::StartImageStreamMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  ImageStreamOptions options;
+  const auto* image_format =
+      std::get_if<std::string>(ValueOrNull(args, kImageFormatKey));
+  if (image_format && !ParseImageStreamFormat(*image_format, &options.format)) {
+    return result->Error("argument_error",
+                         "Unknown image format " + *image_format);
+  }
+
+  // Sizes and counts are optional, must not be negative and must fit in 32
+  // bits.
+  const auto* max_frame_rate =
+      std::get_if<double>(ValueOrNull(args, kMaxFrameRateKey));
+  if (!GetUint32ValueIfPresent(args, kMaxWidthKey, &options.max_width) ||
+      !GetUint32ValueIfPresent(args, kMaxHeightKey, &options.max_height) ||
+      !GetUint32ValueIfPresent(args, kMaxPendingFramesKey,
+                               &options.max_pending_frames) ||
+      options.max_pending_frames < 1 ||
+      (max_frame_rate && *max_frame_rate < 0)) {
+    return result->Error("argument_error", "Invalid image stream options");
+  }
+  options.max_frame_rate = max_frame_rate ? *max_frame_rate : 0;
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  auto image_stream_handler = std::make_unique<ImageStreamHandler>(
+      messenger_,
+      std::string(kImageStreamChannelBaseName) + std::to_string(*camera_id),
+      options, platform_task_runner_.get());
+  if (!cc->StartImageStream(std::move(image_stream_handler))) {
+    return result->Error(
+        "camera_error",
+        "Preview not started, or image format not supported by the camera");
+  }
+  result->Success();
+}
+
+void CameraPlugin::StopImageStreamMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  cc->StopImageStream();
+  result->Success();
+}
+
+void CameraPlugin::SetZeroShutterLagMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  const auto* enabled = std::get_if<bool>(ValueOrNull(args, kEnabledKey));
+  if (!enabled) {
+    return result->Error("argument_error",
+                         std::string(kEnabledKey) + " missing");
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  if (!cc->SetZeroShutterLag(*enabled)) {
+    return result->Error("camera_error", "Preview not started");
+  }
+  result->Success();
+}
+
+void CameraPlugin::StartBurstMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  auto count = GetInt64ValueOrNull(args, kCountKey);
+  if (!count) {
+    return result->Error("argument_error",
+                         std::string(kCountKey) + " missing");
+  }
+  auto interval_ms = GetInt64ValueOrNull(args, kIntervalKey);
+  if (*count <= 0 || *count > UINT32_MAX ||
+      (interval_ms && *interval_ms < 0)) {
+    return result->Error("argument_error", "Invalid burst options");
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  std::optional<std::string> path_prefix = GetFilePathPrefixForBurst();
+  if (!path_prefix) {
+    return result->Error("system_error",
+                         "Failed to get capture path for burst");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  if (!cc->StartBurst(static_cast<uint32_t>(*count),
+                      interval_ms ? *interval_ms : 0, *path_prefix)) {
+    return result->Error("camera_error",
+                         "Preview not started or burst already running");
+  }
+  result->Success();
+}
+
+void CameraPlugin::StopBurstMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  cc->StopBurst();
+  result->Success();
+}
+
+void CameraPlugin::SetPreviewFrameRateLimitMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  // Without a maximum frame rate, the preview is only limited by the
+  // display, if asked to.
+  const auto* max_frame_rate =
+      std::get_if<double>(ValueOrNull(args, kMaxFrameRateKey));
+  if (max_frame_rate &&
+      (!std::isfinite(*max_frame_rate) || *max_frame_rate < 0)) {
+    return result->Error("argument_error", "Invalid preview frame rate limit");
+  }
+  const auto* match_display_refresh_rate =
+      std::get_if<bool>(ValueOrNull(args, kMatchDisplayRefreshRateKey));
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  cc->SetDisplayRefreshRate(display_refresh_rate_);
+  cc->SetPreviewFrameRateLimit(
+      max_frame_rate ? *max_frame_rate : 0,
+      match_display_refresh_rate && *match_display_refresh_rate);
+  result->Success();
+}
+
+void CameraPlugin::SetCaptureThreadMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  const auto* dedicated = std::get_if<bool>(ValueOrNull(args, kDedicatedKey));
+  if (!dedicated) {
+    return result->Error("argument_error",
+                         std::string(kDedicatedKey) + " missing");
+  }
+
+  // Without an affinity mask, the thread may run on any processor.
+  auto cpu_affinity_mask = GetInt64ValueOrNull(args, kCpuAffinityMaskKey);
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  if (!cc->SetCaptureThread(
+          *dedicated,
+          cpu_affinity_mask ? static_cast<uint64_t>(*cpu_affinity_mask) : 0)) {
+    return result->Error("argument_error", "Invalid CPU affinity mask");
+  }
+  result->Success();
+}
+
+void CameraPlugin::SetPreviewCropMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  // Values that are not passed are kept, so that the crop rectangle and the
+  // zoom factor can be set separately.
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  PreviewCrop crop = cc->GetPreviewCrop();
+  const std::pair<const char*, double*> values[] = {
+      {kLeftKey, &crop.left},
+      {kTopKey, &crop.top},
+      {kWidthKey, &crop.width},
+      {kHeightKey, &crop.height},
+      {kZoomKey, &crop.zoom},
+  };
+  for (const auto& [key, value] : values) {
+    const auto* argument = std::get_if<double>(ValueOrNull(args, key));
+    if (argument) {
+      *value = *argument;
+    }
+  }
+  if (!cc->SetPreviewCrop(crop)) {
+    return result->Error("argument_error", "Invalid preview crop");
+  }
+  result->Success();
+}
+
+void CameraPlugin::GetMaxPreviewZoomMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  auto cc = camera->GetCaptureController();
+  assert(cc);
+  result->Success(EncodableValue(GetMaxPreviewZoom(cc->GetPreviewHeight())));
+}
+
 void CameraPlugin::StartVideoRecordingMethodHandler(
     const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
   auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
@@ -581,6 +1210,43 @@ void CameraPlugin::TakePictureMethodHandler(
   }
 }
 
+void CameraPlugin::TakePictureToMemoryMethodHandler(
+    const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
+  auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
+  if (!camera_id) {
+    return result->Error("argument_error",
+                         std::string(kCameraIdKey) + " missing");
+  }
+
+  // Quality and sizes are optional.
+  JpegEncodeOptions options;
+  const auto* quality = std::get_if<double>(ValueOrNull(args, kQualityKey));
+  if ((quality && (*quality < 0 || *quality > 1)) ||
+      !GetUint32ValueIfPresent(args, kMaxWidthKey, &options.max_width) ||
+      !GetUint32ValueIfPresent(args, kMaxHeightKey, &options.max_height)) {
+    return result->Error("argument_error", "Invalid picture options");
+  }
+  if (quality) {
+    options.quality = static_cast<float>(*quality);
+  }
+
+  auto camera = GetCameraByCameraId(*camera_id);
+  if (!camera) {
+    return result->Error("camera_error", "Camera not created");
+  }
+
+  if (camera->HasPendingResultByType(PendingResultType::kTakePicture)) {
+    return result->Error("camera_error", "Pending take picture request exists");
+  }
+
+  if (camera->AddPendingResult(PendingResultType::kTakePicture,
+                               std::move(result))) {
+    auto cc = camera->GetCaptureController();
+    assert(cc);
+    cc->TakePictureToMemory(options);
+  }
+}
+
 void CameraPlugin::DisposeMethodHandler(
     const EncodableMap& args, std::unique_ptr<flutter::MethodResult<>> result) {
   auto camera_id = GetInt64ValueOrNull(args, kCameraIdKey);
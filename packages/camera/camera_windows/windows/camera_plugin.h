@@ -11,10 +11,17 @@
 #include <flutter/standard_method_codec.h>
 
 #include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "camera.h"
 #include "capture_controller.h"
 #include "capture_controller_listener.h"
+#include "device_change_notifier.h"
+#include "device_list_cache.h"
+#include "display_refresh_monitor.h"
+#include "platform_task_runner.h"
 
 namespace camera_windows {
 using flutter::MethodResult;
@@ -26,6 +33,14 @@ class MockCameraPlugin;
 }  // namespace
 }  // namespace test
 
+// Handles the method calls of the plugin, and owns the cameras it opens.
+//
+// Cameras of all plugin instances share a few process-wide objects, which
+// are created on first use and never destroyed: the |MediaContext|, the
+// |MediaTypeStore| and the pool converting preview frames. Static
+// destructors run while the module is unloaded, with the loader lock held,
+// when threads can no longer be joined and cameras of other instances may
+// still exist. The memory is returned when the process exits.
 class CameraPlugin : public flutter::Plugin,
                      public VideoCaptureDeviceEnumerator {
  public:
@@ -50,6 +65,15 @@ class CameraPlugin : public flutter::Plugin,
   void HandleMethodCall(const flutter::MethodCall<>& method_call,
                         std::unique_ptr<MethodResult<>> result);
 
+  // Called when video capture devices are added to or removed from the
+  // system. Drops the cached device list, and tells Dart that the list of
+  // available cameras changed.
+  void OnVideoCaptureDevicesChanged();
+
+  // Called when the refresh rate of the display showing the Flutter view
+  // changes. Passes it on to the cameras, to pace previews that follow it.
+  void OnDisplayRefreshRateChanged(double refresh_rate);
+
  private:
   // Loops through cameras and returns camera
   // with matching device_id or nullptr.
@@ -66,9 +90,15 @@ class CameraPlugin : public flutter::Plugin,
   bool EnumerateVideoCaptureDeviceSources(IMFActivate*** devices,
                                           UINT32* count) override;
 
+  // Enumerates video capture devices and returns their unique names.
+  bool EnumerateDeviceNames(std::vector<std::string>* device_names);
+
+  // Returns the plugin channel, used to send events to Dart.
+  flutter::MethodChannel<>* GetPluginChannel();
+
   // Handles availableCameras method calls.
-  // Enumerates video capture devices and
-  // returns list of available camera devices.
+  // Returns list of available camera devices, enumerating video capture
+  // devices only if they may have changed since the last call.
   void AvailableCamerasMethodHandler(
       std::unique_ptr<flutter::MethodResult<>> result);
 
@@ -90,6 +120,11 @@ class CameraPlugin : public flutter::Plugin,
   void TakePictureMethodHandler(const EncodableMap& args,
                                 std::unique_ptr<MethodResult<>> result);
 
+  // Handles takePictureToMemory method calls.
+  // Captures a photo and returns it encoded as JPEG, without writing a file.
+  void TakePictureToMemoryMethodHandler(const EncodableMap& args,
+                                        std::unique_ptr<MethodResult<>> result);
+
   // Handles startVideoRecording method calls.
   // Requests existing camera controller to start recording.
   // Stores result object to be handled after request is processed.
@@ -114,6 +149,61 @@ class CameraPlugin : public flutter::Plugin,
   void ResumePreviewMethodHandler(const EncodableMap& args,
                                   std::unique_ptr<MethodResult<>> result);
 
+  // Handles getPreviewStats method calls.
+  // Returns the frame counters and timings of the camera preview, with
+  // durations in microseconds.
+  void GetPreviewStatsMethodHandler(const EncodableMap& args,
+                                    std::unique_ptr<MethodResult<>> result);
+
+  // Handles startImageStream method calls.
+  // Starts sending preview frames of the camera to its image stream channel,
+  // converted to the requested format and size.
+  void StartImageStreamMethodHandler(const EncodableMap& args,
+                                     std::unique_ptr<MethodResult<>> result);
+
+  // Handles stopImageStream method calls.
+  // Stops sending preview frames of the camera.
+  void StopImageStreamMethodHandler(const EncodableMap& args,
+                                    std::unique_ptr<MethodResult<>> result);
+
+  // Handles setZeroShutterLag method calls.
+  // Enables or disables taking photos from recently captured preview frames.
+  void SetZeroShutterLagMethodHandler(const EncodableMap& args,
+                                      std::unique_ptr<MethodResult<>> result);
+
+  // Handles startBurst method calls.
+  // Starts taking a burst of photos from preview frames, which are reported
+  // as camera events as soon as each one is written.
+  void StartBurstMethodHandler(const EncodableMap& args,
+                               std::unique_ptr<MethodResult<>> result);
+
+  // Handles stopBurst method calls.
+  // Stops taking the running burst of photos.
+  void StopBurstMethodHandler(const EncodableMap& args,
+                              std::unique_ptr<MethodResult<>> result);
+
+  // Handles setPreviewFrameRateLimit method calls.
+  // Limits the frame rate of the preview of the camera.
+  void SetPreviewFrameRateLimitMethodHandler(
+      const EncodableMap& args, std::unique_ptr<MethodResult<>> result);
+
+  // Handles setCaptureThread method calls.
+  // Moves the processing of preview frames of the camera to a dedicated
+  // thread, or back to the thread of the capture engine.
+  void SetCaptureThreadMethodHandler(const EncodableMap& args,
+                                     std::unique_ptr<MethodResult<>> result);
+
+  // Handles setPreviewCrop method calls.
+  // Sets the crop rectangle and digital zoom of the preview of the camera.
+  void SetPreviewCropMethodHandler(const EncodableMap& args,
+                                   std::unique_ptr<MethodResult<>> result);
+
+  // Handles getMaxPreviewZoom method calls.
+  // Returns the largest digital zoom of the preview of the camera, which
+  // depends on the height of its preview frames.
+  void GetMaxPreviewZoomMethodHandler(const EncodableMap& args,
+                                      std::unique_ptr<MethodResult<>> result);
+
   // Handles dsipose method calls.
   // Disposes camera if exists.
   void DisposeMethodHandler(const EncodableMap& args,
@@ -122,7 +212,26 @@ class CameraPlugin : public flutter::Plugin,
   std::unique_ptr<CameraFactory> camera_factory_;
   flutter::TextureRegistrar* texture_registrar_;
   flutter::BinaryMessenger* messenger_;
+  // Reports results of worker threads on the platform thread. Declared
+  // before |cameras_|, so that it outlives them. Null until registered with
+  // a registrar.
+  std::unique_ptr<PlatformTaskRunnerImpl> platform_task_runner_;
   std::vector<std::unique_ptr<Camera>> cameras_;
+  std::unique_ptr<flutter::MethodChannel<>> plugin_channel_;
+
+  // The device list is only cached while device notifications are
+  // received, so that it is never kept out of date.
+  DeviceListCache device_list_cache_;
+  bool device_notifications_active_ = false;
+
+  // Refresh rate of the display showing the Flutter view, or 0 if it is
+  // unknown.
+  double display_refresh_rate_ = 0;
+
+  // Declared last, so that notifications stop before the members they use
+  // are destroyed.
+  std::unique_ptr<DeviceChangeNotifier> device_change_notifier_;
+  std::unique_ptr<DisplayRefreshMonitor> display_refresh_monitor_;
 
   friend class camera_windows::test::MockCameraPlugin;
 };
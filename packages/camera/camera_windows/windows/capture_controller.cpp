@@ -4,14 +4,19 @@
 
 #include "capture_controller.h"
 
+#include <avrt.h>
 #include <comdef.h>
 #include <wincodec.h>
 #include <wrl/client.h>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <vector>
 
 #include "com_heap_ptr.h"
+#include "media_type_selection.h"
+#include "media_type_store.h"
 #include "photo_handler.h"
 #include "preview_handler.h"
 #include "record_handler.h"
@@ -22,6 +27,10 @@ namespace camera_windows {
 
 using Microsoft::WRL::ComPtr;
 
+// Frames the camera may buffer in low-latency mode: one being filled while
+// the previous one is processed.
+constexpr UINT32 kLowLatencySourceBufferCount = 2;
+
 CameraResult GetCameraResult(HRESULT hr) {
   if (SUCCEEDED(hr)) {
     return CameraResult::kSuccess;
@@ -36,7 +45,12 @@ CaptureControllerImpl::CaptureControllerImpl(
     : capture_controller_listener_(listener), CaptureController(){};
 
 CaptureControllerImpl::~CaptureControllerImpl() {
+  // Joins the worker threads of the photo handlers, which post no more
+  // results afterwards.
   ResetCaptureController();
+  if (platform_task_runner_) {
+    platform_task_runner_->CancelTasks(this);
+  }
   capture_controller_listener_ = nullptr;
 };
 
@@ -122,7 +136,7 @@ HRESULT CaptureControllerImpl::CreateVideoCaptureSourceForDevice(
 
   ComPtr<IMFAttributes> video_capture_source_attributes;
 
-  HRESULT hr = MFCreateAttributes(&video_capture_source_attributes, 2);
+  HRESULT hr = MFCreateAttributes(&video_capture_source_attributes, 4);
   if (FAILED(hr)) {
     return hr;
   }
@@ -141,39 +155,24 @@ HRESULT CaptureControllerImpl::CreateVideoCaptureSourceForDevice(
     return hr;
   }
 
-  hr = MFCreateDeviceSource(video_capture_source_attributes.Get(),
-                            video_source_.GetAddressOf());
-  return hr;
-}
-
-HRESULT CaptureControllerImpl::CreateD3DManagerWithDX11Device() {
-  // TODO: Use existing ANGLE device
-
-  HRESULT hr = S_OK;
-  hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr,
-                         D3D11_CREATE_DEVICE_VIDEO_SUPPORT, nullptr, 0,
-                         D3D11_SDK_VERSION, &dx11_device_, nullptr, nullptr);
-  if (FAILED(hr)) {
-    return hr;
-  }
-
-  // Enable multithread protection
-  ComPtr<ID3D10Multithread> multi_thread;
-  hr = dx11_device_.As(&multi_thread);
-  if (FAILED(hr)) {
-    return hr;
-  }
-
-  multi_thread->SetMultithreadProtected(TRUE);
+  if (low_latency_) {
+    // Asks the driver to deliver frames as soon as they are captured, and
+    // to queue as few of them as possible.
+    hr = video_capture_source_attributes->SetUINT32(MF_LOW_LATENCY, TRUE);
+    if (FAILED(hr)) {
+      return hr;
+    }
 
-  hr = MFCreateDXGIDeviceManager(&dx_device_reset_token_,
-                                 dxgi_device_manager_.GetAddressOf());
-  if (FAILED(hr)) {
-    return hr;
+    hr = video_capture_source_attributes->SetUINT32(
+        MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_MAX_BUFFERS,
+        kLowLatencySourceBufferCount);
+    if (FAILED(hr)) {
+      return hr;
+    }
   }
 
-  hr = dxgi_device_manager_->ResetDevice(dx11_device_.Get(),
-                                         dx_device_reset_token_);
+  hr = MFCreateDeviceSource(video_capture_source_attributes.Get(),
+                            video_source_.GetAddressOf());
   return hr;
 }
 
@@ -202,11 +201,7 @@ HRESULT CaptureControllerImpl::CreateCaptureEngine() {
     }
   }
 
-  hr = CreateD3DManagerWithDX11Device();
-
-  if (FAILED(hr)) {
-    return hr;
-  }
+  assert(dxgi_device_manager_);
 
   // Creates video source only if not already initialized by test framework
   if (!video_source_) {
@@ -227,9 +222,10 @@ HRESULT CaptureControllerImpl::CreateCaptureEngine() {
   if (!capture_engine_callback_handler_) {
     capture_engine_callback_handler_ =
         ComPtr<CaptureEngineListener>(new CaptureEngineListener(this));
+    UpdateCaptureThread();
   }
 
-  hr = MFCreateAttributes(&attributes, 2);
+  hr = MFCreateAttributes(&attributes, 3);
   if (FAILED(hr)) {
     return hr;
   }
@@ -246,6 +242,15 @@ HRESULT CaptureControllerImpl::CreateCaptureEngine() {
     return hr;
   }
 
+  if (low_latency_) {
+    // Keeps the capture engine from buffering samples on their way to the
+    // sinks.
+    hr = attributes->SetUINT32(MF_LOW_LATENCY, TRUE);
+    if (FAILED(hr)) {
+      return hr;
+    }
+  }
+
   // Check MF_CAPTURE_ENGINE_INITIALIZED event handling
   // for response process.
   hr = capture_engine_->Initialize(capture_engine_callback_handler_.Get(),
@@ -255,6 +260,12 @@ HRESULT CaptureControllerImpl::CreateCaptureEngine() {
 }
 
 void CaptureControllerImpl::ResetCaptureController() {
+  // Finishes the samples waiting for the capture thread while the handlers
+  // they are passed to still exist.
+  if (capture_engine_callback_handler_) {
+    capture_engine_callback_handler_->SetProcessingThread(nullptr);
+  }
+
   if (record_handler_ && record_handler_->CanStop()) {
     if (record_handler_->IsContinuousRecording()) {
       StopRecord();
@@ -263,19 +274,14 @@ void CaptureControllerImpl::ResetCaptureController() {
     }
   }
 
+  StopImageStream();
+  SetZeroShutterLag(false);
+  StopBurst();
   if (preview_handler_) {
     StopPreview();
   }
 
-  // Shuts down the media foundation platform object.
-  // Releases all resources including threads.
-  // Application should call MFShutdown the same number of times as MFStartup
-  if (media_foundation_started_) {
-    MFShutdown();
-  }
-
   // States
-  media_foundation_started_ = false;
   capture_engine_state_ = CaptureEngineState::kNotInitialized;
   preview_frame_width_ = 0;
   preview_frame_height_ = 0;
@@ -286,22 +292,28 @@ void CaptureControllerImpl::ResetCaptureController() {
   base_preview_media_type_ = nullptr;
   base_capture_media_type_ = nullptr;
 
-  if (dxgi_device_manager_) {
-    dxgi_device_manager_->ResetDevice(dx11_device_.Get(),
-                                      dx_device_reset_token_);
-  }
+  // Releases the shared Media Foundation context once the capture engine no
+  // longer uses its device.
   dxgi_device_manager_ = nullptr;
-  dx11_device_ = nullptr;
+  if (media_context_acquired_) {
+    MediaContext::GetInstance()->Release();
+    media_context_acquired_ = false;
+  }
 
   record_handler_ = nullptr;
-  preview_handler_ = nullptr;
+  ResetPreviewHandler();
   photo_handler_ = nullptr;
-  texture_handler_ = nullptr;
+  {
+    const std::lock_guard<std::mutex> lock(preview_size_mutex_);
+    texture_handler_ = nullptr;
+  }
 }
 
 bool CaptureControllerImpl::InitCaptureDevice(
     flutter::TextureRegistrar* texture_registrar, const std::string& device_id,
-    bool record_audio, ResolutionPreset resolution_preset) {
+    bool record_audio, ResolutionPreset resolution_preset,
+    const std::optional<MediaTypePreferences>& media_type_preferences,
+    bool low_latency) {
   assert(capture_controller_listener_);
 
   if (IsInitialized()) {
@@ -316,13 +328,16 @@ bool CaptureControllerImpl::InitCaptureDevice(
 
   capture_engine_state_ = CaptureEngineState::kInitializing;
   resolution_preset_ = resolution_preset;
+  media_type_preferences_ = media_type_preferences;
+  low_latency_ = low_latency;
   record_audio_ = record_audio;
   texture_registrar_ = texture_registrar;
   video_device_id_ = device_id;
 
-  // MFStartup must be called before using Media Foundation.
-  if (!media_foundation_started_) {
-    HRESULT hr = MFStartup(MF_VERSION);
+  // Media Foundation must be started before using it. The context is
+  // shared with other cameras, and may still be running from the last one.
+  if (!media_context_acquired_) {
+    HRESULT hr = MediaContext::GetInstance()->Acquire(&dxgi_device_manager_);
 
     if (FAILED(hr)) {
       capture_controller_listener_->OnCreateCaptureEngineFailed(
@@ -331,7 +346,7 @@ bool CaptureControllerImpl::InitCaptureDevice(
       return false;
     }
 
-    media_foundation_started_ = true;
+    media_context_acquired_ = true;
   }
 
   HRESULT hr = CreateCaptureEngine();
@@ -353,32 +368,314 @@ void CaptureControllerImpl::TakePicture(const std::string& file_path) {
     return OnPicture(CameraResult::kError, "Not initialized");
   }
 
-  HRESULT hr = S_OK;
+  {
+    // Falls back to the capture engine until a frame has been kept, and
+    // while the preview is not running, as kept frames are then outdated.
+    const std::lock_guard<std::mutex> lock(zsl_mutex_);
+    if (zsl_photo_handler_ && preview_handler_ &&
+        preview_handler_->IsRunning() &&
+        zsl_photo_handler_->TakePhoto(
+            file_path, [this](HRESULT hr, const std::string& path) {
+              PostToPlatformThread(
+                  [this, hr, path]() { OnZslPicture(hr, path); });
+            })) {
+      return;
+    }
+  }
+
+  if (!PreparePhotoHandler()) {
+    return;
+  }
+
+  // Check MF_CAPTURE_ENGINE_PHOTO_TAKEN event handling
+  // for response process.
+  HRESULT hr = photo_handler_->TakePhoto(file_path, capture_engine_.Get(),
+                                         base_capture_media_type_.Get());
+  if (FAILED(hr)) {
+    // Destroy photo handler on error cases to make sure state is resetted.
+    photo_handler_ = nullptr;
+    return OnPicture(GetCameraResult(hr), "Failed to take photo");
+  }
+}
+
+void CaptureControllerImpl::TakePictureToMemory(
+    const JpegEncodeOptions& options) {
+  assert(capture_engine_callback_handler_);
+  assert(capture_engine_);
+
+  if (!IsInitialized()) {
+    return OnPicture(CameraResult::kError, "Not initialized");
+  }
+
+  auto on_picture_data = [this](HRESULT hr, std::vector<uint8_t> image) {
+    PostToPlatformThread([this, hr, image = std::move(image)]() mutable {
+      OnPictureData(hr, std::move(image));
+    });
+  };
+
+  {
+    // Falls back to the capture engine until a frame has been kept, and
+    // while the preview is not running, as kept frames are then outdated.
+    const std::lock_guard<std::mutex> lock(zsl_mutex_);
+    if (zsl_photo_handler_ && preview_handler_ &&
+        preview_handler_->IsRunning() &&
+        zsl_photo_handler_->TakePhotoToMemory(options, on_picture_data)) {
+      return;
+    }
+  }
+
+  if (!PreparePhotoHandler()) {
+    return;
+  }
+
+  // The photo is reported once it has been encoded, after the
+  // MF_CAPTURE_ENGINE_PHOTO_TAKEN event.
+  HRESULT hr = photo_handler_->TakePhotoToMemory(
+      options, capture_engine_.Get(), base_capture_media_type_.Get(),
+      std::move(on_picture_data));
+  if (FAILED(hr)) {
+    // Destroy photo handler on error cases to make sure state is resetted.
+    photo_handler_ = nullptr;
+    return OnPicture(GetCameraResult(hr), "Failed to take photo");
+  }
+}
 
+bool CaptureControllerImpl::PreparePhotoHandler() {
   if (!base_capture_media_type_) {
     // Enumerates mediatypes and finds media type for video capture.
-    hr = FindBaseMediaTypes();
+    HRESULT hr = FindBaseMediaTypes();
     if (FAILED(hr)) {
-      return OnPicture(GetCameraResult(hr),
-                       "Failed to initialize photo capture");
+      OnPicture(GetCameraResult(hr), "Failed to initialize photo capture");
+      return false;
     }
   }
 
   if (!photo_handler_) {
     photo_handler_ = std::make_unique<PhotoHandler>();
   } else if (photo_handler_->IsTakingPhoto()) {
-    return OnPicture(CameraResult::kError, "Photo already requested");
+    OnPicture(CameraResult::kError, "Photo already requested");
+    return false;
   }
+  return true;
+}
 
-  // Check MF_CAPTURE_ENGINE_PHOTO_TAKEN event handling
-  // for response process.
-  hr = photo_handler_->TakePhoto(file_path, capture_engine_.Get(),
-                                 base_capture_media_type_.Get());
-  if (FAILED(hr)) {
-    // Destroy photo handler on error cases to make sure state is resetted.
-    photo_handler_ = nullptr;
-    return OnPicture(GetCameraResult(hr), "Failed to take photo");
+bool CaptureControllerImpl::GetPreviewStats(
+    PreviewStatsSnapshot* stats) const {
+  assert(stats);
+  if (!texture_handler_) {
+    return false;
+  }
+  *stats = texture_handler_->GetPreviewStats();
+  stats->frames_skipped = preview_frame_pacer_.GetSkippedFrameCount();
+  return true;
+}
+
+void CaptureControllerImpl::SetPreviewFrameRateLimit(
+    double max_frame_rate, bool match_display_refresh_rate) {
+  preview_frame_rate_limit_ = std::max(max_frame_rate, 0.0);
+  match_display_refresh_rate_ = match_display_refresh_rate;
+  UpdatePreviewFrameRate();
+}
+
+void CaptureControllerImpl::SetDisplayRefreshRate(double refresh_rate) {
+  display_refresh_rate_ = std::max(refresh_rate, 0.0);
+  UpdatePreviewFrameRate();
+}
+
+bool CaptureControllerImpl::SetCaptureThread(bool dedicated,
+                                             uint64_t cpu_affinity_mask) {
+  if (cpu_affinity_mask != 0) {
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask,
+                                &system_mask) ||
+        (cpu_affinity_mask & ~static_cast<uint64_t>(process_mask)) != 0) {
+      return false;
+    }
+  }
+
+  dedicated_capture_thread_ = dedicated;
+  capture_thread_affinity_mask_ = cpu_affinity_mask;
+  if (capture_engine_callback_handler_) {
+    UpdateCaptureThread();
+  }
+  return true;
+}
+
+bool CaptureControllerImpl::SetPreviewCrop(const PreviewCrop& crop) {
+  if (!IsValidPreviewCrop(crop) ||
+      crop.zoom > GetMaxPreviewZoom(preview_frame_height_)) {
+    return false;
+  }
+  preview_crop_ = crop;
+  if (texture_handler_) {
+    texture_handler_->SetPreviewCrop(crop);
+  }
+  return true;
+}
+
+void CaptureControllerImpl::UpdateCaptureThread() {
+  assert(capture_engine_callback_handler_);
+  if (!dedicated_capture_thread_) {
+    capture_engine_callback_handler_->SetProcessingThread(nullptr);
+    return;
+  }
+
+  // Registers the thread for the "Capture" task of the Multimedia Class
+  // Scheduler Service, which raises its priority above normal threads while
+  // frames arrive. Without the service, the thread is only raised to the
+  // highest normal priority.
+  auto mmcss_handle = std::make_shared<HANDLE>(nullptr);
+  const uint64_t affinity_mask = capture_thread_affinity_mask_;
+  auto on_start = [mmcss_handle, affinity_mask]() {
+    DWORD task_index = 0;
+    *mmcss_handle = AvSetMmThreadCharacteristicsW(L"Capture", &task_index);
+    if (!*mmcss_handle) {
+      SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    }
+    if (affinity_mask != 0) {
+      SetThreadAffinityMask(GetCurrentThread(),
+                            static_cast<DWORD_PTR>(affinity_mask));
+    }
+  };
+  auto on_stop = [mmcss_handle]() {
+    if (*mmcss_handle) {
+      AvRevertMmThreadCharacteristics(*mmcss_handle);
+    }
+  };
+  capture_engine_callback_handler_->SetProcessingThread(
+      std::make_unique<FrameProcessingThread>(std::move(on_start),
+                                              std::move(on_stop)));
+}
+
+void CaptureControllerImpl::UpdatePreviewFrameRate() {
+  double max_frame_rate = preview_frame_rate_limit_;
+  if (match_display_refresh_rate_ && display_refresh_rate_ > 0 &&
+      (max_frame_rate == 0 || display_refresh_rate_ < max_frame_rate)) {
+    max_frame_rate = display_refresh_rate_;
+  }
+  preview_frame_pacer_.SetMaxFrameRate(max_frame_rate);
+}
+
+bool CaptureControllerImpl::StartImageStream(
+    std::unique_ptr<ImageStreamHandler> image_stream_handler) {
+  assert(image_stream_handler);
+  if (!IsInitialized() || !preview_handler_ ||
+      !preview_handler_->IsInitialized()) {
+    return false;
+  }
+
+  const FrameFormat& frame_format = preview_handler_->GetFrameFormat();
+  if (!IsImageStreamFormatSupported(
+          frame_format.pixel_format,
+          image_stream_handler->GetOptions().format)) {
+    return false;
+  }
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if (FAILED(preview_handler_->GetFrameSize(&width, &height))) {
+    return false;
+  }
+  image_stream_handler->UpdateFrameFormat(frame_format);
+  image_stream_handler->UpdateFrameSize(width, height);
+
+  const std::lock_guard<std::mutex> lock(image_stream_mutex_);
+  image_stream_handler_ = std::move(image_stream_handler);
+  return true;
+}
+
+void CaptureControllerImpl::StopImageStream() {
+  const std::lock_guard<std::mutex> lock(image_stream_mutex_);
+  image_stream_handler_ = nullptr;
+}
+
+bool CaptureControllerImpl::SetZeroShutterLag(bool enabled) {
+  if (!enabled) {
+    zero_shutter_lag_ = false;
+    std::unique_ptr<ZslPhotoHandler> zsl_photo_handler;
+    {
+      const std::lock_guard<std::mutex> lock(zsl_mutex_);
+      zsl_photo_handler = std::move(zsl_photo_handler_);
+    }
+    // Waits for photos that are still being encoded without holding up the
+    // capture thread.
+    zsl_photo_handler = nullptr;
+    return true;
+  }
+
+  if (!IsInitialized() || !preview_handler_ ||
+      !preview_handler_->IsInitialized()) {
+    return false;
+  }
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if (FAILED(preview_handler_->GetFrameSize(&width, &height))) {
+    return false;
+  }
+
+  const std::lock_guard<std::mutex> lock(zsl_mutex_);
+  if (!zsl_photo_handler_) {
+    zsl_photo_handler_ = std::make_unique<ZslPhotoHandler>();
+    zsl_photo_handler_->UpdateFrameFormat(preview_handler_->GetFrameFormat());
+    zsl_photo_handler_->UpdateFrameSize(width, height);
   }
+  zero_shutter_lag_ = true;
+  return true;
+}
+
+bool CaptureControllerImpl::StartBurst(uint32_t count, int64_t interval_ms,
+                                       const std::string& file_path_prefix) {
+  // Bursts are taken from preview frames, which are not captured while the
+  // preview is paused.
+  if (!IsInitialized() || !preview_handler_ ||
+      !preview_handler_->IsRunning() || burst_running_) {
+    return false;
+  }
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if (FAILED(preview_handler_->GetFrameSize(&width, &height))) {
+    return false;
+  }
+
+  auto burst_photo_handler = std::make_unique<BurstPhotoHandler>(
+      count, static_cast<uint64_t>(interval_ms) * 1000, file_path_prefix,
+      [this](uint32_t index, HRESULT hr, const std::string& file_path) {
+        PostToPlatformThread([this, index, hr, file_path]() {
+          OnBurstPicture(index, hr, file_path);
+        });
+      },
+      [this]() { PostToPlatformThread([this]() { OnBurstCompleted(); }); });
+  burst_photo_handler->UpdateFrameFormat(preview_handler_->GetFrameFormat());
+  burst_photo_handler->UpdateFrameSize(width, height);
+
+  // Replaces the handler of a completed burst.
+  std::unique_ptr<BurstPhotoHandler> completed_handler;
+  {
+    const std::lock_guard<std::mutex> lock(burst_mutex_);
+    completed_handler = std::move(burst_photo_handler_);
+    burst_photo_handler_ = std::move(burst_photo_handler);
+  }
+  burst_running_ = true;
+  return true;
+}
+
+void CaptureControllerImpl::StopBurst() {
+  std::unique_ptr<BurstPhotoHandler> burst_photo_handler;
+  {
+    const std::lock_guard<std::mutex> lock(burst_mutex_);
+    burst_photo_handler = std::move(burst_photo_handler_);
+  }
+  if (!burst_photo_handler) {
+    return;
+  }
+  // No more frames are taken once the handler is out of the capture path.
+  // Waits for photos that are still being written without holding up the
+  // capture thread.
+  burst_photo_handler->Stop();
+  burst_photo_handler = nullptr;
 }
 
 uint32_t CaptureControllerImpl::GetMaxPreviewHeight() const {
@@ -407,64 +704,99 @@ uint32_t CaptureControllerImpl::GetMaxPreviewHeight() const {
   }
 }
 
-// Finds best media type for given source stream index and max height;
-bool FindBestMediaType(DWORD source_stream_index, IMFCaptureSource* source,
-                       IMFMediaType** target_media_type, uint32_t max_height,
-                       uint32_t* target_frame_width,
-                       uint32_t* target_frame_height,
-                       float minimum_accepted_framerate = 15.f) {
-  assert(source);
-  ComPtr<IMFMediaType> media_type;
+namespace {
+
+// Reads the frame size, rate and pixel format of |media_type|. Returns false
+// for media types without a frame size or rate.
+bool ReadMediaTypeInfo(IMFMediaType* media_type, MediaTypeInfo* info) {
+  uint32_t frame_rate_numerator, frame_rate_denominator;
+  if (FAILED(MFGetAttributeRatio(media_type, MF_MT_FRAME_RATE,
+                                 &frame_rate_numerator,
+                                 &frame_rate_denominator)) ||
+      !frame_rate_denominator ||
+      FAILED(MFGetAttributeSize(media_type, MF_MT_FRAME_SIZE, &info->width,
+                                &info->height))) {
+    return false;
+  }
+  info->frame_rate =
+      static_cast<float>(frame_rate_numerator) / frame_rate_denominator;
 
-  uint32_t best_width = 0;
-  uint32_t best_height = 0;
-  float best_framerate = 0.f;
+  GUID subtype = GUID_NULL;
+  info->has_pixel_format =
+      SUCCEEDED(media_type->GetGUID(MF_MT_SUBTYPE, &subtype)) &&
+      GetPixelFormatForSubtype(subtype, &info->pixel_format);
+  return true;
+}
+
+bool IsSameMediaType(const MediaTypeInfo& a, const MediaTypeInfo& b) {
+  return a.width == b.width && a.height == b.height &&
+         a.frame_rate == b.frame_rate &&
+         a.has_pixel_format == b.has_pixel_format &&
+         (!a.has_pixel_format || a.pixel_format == b.pixel_format);
+}
 
+// Reads the native media types of the given source stream.
+void ReadStreamCapabilities(DWORD source_stream_index,
+                            IMFCaptureSource* source,
+                            StreamCapabilities* capabilities) {
+  assert(source);
   // Loop native media types.
-  for (int i = 0;; i++) {
+  for (uint32_t i = 0;; i++) {
+    ComPtr<IMFMediaType> media_type;
     if (FAILED(source->GetAvailableDeviceMediaType(
             source_stream_index, i, media_type.GetAddressOf()))) {
       break;
     }
 
-    uint32_t frame_rate_numerator, frame_rate_denominator;
-    if (FAILED(MFGetAttributeRatio(media_type.Get(), MF_MT_FRAME_RATE,
-                                   &frame_rate_numerator,
-                                   &frame_rate_denominator)) ||
-        !frame_rate_denominator) {
-      continue;
-    }
-
-    float frame_rate =
-        static_cast<float>(frame_rate_numerator) / frame_rate_denominator;
-    if (frame_rate < minimum_accepted_framerate) {
-      continue;
-    }
-
-    uint32_t frame_width;
-    uint32_t frame_height;
-    if (SUCCEEDED(MFGetAttributeSize(media_type.Get(), MF_MT_FRAME_SIZE,
-                                     &frame_width, &frame_height))) {
-      // Update target mediatype
-      if (frame_height <= max_height &&
-          (best_width < frame_width || best_height < frame_height ||
-           best_framerate < frame_rate)) {
-        media_type.CopyTo(target_media_type);
-        best_width = frame_width;
-        best_height = frame_height;
-        best_framerate = frame_rate;
-      }
+    MediaTypeInfo info;
+    if (ReadMediaTypeInfo(media_type.Get(), &info)) {
+      capabilities->media_types.push_back(info);
+      capabilities->native_indices.push_back(i);
     }
   }
+}
+
+// Finds best media type of |capabilities| for given max height and
+// preferences, and gets it from the source stream. Returns false if no media
+// type qualifies, or if the source no longer offers it at the same index.
+bool GetBestMediaType(DWORD source_stream_index, IMFCaptureSource* source,
+                      const StreamCapabilities& capabilities,
+                      uint32_t max_height,
+                      const std::optional<MediaTypePreferences>& preferences,
+                      IMFMediaType** target_media_type,
+                      uint32_t* target_frame_width,
+                      uint32_t* target_frame_height) {
+  assert(source);
+  const int best_index =
+      preferences ? FindBestMediaTypeIndex(capabilities.media_types,
+                                           max_height, *preferences)
+                  : FindBestMediaTypeIndex(capabilities.media_types,
+                                           max_height);
+  if (best_index < 0) {
+    return false;
+  }
+
+  ComPtr<IMFMediaType> media_type;
+  MediaTypeInfo info;
+  if (FAILED(source->GetAvailableDeviceMediaType(
+          source_stream_index, capabilities.native_indices[best_index],
+          media_type.GetAddressOf())) ||
+      !ReadMediaTypeInfo(media_type.Get(), &info) ||
+      !IsSameMediaType(info, capabilities.media_types[best_index])) {
+    return false;
+  }
+  media_type.CopyTo(target_media_type);
 
   if (target_frame_width && target_frame_height) {
-    *target_frame_width = best_width;
-    *target_frame_height = best_height;
+    *target_frame_width = info.width;
+    *target_frame_height = info.height;
   }
 
   return *target_media_type != nullptr;
 }
 
+}  // namespace
+
 HRESULT CaptureControllerImpl::FindBaseMediaTypes() {
   if (!IsInitialized()) {
     return E_FAIL;
@@ -476,24 +808,54 @@ HRESULT CaptureControllerImpl::FindBaseMediaTypes() {
     return hr;
   }
 
+  // Reading every native media type is slow on devices with many of them,
+  // so they are read once per driver and firmware version of the device.
+  MediaTypeStore* store = MediaTypeStore::GetInstance();
+  DeviceCapabilities capabilities;
+  const bool use_store = MediaTypeStore::GetDeviceFingerprint(
+      video_device_id_, &capabilities.fingerprint);
+  if (use_store &&
+      store->Find(video_device_id_, capabilities.fingerprint,
+                  &capabilities)) {
+    if (SelectBaseMediaTypes(source.Get(), capabilities)) {
+      return S_OK;
+    }
+    // The stored media types no longer match the ones of the device.
+    store->Remove(video_device_id_);
+  }
+
+  capabilities.preview = StreamCapabilities();
+  capabilities.record = StreamCapabilities();
+  ReadStreamCapabilities(
+      (DWORD)MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_PREVIEW,
+      source.Get(), &capabilities.preview);
+  ReadStreamCapabilities(
+      (DWORD)MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_RECORD,
+      source.Get(), &capabilities.record);
+  if (use_store) {
+    store->Store(video_device_id_, capabilities);
+  }
+
+  return SelectBaseMediaTypes(source.Get(), capabilities) ? S_OK : E_FAIL;
+}
+
+bool CaptureControllerImpl::SelectBaseMediaTypes(
+    IMFCaptureSource* source, const DeviceCapabilities& capabilities) {
   // Find base media type for previewing.
-  if (!FindBestMediaType(
+  if (!GetBestMediaType(
           (DWORD)MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_PREVIEW,
-          source.Get(), base_preview_media_type_.GetAddressOf(),
-          GetMaxPreviewHeight(), &preview_frame_width_,
-          &preview_frame_height_)) {
-    return E_FAIL;
+          source, capabilities.preview, GetMaxPreviewHeight(),
+          media_type_preferences_,
+          base_preview_media_type_.ReleaseAndGetAddressOf(),
+          &preview_frame_width_, &preview_frame_height_)) {
+    return false;
   }
 
   // Find base media type for record and photo capture.
-  if (!FindBestMediaType(
-          (DWORD)MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_RECORD,
-          source.Get(), base_capture_media_type_.GetAddressOf(), 0xffffffff,
-          nullptr, nullptr)) {
-    return E_FAIL;
-  }
-
-  return S_OK;
+  return GetBestMediaType(
+      (DWORD)MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_RECORD,
+      source, capabilities.record, 0xffffffff, media_type_preferences_,
+      base_capture_media_type_.ReleaseAndGetAddressOf(), nullptr, nullptr);
 }
 
 void CaptureControllerImpl::StartRecord(const std::string& file_path,
@@ -609,6 +971,7 @@ void CaptureControllerImpl::StartPreview() {
   // TODO(loic-sharma): This does not handle duplicate calls properly.
   // See: https://github.com/flutter/flutter/issues/108404
   if (!preview_handler_) {
+    const std::lock_guard<std::mutex> lock(preview_size_mutex_);
     preview_handler_ = std::make_unique<PreviewHandler>();
   } else if (preview_handler_->IsInitialized()) {
     return OnPreviewStarted(CameraResult::kSuccess, "");
@@ -624,7 +987,7 @@ void CaptureControllerImpl::StartPreview() {
 
   if (FAILED(hr)) {
     // Destroy preview handler on error cases to make sure state is resetted.
-    preview_handler_ = nullptr;
+    ResetPreviewHandler();
     return OnPreviewStarted(GetCameraResult(hr),
                             "Failed to start video preview");
   }
@@ -646,41 +1009,46 @@ HRESULT CaptureControllerImpl::StopPreview() {
   return preview_handler_->StopPreview(capture_engine_.Get());
 }
 
-// Marks preview as paused.
-// When preview is paused, captured frames are not processed for preview
-// and flutter texture is not updated
+// Pauses the preview.
+// The preview stream of the capture engine is stopped, so that the camera
+// no longer captures and converts frames for preview, and flutter texture
+// is not updated. Recording and photos are not affected.
 void CaptureControllerImpl::PausePreview() {
   assert(capture_controller_listener_);
+  assert(capture_engine_);
 
   if (!preview_handler_ || !preview_handler_->IsInitialized()) {
     return capture_controller_listener_->OnPausePreviewFailed(
         CameraResult::kError, "Preview not started");
   }
 
-  if (preview_handler_->PausePreview()) {
+  HRESULT hr = preview_handler_->PausePreview(capture_engine_.Get());
+  if (SUCCEEDED(hr)) {
     capture_controller_listener_->OnPausePreviewSucceeded();
   } else {
     capture_controller_listener_->OnPausePreviewFailed(
-        CameraResult::kError, "Failed to pause preview");
+        GetCameraResult(hr), "Failed to pause preview");
   }
 }
 
-// Marks preview as not paused.
-// When preview is not paused, captured frames are processed for preview
-// and flutter texture is updated.
+// Resumes the preview.
+// The preview stream of the capture engine is restarted with the preview
+// sink configured when the preview was started.
 void CaptureControllerImpl::ResumePreview() {
   assert(capture_controller_listener_);
+  assert(capture_engine_);
 
   if (!preview_handler_ || !preview_handler_->IsInitialized()) {
     return capture_controller_listener_->OnResumePreviewFailed(
         CameraResult::kError, "Preview not started");
   }
 
-  if (preview_handler_->ResumePreview()) {
+  HRESULT hr = preview_handler_->ResumePreview(capture_engine_.Get());
+  if (SUCCEEDED(hr)) {
     capture_controller_listener_->OnResumePreviewSucceeded();
   } else {
     capture_controller_listener_->OnResumePreviewFailed(
-        CameraResult::kError, "Failed to pause preview");
+        GetCameraResult(hr), "Failed to resume preview");
   }
 }
 
@@ -738,7 +1106,9 @@ void CaptureControllerImpl::OnEvent(IMFMediaEvent* event) {
 void CaptureControllerImpl::OnPicture(CameraResult result,
                                       const std::string& error) {
   if (result == CameraResult::kSuccess && photo_handler_) {
-    if (capture_controller_listener_) {
+    // Photos taken to memory are reported once they are encoded.
+    if (capture_controller_listener_ &&
+        photo_handler_->GetPhotoOutput() == PhotoOutput::kFile) {
       std::string path = photo_handler_->GetPhotoPath();
       capture_controller_listener_->OnTakePictureSucceeded(path);
     }
@@ -752,6 +1122,66 @@ void CaptureControllerImpl::OnPicture(CameraResult result,
   }
 }
 
+void CaptureControllerImpl::PostToPlatformThread(
+    PlatformTaskRunner::Task task) {
+  if (platform_task_runner_) {
+    platform_task_runner_->PostTask(this, std::move(task));
+  } else {
+    task();
+  }
+}
+
+// Handles zero-shutter-lag photo results and informs
+// CaptureControllerListener.
+void CaptureControllerImpl::OnZslPicture(HRESULT hr,
+                                         const std::string& file_path) {
+  if (!capture_controller_listener_) {
+    return;
+  }
+  if (SUCCEEDED(hr)) {
+    capture_controller_listener_->OnTakePictureSucceeded(file_path);
+  } else {
+    capture_controller_listener_->OnTakePictureFailed(GetCameraResult(hr),
+                                                      "Failed to take photo");
+  }
+}
+
+// Handles the photos of a burst and informs CaptureControllerListener.
+void CaptureControllerImpl::OnBurstPicture(uint32_t index, HRESULT hr,
+                                           const std::string& file_path) {
+  if (!capture_controller_listener_) {
+    return;
+  }
+  if (SUCCEEDED(hr)) {
+    capture_controller_listener_->OnBurstPictureTaken(index, file_path);
+  } else {
+    capture_controller_listener_->OnBurstPictureFailed(
+        index, GetCameraResult(hr), "Failed to take photo");
+  }
+}
+
+// Handles the completion of a burst and informs CaptureControllerListener.
+void CaptureControllerImpl::OnBurstCompleted() {
+  burst_running_ = false;
+  if (capture_controller_listener_) {
+    capture_controller_listener_->OnBurstCompleted();
+  }
+}
+
+// Handles photos encoded in memory and informs CaptureControllerListener.
+void CaptureControllerImpl::OnPictureData(HRESULT hr,
+                                          std::vector<uint8_t> image) {
+  if (!capture_controller_listener_) {
+    return;
+  }
+  if (SUCCEEDED(hr)) {
+    capture_controller_listener_->OnTakePictureToMemorySucceeded(image);
+  } else {
+    capture_controller_listener_->OnTakePictureFailed(GetCameraResult(hr),
+                                                      "Failed to take photo");
+  }
+}
+
 // Handles CaptureEngineInitialized event and informs
 // CaptureControllerListener.
 void CaptureControllerImpl::OnCaptureEngineInitialized(
@@ -766,6 +1196,7 @@ void CaptureControllerImpl::OnCaptureEngineInitialized(
 
     // Create texture handler and register new texture.
     texture_handler_ = std::make_unique<TextureHandler>(texture_registrar_);
+    texture_handler_->SetPreviewCrop(preview_crop_);
 
     int64_t texture_id = texture_handler_->RegisterTexture();
     if (texture_id >= 0) {
@@ -797,10 +1228,23 @@ void CaptureControllerImpl::OnCaptureEngineError(CameraResult result,
 void CaptureControllerImpl::OnPreviewStarted(CameraResult result,
                                              const std::string& error) {
   if (preview_handler_ && result == CameraResult::kSuccess) {
+    if (texture_handler_) {
+      // Samples are only passed to the texture handler after this point.
+      texture_handler_->UpdateFrameFormat(preview_handler_->GetFrameFormat());
+    }
     preview_handler_->OnPreviewStarted();
+
+    // MJPEG frames are instead scaled down while decoding.
+    const PixelFormat pixel_format =
+        preview_handler_->GetFrameFormat().pixel_format;
+    const std::lock_guard<std::mutex> lock(preview_size_mutex_);
+    if (!preview_size_policy_ && pixel_format != PixelFormat::kMJPG) {
+      preview_size_policy_ = std::make_unique<PreviewSizePolicy>(
+          FrameSize{preview_frame_width_, preview_frame_height_});
+    }
   } else {
     // Destroy preview handler on error cases to make sure state is resetted.
-    preview_handler_ = nullptr;
+    ResetPreviewHandler();
   }
 
   if (capture_controller_listener_) {
@@ -817,9 +1261,15 @@ void CaptureControllerImpl::OnPreviewStarted(CameraResult result,
 // Handles PreviewStopped event.
 void CaptureControllerImpl::OnPreviewStopped(CameraResult result,
                                              const std::string& error) {
+  // A paused preview keeps its handler, to be resumed later.
+  if (preview_handler_ &&
+      preview_handler_->OnPreviewStopped(capture_engine_.Get())) {
+    return;
+  }
+
   // Preview handler is destroyed if preview is stopped as it
   // does not have any use anymore.
-  preview_handler_ = nullptr;
+  ResetPreviewHandler();
 };
 
 // Handles RecordStarted event and informs CaptureControllerListener.
@@ -870,15 +1320,53 @@ void CaptureControllerImpl::OnRecordStopped(CameraResult result,
   }
 }
 
+// Paces preview frames to the preview frame rate limit.
+// Called via IMFCaptureEngineOnSampleCallback implementation.
+// Implements CaptureEngineObserver::ShouldProcessSample.
+bool CaptureControllerImpl::ShouldProcessSample(uint64_t sample_time_us,
+                                                bool* draw_preview) {
+  assert(draw_preview);
+  *draw_preview = preview_frame_pacer_.ShouldProcessFrame(sample_time_us);
+  if (*draw_preview || zero_shutter_lag_ || burst_running_) {
+    return true;
+  }
+  // Image streams limit their own frame rate.
+  const std::lock_guard<std::mutex> lock(image_stream_mutex_);
+  return image_stream_handler_ != nullptr;
+}
+
 // Updates texture handlers buffer with given data.
 // Called via IMFCaptureEngineOnSampleCallback implementation.
 // Implements CaptureEngineObserver::UpdateBuffer.
-bool CaptureControllerImpl::UpdateBuffer(uint8_t* buffer,
-                                         uint32_t data_length) {
+bool CaptureControllerImpl::UpdateBuffer(
+    const FrameBufferView& frame, uint64_t sample_time_us,
+    std::chrono::steady_clock::time_point capture_time, bool draw_preview) {
   if (!texture_handler_) {
     return false;
   }
-  return texture_handler_->UpdateBuffer(buffer, data_length);
+  const bool updated =
+      draw_preview &&
+      texture_handler_->UpdateBuffer(frame, sample_time_us, capture_time);
+
+  {
+    const std::lock_guard<std::mutex> lock(image_stream_mutex_);
+    if (image_stream_handler_) {
+      image_stream_handler_->OnFrame(frame, sample_time_us);
+    }
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock(zsl_mutex_);
+    if (zsl_photo_handler_) {
+      zsl_photo_handler_->OnFrame(frame, sample_time_us);
+    }
+  }
+
+  const std::lock_guard<std::mutex> lock(burst_mutex_);
+  if (burst_photo_handler_ && burst_photo_handler_->IsCapturing()) {
+    burst_photo_handler_->OnFrame(frame, sample_time_us);
+  }
+  return updated;
 }
 
 // Handles capture time update from each processed frame.
@@ -896,6 +1384,8 @@ void CaptureControllerImpl::UpdateCaptureTime(uint64_t capture_time_us) {
     OnPreviewStarted(CameraResult::kSuccess, "");
   }
 
+  UpdatePreviewFrameSize();
+
   // Checks if max_video_duration_ms is passed.
   if (record_handler_) {
     record_handler_->UpdateRecordingTime(capture_time_us);
@@ -905,4 +1395,76 @@ void CaptureControllerImpl::UpdateCaptureTime(uint64_t capture_time_us) {
   }
 }
 
+// Handles format changes of the preview samples.
+// Called via IMFCaptureEngineOnSampleCallback2 implementation.
+// Implements CaptureEngineObserver::OnSampleFormatChanged.
+void CaptureControllerImpl::OnSampleFormatChanged() {
+  if (!preview_handler_ || !texture_handler_) {
+    return;
+  }
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if (SUCCEEDED(preview_handler_->GetFrameSize(&width, &height))) {
+    texture_handler_->UpdateTextureSize(width, height);
+
+    {
+      const std::lock_guard<std::mutex> lock(image_stream_mutex_);
+      if (image_stream_handler_) {
+        image_stream_handler_->UpdateFrameSize(width, height);
+      }
+    }
+
+    {
+      const std::lock_guard<std::mutex> lock(zsl_mutex_);
+      if (zsl_photo_handler_) {
+        zsl_photo_handler_->UpdateFrameSize(width, height);
+      }
+    }
+
+    const std::lock_guard<std::mutex> lock(burst_mutex_);
+    if (burst_photo_handler_) {
+      burst_photo_handler_->UpdateFrameSize(width, height);
+    }
+  }
+}
+
+void CaptureControllerImpl::UpdatePreviewFrameSize() {
+  const std::lock_guard<std::mutex> lock(preview_size_mutex_);
+  if (!preview_size_policy_ || preview_size_disabled_ || !preview_handler_ ||
+      !preview_handler_->IsRunning() || !texture_handler_) {
+    return;
+  }
+
+  // Zero-shutter-lag and burst photos are taken from preview frames, so the
+  // preview is kept at full size while they are enabled. Otherwise the
+  // texture only shows the cropped region, so frames must be larger than the
+  // texture for the region to cover it.
+  FrameSize requested_size = GetUncroppedFrameSize(
+      {texture_handler_->GetTargetWidth(), texture_handler_->GetTargetHeight()},
+      texture_handler_->GetPreviewCrop());
+  if (zero_shutter_lag_ || burst_running_) {
+    requested_size = {preview_frame_width_, preview_frame_height_};
+  }
+  FrameSize next_size;
+  if (!preview_size_policy_->Update(
+          requested_size, PreviewSizePolicy::Clock::now(), &next_size)) {
+    return;
+  }
+
+  if (FAILED(preview_handler_->SetFrameSize(next_size.width,
+                                            next_size.height))) {
+    // Keeps the current frame size if the preview sink cannot be
+    // reconfigured, for example before Windows 8.1.
+    preview_size_disabled_ = true;
+  }
+}
+
+void CaptureControllerImpl::ResetPreviewHandler() {
+  const std::lock_guard<std::mutex> lock(preview_size_mutex_);
+  preview_handler_ = nullptr;
+  preview_size_policy_ = nullptr;
+  preview_size_disabled_ = false;
+}
+
 }  // namespace camera_windows
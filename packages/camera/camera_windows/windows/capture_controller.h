@@ -14,15 +14,31 @@
 #include <windows.h>
 #include <wrl/client.h>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "burst_photo_handler.h"
 #include "capture_controller_listener.h"
 #include "capture_engine_listener.h"
+#include "frame_pacer.h"
+#include "image_stream_handler.h"
+#include "media_context.h"
+#include "media_type_cache.h"
+#include "media_type_selection.h"
 #include "photo_handler.h"
+#include "platform_task_runner.h"
+#include "preview_crop.h"
 #include "preview_handler.h"
+#include "preview_size_policy.h"
+#include "preview_stats.h"
 #include "record_handler.h"
 #include "texture_handler.h"
+#include "zsl_photo_handler.h"
 
 namespace camera_windows {
 using flutter::TextureRegistrar;
@@ -85,10 +101,17 @@ class CaptureController {
   // record_audio:      A boolean value telling if audio should be captured on
   //                    video recording.
   // resolution_preset: Maximum capture resolution height.
-  virtual bool InitCaptureDevice(TextureRegistrar* texture_registrar,
-                                 const std::string& device_id,
-                                 bool record_audio,
-                                 ResolutionPreset resolution_preset) = 0;
+  // media_type_preferences: Preferences used to score the media types of
+  //                    the device, or nullopt to pick the largest and
+  //                    fastest media type within the resolution preset.
+  // low_latency:       A boolean value telling if the camera and the
+  //                    capture engine should buffer as few frames as
+  //                    possible, trading throughput for latency.
+  virtual bool InitCaptureDevice(
+      TextureRegistrar* texture_registrar, const std::string& device_id,
+      bool record_audio, ResolutionPreset resolution_preset,
+      const std::optional<MediaTypePreferences>& media_type_preferences,
+      bool low_latency) = 0;
 
   // Returns preview frame width
   virtual uint32_t GetPreviewWidth() const = 0;
@@ -114,6 +137,100 @@ class CaptureController {
 
   // Captures a still photo.
   virtual void TakePicture(const std::string& file_path) = 0;
+
+  // Captures a still photo, encoded to JPEG in memory with |options|.
+  //
+  // The encoded photo is passed to the listener instead of being written to
+  // a file.
+  virtual void TakePictureToMemory(const JpegEncodeOptions& options) = 0;
+
+  // Enables or disables zero-shutter-lag photos.
+  //
+  // While enabled, recent preview frames are kept at the full preview size,
+  // and |TakePicture| encodes the kept frame closest to the request instead
+  // of having the capture engine take a new photo.
+  //
+  // Returns false if the preview has not been started.
+  virtual bool SetZeroShutterLag(bool enabled) = 0;
+
+  // Starts a burst of |count| photos taken from preview frames
+  // |interval_ms| apart, and written to files named after
+  // |file_path_prefix|.
+  //
+  // Each photo is passed to the listener as soon as it is written, while
+  // the burst carries on. The preview is kept at full size until the burst
+  // completes.
+  //
+  // Returns false if the preview has not been started, or if a burst is
+  // already running.
+  virtual bool StartBurst(uint32_t count, int64_t interval_ms,
+                          const std::string& file_path_prefix) = 0;
+
+  // Stops the running burst, if any. Photos already taken are still
+  // written and passed to the listener before the burst completes.
+  virtual void StopBurst() = 0;
+
+  // Gets the frame counters and timings of the preview.
+  //
+  // Returns false if the preview has not been set up.
+  virtual bool GetPreviewStats(PreviewStatsSnapshot* stats) const = 0;
+
+  // Starts sending preview frames to |image_stream_handler|, replacing the
+  // running image stream, if any.
+  //
+  // Returns false if the preview has not been started, or if the preview
+  // frames cannot be sent in the format of the stream.
+  virtual bool StartImageStream(
+      std::unique_ptr<ImageStreamHandler> image_stream_handler) = 0;
+
+  // Stops the running image stream, if any.
+  virtual void StopImageStream() = 0;
+
+  // Limits the preview to |max_frame_rate| frames per second, or removes
+  // the limit if it is 0. If |match_display_refresh_rate| is true, the
+  // preview is also kept to the refresh rate set by
+  // |SetDisplayRefreshRate|.
+  //
+  // Frames over the limit are skipped before they are read, by their
+  // presentation time. While an image stream, a burst or zero shutter lag
+  // runs, every frame is still read for them, but only frames within the
+  // limit are drawn.
+  virtual void SetPreviewFrameRateLimit(double max_frame_rate,
+                                        bool match_display_refresh_rate) = 0;
+
+  // Sets the refresh rate of the display showing the preview, or 0 if it is
+  // unknown.
+  virtual void SetDisplayRefreshRate(double refresh_rate) = 0;
+
+  // Processes preview frames on a dedicated thread registered with the
+  // Multimedia Class Scheduler Service if |dedicated| is true, or on the
+  // thread of the capture engine delivering them otherwise. A non-zero
+  // |cpu_affinity_mask| keeps the dedicated thread on the given processors.
+  //
+  // The setting is kept when the capture engine is created again. Returns
+  // false if |cpu_affinity_mask| has processors the process cannot use.
+  virtual bool SetCaptureThread(bool dedicated,
+                                uint64_t cpu_affinity_mask) = 0;
+
+  // Shows only the part of preview frames set by |crop|, and scales it to
+  // the preview texture. Takes effect from the next preview frame, without
+  // restarting the preview. Recordings, photos and image streams still get
+  // whole frames.
+  //
+  // The setting is kept when the capture engine is created again. Returns
+  // false if |crop| is not valid, or if it zooms in further than
+  // |GetMaxPreviewZoom| allows for the current preview frames, which only
+  // allows a zoom factor of 1 until the preview has started.
+  virtual bool SetPreviewCrop(const PreviewCrop& crop) = 0;
+
+  // Returns the part of preview frames shown, as last set by
+  // |SetPreviewCrop|.
+  virtual PreviewCrop GetPreviewCrop() const = 0;
+
+  // Sets the runner through which results of photos encoded on worker
+  // threads are reported on the platform thread. Without a runner, they are
+  // reported on the worker threads. |runner| must outlive the controller.
+  virtual void SetPlatformTaskRunner(PlatformTaskRunner* runner) = 0;
 };
 
 // Concrete implementation of the |CaptureController| interface.
@@ -137,7 +254,10 @@ class CaptureControllerImpl : public CaptureController,
   // CaptureController
   bool InitCaptureDevice(TextureRegistrar* texture_registrar,
                          const std::string& device_id, bool record_audio,
-                         ResolutionPreset resolution_preset) override;
+                         ResolutionPreset resolution_preset,
+                         const std::optional<MediaTypePreferences>&
+                             media_type_preferences,
+                         bool low_latency) override;
   uint32_t GetPreviewWidth() const override { return preview_frame_width_; }
   uint32_t GetPreviewHeight() const override { return preview_frame_height_; }
   void StartPreview() override;
@@ -147,6 +267,24 @@ class CaptureControllerImpl : public CaptureController,
                    int64_t max_video_duration_ms) override;
   void StopRecord() override;
   void TakePicture(const std::string& file_path) override;
+  void TakePictureToMemory(const JpegEncodeOptions& options) override;
+  bool SetZeroShutterLag(bool enabled) override;
+  bool StartBurst(uint32_t count, int64_t interval_ms,
+                  const std::string& file_path_prefix) override;
+  void StopBurst() override;
+  bool GetPreviewStats(PreviewStatsSnapshot* stats) const override;
+  bool StartImageStream(
+      std::unique_ptr<ImageStreamHandler> image_stream_handler) override;
+  void StopImageStream() override;
+  void SetPreviewFrameRateLimit(double max_frame_rate,
+                                bool match_display_refresh_rate) override;
+  void SetDisplayRefreshRate(double refresh_rate) override;
+  bool SetCaptureThread(bool dedicated, uint64_t cpu_affinity_mask) override;
+  bool SetPreviewCrop(const PreviewCrop& crop) override;
+  PreviewCrop GetPreviewCrop() const override { return preview_crop_; }
+  void SetPlatformTaskRunner(PlatformTaskRunner* runner) override {
+    platform_task_runner_ = runner;
+  }
 
   // CaptureEngineObserver
   void OnEvent(IMFMediaEvent* event) override;
@@ -154,8 +292,13 @@ class CaptureControllerImpl : public CaptureController,
     return capture_engine_state_ == CaptureEngineState::kInitialized &&
            preview_handler_ && preview_handler_->IsRunning();
   }
-  bool UpdateBuffer(uint8_t* data, uint32_t data_length) override;
+  bool ShouldProcessSample(uint64_t sample_time_us,
+                           bool* draw_preview) override;
+  bool UpdateBuffer(const FrameBufferView& frame, uint64_t sample_time_us,
+                    std::chrono::steady_clock::time_point capture_time,
+                    bool draw_preview) override;
   void UpdateCaptureTime(uint64_t capture_time) override;
+  void OnSampleFormatChanged() override;
 
   // Sets capture engine, for testing purposes.
   void SetCaptureEngine(IMFCaptureEngine* capture_engine) {
@@ -192,9 +335,6 @@ class CaptureControllerImpl : public CaptureController,
   // Initializes video capture source from camera device.
   HRESULT CreateVideoCaptureSourceForDevice(const std::string& video_device_id);
 
-  // Creates DX11 Device and D3D Manager.
-  HRESULT CreateD3DManagerWithDX11Device();
-
   // Initializes capture engine object.
   HRESULT CreateCaptureEngine();
 
@@ -202,6 +342,12 @@ class CaptureControllerImpl : public CaptureController,
   // for preview and video capture.
   HRESULT FindBaseMediaTypes();
 
+  // Selects the base media types for preview and video capture among the
+  // media types of |capabilities|. Returns false if none qualifies, or if
+  // they are no longer offered by |source|.
+  bool SelectBaseMediaTypes(IMFCaptureSource* source,
+                            const DeviceCapabilities& capabilities);
+
   // Stops timed video record. Called internally when record handler when max
   // recording time is exceeded.
   void StopTimedRecord();
@@ -209,6 +355,14 @@ class CaptureControllerImpl : public CaptureController,
   // Stops preview. Called internally on camera reset and dispose.
   HRESULT StopPreview();
 
+  // Resizes preview frames to follow the texture size requested by Flutter.
+  // Called from the sample thread for each sample.
+  void UpdatePreviewFrameSize();
+
+  // Destroys the preview handler and the frame size policy of the preview,
+  // once the sample thread is no longer resizing preview frames.
+  void ResetPreviewHandler();
+
   // Handles capture engine initalization event.
   void OnCaptureEngineInitialized(CameraResult result,
                                   const std::string& error);
@@ -219,9 +373,46 @@ class CaptureControllerImpl : public CaptureController,
   // Handles picture events.
   void OnPicture(CameraResult result, const std::string& error);
 
+  // Runs |task| on the platform thread through |platform_task_runner_|,
+  // or right away if there is none. Used by the worker threads of the photo
+  // handlers to report their results.
+  void PostToPlatformThread(PlatformTaskRunner::Task task);
+
+  // Handles the result of a zero-shutter-lag photo. Posted from the worker
+  // thread of the |ZslPhotoHandler|.
+  void OnZslPicture(HRESULT hr, const std::string& file_path);
+
+  // Handles the result of a photo encoded in memory. Posted from the worker
+  // thread of the |PhotoHandler| or the |ZslPhotoHandler|.
+  void OnPictureData(HRESULT hr, std::vector<uint8_t> image);
+
+  // Handles the result of a photo of a burst. Posted from a worker thread
+  // of the |BurstPhotoHandler|.
+  void OnBurstPicture(uint32_t index, HRESULT hr,
+                      const std::string& file_path);
+
+  // Handles the completion of a burst. Posted from a worker thread of the
+  // |BurstPhotoHandler|, or from |StopBurst|, after the results of its
+  // photos.
+  void OnBurstCompleted();
+
+  // Creates the photo handler and the base media types for photos taken by
+  // the capture engine.
+  //
+  // Reports failures to the listener and returns false.
+  bool PreparePhotoHandler();
+
   // Handles preview started events.
   void OnPreviewStarted(CameraResult result, const std::string& error);
 
+  // Applies the lower of the preview frame rate limit and the display
+  // refresh rate to |preview_frame_pacer_|.
+  void UpdatePreviewFrameRate();
+
+  // Hands samples off to a new dedicated capture thread, or processes them
+  // inline, as set by |SetCaptureThread|.
+  void UpdateCaptureThread();
+
   // Handles preview stopped events.
   void OnPreviewStopped(CameraResult result, const std::string& error);
 
@@ -231,25 +422,72 @@ class CaptureControllerImpl : public CaptureController,
   // Handles record stopped events.
   void OnRecordStopped(CameraResult result, const std::string& error);
 
-  bool media_foundation_started_ = false;
+  bool media_context_acquired_ = false;
   bool record_audio_ = false;
   uint32_t preview_frame_width_ = 0;
   uint32_t preview_frame_height_ = 0;
-  UINT dx_device_reset_token_ = 0;
   std::unique_ptr<RecordHandler> record_handler_;
   std::unique_ptr<PreviewHandler> preview_handler_;
   std::unique_ptr<PhotoHandler> photo_handler_;
   std::unique_ptr<TextureHandler> texture_handler_;
   CaptureControllerListener* capture_controller_listener_;
+  PlatformTaskRunner* platform_task_runner_ = nullptr;
+
+  // Preview frames are resized from the sample thread, while the preview and
+  // texture handlers are destroyed on the platform and event threads. Held
+  // while resizing, and while these handlers are created or destroyed.
+  // |preview_size_disabled_| is set once the preview sink fails to resize.
+  std::mutex preview_size_mutex_;
+  std::unique_ptr<PreviewSizePolicy> preview_size_policy_;
+  bool preview_size_disabled_ = false;
+
+  // Started and stopped on the platform thread, while frames are sent from
+  // the capture thread.
+  std::mutex image_stream_mutex_;
+  std::unique_ptr<ImageStreamHandler> image_stream_handler_;
+
+  // Enabled and disabled on the platform thread, while frames are kept from
+  // the capture thread. |zero_shutter_lag_| is also read by the capture
+  // thread to keep the preview at full size.
+  std::mutex zsl_mutex_;
+  std::unique_ptr<ZslPhotoHandler> zsl_photo_handler_;
+  std::atomic<bool> zero_shutter_lag_ = false;
+
+  // Started and stopped on the platform thread, while frames are taken from
+  // the capture thread. The handler is kept once the burst has completed,
+  // so that it is never destroyed from its own worker threads.
+  // |burst_running_| is cleared once the completion reaches the platform
+  // thread, and is also read by the capture thread to keep the preview at
+  // full size.
+  std::mutex burst_mutex_;
+  std::unique_ptr<BurstPhotoHandler> burst_photo_handler_;
+  std::atomic<bool> burst_running_ = false;
+
+  // Limits are set on the platform thread, while frames are paced on the
+  // thread delivering samples. Whether each sample is drawn travels with
+  // the sample, which may be processed on another thread.
+  FramePacer preview_frame_pacer_;
+  double preview_frame_rate_limit_ = 0;
+  bool match_display_refresh_rate_ = false;
+  double display_refresh_rate_ = 0;
+
+  bool dedicated_capture_thread_ = false;
+  uint64_t capture_thread_affinity_mask_ = 0;
+
+  // Set on the platform thread. The texture handler keeps the copy used by
+  // the capture thread.
+  PreviewCrop preview_crop_;
 
   std::string video_device_id_;
   CaptureEngineState capture_engine_state_ =
       CaptureEngineState::kNotInitialized;
   ResolutionPreset resolution_preset_ = ResolutionPreset::kMedium;
+  std::optional<MediaTypePreferences> media_type_preferences_;
+  bool low_latency_ = false;
   ComPtr<IMFCaptureEngine> capture_engine_;
   ComPtr<CaptureEngineListener> capture_engine_callback_handler_;
+  // Device manager of the shared |MediaContext|.
   ComPtr<IMFDXGIDeviceManager> dxgi_device_manager_;
-  ComPtr<ID3D11Device> dx11_device_;
   ComPtr<IMFMediaType> base_capture_media_type_;
   ComPtr<IMFMediaType> base_preview_media_type_;
   ComPtr<IMFMediaSource> video_source_;
@@ -5,7 +5,9 @@
 #ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CAPTURE_CONTROLLER_LISTENER_H_
 #define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CAPTURE_CONTROLLER_LISTENER_H_
 
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 namespace camera_windows {
 
@@ -99,6 +101,13 @@ class CaptureControllerListener {
   // file_path: Filesystem path of the captured image.
   virtual void OnTakePictureSucceeded(const std::string& file_path) = 0;
 
+  // Called by CaptureController on successfully captured picture taken to
+  // memory.
+  //
+  // image: The captured image, encoded as JPEG.
+  virtual void OnTakePictureToMemorySucceeded(
+      const std::vector<uint8_t>& image) = 0;
+
   // Called by CaptureController if taking picture fails.
   //
   // result: The kind of result.
@@ -106,6 +115,25 @@ class CaptureControllerListener {
   virtual void OnTakePictureFailed(CameraResult result,
                                    const std::string& error) = 0;
 
+  // Called by CaptureController when a photo of a burst has been written.
+  //
+  // index: The position of the photo in the burst, starting at 0.
+  // file_path: Filesystem path of the captured image.
+  virtual void OnBurstPictureTaken(uint32_t index,
+                                   const std::string& file_path) = 0;
+
+  // Called by CaptureController if a photo of a burst fails.
+  //
+  // index: The position of the photo in the burst, starting at 0.
+  // result: The kind of result.
+  // error: A string describing the error.
+  virtual void OnBurstPictureFailed(uint32_t index, CameraResult result,
+                                    const std::string& error) = 0;
+
+  // Called by CaptureController once every photo of a burst has been
+  // reported, or the burst has been stopped.
+  virtual void OnBurstCompleted() = 0;
+
   // Called by CaptureController when timed recording is successfully recorded.
   //
   // file_path: Filesystem path of the captured image.
@@ -5,6 +5,7 @@
 
 #include "capture_engine_listener.h"
 
+#include <mfapi.h>
 #include <mfcaptureengine.h>
 #include <wrl/client.h>
 
@@ -12,6 +13,100 @@ namespace camera_windows {
 
 using Microsoft::WRL::ComPtr;
 
+namespace {
+
+// Locks the media buffer of a sample for reading until destroyed.
+//
+// Single-buffer samples are locked through IMF2DBuffer2 when available, which
+// exposes padded and bottom-up frames in place. Other samples are converted
+// to a contiguous buffer first, which may allocate and copy.
+class SampleBufferLock {
+ public:
+  explicit SampleBufferLock(IMFSample* sample);
+  ~SampleBufferLock();
+
+  // Prevent copying.
+  SampleBufferLock(SampleBufferLock const&) = delete;
+  SampleBufferLock& operator=(SampleBufferLock const&) = delete;
+
+  // Returns the result of locking the buffer.
+  HRESULT status() const { return status_; }
+
+  // Returns the locked frame. Only valid if locking succeeded.
+  const FrameBufferView& frame() const { return frame_; }
+
+ private:
+  HRESULT status_ = E_FAIL;
+  ComPtr<IMF2DBuffer2> buffer_2d_;
+  ComPtr<IMFMediaBuffer> buffer_;
+  FrameBufferView frame_;
+};
+
+SampleBufferLock::SampleBufferLock(IMFSample* sample) {
+  DWORD buffer_count = 0;
+  ComPtr<IMFMediaBuffer> buffer;
+  if (SUCCEEDED(sample->GetBufferCount(&buffer_count)) && buffer_count == 1 &&
+      SUCCEEDED(sample->GetBufferByIndex(0, &buffer)) &&
+      SUCCEEDED(buffer.As(&buffer_2d_))) {
+    BYTE* scanline0 = nullptr;
+    LONG pitch = 0;
+    BYTE* buffer_start = nullptr;
+    DWORD buffer_length = 0;
+    status_ = buffer_2d_->Lock2DSize(MF2DBuffer_LockFlags_Read, &scanline0,
+                                     &pitch, &buffer_start, &buffer_length);
+    if (SUCCEEDED(status_)) {
+      frame_.scanline0 = scanline0;
+      frame_.stride = pitch;
+      frame_.buffer_start = buffer_start;
+      frame_.buffer_length = buffer_length;
+      return;
+    }
+    buffer_2d_.Reset();
+  }
+
+  status_ = sample->ConvertToContiguousBuffer(&buffer_);
+  if (SUCCEEDED(status_)) {
+    BYTE* data = nullptr;
+    DWORD max_length = 0;
+    DWORD current_length = 0;
+    status_ = buffer_->Lock(&data, &max_length, &current_length);
+    if (SUCCEEDED(status_)) {
+      // Contiguous buffers are packed without padding.
+      frame_.scanline0 = data;
+      frame_.buffer_start = data;
+      frame_.buffer_length = current_length;
+      return;
+    }
+  }
+  buffer_.Reset();
+}
+
+SampleBufferLock::~SampleBufferLock() {
+  if (buffer_2d_) {
+    buffer_2d_->Unlock2D();
+  } else if (buffer_) {
+    buffer_->Unlock();
+  }
+}
+
+// Returns when the camera captured |sample|, from its device timestamp.
+//
+// Device timestamps are in the 100-nanosecond units of |MFGetSystemTime|.
+// Samples without one are taken to be captured when they are delivered.
+std::chrono::steady_clock::time_point GetCaptureTime(IMFSample* sample) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  UINT64 device_timestamp = 0;
+  if (FAILED(sample->GetUINT64(MFSampleExtension_DeviceTimestamp,
+                               &device_timestamp))) {
+    return now;
+  }
+  const LONGLONG age =
+      MFGetSystemTime() - static_cast<LONGLONG>(device_timestamp);
+  return age > 0 ? now - std::chrono::microseconds(age / 10) : now;
+}
+
+}  // namespace
+
 // IUnknown
 STDMETHODIMP_(ULONG) CaptureEngineListener::AddRef() {
   return InterlockedIncrement(&ref_);
@@ -40,6 +135,10 @@ CaptureEngineListener::QueryInterface(const IID& riid, void** ppv) {
     *ppv = static_cast<IMFCaptureEngineOnSampleCallback*>(this);
     ((IUnknown*)*ppv)->AddRef();
     return S_OK;
+  } else if (riid == IID_IMFCaptureEngineOnSampleCallback2) {
+    *ppv = static_cast<IMFCaptureEngineOnSampleCallback2*>(this);
+    ((IUnknown*)*ppv)->AddRef();
+    return S_OK;
   }
 
   return E_NOINTERFACE;
@@ -62,29 +161,83 @@ HRESULT CaptureEngineListener::OnSample(IMFSample* sample) {
     sample->GetSampleTime(&raw_time_stamp);
 
     // Report time in microseconds.
-    this->observer_->UpdateCaptureTime(
-        static_cast<uint64_t>(raw_time_stamp / 10));
+    const uint64_t sample_time_us = static_cast<uint64_t>(raw_time_stamp / 10);
+    this->observer_->UpdateCaptureTime(sample_time_us);
 
     if (!this->observer_->IsReadyForSample()) {
       // No texture target available or not previewing, just return status.
       return hr;
     }
 
-    ComPtr<IMFMediaBuffer> buffer;
-    hr = sample->ConvertToContiguousBuffer(&buffer);
-
-    // Draw the frame.
-    if (SUCCEEDED(hr) && buffer) {
-      DWORD max_length = 0;
-      DWORD current_length = 0;
-      uint8_t* data;
-      if (SUCCEEDED(buffer->Lock(&data, &max_length, &current_length))) {
-        this->observer_->UpdateBuffer(data, current_length);
-      }
-      hr = buffer->Unlock();
+    // Frames over the preview frame rate limit are skipped before their
+    // buffer is locked, so they are never copied or converted.
+    bool draw_preview = false;
+    if (!this->observer_->ShouldProcessSample(sample_time_us, &draw_preview)) {
+      return hr;
+    }
+
+    const std::chrono::steady_clock::time_point capture_time =
+        GetCaptureTime(sample);
+
+    std::lock_guard<std::mutex> lock(processing_mutex_);
+    if (!processing_thread_) {
+      return ProcessSample(sample, sample_time_us, capture_time,
+                           draw_preview);
     }
+
+    // The sample keeps its buffer until the processing thread reads it, or
+    // until a newer sample replaces it.
+    ComPtr<IMFSample> queued_sample(sample);
+    processing_thread_->PostFrame(
+        [this, queued_sample, sample_time_us, capture_time, draw_preview]() {
+          // The preview may have stopped while the sample was waiting.
+          if (observer_->IsReadyForSample()) {
+            ProcessSample(queued_sample.Get(), sample_time_us, capture_time,
+                          draw_preview);
+          }
+        });
+  }
+  return hr;
+}
+
+HRESULT CaptureEngineListener::ProcessSample(
+    IMFSample* sample, uint64_t sample_time_us,
+    std::chrono::steady_clock::time_point capture_time, bool draw_preview) {
+  // Draw the frame.
+  SampleBufferLock lock(sample);
+  HRESULT hr = lock.status();
+  if (SUCCEEDED(hr)) {
+    observer_->UpdateBuffer(lock.frame(), sample_time_us, capture_time,
+                            draw_preview);
   }
   return hr;
 }
 
+// IMFCaptureEngineOnSampleCallback2
+// Called on the sample thread, in order with the samples, when the format of
+// the samples changes.
+HRESULT CaptureEngineListener::OnSynchronizedEvent(IMFMediaEvent* event) {
+  if (this->observer_) {
+    std::lock_guard<std::mutex> lock(processing_mutex_);
+    if (processing_thread_) {
+      // Keeps the format change in order with the samples already queued.
+      processing_thread_->PostTask(
+          [this]() { observer_->OnSampleFormatChanged(); });
+    } else {
+      this->observer_->OnSampleFormatChanged();
+    }
+  }
+  return S_OK;
+}
+
+void CaptureEngineListener::SetProcessingThread(
+    std::unique_ptr<FrameProcessingThread> thread) {
+  std::lock_guard<std::mutex> lock(processing_mutex_);
+  // Finishes the samples queued on the previous thread before new samples
+  // are processed, so that only one thread processes samples at a time.
+  // Samples delivered meanwhile wait for the lock.
+  processing_thread_.reset();
+  processing_thread_ = std::move(thread);
+}
+
 }  // namespace camera_windows
@@ -8,7 +8,13 @@
 #include <mfcaptureengine.h>
 
 #include <cassert>
+#include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
+
+#include "frame_buffer_view.h"
+#include "frame_processing_thread.h"
 
 namespace camera_windows {
 
@@ -20,22 +26,48 @@ class CaptureEngineObserver {
   // Returns true if sample can be processed.
   virtual bool IsReadyForSample() const = 0;
 
+  // Returns true if the sample presented at |sample_time_us| should be read
+  // and passed to |UpdateBuffer|. Called for each sample once
+  // |IsReadyForSample| returns true, before the sample buffer is locked.
+  //
+  // Sets |draw_preview| to whether the preview should draw the sample. The
+  // decision is handed back to |UpdateBuffer| with the sample, as samples
+  // may be processed on another thread after later samples were paced.
+  virtual bool ShouldProcessSample(uint64_t sample_time_us,
+                                   bool* draw_preview) = 0;
+
   // Handles Capture Engine media events.
   virtual void OnEvent(IMFMediaEvent* event) = 0;
 
-  // Updates texture buffer
-  virtual bool UpdateBuffer(uint8_t* data, uint32_t new_length) = 0;
+  // Updates texture buffer with the given locked frame, presented at
+  // |sample_time_us| microseconds and captured by the camera at
+  // |capture_time|. If |draw_preview|, as set by |ShouldProcessSample| for
+  // this sample, is false, the frame is only passed to the other consumers
+  // of preview frames.
+  //
+  // |frame| is only valid for the duration of the call.
+  virtual bool UpdateBuffer(const FrameBufferView& frame,
+                            uint64_t sample_time_us,
+                            std::chrono::steady_clock::time_point capture_time,
+                            bool draw_preview) = 0;
 
   // Handles capture timestamps updates.
   // Used to stop timed recordings when recorded time is exceeded.
   virtual void UpdateCaptureTime(uint64_t capture_time) = 0;
+
+  // Handles format changes of the samples, such as a new frame size.
+  // Called before the first sample of the new format is passed to
+  // |UpdateBuffer|.
+  virtual void OnSampleFormatChanged() = 0;
 };
 
 // Listener for Windows Media Foundation capture engine events and samples.
 //
 // Events are redirected to observers for processing. Samples are preprosessed
-// and sent to the associated observer if it is ready to process samples.
-class CaptureEngineListener : public IMFCaptureEngineOnSampleCallback,
+// and sent to the associated observer if it is ready to process samples,
+// either on the thread delivering them or on a processing thread set with
+// |SetProcessingThread|.
+class CaptureEngineListener : public IMFCaptureEngineOnSampleCallback2,
                               public IMFCaptureEngineOnEventCallback {
  public:
   CaptureEngineListener(CaptureEngineObserver* observer) : observer_(observer) {
@@ -59,8 +91,27 @@ class CaptureEngineListener : public IMFCaptureEngineOnSampleCallback,
   // IMFCaptureEngineOnSampleCallback
   STDMETHODIMP_(HRESULT) OnSample(IMFSample* pSample);
 
+  // IMFCaptureEngineOnSampleCallback2
+  STDMETHODIMP_(HRESULT) OnSynchronizedEvent(IMFMediaEvent* pEvent);
+
+  // Hands samples off to |thread| instead of processing them on the thread
+  // delivering them, or processes them inline again if |thread| is null.
+  // The previous processing thread finishes its queued samples and is
+  // destroyed before this returns.
+  void SetProcessingThread(std::unique_ptr<FrameProcessingThread> thread);
+
  private:
+  // Reads |sample| and passes it to the observer. Called with
+  // |processing_mutex_| held when processing inline.
+  HRESULT ProcessSample(IMFSample* sample, uint64_t sample_time_us,
+                        std::chrono::steady_clock::time_point capture_time,
+                        bool draw_preview);
+
   CaptureEngineObserver* observer_;
+  // Guards |processing_thread_|, and serializes inline processing with
+  // changes of the processing thread.
+  std::mutex processing_mutex_;
+  std::unique_ptr<FrameProcessingThread> processing_thread_;
   volatile ULONG ref_ = 0;
 };
 
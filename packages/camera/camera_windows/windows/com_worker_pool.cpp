@@ -0,0 +1,33 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "com_worker_pool.h"
+
+#include <objbase.h>
+
+namespace camera_windows {
+
+namespace {
+
+// Whether COM was initialized on the current thread by |InitializeCom|, and
+// must be uninitialized before the thread exits.
+thread_local bool com_initialized = false;
+
+void InitializeCom() {
+  com_initialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+}
+
+void UninitializeCom() {
+  if (com_initialized) {
+    CoUninitialize();
+    com_initialized = false;
+  }
+}
+
+}  // namespace
+
+ComWorkerPool::ComWorkerPool(size_t thread_count)
+    : WorkerPool(thread_count, InitializeCom, UninitializeCom) {}
+
+}  // namespace camera_windows
@@ -0,0 +1,28 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_COM_WORKER_POOL_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_COM_WORKER_POOL_H_
+
+#include <cstddef>
+
+#include "worker_pool.h"
+
+namespace camera_windows {
+
+// A |WorkerPool| whose threads are initialized for COM in the multithreaded
+// apartment for their whole lifetime, as needed by the Windows Imaging
+// Component used to encode photos.
+//
+// A thread that fails to initialize COM still runs tasks, whose COM calls
+// then fail with an error.
+class ComWorkerPool : public WorkerPool {
+ public:
+  // Starts |thread_count| threads, at least one.
+  explicit ComWorkerPool(size_t thread_count);
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_COM_WORKER_POOL_H_
@@ -0,0 +1,50 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "burst_capture.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace camera_windows {
+
+BurstCapture::BurstCapture(uint32_t frame_count, uint64_t interval_us,
+                           size_t pool_size, FrameCallback callback)
+    : frame_count_(frame_count),
+      interval_us_(interval_us),
+      pool_(std::max<size_t>(pool_size, 1), 0),
+      callback_(std::move(callback)) {
+  assert(callback_);
+}
+
+bool BurstCapture::OnFrame(const FrameFormat& format,
+                           const FrameBufferView& source, uint32_t width,
+                           uint32_t height, uint64_t sample_time_us) {
+  const uint32_t index = taken_frame_count_.load(std::memory_order_relaxed);
+  if (index == frame_count_) {
+    return false;
+  }
+
+  // Frames arrive with some jitter, so a frame up to a quarter of the
+  // interval early is taken rather than waiting a whole frame longer.
+  if (index > 0 && sample_time_us + interval_us_ / 4 < next_due_time_us_) {
+    return false;
+  }
+
+  FrameRef frame;
+  if (!CopyCapturedFrame(format, source, width, height, &pool_, &frame)) {
+    return false;
+  }
+  frame.GetMutable()->sample_time_us = sample_time_us;
+
+  // The next frame is due one interval after this one, so frames that were
+  // delayed are not made up for with a quick succession of photos.
+  next_due_time_us_ = sample_time_us + interval_us_;
+  taken_frame_count_.store(index + 1, std::memory_order_release);
+  callback_(index, std::move(frame));
+  return true;
+}
+
+}  // namespace camera_windows
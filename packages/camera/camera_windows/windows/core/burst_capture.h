@@ -0,0 +1,76 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_BURST_CAPTURE_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_BURST_CAPTURE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "frame_buffer_view.h"
+#include "frame_conversion.h"
+#include "frame_pool.h"
+
+namespace camera_windows {
+
+// Picks the frames of a burst of photos from the captured frames.
+//
+// A burst takes |frame_count| frames, one per |interval_us| of presentation
+// time, starting with the first frame it sees. Each frame is copied, as the
+// camera delivered it, into a fixed-size |FramePool| and handed to a
+// callback, which encodes it elsewhere. While every pooled frame is still
+// referenced by the encoder, due frames are skipped and a later frame is
+// taken instead, so a slow encoder delays photos instead of queuing copies.
+class BurstCapture {
+ public:
+  // Called from the capture thread with each frame taken, and its index in
+  // the burst.
+  using FrameCallback = std::function<void(uint32_t index, FrameRef frame)>;
+
+  // Creates a burst of |frame_count| frames, copied into a pool of
+  // |pool_size| frames.
+  BurstCapture(uint32_t frame_count, uint64_t interval_us, size_t pool_size,
+               FrameCallback callback);
+  virtual ~BurstCapture() = default;
+
+  // Prevent copying.
+  BurstCapture(BurstCapture const&) = delete;
+  BurstCapture& operator=(BurstCapture const&) = delete;
+
+  // Takes a captured frame of |width| x |height| pixels, presented at
+  // |sample_time_us|, if the next frame of the burst is due.
+  //
+  // Called from the capture thread. Returns true if the frame was taken.
+  bool OnFrame(const FrameFormat& format, const FrameBufferView& source,
+               uint32_t width, uint32_t height, uint64_t sample_time_us);
+
+  // Returns the number of frames taken so far. May be called from any
+  // thread.
+  uint32_t GetTakenFrameCount() const {
+    return taken_frame_count_.load(std::memory_order_acquire);
+  }
+
+  // Returns true once all frames of the burst have been taken.
+  bool IsComplete() const { return GetTakenFrameCount() == frame_count_; }
+
+  // Returns the number of due frames that were skipped because all pooled
+  // frames were referenced.
+  uint64_t GetDelayedFrameCount() const { return pool_.GetExhaustedCount(); }
+
+ private:
+  const uint32_t frame_count_;
+  const uint64_t interval_us_;
+  FramePool pool_;
+  FrameCallback callback_;
+
+  std::atomic<uint32_t> taken_frame_count_ = 0;
+  // Presentation time from which the next frame is due.
+  uint64_t next_due_time_us_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_BURST_CAPTURE_H_
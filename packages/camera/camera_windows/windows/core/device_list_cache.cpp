@@ -0,0 +1,38 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "device_list_cache.h"
+
+#include <cassert>
+#include <utility>
+
+namespace camera_windows {
+
+bool DeviceListCache::GetDeviceNames(std::vector<std::string>* names) {
+  assert(names);
+  if (!valid_) {
+    miss_count_++;
+    return false;
+  }
+  hit_count_++;
+  *names = names_;
+  return true;
+}
+
+void DeviceListCache::Update(std::vector<std::string> names) {
+  names_ = std::move(names);
+  valid_ = true;
+  change_reported_ = false;
+}
+
+bool DeviceListCache::OnDevicesChanged() {
+  valid_ = false;
+  if (change_reported_) {
+    return false;
+  }
+  change_reported_ = true;
+  return true;
+}
+
+}  // namespace camera_windows
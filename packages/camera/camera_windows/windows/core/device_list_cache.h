@@ -0,0 +1,58 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_DEVICE_LIST_CACHE_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_DEVICE_LIST_CACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace camera_windows {
+
+// Cached list of the video capture devices of the system.
+//
+// Enumerating devices and reading their names takes hundreds of
+// milliseconds on some systems, so the list is kept until the system reports
+// that devices were added or removed. Used from the platform thread only.
+class DeviceListCache {
+ public:
+  DeviceListCache() = default;
+  virtual ~DeviceListCache() = default;
+
+  // Prevent copying.
+  DeviceListCache(DeviceListCache const&) = delete;
+  DeviceListCache& operator=(DeviceListCache const&) = delete;
+
+  // Copies the cached device names to |names| and returns true if the list
+  // is up to date. Returns false if devices must be enumerated again.
+  bool GetDeviceNames(std::vector<std::string>* names);
+
+  // Caches a freshly enumerated list of device names.
+  void Update(std::vector<std::string> names);
+
+  // Marks the list as outdated after devices were added or removed.
+  //
+  // Returns true for the first change since the list was last updated, and
+  // false for changes that follow before devices are enumerated again, so
+  // that listeners are told once about a series of changes.
+  bool OnDevicesChanged();
+
+  // Returns the number of lookups answered from the cache.
+  uint64_t GetHitCount() const { return hit_count_; }
+
+  // Returns the number of lookups that required an enumeration.
+  uint64_t GetMissCount() const { return miss_count_; }
+
+ private:
+  std::vector<std::string> names_;
+  bool valid_ = false;
+  bool change_reported_ = false;
+  uint64_t hit_count_ = 0;
+  uint64_t miss_count_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_DEVICE_LIST_CACHE_H_
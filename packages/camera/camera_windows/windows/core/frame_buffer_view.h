@@ -0,0 +1,59 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_BUFFER_VIEW_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_BUFFER_VIEW_H_
+
+#include <algorithm>
+#include <cstdint>
+
+namespace camera_windows {
+
+// Read-only view of a locked frame buffer.
+//
+// Describes where the rows of a frame are in memory, without making any
+// assumptions about the pixel format. Rows may be padded, and may be stored
+// bottom-up, as reported by IMF2DBuffer::Lock2D.
+struct FrameBufferView {
+  // First byte of the top row of the frame.
+  const uint8_t* scanline0 = nullptr;
+
+  // Byte offset from the start of one row to the start of the row below it.
+  // Negative for bottom-up frames. Zero if rows are packed without padding.
+  int32_t stride = 0;
+
+  // Lowest address of the buffer, and its length in bytes. Used to validate
+  // the layout before pixels are read.
+  const uint8_t* buffer_start = nullptr;
+  uint32_t buffer_length = 0;
+
+  // Returns the stride of rows of |row_size| bytes.
+  int32_t GetStride(uint32_t row_size) const {
+    return stride != 0 ? stride : static_cast<int32_t>(row_size);
+  }
+
+  // Returns true if |height| rows of |row_size| bytes fit inside the buffer.
+  bool Contains(uint32_t row_size, uint32_t height) const {
+    if (!scanline0 || !buffer_start || row_size == 0 || height == 0) {
+      return false;
+    }
+
+    const int64_t stride_bytes = GetStride(row_size);
+    const int64_t abs_stride = stride_bytes < 0 ? -stride_bytes : stride_bytes;
+    if (abs_stride < row_size) {
+      // Rows would overlap.
+      return false;
+    }
+
+    // Offsets of the first and last row, relative to the buffer start.
+    const int64_t first_row = scanline0 - buffer_start;
+    const int64_t last_row = first_row + stride_bytes * (height - 1);
+    return std::min(first_row, last_row) >= 0 &&
+           std::max(first_row, last_row) + row_size <= buffer_length;
+  }
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_BUFFER_VIEW_H_
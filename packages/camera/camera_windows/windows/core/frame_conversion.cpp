@@ -0,0 +1,278 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_conversion.h"
+
+#include <cassert>
+#include <cstddef>
+
+#include "pixel_conversion.h"
+
+namespace camera_windows {
+
+bool GetFramePlanes(const FrameFormat& format, const FrameBufferView& src,
+                    uint32_t width, uint32_t height, FramePlanes* planes) {
+  if (width == 0 || height == 0) {
+    return false;
+  }
+
+  switch (format.pixel_format) {
+    case PixelFormat::kRGB32: {
+      const uint32_t row_size = width * 4;
+      if (!src.Contains(row_size, height)) {
+        return false;
+      }
+      planes->rows = src.scanline0;
+      planes->stride = src.GetStride(row_size);
+      return true;
+    }
+    case PixelFormat::kNV12: {
+      // Chroma rows hold one U and V pair per two pixels, rounded up.
+      const uint32_t row_size = (width + 1) / 2 * 2;
+      const uint32_t chroma_height = (height + 1) / 2;
+      const int32_t stride = src.GetStride(row_size);
+      if (stride < 0 || !src.Contains(row_size, height + chroma_height)) {
+        return false;
+      }
+      planes->rows = src.scanline0;
+      planes->stride = stride;
+      planes->chroma_rows =
+          src.scanline0 + static_cast<ptrdiff_t>(stride) * height;
+      return true;
+    }
+    case PixelFormat::kYUY2: {
+      const uint32_t row_size = (width + 1) / 2 * 4;
+      if (!src.Contains(row_size, height)) {
+        return false;
+      }
+      planes->rows = src.scanline0;
+      planes->stride = src.GetStride(row_size);
+      return true;
+    }
+    case PixelFormat::kMJPG:
+      return false;
+  }
+  return false;
+}
+
+namespace {
+
+// Converts rows |begin| to |end| of a frame located by |planes| into the
+// same rows of |dst|. NV12 strips must start at an even row, as two rows
+// share each chroma row.
+void ConvertRows(const FrameFormat& format, const FramePlanes& planes,
+                 uint8_t* dst, uint32_t width, uint32_t begin, uint32_t end,
+                 bool mirror) {
+  const ptrdiff_t stride = planes.stride;
+  uint8_t* dst_rows = dst + static_cast<size_t>(begin) * width * 4;
+  switch (format.pixel_format) {
+    case PixelFormat::kRGB32:
+      ConvertRGB32ToRGBA(planes.rows + stride * begin, planes.stride,
+                         dst_rows, width, end - begin, mirror);
+      break;
+    case PixelFormat::kNV12:
+      assert(begin % 2 == 0);
+      ConvertNV12ToRGBA(planes.rows + stride * begin, planes.stride,
+                        planes.chroma_rows + stride * (begin / 2),
+                        planes.stride, dst_rows, width, end - begin,
+                        format.color_space, mirror);
+      break;
+    case PixelFormat::kYUY2:
+      ConvertYUY2ToRGBA(planes.rows + stride * begin, planes.stride,
+                        dst_rows, width, end - begin, format.color_space,
+                        mirror);
+      break;
+    case PixelFormat::kMJPG:
+      assert(false);
+      break;
+  }
+}
+
+// Converts a frame located by |planes| like |ConvertFrameToRGBA|.
+void ConvertPlanes(const FrameFormat& format, const FramePlanes& planes,
+                   uint8_t* dst, uint32_t width, uint32_t height, bool mirror,
+                   StripPool* pool) {
+  if (!pool) {
+    ConvertRows(format, planes, dst, width, 0, height, mirror);
+    return;
+  }
+  const uint32_t min_strip_rows = (kMinStripPixels + width - 1) / width;
+  const uint32_t row_alignment =
+      format.pixel_format == PixelFormat::kNV12 ? 2 : 1;
+  pool->ParallelFor(height, min_strip_rows, row_alignment,
+                    [&](uint32_t begin, uint32_t end) {
+                      ConvertRows(format, planes, dst, width, begin, end,
+                                  mirror);
+                    });
+}
+
+}  // namespace
+
+bool ConvertFrameToRGBA(const FrameFormat& format, const FrameBufferView& src,
+                        uint8_t* dst, uint32_t width, uint32_t height,
+                        bool mirror) {
+  return ConvertFrameToRGBA(format, src, dst, width, height, mirror, nullptr);
+}
+
+bool ConvertFrameToRGBA(const FrameFormat& format, const FrameBufferView& src,
+                        uint8_t* dst, uint32_t width, uint32_t height,
+                        bool mirror, StripPool* pool) {
+  assert(dst);
+  FramePlanes planes;
+  if (!GetFramePlanes(format, src, width, height, &planes)) {
+    return false;
+  }
+  ConvertPlanes(format, planes, dst, width, height, mirror, pool);
+  return true;
+}
+
+namespace {
+
+// Scales a frame located by |planes| like |ScaleFrameToRGBA|. The scaler
+// swaps the red and blue channels of sources in the opposite order of the
+// output, so BGRA output costs nothing extra.
+bool ScalePlanes(const FrameFormat& format, const FramePlanes& planes,
+                 uint32_t width, uint32_t height, uint8_t* dst,
+                 uint32_t dst_width, uint32_t dst_height, bool mirror,
+                 bool bgra_output, FrameScaler* scaler) {
+  assert(dst && scaler);
+  if (dst_width == 0 || dst_height == 0 || dst_width > width ||
+      dst_height > height ||
+      dst_width * kMaxScaleDenominator < width ||
+      dst_height * kMaxScaleDenominator < height) {
+    return false;
+  }
+
+  const ScaleFilter filter =
+      GetScaleFilter(width, height, dst_width, dst_height);
+  const YuvColorSpace& color_space = format.color_space;
+  switch (format.pixel_format) {
+    case PixelFormat::kRGB32:
+      // BGRX rows are read in place; the scaler swaps the channels as
+      // needed.
+      scaler->Scale(
+          [&planes](uint32_t y, uint8_t*) {
+            return planes.rows + static_cast<ptrdiff_t>(planes.stride) * y;
+          },
+          bgra_output ? SourcePixelOrder::kRGBA : SourcePixelOrder::kBGRA,
+          width, height, dst, dst_width, dst_height, filter, mirror);
+      return true;
+    case PixelFormat::kNV12:
+      scaler->Scale(
+          [&planes, &color_space, width](uint32_t y, uint8_t* buffer) {
+            const ptrdiff_t stride = planes.stride;
+            ConvertNV12ToRGBA(planes.rows + stride * y, planes.stride,
+                              planes.chroma_rows + stride * (y / 2),
+                              planes.stride, buffer, width, 1, color_space,
+                              false);
+            return static_cast<const uint8_t*>(buffer);
+          },
+          bgra_output ? SourcePixelOrder::kBGRA : SourcePixelOrder::kRGBA,
+          width, height, dst, dst_width, dst_height, filter, mirror);
+      return true;
+    case PixelFormat::kYUY2:
+      scaler->Scale(
+          [&planes, &color_space, width](uint32_t y, uint8_t* buffer) {
+            ConvertYUY2ToRGBA(
+                planes.rows + static_cast<ptrdiff_t>(planes.stride) * y,
+                planes.stride, buffer, width, 1, color_space, false);
+            return static_cast<const uint8_t*>(buffer);
+          },
+          bgra_output ? SourcePixelOrder::kBGRA : SourcePixelOrder::kRGBA,
+          width, height, dst, dst_width, dst_height, filter, mirror);
+      return true;
+    case PixelFormat::kMJPG:
+      return false;
+  }
+  return false;
+}
+
+// Scales a frame like |ScaleFrameToRGBA|.
+bool ScaleFrame(const FrameFormat& format, const FrameBufferView& src,
+                uint32_t width, uint32_t height, uint8_t* dst,
+                uint32_t dst_width, uint32_t dst_height, bool mirror,
+                bool bgra_output, FrameScaler* scaler) {
+  FramePlanes planes;
+  if (!GetFramePlanes(format, src, width, height, &planes)) {
+    return false;
+  }
+  return ScalePlanes(format, planes, width, height, dst, dst_width,
+                     dst_height, mirror, bgra_output, scaler);
+}
+
+// Moves |planes| of a frame to the first pixel of |region|. Returns false if
+// the region splits chroma samples.
+bool GetRegionPlanes(const FrameFormat& format, const FrameRegion& region,
+                     FramePlanes* planes) {
+  const ptrdiff_t stride = planes->stride;
+  switch (format.pixel_format) {
+    case PixelFormat::kRGB32:
+      planes->rows += stride * region.y + ptrdiff_t{4} * region.x;
+      return true;
+    case PixelFormat::kNV12:
+      if (region.x % 2 != 0 || region.y % 2 != 0) {
+        return false;
+      }
+      // Each chroma row holds a U and V pair per two pixels, so chroma
+      // columns start at the same offset as luma columns.
+      planes->rows += stride * region.y + region.x;
+      planes->chroma_rows += stride * (region.y / 2) + region.x;
+      return true;
+    case PixelFormat::kYUY2:
+      if (region.x % 2 != 0) {
+        return false;
+      }
+      planes->rows += stride * region.y + ptrdiff_t{2} * region.x;
+      return true;
+    case PixelFormat::kMJPG:
+      return false;
+  }
+  return false;
+}
+
+}  // namespace
+
+bool ScaleFrameToRGBA(const FrameFormat& format, const FrameBufferView& src,
+                      uint32_t width, uint32_t height, uint8_t* dst,
+                      uint32_t dst_width, uint32_t dst_height, bool mirror,
+                      FrameScaler* scaler) {
+  return ScaleFrame(format, src, width, height, dst, dst_width, dst_height,
+                    mirror, false, scaler);
+}
+
+bool ScaleFrameToBGRA(const FrameFormat& format, const FrameBufferView& src,
+                      uint32_t width, uint32_t height, uint8_t* dst,
+                      uint32_t dst_width, uint32_t dst_height, bool mirror,
+                      FrameScaler* scaler) {
+  return ScaleFrame(format, src, width, height, dst, dst_width, dst_height,
+                    mirror, true, scaler);
+}
+
+bool ConvertFrameRegionToRGBA(const FrameFormat& format,
+                              const FrameBufferView& src, uint32_t width,
+                              uint32_t height, const FrameRegion& region,
+                              uint8_t* dst, uint32_t dst_width,
+                              uint32_t dst_height, bool mirror,
+                              FrameScaler* scaler, StripPool* pool) {
+  assert(dst);
+  FramePlanes planes;
+  if (region.width == 0 || region.height == 0 || region.x >= width ||
+      region.y >= height || region.width > width - region.x ||
+      region.height > height - region.y ||
+      !GetFramePlanes(format, src, width, height, &planes) ||
+      !GetRegionPlanes(format, region, &planes)) {
+    return false;
+  }
+
+  if (dst_width == region.width && dst_height == region.height) {
+    ConvertPlanes(format, planes, dst, region.width, region.height, mirror,
+                  pool);
+    return true;
+  }
+  return scaler && ScalePlanes(format, planes, region.width, region.height,
+                               dst, dst_width, dst_height, mirror, false,
+                               scaler);
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,126 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_CONVERSION_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_CONVERSION_H_
+
+#include <cstdint>
+
+#include "frame_buffer_view.h"
+#include "frame_scaler.h"
+#include "strip_pool.h"
+#include "yuv_conversion.h"
+
+namespace camera_windows {
+
+// Pixel formats of captured frames.
+enum class PixelFormat {
+  // MFVideoFormat_RGB32: BGRX pixels.
+  kRGB32,
+  // MFVideoFormat_NV12: luma plane followed by an interleaved chroma plane.
+  kNV12,
+  // MFVideoFormat_YUY2: packed Y0 U Y1 V macropixels.
+  kYUY2,
+  // MFVideoFormat_MJPG: one JPEG image per frame. Compressed frames are
+  // decoded by MjpegDecoder instead of |ConvertFrameToRGBA|.
+  kMJPG,
+};
+
+// Describes the pixels of captured frames.
+struct FrameFormat {
+  PixelFormat pixel_format = PixelFormat::kRGB32;
+  // Ignored for RGB formats.
+  YuvColorSpace color_space;
+};
+
+// Location of the rows of a captured frame.
+struct FramePlanes {
+  const uint8_t* rows = nullptr;
+  int32_t stride = 0;
+  // Interleaved chroma rows of NV12 frames, with the same stride.
+  const uint8_t* chroma_rows = nullptr;
+};
+
+// Locates the rows of a frame of |width| x |height| pixels in |src|.
+//
+// Returns false if |src| does not contain a complete frame, or if frames of
+// |format| are compressed.
+bool GetFramePlanes(const FrameFormat& format, const FrameBufferView& src,
+                    uint32_t width, uint32_t height, FramePlanes* planes);
+
+// Converts a captured frame of |width| x |height| pixels to packed RGBA.
+//
+// NV12 frames must store the chroma plane right after the last luma row,
+// with the same stride. If |mirror| is true, each row is flipped
+// horizontally.
+//
+// Returns false without writing to |dst| if |src| does not contain a
+// complete frame, or if frames of |format| are compressed.
+bool ConvertFrameToRGBA(const FrameFormat& format, const FrameBufferView& src,
+                        uint8_t* dst, uint32_t width, uint32_t height,
+                        bool mirror);
+
+// Smallest number of pixels converted in a strip by the |StripPool|
+// overload of |ConvertFrameToRGBA|. Below this, handing a strip to another
+// thread costs more than converting it.
+constexpr uint32_t kMinStripPixels = 256 * 1024;
+
+// Same as |ConvertFrameToRGBA|, but converts frames of more than
+// |kMinStripPixels| pixels in strips of rows on |pool|.
+bool ConvertFrameToRGBA(const FrameFormat& format, const FrameBufferView& src,
+                        uint8_t* dst, uint32_t width, uint32_t height,
+                        bool mirror, StripPool* pool);
+
+// Converts a captured frame of |width| x |height| pixels to packed RGBA of
+// |dst_width| x |dst_height| pixels, scaled down with |scaler|.
+//
+// RGB32 rows are scaled straight from |src|, and YUV rows are converted one
+// at a time as the scaler reads them, so no full-size RGBA frame is written.
+//
+// Returns false without writing to |dst| under the same conditions as
+// |ConvertFrameToRGBA|, or if the output size is larger than the frame or
+// smaller than the scaler supports.
+bool ScaleFrameToRGBA(const FrameFormat& format, const FrameBufferView& src,
+                      uint32_t width, uint32_t height, uint8_t* dst,
+                      uint32_t dst_width, uint32_t dst_height, bool mirror,
+                      FrameScaler* scaler);
+
+// Same as |ScaleFrameToRGBA|, but writes packed BGRA pixels.
+bool ScaleFrameToBGRA(const FrameFormat& format, const FrameBufferView& src,
+                      uint32_t width, uint32_t height, uint8_t* dst,
+                      uint32_t dst_width, uint32_t dst_height, bool mirror,
+                      FrameScaler* scaler);
+
+// Rectangle of pixels within a frame.
+struct FrameRegion {
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// Converts |region| of a captured frame of |width| x |height| pixels to
+// packed RGBA of |dst_width| x |dst_height| pixels.
+//
+// Only the pixels of the region are read, so the cost follows the size of
+// the region rather than the size of the frame. If the output has the size
+// of the region, it is converted like |ConvertFrameToRGBA|, in strips on
+// |pool| if not null. Otherwise it is scaled down with |scaler| like
+// |ScaleFrameToRGBA|. If |mirror| is true, the region is flipped
+// horizontally, but stays where it is in the frame.
+//
+// YUY2 and NV12 regions must start at an even column, and NV12 regions at
+// an even row, so that they do not split chroma samples. Returns false
+// without writing to |dst| if the region is misaligned or not within the
+// frame, or under the same conditions as |ScaleFrameToRGBA|.
+bool ConvertFrameRegionToRGBA(const FrameFormat& format,
+                              const FrameBufferView& src, uint32_t width,
+                              uint32_t height, const FrameRegion& region,
+                              uint8_t* dst, uint32_t dst_width,
+                              uint32_t dst_height, bool mirror,
+                              FrameScaler* scaler, StripPool* pool);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_CONVERSION_H_
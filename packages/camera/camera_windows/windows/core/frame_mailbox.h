@@ -0,0 +1,95 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_MAILBOX_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_MAILBOX_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace camera_windows {
+
+// Latest-wins frame exchange between one producer and one consumer thread.
+//
+// The mailbox owns three slots: one being written by the producer, one being
+// read by the consumer, and one holding the newest published frame. Slots are
+// swapped with a single atomic exchange, so neither side ever blocks or waits
+// for the other. If the producer publishes again before the consumer has
+// taken the previous frame, the older frame is overwritten and counted as
+// dropped.
+//
+// All producer methods must be called from the same thread, and all consumer
+// methods must be called from the same thread.
+template <typename T>
+class FrameMailbox {
+ public:
+  FrameMailbox() = default;
+  ~FrameMailbox() = default;
+
+  // Prevent copying.
+  FrameMailbox(FrameMailbox const&) = delete;
+  FrameMailbox& operator=(FrameMailbox const&) = delete;
+
+  // Producer: returns the slot the next frame should be written to.
+  //
+  // The slot stays owned by the producer until |Publish| is called.
+  T& GetWriteSlot() { return slots_[write_index_]; }
+
+  // Producer: publishes the write slot as the newest frame.
+  void Publish() {
+    uint32_t previous =
+        ready_.exchange(write_index_ | kNewFrameBit, std::memory_order_acq_rel);
+    write_index_ = previous & kIndexMask;
+    published_frame_count_.fetch_add(1, std::memory_order_relaxed);
+    if (previous & kNewFrameBit) {
+      // The consumer never took the previous frame.
+      dropped_frame_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Consumer: makes the newest published frame available via |GetReadSlot|.
+  //
+  // Returns false if nothing was published since the last call, in which case
+  // the read slot still holds the previously taken frame.
+  bool TakeNewest() {
+    if (!(ready_.load(std::memory_order_relaxed) & kNewFrameBit)) {
+      return false;
+    }
+    uint32_t previous =
+        ready_.exchange(read_index_, std::memory_order_acq_rel);
+    read_index_ = previous & kIndexMask;
+    return true;
+  }
+
+  // Consumer: returns the slot taken by the last successful |TakeNewest|.
+  //
+  // The slot stays owned by the consumer until the next |TakeNewest|.
+  const T& GetReadSlot() const { return slots_[read_index_]; }
+
+  // Returns the number of frames published so far.
+  uint64_t GetPublishedFrameCount() const {
+    return published_frame_count_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the number of frames overwritten before the consumer took them.
+  uint64_t GetDroppedFrameCount() const {
+    return dropped_frame_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr uint32_t kIndexMask = 0x3;
+  static constexpr uint32_t kNewFrameBit = 0x4;
+
+  T slots_[3];
+  uint32_t write_index_ = 0;
+  uint32_t read_index_ = 1;
+  // Index of the newest published slot, and whether it is not taken yet.
+  std::atomic<uint32_t> ready_ = 2;
+  std::atomic<uint64_t> published_frame_count_ = 0;
+  std::atomic<uint64_t> dropped_frame_count_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_MAILBOX_H_
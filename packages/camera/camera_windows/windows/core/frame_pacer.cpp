@@ -0,0 +1,56 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_pacer.h"
+
+#include <cmath>
+
+namespace camera_windows {
+
+void FramePacer::SetMaxFrameRate(double max_frame_rate) {
+  uint64_t interval_us = 0;
+  if (max_frame_rate > 0 && std::isfinite(max_frame_rate)) {
+    interval_us =
+        static_cast<uint64_t>(std::llround(1000000.0 / max_frame_rate));
+  }
+  frame_interval_us_.store(interval_us, std::memory_order_relaxed);
+}
+
+bool FramePacer::ShouldProcessFrame(uint64_t sample_time_us) {
+  const int64_t time_us = static_cast<int64_t>(sample_time_us);
+  const uint64_t interval = frame_interval_us_.load(std::memory_order_relaxed);
+  const int64_t interval_us = static_cast<int64_t>(interval);
+
+  // The schedule restarts when the limit changes, and when sample times go
+  // back, as they do when the preview stream is restarted.
+  if (interval != schedule_interval_us_ || time_us < last_frame_time_us_) {
+    schedule_interval_us_ = interval;
+    next_frame_time_us_ = -1;
+  }
+  last_frame_time_us_ = time_us;
+
+  if (interval_us == 0) {
+    return true;
+  }
+
+  // Frames a little early are still processed, so that a camera running at
+  // the limit is not halved by jitter in its timestamps.
+  if (next_frame_time_us_ >= 0 &&
+      time_us + interval_us / 4 < next_frame_time_us_) {
+    skipped_frames_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // After a gap, the schedule restarts from this frame instead of
+  // processing a burst of frames to catch up.
+  if (next_frame_time_us_ < 0 ||
+      time_us >= next_frame_time_us_ + interval_us) {
+    next_frame_time_us_ = time_us + interval_us;
+  } else {
+    next_frame_time_us_ += interval_us;
+  }
+  return true;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,67 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_PACER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_PACER_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace camera_windows {
+
+// Limits the rate of preview frames by their presentation time.
+//
+// Cameras deliver frames at the rate of their media type, often 60 fps,
+// while many previews need far fewer. The pacer decides from the sample time
+// alone whether a frame is processed, so that frames over the limit are
+// dropped before they are locked, copied or converted.
+//
+// The limit may be changed from any thread, while |ShouldProcessFrame| is
+// only called from the capture thread.
+class FramePacer {
+ public:
+  FramePacer() = default;
+  virtual ~FramePacer() = default;
+
+  // Prevent copying.
+  FramePacer(FramePacer const&) = delete;
+  FramePacer& operator=(FramePacer const&) = delete;
+
+  // Sets the highest number of frames per second, or 0 to process every
+  // frame. Takes effect from the next frame.
+  void SetMaxFrameRate(double max_frame_rate);
+
+  // Returns the interval between processed frames, or 0 without a limit.
+  uint64_t GetFrameInterval() const {
+    return frame_interval_us_.load(std::memory_order_relaxed);
+  }
+
+  // Returns true if the frame presented at |sample_time_us| should be
+  // processed.
+  bool ShouldProcessFrame(uint64_t sample_time_us);
+
+  // Returns the number of frames dropped to keep to the limit.
+  uint64_t GetSkippedFrameCount() const {
+    return skipped_frames_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Minimum time between processed frames, or 0 without a limit.
+  std::atomic<uint64_t> frame_interval_us_ = 0;
+
+  // Only used by the capture thread.
+  // Interval the schedule was computed with.
+  uint64_t schedule_interval_us_ = 0;
+  // Presentation time from which the next frame may be processed, or -1
+  // before the first frame.
+  int64_t next_frame_time_us_ = -1;
+  // Presentation time of the previous frame, or -1 before the first frame.
+  int64_t last_frame_time_us_ = -1;
+
+  std::atomic<uint64_t> skipped_frames_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_PACER_H_
@@ -0,0 +1,241 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_pool.h"
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace camera_windows {
+
+struct FramePoolState {
+  std::mutex mutex;
+  bool fixed_size = false;
+  // Set once the pool is destroyed. The state is then deleted with the
+  // release of the last referenced frame.
+  bool pool_destroyed = false;
+  std::vector<std::unique_ptr<PooledFrame>> frames;
+  // Has the capacity of |frames|, so returning a frame never allocates.
+  std::vector<PooledFrame*> free_frames;
+  size_t frames_in_use = 0;
+  uint64_t allocation_count = 0;
+  uint64_t exhausted_count = 0;
+};
+
+FrameRef::FrameRef(const FrameRef& other) : frame_(other.frame_) {
+  if (frame_) {
+    frame_->ref_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+FrameRef& FrameRef::operator=(const FrameRef& other) {
+  FrameRef copy(other);
+  *this = std::move(copy);
+  return *this;
+}
+
+FrameRef& FrameRef::operator=(FrameRef&& other) noexcept {
+  if (this != &other) {
+    reset();
+    frame_ = other.frame_;
+    other.frame_ = nullptr;
+  }
+  return *this;
+}
+
+PooledFrame* FrameRef::GetMutable() {
+  assert(IsUnique());
+  return frame_;
+}
+
+bool FrameRef::IsUnique() const {
+  return frame_ && frame_->ref_count_.load(std::memory_order_acquire) == 1;
+}
+
+void FrameRef::reset() {
+  if (!frame_) {
+    return;
+  }
+  // Writes made by other holders happen before the frame is reused.
+  if (frame_->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    FramePool::Recycle(frame_);
+  }
+  frame_ = nullptr;
+}
+
+FramePool::FramePool() : state_(new FramePoolState()) {}
+
+FramePool::FramePool(size_t frame_count, size_t frame_size)
+    : state_(new FramePoolState()) {
+  state_->fixed_size = true;
+  state_->frames.reserve(frame_count);
+  state_->free_frames.reserve(frame_count);
+  for (size_t i = 0; i < frame_count; i++) {
+    std::unique_ptr<PooledFrame> frame(new PooledFrame());
+    frame->pool_state_ = state_;
+    frame->buffer_.resize(frame_size);
+    state_->free_frames.push_back(frame.get());
+    state_->frames.push_back(std::move(frame));
+  }
+  state_->allocation_count = frame_count;
+}
+
+FramePool::~FramePool() {
+  bool delete_state = false;
+  {
+    const std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->pool_destroyed = true;
+    delete_state = state_->frames_in_use == 0;
+  }
+  if (delete_state) {
+    delete state_;
+  }
+}
+
+FrameRef FramePool::Acquire(size_t size) {
+  const std::lock_guard<std::mutex> lock(state_->mutex);
+  if (state_->free_frames.empty()) {
+    if (state_->fixed_size) {
+      state_->exhausted_count++;
+      return FrameRef();
+    }
+    std::unique_ptr<PooledFrame> frame(new PooledFrame());
+    frame->pool_state_ = state_;
+    state_->free_frames.reserve(state_->frames.size() + 1);
+    state_->free_frames.push_back(frame.get());
+    state_->frames.push_back(std::move(frame));
+    state_->allocation_count++;
+  }
+
+  PooledFrame* frame = state_->free_frames.back();
+  state_->free_frames.pop_back();
+  state_->frames_in_use++;
+
+  if (frame->buffer_.size() < size) {
+    frame->buffer_.resize(size);
+    state_->allocation_count++;
+  }
+  frame->size_ = size;
+  frame->content = FrameContent::kRGBA;
+  frame->captured_format = FrameFormat();
+  frame->width = 0;
+  frame->height = 0;
+  frame->stride = 0;
+  frame->sample_time_us = 0;
+  frame->mirrored = false;
+  frame->ref_count_.store(1, std::memory_order_relaxed);
+  return FrameRef(frame);
+}
+
+size_t FramePool::GetFramesInUse() const {
+  const std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->frames_in_use;
+}
+
+size_t FramePool::GetFrameCount() const {
+  const std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->frames.size();
+}
+
+uint64_t FramePool::GetAllocationCount() const {
+  const std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->allocation_count;
+}
+
+uint64_t FramePool::GetExhaustedCount() const {
+  const std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->exhausted_count;
+}
+
+// static
+void FramePool::Recycle(PooledFrame* frame) {
+  FramePoolState* state = frame->pool_state_;
+  bool delete_state = false;
+  {
+    const std::lock_guard<std::mutex> lock(state->mutex);
+    state->free_frames.push_back(frame);
+    state->frames_in_use--;
+    delete_state = state->pool_destroyed && state->frames_in_use == 0;
+  }
+  if (delete_state) {
+    delete state;
+  }
+}
+
+bool CopyCapturedFrame(const FrameFormat& format, const FrameBufferView& src,
+                       uint32_t width, uint32_t height, FramePool* pool,
+                       FrameRef* frame) {
+  assert(pool && frame);
+  FrameRef copy;
+  if (format.pixel_format == PixelFormat::kMJPG) {
+    if (!src.buffer_start || src.buffer_length == 0) {
+      return false;
+    }
+    copy = pool->Acquire(src.buffer_length);
+    if (!copy) {
+      return false;
+    }
+    memcpy(copy.GetMutable()->GetData(), src.buffer_start, src.buffer_length);
+  } else {
+    FramePlanes planes;
+    if (!GetFramePlanes(format, src, width, height, &planes)) {
+      return false;
+    }
+
+    size_t row_size = 0;
+    uint32_t chroma_height = 0;
+    switch (format.pixel_format) {
+      case PixelFormat::kRGB32:
+        row_size = static_cast<size_t>(width) * 4;
+        break;
+      case PixelFormat::kNV12:
+        row_size = (width + 1) / 2 * 2;
+        chroma_height = (height + 1) / 2;
+        break;
+      case PixelFormat::kYUY2:
+        row_size = static_cast<size_t>((width + 1) / 2) * 4;
+        break;
+      case PixelFormat::kMJPG:
+        return false;
+    }
+
+    copy = pool->Acquire(row_size * (height + chroma_height));
+    if (!copy) {
+      return false;
+    }
+    uint8_t* dst = copy.GetMutable()->GetData();
+    const ptrdiff_t stride = planes.stride;
+    for (uint32_t y = 0; y < height; y++) {
+      memcpy(dst + row_size * y, planes.rows + stride * y, row_size);
+    }
+    // NV12 chroma rows follow the luma rows, as in the media buffer.
+    for (uint32_t y = 0; y < chroma_height; y++) {
+      memcpy(dst + row_size * (height + y), planes.chroma_rows + stride * y,
+             row_size);
+    }
+    copy.GetMutable()->stride = static_cast<int32_t>(row_size);
+  }
+
+  PooledFrame* output = copy.GetMutable();
+  output->content = FrameContent::kCaptured;
+  output->captured_format = format;
+  output->width = width;
+  output->height = height;
+  *frame = std::move(copy);
+  return true;
+}
+
+FrameBufferView GetFrameBufferView(const PooledFrame& frame) {
+  FrameBufferView view;
+  view.scanline0 = frame.GetData();
+  view.stride = frame.stride;
+  view.buffer_start = frame.GetData();
+  view.buffer_length = static_cast<uint32_t>(frame.GetSize());
+  return view;
+}
+
+}  // namespace camera_windows
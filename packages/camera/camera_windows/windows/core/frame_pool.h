@@ -0,0 +1,192 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_POOL_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "frame_conversion.h"
+
+namespace camera_windows {
+
+// Contents of a pooled frame.
+enum class FrameContent {
+  // Packed RGBA pixels, converted from a captured frame.
+  kRGBA,
+  // A copy of a captured frame in the format the camera delivered it in,
+  // described by |PooledFrame::captured_format|.
+  kCaptured,
+};
+
+class FramePool;
+class FrameRef;
+
+// Shared state of a |FramePool| and its frames.
+struct FramePoolState;
+
+// A frame in the memory of a |FramePool|.
+//
+// The frame is written by the thread that acquired it, and is immutable once
+// it has been shared: |FrameRef| only hands out const access to it.
+class PooledFrame {
+ public:
+  // Prevent copying.
+  PooledFrame(PooledFrame const&) = delete;
+  PooledFrame& operator=(PooledFrame const&) = delete;
+
+  // Returns the bytes of the frame.
+  uint8_t* GetData() { return buffer_.data(); }
+  const uint8_t* GetData() const { return buffer_.data(); }
+
+  // Returns the number of bytes of the frame, as requested from the pool.
+  size_t GetSize() const { return size_; }
+
+  FrameContent content = FrameContent::kRGBA;
+  // Format of |kCaptured| frames.
+  FrameFormat captured_format;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  // Bytes from the start of one row to the next. 0 for compressed frames.
+  int32_t stride = 0;
+  // Presentation time of the captured sample.
+  uint64_t sample_time_us = 0;
+  // Whether rows were flipped horizontally.
+  bool mirrored = false;
+
+ private:
+  friend class FramePool;
+  friend class FrameRef;
+
+  PooledFrame() = default;
+
+  std::vector<uint8_t> buffer_;
+  size_t size_ = 0;
+  std::atomic<uint32_t> ref_count_ = 0;
+  // State of the pool the frame returns to. Outlives the pool while any of
+  // its frames are referenced.
+  FramePoolState* pool_state_ = nullptr;
+};
+
+// Shared reference to a |PooledFrame|.
+//
+// Copying a reference increments the reference count of the frame, and the
+// frame returns to its pool when the last reference is released. References
+// may be copied and released on any thread, and the frame may be read by all
+// holders at once.
+class FrameRef {
+ public:
+  FrameRef() = default;
+  ~FrameRef() { reset(); }
+
+  FrameRef(const FrameRef& other);
+  FrameRef& operator=(const FrameRef& other);
+  FrameRef(FrameRef&& other) noexcept : frame_(other.frame_) {
+    other.frame_ = nullptr;
+  }
+  FrameRef& operator=(FrameRef&& other) noexcept;
+
+  explicit operator bool() const { return frame_ != nullptr; }
+  const PooledFrame* get() const { return frame_; }
+  const PooledFrame* operator->() const { return frame_; }
+  const PooledFrame& operator*() const { return *frame_; }
+
+  // Returns the frame for writing. Must only be called while this is the
+  // only reference to the frame, i.e. before it has been shared.
+  PooledFrame* GetMutable();
+
+  // Returns true if this is the only reference to the frame.
+  bool IsUnique() const;
+
+  // Releases the reference.
+  void reset();
+
+ private:
+  friend class FramePool;
+
+  // Adopts a reference that was already counted.
+  explicit FrameRef(PooledFrame* frame) : frame_(frame) {}
+
+  PooledFrame* frame_ = nullptr;
+};
+
+// Pool of reusable frame buffers.
+//
+// |Acquire| hands out an unshared frame, reusing the buffer of a released
+// frame when there is one. Buffers only grow, so once every frame has been
+// used at the largest size being captured, acquiring frames no longer
+// allocates.
+//
+// In fixed-size mode, the pool creates all of its frames up front and never
+// adds more: |Acquire| fails while all of them are referenced, and the
+// caller drops the frame instead of allocating. In growing mode, a frame is
+// created whenever none is free.
+//
+// The pool may be destroyed while its frames are still referenced; their
+// memory is freed when the last reference is released. All methods may be
+// called from any thread.
+class FramePool {
+ public:
+  // Creates a pool in growing mode.
+  FramePool();
+
+  // Creates a pool in fixed-size mode, with |frame_count| frames of
+  // |frame_size| bytes allocated up front.
+  FramePool(size_t frame_count, size_t frame_size);
+
+  virtual ~FramePool();
+
+  // Prevent copying.
+  FramePool(FramePool const&) = delete;
+  FramePool& operator=(FramePool const&) = delete;
+
+  // Returns an unshared frame of |size| bytes with default metadata, or an
+  // empty reference if the pool is in fixed-size mode and all of its frames
+  // are referenced. The bytes of the frame are left as they were.
+  FrameRef Acquire(size_t size);
+
+  // Returns the number of frames that are referenced.
+  size_t GetFramesInUse() const;
+
+  // Returns the number of frames created by the pool.
+  size_t GetFrameCount() const;
+
+  // Returns the number of times a frame was created or a frame buffer grew,
+  // including the allocations made up front in fixed-size mode.
+  uint64_t GetAllocationCount() const;
+
+  // Returns the number of |Acquire| calls that failed because all frames of
+  // a fixed-size pool were referenced.
+  uint64_t GetExhaustedCount() const;
+
+ private:
+  friend class FrameRef;
+
+  // Returns |frame| to its pool once its last reference is released.
+  static void Recycle(PooledFrame* frame);
+
+  FramePoolState* state_;
+};
+
+// Copies a captured frame of |width| x |height| pixels into a |kCaptured|
+// frame acquired from |pool|.
+//
+// Rows are copied top-down without padding, so the copy can be read back
+// through |GetFrameBufferView| like the original. Compressed frames are
+// copied as a whole. Returns false if |src| does not contain a complete
+// frame, or if the pool has no free frame.
+bool CopyCapturedFrame(const FrameFormat& format, const FrameBufferView& src,
+                       uint32_t width, uint32_t height, FramePool* pool,
+                       FrameRef* frame);
+
+// Returns a view of the bytes of a |kCaptured| frame, to be read like the
+// media buffer it was copied from.
+FrameBufferView GetFrameBufferView(const PooledFrame& frame);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_POOL_H_
@@ -0,0 +1,86 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_processing_thread.h"
+
+#include <utility>
+
+namespace camera_windows {
+
+FrameProcessingThread::FrameProcessingThread(Task on_start, Task on_stop) {
+  thread_ = std::thread(
+      [this, on_start = std::move(on_start), on_stop = std::move(on_stop)]() {
+        Run(on_start, on_stop);
+      });
+}
+
+FrameProcessingThread::~FrameProcessingThread() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  entry_available_.notify_one();
+  thread_.join();
+}
+
+bool FrameProcessingThread::PostFrame(Task frame) {
+  // Destroyed outside the lock, as it may release the resources of a frame.
+  Task replaced;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    // Only the last entry can be a waiting frame: frames posted after a
+    // task must run after it.
+    if (!entries_.empty() && entries_.back().is_frame) {
+      replaced = std::move(entries_.back().task);
+      entries_.back().task = std::move(frame);
+    } else {
+      entries_.push_back({std::move(frame), true});
+    }
+  }
+  entry_available_.notify_one();
+  if (replaced) {
+    replaced_frames_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void FrameProcessingThread::PostTask(Task task) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    entries_.push_back({std::move(task), false});
+  }
+  entry_available_.notify_one();
+}
+
+void FrameProcessingThread::Run(const Task& on_start, const Task& on_stop) {
+  if (on_start) {
+    on_start();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    entry_available_.wait(lock,
+                          [this]() { return stopping_ || !entries_.empty(); });
+    if (entries_.empty()) {
+      // Only reached once the thread is stopping.
+      break;
+    }
+    Task task = std::move(entries_.front().task);
+    entries_.pop_front();
+
+    lock.unlock();
+    task();
+    // Releases whatever the task holds before taking the next one.
+    task = nullptr;
+    lock.lock();
+  }
+  lock.unlock();
+
+  if (on_stop) {
+    on_stop();
+  }
+}
+
+}  // namespace camera_windows
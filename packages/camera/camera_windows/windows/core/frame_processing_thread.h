@@ -0,0 +1,74 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_PROCESSING_THREAD_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_PROCESSING_THREAD_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace camera_windows {
+
+// Processes the frames of a camera on a thread of its own, so that the
+// thread delivering frames is never held up by their processing.
+//
+// At most one frame waits for the thread: a frame posted while another is
+// still waiting replaces it, so a thread that falls behind skips to the
+// newest frame instead of building up latency. Other tasks, such as format
+// changes, are never dropped and run in order with the frames.
+class FrameProcessingThread {
+ public:
+  using Task = std::function<void()>;
+
+  // Starts the thread. |on_start| runs on the thread before any task, and
+  // |on_stop| after the last one, for example to change the scheduling of
+  // the thread. Either may be null.
+  FrameProcessingThread(Task on_start, Task on_stop);
+
+  // Runs the tasks and the frame that are still queued, then joins the
+  // thread.
+  virtual ~FrameProcessingThread();
+
+  // Prevent copying.
+  FrameProcessingThread(FrameProcessingThread const&) = delete;
+  FrameProcessingThread& operator=(FrameProcessingThread const&) = delete;
+
+  // Queues the processing of a frame. Returns false if it replaced a frame
+  // that was still waiting.
+  bool PostFrame(Task frame);
+
+  // Queues |task| to run after the frames posted before it.
+  void PostTask(Task task);
+
+  // Returns the number of frames replaced while waiting.
+  uint64_t GetReplacedFrameCount() const {
+    return replaced_frames_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Entry {
+    Task task;
+    bool is_frame = false;
+  };
+
+  // Runs queued entries until the thread is stopping and the queue is
+  // empty.
+  void Run(const Task& on_start, const Task& on_stop);
+
+  std::mutex mutex_;
+  std::condition_variable entry_available_;
+  std::deque<Entry> entries_;
+  bool stopping_ = false;
+  std::atomic<uint64_t> replaced_frames_ = 0;
+  std::thread thread_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_PROCESSING_THREAD_H_
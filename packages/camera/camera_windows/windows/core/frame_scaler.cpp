@@ -0,0 +1,550 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_scaler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "simd_utils.h"
+
+namespace camera_windows {
+
+namespace {
+
+constexpr uint32_t kBytesPerPixel = 4;
+
+// Copies |count| bytes of |src| to 16-bit |sums|.
+inline void WidenRowTail(const uint8_t* src, uint16_t* sums, size_t begin,
+                         size_t count) {
+  for (size_t i = begin; i < count; i++) {
+    sums[i] = src[i];
+  }
+}
+
+// Adds |count| bytes of |src| to 16-bit |sums|.
+inline void AddRowTail(const uint8_t* src, uint16_t* sums, size_t begin,
+                       size_t count) {
+  for (size_t i = begin; i < count; i++) {
+    sums[i] = static_cast<uint16_t>(sums[i] + src[i]);
+  }
+}
+
+// Blends |count| bytes of |top| and |bottom| to |sums|, with weights in
+// 1/256 units that add up to 256.
+inline void BlendRowsTail(const uint8_t* top, const uint8_t* bottom,
+                          uint32_t bottom_weight, uint16_t* sums, size_t begin,
+                          size_t count) {
+  const uint32_t top_weight = 256 - bottom_weight;
+  for (size_t i = begin; i < count; i++) {
+    sums[i] =
+        static_cast<uint16_t>(top[i] * top_weight + bottom[i] * bottom_weight);
+  }
+}
+
+void WidenRowScalar(const uint8_t* src, uint16_t* sums, size_t count) {
+  WidenRowTail(src, sums, 0, count);
+}
+
+void AddRowScalar(const uint8_t* src, uint16_t* sums, size_t count) {
+  AddRowTail(src, sums, 0, count);
+}
+
+void BlendRowsScalar(const uint8_t* top, const uint8_t* bottom,
+                     uint32_t bottom_weight, uint16_t* sums, size_t count) {
+  BlendRowsTail(top, bottom, bottom_weight, sums, 0, count);
+}
+
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+
+// The SSSE3 path only needs SSE2 instructions for these kernels.
+CAMERA_WINDOWS_TARGET("ssse3")
+void WidenRowSSSE3(const uint8_t* src, uint16_t* sums, size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i),
+                     _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i + 8),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+  WidenRowTail(src, sums, i, count);
+}
+
+CAMERA_WINDOWS_TARGET("ssse3")
+void AddRowSSSE3(const uint8_t* src, uint16_t* sums, size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i* low = reinterpret_cast<__m128i*>(sums + i);
+    __m128i* high = reinterpret_cast<__m128i*>(sums + i + 8);
+    _mm_storeu_si128(low, _mm_add_epi16(_mm_loadu_si128(low),
+                                        _mm_unpacklo_epi8(bytes, zero)));
+    _mm_storeu_si128(high, _mm_add_epi16(_mm_loadu_si128(high),
+                                         _mm_unpackhi_epi8(bytes, zero)));
+  }
+  AddRowTail(src, sums, i, count);
+}
+
+CAMERA_WINDOWS_TARGET("ssse3")
+void BlendRowsSSSE3(const uint8_t* top, const uint8_t* bottom,
+                    uint32_t bottom_weight, uint16_t* sums, size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i top_weights =
+      _mm_set1_epi16(static_cast<int16_t>(256 - bottom_weight));
+  const __m128i bottom_weights =
+      _mm_set1_epi16(static_cast<int16_t>(bottom_weight));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m128i top_bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i));
+    const __m128i bottom_bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i));
+    // Products and their sums stay below 2^16, so wrapping 16-bit
+    // multiplies are exact.
+    const __m128i low = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(top_bytes, zero), top_weights),
+        _mm_mullo_epi16(_mm_unpacklo_epi8(bottom_bytes, zero),
+                        bottom_weights));
+    const __m128i high = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(top_bytes, zero), top_weights),
+        _mm_mullo_epi16(_mm_unpackhi_epi8(bottom_bytes, zero),
+                        bottom_weights));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i), low);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i + 8), high);
+  }
+  BlendRowsTail(top, bottom, bottom_weight, sums, i, count);
+}
+
+CAMERA_WINDOWS_TARGET("avx2")
+void WidenRowAVX2(const uint8_t* src, uint16_t* sums, size_t count) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(sums + i),
+        _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+  }
+  WidenRowTail(src, sums, i, count);
+}
+
+CAMERA_WINDOWS_TARGET("avx2")
+void AddRowAVX2(const uint8_t* src, uint16_t* sums, size_t count) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m256i* dst = reinterpret_cast<__m256i*>(sums + i);
+    const __m256i words = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    _mm256_storeu_si256(dst, _mm256_add_epi16(_mm256_loadu_si256(dst), words));
+  }
+  AddRowTail(src, sums, i, count);
+}
+
+CAMERA_WINDOWS_TARGET("avx2")
+void BlendRowsAVX2(const uint8_t* top, const uint8_t* bottom,
+                   uint32_t bottom_weight, uint16_t* sums, size_t count) {
+  const __m256i top_weights =
+      _mm256_set1_epi16(static_cast<int16_t>(256 - bottom_weight));
+  const __m256i bottom_weights =
+      _mm256_set1_epi16(static_cast<int16_t>(bottom_weight));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m256i top_words = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i)));
+    const __m256i bottom_words = _mm256_cvtepu8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(sums + i),
+        _mm256_add_epi16(_mm256_mullo_epi16(top_words, top_weights),
+                         _mm256_mullo_epi16(bottom_words, bottom_weights)));
+  }
+  BlendRowsTail(top, bottom, bottom_weight, sums, i, count);
+}
+
+#endif  // defined(CAMERA_WINDOWS_ARCH_X86)
+
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+
+void WidenRowNEON(const uint8_t* src, uint16_t* sums, size_t count) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const uint8x16_t bytes = vld1q_u8(src + i);
+    vst1q_u16(sums + i, vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(sums + i + 8, vmovl_high_u8(bytes));
+  }
+  WidenRowTail(src, sums, i, count);
+}
+
+void AddRowNEON(const uint8_t* src, uint16_t* sums, size_t count) {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const uint8x16_t bytes = vld1q_u8(src + i);
+    vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(bytes)));
+    vst1q_u16(sums + i + 8, vaddw_high_u8(vld1q_u16(sums + i + 8), bytes));
+  }
+  AddRowTail(src, sums, i, count);
+}
+
+void BlendRowsNEON(const uint8_t* top, const uint8_t* bottom,
+                   uint32_t bottom_weight, uint16_t* sums, size_t count) {
+  // The top weight may be 256, which does not fit the 8-bit multiplies.
+  const uint16x8_t top_weights =
+      vdupq_n_u16(static_cast<uint16_t>(256 - bottom_weight));
+  const uint16x8_t bottom_weights =
+      vdupq_n_u16(static_cast<uint16_t>(bottom_weight));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const uint8x16_t top_bytes = vld1q_u8(top + i);
+    const uint8x16_t bottom_bytes = vld1q_u8(bottom + i);
+    vst1q_u16(sums + i,
+              vmlaq_u16(vmulq_u16(vmovl_u8(vget_low_u8(top_bytes)),
+                                  top_weights),
+                        vmovl_u8(vget_low_u8(bottom_bytes)), bottom_weights));
+    vst1q_u16(sums + i + 8,
+              vmlaq_u16(vmulq_u16(vmovl_high_u8(top_bytes), top_weights),
+                        vmovl_high_u8(bottom_bytes), bottom_weights));
+  }
+  BlendRowsTail(top, bottom, bottom_weight, sums, i, count);
+}
+
+#endif  // defined(CAMERA_WINDOWS_ARCH_ARM64)
+
+using WidenRowFunction = void (*)(const uint8_t* src, uint16_t* sums,
+                                  size_t count);
+using AddRowFunction = void (*)(const uint8_t* src, uint16_t* sums,
+                                size_t count);
+using BlendRowsFunction = void (*)(const uint8_t* top, const uint8_t* bottom,
+                                   uint32_t bottom_weight, uint16_t* sums,
+                                   size_t count);
+
+// Returns the row widening kernel implementing |path|.
+WidenRowFunction GetWidenRowFunction(PixelConversionPath path) {
+  switch (path) {
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    case PixelConversionPath::kSSSE3:
+      return WidenRowSSSE3;
+    case PixelConversionPath::kAVX2:
+      return WidenRowAVX2;
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      return WidenRowNEON;
+#endif
+    case PixelConversionPath::kScalar:
+    default:
+      return WidenRowScalar;
+  }
+}
+
+// Returns the row accumulation kernel implementing |path|.
+AddRowFunction GetAddRowFunction(PixelConversionPath path) {
+  switch (path) {
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    case PixelConversionPath::kSSSE3:
+      return AddRowSSSE3;
+    case PixelConversionPath::kAVX2:
+      return AddRowAVX2;
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      return AddRowNEON;
+#endif
+    case PixelConversionPath::kScalar:
+    default:
+      return AddRowScalar;
+  }
+}
+
+// Returns the row blending kernel implementing |path|.
+BlendRowsFunction GetBlendRowsFunction(PixelConversionPath path) {
+  switch (path) {
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    case PixelConversionPath::kSSSE3:
+      return BlendRowsSSSE3;
+    case PixelConversionPath::kAVX2:
+      return BlendRowsAVX2;
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      return BlendRowsNEON;
+#endif
+    case PixelConversionPath::kScalar:
+    default:
+      return BlendRowsScalar;
+  }
+}
+
+// Writes an opaque RGBA pixel from the first three channel values of a
+// source pixel.
+inline void WritePixel(uint8_t* dst, uint32_t c0, uint32_t c1, uint32_t c2,
+                       bool swap_red_blue) {
+  dst[0] = static_cast<uint8_t>(swap_red_blue ? c2 : c0);
+  dst[1] = static_cast<uint8_t>(c1);
+  dst[2] = static_cast<uint8_t>(swap_red_blue ? c0 : c2);
+  dst[3] = 255;
+}
+
+// Returns the source position of the center of output pixel |i|, in 1/256
+// pixels, clamped to the centers of the first and last source pixels.
+uint32_t GetSourcePosition(uint32_t i, uint32_t src_size, uint32_t dst_size) {
+  const int64_t position =
+      (2 * static_cast<int64_t>(i) + 1) * src_size * 256 / (2 * dst_size) -
+      128;
+  return static_cast<uint32_t>(
+      std::clamp<int64_t>(position, 0, (src_size - 1) * int64_t{256}));
+}
+
+}  // namespace
+
+ScaleFilter GetScaleFilter(uint32_t src_width, uint32_t src_height,
+                           uint32_t dst_width, uint32_t dst_height) {
+  if (src_width >= 2 * static_cast<uint64_t>(dst_width) ||
+      src_height >= 2 * static_cast<uint64_t>(dst_height)) {
+    return ScaleFilter::kBox;
+  }
+  return ScaleFilter::kBilinear;
+}
+
+bool GetFittedFrameSize(uint32_t width, uint32_t height, uint32_t max_width,
+                        uint32_t max_height, uint32_t* fitted_width,
+                        uint32_t* fitted_height) {
+  assert(fitted_width && fitted_height);
+  if (width == 0 || height == 0) {
+    return false;
+  }
+
+  // Limited by whichever side needs the most scaling.
+  const uint64_t limit_width = max_width > 0 ? max_width : width;
+  const uint64_t limit_height = max_height > 0 ? max_height : height;
+  uint64_t new_width = width;
+  uint64_t new_height = height;
+  if (limit_width < width || limit_height < height) {
+    if (limit_width * height <= limit_height * width) {
+      new_width = limit_width;
+      new_height = std::max<uint64_t>(height * limit_width / width, 1);
+    } else {
+      new_width = std::max<uint64_t>(width * limit_height / height, 1);
+      new_height = limit_height;
+    }
+  }
+
+  *fitted_width = static_cast<uint32_t>(new_width);
+  *fitted_height = static_cast<uint32_t>(new_height);
+  return true;
+}
+
+bool GetScaledFrameSize(uint32_t width, uint32_t height, uint32_t target_width,
+                        uint32_t target_height, uint32_t* scaled_width,
+                        uint32_t* scaled_height) {
+  assert(scaled_width && scaled_height);
+  if (width == 0 || height == 0 || target_width == 0 || target_height == 0) {
+    return false;
+  }
+
+  // Matches the target size on the axis that needs the larger size, and
+  // rounds the other axis up.
+  uint64_t new_width = 0;
+  uint64_t new_height = 0;
+  if (static_cast<uint64_t>(target_width) * height >=
+      static_cast<uint64_t>(target_height) * width) {
+    new_width = target_width;
+    new_height =
+        (static_cast<uint64_t>(target_width) * height + width - 1) / width;
+  } else {
+    new_height = target_height;
+    new_width =
+        (static_cast<uint64_t>(target_height) * width + height - 1) / height;
+  }
+
+  // Close to the frame size, scaling costs more than it saves.
+  if (new_width * 4 > static_cast<uint64_t>(width) * 3) {
+    return false;
+  }
+
+  // Flutter scales the rest of the way for tiny textures.
+  const uint64_t min_width =
+      (width + kMaxScaleDenominator - 1) / kMaxScaleDenominator;
+  const uint64_t min_height =
+      (height + kMaxScaleDenominator - 1) / kMaxScaleDenominator;
+  if (new_width < min_width || new_height < min_height) {
+    new_width = min_width;
+    new_height = min_height;
+  }
+
+  *scaled_width = static_cast<uint32_t>(new_width);
+  *scaled_height = static_cast<uint32_t>(new_height);
+  return true;
+}
+
+void FrameScaler::Scale(const RowReader& read_row, SourcePixelOrder order,
+                        uint32_t src_width, uint32_t src_height, uint8_t* dst,
+                        uint32_t dst_width, uint32_t dst_height,
+                        ScaleFilter filter, bool mirror) {
+  assert(dst);
+  assert(dst_width <= src_width && dst_height <= src_height);
+  assert(dst_width * kMaxScaleDenominator >= src_width &&
+         dst_height * kMaxScaleDenominator >= src_height);
+  if (dst_width == 0 || dst_height == 0) {
+    return;
+  }
+
+  row_buffer_.resize(static_cast<size_t>(src_width) * kBytesPerPixel * 2);
+  cached_rows_[0] = CachedRow();
+  cached_rows_[1] = CachedRow();
+
+  const bool swap_red_blue = order == SourcePixelOrder::kBGRA;
+  if (filter == ScaleFilter::kBox) {
+    ScaleBox(read_row, swap_red_blue, src_width, src_height, dst, dst_width,
+             dst_height, mirror);
+  } else {
+    ScaleBilinear(read_row, swap_red_blue, src_width, src_height, dst,
+                  dst_width, dst_height, mirror);
+  }
+}
+
+void FrameScaler::ScaleBox(const RowReader& read_row, bool swap_red_blue,
+                           uint32_t src_width, uint32_t src_height,
+                           uint8_t* dst, uint32_t dst_width,
+                           uint32_t dst_height, bool mirror) {
+  const size_t row_size = static_cast<size_t>(src_width) * kBytesPerPixel;
+  row_sums_.resize(row_size);
+
+  column_starts_.resize(dst_width + 1);
+  for (uint32_t x = 0; x <= dst_width; x++) {
+    column_starts_[x] =
+        static_cast<uint32_t>(static_cast<uint64_t>(x) * src_width / dst_width);
+  }
+
+  const WidenRowFunction widen_row = GetWidenRowFunction(path_);
+  const AddRowFunction add_row = GetAddRowFunction(path_);
+
+  const uint32_t max_box_width = (src_width + dst_width - 1) / dst_width;
+  reciprocals_.resize(max_box_width + 1);
+  uint32_t reciprocals_box_height = 0;
+
+  for (uint32_t y = 0; y < dst_height; y++) {
+    const uint32_t first_row =
+        static_cast<uint32_t>(static_cast<uint64_t>(y) * src_height /
+                              dst_height);
+    const uint32_t end_row = static_cast<uint32_t>(
+        static_cast<uint64_t>(y + 1) * src_height / dst_height);
+    const uint32_t box_height = end_row - first_row;
+
+    // Sums the rows of the box channel by channel, so that each source row
+    // is read once. Boxes are at most |kMaxScaleDenominator| pixels on each
+    // side, so sums fit in 16 bits.
+    uint16_t* sums = row_sums_.data();
+    widen_row(read_row(first_row, row_buffer_.data()), sums, row_size);
+    for (uint32_t src_y = first_row + 1; src_y < end_row; src_y++) {
+      add_row(read_row(src_y, row_buffer_.data()), sums, row_size);
+    }
+
+    // Box heights only take two values, so the reciprocals rarely change.
+    if (box_height != reciprocals_box_height) {
+      for (uint32_t box_width = 1; box_width <= max_box_width; box_width++) {
+        const uint32_t area = box_width * box_height;
+        reciprocals_[box_width] = ((1u << 24) + area / 2) / area;
+      }
+      reciprocals_box_height = box_height;
+    }
+
+    uint8_t* dst_row = dst + static_cast<size_t>(y) * dst_width * 4;
+    for (uint32_t x = 0; x < dst_width; x++) {
+      const uint32_t first_column = column_starts_[x];
+      const uint32_t end_column = column_starts_[x + 1];
+
+      // Adds the four channels of each column at once, as 16-bit lanes of a
+      // little-endian 64-bit value.
+      uint64_t lanes = 0;
+      for (uint32_t src_x = first_column; src_x < end_column; src_x++) {
+        uint64_t column;
+        std::memcpy(&column, sums + src_x * kBytesPerPixel, sizeof(column));
+        lanes += column;
+      }
+
+      // Divides by the box area, rounding to nearest.
+      const uint32_t reciprocal = reciprocals_[end_column - first_column];
+      const uint32_t half = 1u << 23;
+      const uint32_t sum0 = static_cast<uint32_t>(lanes & 0xFFFF);
+      const uint32_t sum1 = static_cast<uint32_t>((lanes >> 16) & 0xFFFF);
+      const uint32_t sum2 = static_cast<uint32_t>((lanes >> 32) & 0xFFFF);
+      const uint32_t dst_x = mirror ? dst_width - 1 - x : x;
+      WritePixel(dst_row + dst_x * 4, (sum0 * reciprocal + half) >> 24,
+                 (sum1 * reciprocal + half) >> 24,
+                 (sum2 * reciprocal + half) >> 24, swap_red_blue);
+    }
+  }
+}
+
+void FrameScaler::ScaleBilinear(const RowReader& read_row, bool swap_red_blue,
+                                uint32_t src_width, uint32_t src_height,
+                                uint8_t* dst, uint32_t dst_width,
+                                uint32_t dst_height, bool mirror) {
+  const size_t row_size = static_cast<size_t>(src_width) * kBytesPerPixel;
+  // One more pixel repeats the last one, so that the last column can be
+  // interpolated like the others.
+  row_sums_.resize(row_size + kBytesPerPixel);
+
+  column_offsets_.resize(dst_width);
+  column_weights_.resize(dst_width);
+  for (uint32_t x = 0; x < dst_width; x++) {
+    const uint32_t position = GetSourcePosition(x, src_width, dst_width);
+    column_offsets_[x] = (position >> 8) * kBytesPerPixel;
+    column_weights_[x] = position & 0xFF;
+  }
+
+  const BlendRowsFunction blend_rows = GetBlendRowsFunction(path_);
+  for (uint32_t y = 0; y < dst_height; y++) {
+    const uint32_t position = GetSourcePosition(y, src_height, dst_height);
+    const uint32_t top_y = position >> 8;
+    const uint32_t bottom_y = std::min(top_y + 1, src_height - 1);
+    const uint32_t bottom_weight = position & 0xFF;
+
+    // Blends the two source rows, keeping 8 bits of fraction.
+    const uint8_t* top = GetCachedRow(read_row, top_y, bottom_y);
+    const uint8_t* bottom =
+        bottom_weight == 0 ? top : GetCachedRow(read_row, bottom_y, top_y);
+    blend_rows(top, bottom, bottom_weight, row_sums_.data(), row_size);
+    std::copy(row_sums_.begin() + row_size - kBytesPerPixel,
+              row_sums_.begin() + row_size, row_sums_.begin() + row_size);
+
+    uint8_t* dst_row = dst + static_cast<size_t>(y) * dst_width * 4;
+    for (uint32_t x = 0; x < dst_width; x++) {
+      const uint16_t* left = row_sums_.data() + column_offsets_[x];
+      const uint16_t* right = left + kBytesPerPixel;
+      const uint32_t right_weight = column_weights_[x];
+      const uint32_t left_weight = 256 - right_weight;
+      const uint32_t half = 1 << 15;
+      const uint32_t dst_x = mirror ? dst_width - 1 - x : x;
+      WritePixel(
+          dst_row + dst_x * 4,
+          (left[0] * left_weight + right[0] * right_weight + half) >> 16,
+          (left[1] * left_weight + right[1] * right_weight + half) >> 16,
+          (left[2] * left_weight + right[2] * right_weight + half) >> 16,
+          swap_red_blue);
+    }
+  }
+}
+
+const uint8_t* FrameScaler::GetCachedRow(const RowReader& read_row,
+                                         uint32_t y, int64_t keep_y) {
+  for (const CachedRow& row : cached_rows_) {
+    if (row.y == y) {
+      return row.data;
+    }
+  }
+
+  const size_t slot = cached_rows_[0].y == keep_y ? 1 : 0;
+  uint8_t* buffer = row_buffer_.data() + slot * (row_buffer_.size() / 2);
+  cached_rows_[slot].y = y;
+  cached_rows_[slot].data = read_row(y, buffer);
+  return cached_rows_[slot].data;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,143 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_SCALER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_SCALER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "pixel_conversion.h"
+
+namespace camera_windows {
+
+// Filters for scaling frames down.
+enum class ScaleFilter {
+  // Interpolates between the two nearest source pixels on each axis.
+  kBilinear,
+  // Averages all source pixels covered by each output pixel.
+  kBox,
+};
+
+// Channel order of the 4-byte pixels of source rows. The fourth channel is
+// ignored; output pixels are always opaque.
+enum class SourcePixelOrder {
+  kRGBA,
+  kBGRA,
+};
+
+// Smallest scale factor, on each axis, supported by |FrameScaler|.
+constexpr uint32_t kMaxScaleDenominator = 8;
+
+// Returns the filter for scaling |src_width| x |src_height| pixels down to
+// |dst_width| x |dst_height| pixels.
+//
+// Bilinear filtering skips source pixels below half size, so the box filter
+// is used from there on.
+ScaleFilter GetScaleFilter(uint32_t src_width, uint32_t src_height,
+                           uint32_t dst_width, uint32_t dst_height);
+
+// Picks the size to which frames of |width| x |height| pixels are scaled
+// down before being shown in a texture of |target_width| x |target_height|
+// pixels.
+//
+// The scaled size keeps the aspect ratio of the frame and covers the target
+// size, down to 1 / |kMaxScaleDenominator| of the frame size. Returns false
+// if the frame should not be scaled, because the target size is unknown or
+// not much smaller than the frame.
+bool GetScaledFrameSize(uint32_t width, uint32_t height, uint32_t target_width,
+                        uint32_t target_height, uint32_t* scaled_width,
+                        uint32_t* scaled_height);
+
+// Gets the size of a frame of |width| x |height| pixels scaled down to fit
+// inside |max_width| x |max_height| pixels, keeping its aspect ratio.
+//
+// Frames are never scaled up, and a maximum of 0 means no limit on that
+// axis. Returns false if the frame is empty.
+bool GetFittedFrameSize(uint32_t width, uint32_t height, uint32_t max_width,
+                        uint32_t max_height, uint32_t* fitted_width,
+                        uint32_t* fitted_height);
+
+// Scales frames of 4-byte pixels down to packed RGBA.
+//
+// Source rows are read one at a time, so frames in other formats can be
+// converted row by row into a small cache instead of into a full-size
+// intermediate frame. Channel order and mirroring are handled while writing
+// the output. Buffers are kept between frames to reuse their allocations.
+class FrameScaler {
+ public:
+  // Returns row |y| of the source frame. A row that needs converting is
+  // written to |buffer|, which has room for one row, and the returned
+  // pointer may point into it.
+  using RowReader = std::function<const uint8_t*(uint32_t y, uint8_t* buffer)>;
+
+  FrameScaler() : FrameScaler(GetPreferredPixelConversionPath()) {}
+
+  // Creates a scaler with the row kernels of |path|, which must be
+  // supported by the current CPU. Used by tests and benchmarks to compare
+  // paths.
+  explicit FrameScaler(PixelConversionPath path) : path_(path) {}
+
+  virtual ~FrameScaler() = default;
+
+  // Prevent copying.
+  FrameScaler(FrameScaler const&) = delete;
+  FrameScaler& operator=(FrameScaler const&) = delete;
+
+  // Scales |src_width| x |src_height| pixels read with |read_row| to
+  // |dst_width| x |dst_height| packed RGBA pixels in |dst|. The output size
+  // must not exceed the source size, nor be smaller than
+  // 1 / |kMaxScaleDenominator| of it. If |mirror| is true, each row is
+  // flipped horizontally.
+  void Scale(const RowReader& read_row, SourcePixelOrder order,
+             uint32_t src_width, uint32_t src_height, uint8_t* dst,
+             uint32_t dst_width, uint32_t dst_height, ScaleFilter filter,
+             bool mirror);
+
+ private:
+  // A source row read into one of the two row buffers.
+  struct CachedRow {
+    int64_t y = -1;
+    const uint8_t* data = nullptr;
+  };
+
+  void ScaleBox(const RowReader& read_row, bool swap_red_blue,
+                uint32_t src_width, uint32_t src_height, uint8_t* dst,
+                uint32_t dst_width, uint32_t dst_height, bool mirror);
+
+  void ScaleBilinear(const RowReader& read_row, bool swap_red_blue,
+                     uint32_t src_width, uint32_t src_height, uint8_t* dst,
+                     uint32_t dst_width, uint32_t dst_height, bool mirror);
+
+  // Returns row |y|, reading it unless it is cached. Keeps the cached row
+  // |keep_y| if it is needed at the same time.
+  const uint8_t* GetCachedRow(const RowReader& read_row, uint32_t y,
+                              int64_t keep_y);
+
+  PixelConversionPath path_;
+
+  // Two rows of source pixels, for sources that need converting.
+  std::vector<uint8_t> row_buffer_;
+  CachedRow cached_rows_[2];
+
+  // Per-channel sums of the source rows of a box, or vertically blended
+  // source rows, with one value per source byte.
+  std::vector<uint16_t> row_sums_;
+
+  // First source column of each output column, and one past the last.
+  std::vector<uint32_t> column_starts_;
+
+  // Bilinear source column and weight of the next column, in 1/256 units,
+  // of each output column.
+  std::vector<uint32_t> column_offsets_;
+  std::vector<uint32_t> column_weights_;
+
+  // Reciprocals of box areas, in 2^-24 units, by box width.
+  std::vector<uint32_t> reciprocals_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_FRAME_SCALER_H_
@@ -0,0 +1,457 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "image_stream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "pixel_conversion.h"
+#include "yuv_conversion.h"
+
+namespace camera_windows {
+
+namespace {
+
+constexpr uint32_t kBytesPerPixel = 4;
+
+// Writes |value| to |dst| in little-endian byte order.
+void WriteUint32(uint32_t value, uint8_t* dst) {
+  dst[0] = static_cast<uint8_t>(value);
+  dst[1] = static_cast<uint8_t>(value >> 8);
+  dst[2] = static_cast<uint8_t>(value >> 16);
+  dst[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// Returns the BT.601 luma of a pixel, for frames that are not YUV.
+inline uint8_t GetLuma(uint8_t r, uint8_t g, uint8_t b) {
+  return static_cast<uint8_t>((77 * r + 150 * g + 29 * b + 128) >> 8);
+}
+
+// Returns the number of |denominator|ths of |value|, rounded up.
+uint32_t DivideRoundingUp(uint32_t value, uint32_t denominator) {
+  return (value + denominator - 1) / denominator;
+}
+
+}  // namespace
+
+bool IsImageStreamFormatSupported(PixelFormat pixel_format,
+                                  ImageStreamFormat format) {
+  switch (format) {
+    case ImageStreamFormat::kRGBA:
+    case ImageStreamFormat::kBGRA:
+    case ImageStreamFormat::kLuma:
+      return true;
+    case ImageStreamFormat::kNV12:
+      return pixel_format == PixelFormat::kNV12 ||
+             pixel_format == PixelFormat::kYUY2;
+  }
+  return false;
+}
+
+bool GetImageStreamFrameSize(const ImageStreamOptions& options, uint32_t width,
+                             uint32_t height, uint32_t* stream_width,
+                             uint32_t* stream_height) {
+  assert(stream_width && stream_height);
+  if (width == 0 || height == 0) {
+    return false;
+  }
+
+  uint32_t fitted_width = 0;
+  uint32_t fitted_height = 0;
+  GetFittedFrameSize(width, height, options.max_width, options.max_height,
+                     &fitted_width, &fitted_height);
+  uint64_t scaled_width = fitted_width;
+  uint64_t scaled_height = fitted_height;
+
+  switch (options.format) {
+    case ImageStreamFormat::kRGBA:
+    case ImageStreamFormat::kBGRA:
+      // The frame scaler reduces each side by at most |kMaxScaleDenominator|.
+      scaled_width = std::max<uint64_t>(
+          scaled_width, DivideRoundingUp(width, kMaxScaleDenominator));
+      scaled_height = std::max<uint64_t>(
+          scaled_height, DivideRoundingUp(height, kMaxScaleDenominator));
+      break;
+    case ImageStreamFormat::kNV12:
+      // Chroma samples cover 2 x 2 pixels, so both sides must be even.
+      if (width < 2 || height < 2) {
+        return false;
+      }
+      scaled_width = std::max<uint64_t>(scaled_width & ~uint64_t{1}, 2);
+      scaled_height = std::max<uint64_t>(scaled_height & ~uint64_t{1}, 2);
+      break;
+    case ImageStreamFormat::kLuma:
+      break;
+  }
+
+  *stream_width = static_cast<uint32_t>(std::max<uint64_t>(scaled_width, 1));
+  *stream_height = static_cast<uint32_t>(std::max<uint64_t>(scaled_height, 1));
+  return true;
+}
+
+ImageStreamFrameLayout GetImageStreamFrameLayout(ImageStreamFormat format,
+                                                 uint32_t width,
+                                                 uint32_t height) {
+  ImageStreamFrameLayout layout;
+  layout.format = format;
+  layout.width = width;
+  layout.height = height;
+
+  ImageStreamPlane& first = layout.planes[0];
+  first.width = width;
+  first.height = height;
+  switch (format) {
+    case ImageStreamFormat::kRGBA:
+    case ImageStreamFormat::kBGRA:
+      layout.plane_count = 1;
+      first.bytes_per_pixel = kBytesPerPixel;
+      first.bytes_per_row = width * kBytesPerPixel;
+      break;
+    case ImageStreamFormat::kNV12: {
+      layout.plane_count = 2;
+      first.bytes_per_pixel = 1;
+      first.bytes_per_row = width;
+      ImageStreamPlane& chroma = layout.planes[1];
+      chroma.offset = static_cast<uint32_t>(first.GetSize());
+      chroma.bytes_per_pixel = 2;
+      chroma.width = width / 2;
+      chroma.height = height / 2;
+      chroma.bytes_per_row = chroma.width * 2;
+      break;
+    }
+    case ImageStreamFormat::kLuma:
+      layout.plane_count = 1;
+      first.bytes_per_pixel = 1;
+      first.bytes_per_row = width;
+      break;
+  }
+
+  for (uint32_t i = 0; i < layout.plane_count; i++) {
+    layout.size += layout.planes[i].GetSize();
+  }
+  return layout;
+}
+
+void WriteImageStreamHeader(const ImageStreamFrameLayout& layout,
+                            uint64_t sample_time_us, uint8_t* dst) {
+  assert(dst);
+  uint32_t fields[kImageStreamHeaderSize / 4] = {};
+  fields[0] = static_cast<uint32_t>(layout.format);
+  fields[1] = layout.width;
+  fields[2] = layout.height;
+  fields[3] = layout.plane_count;
+  fields[4] = static_cast<uint32_t>(sample_time_us);
+  fields[5] = static_cast<uint32_t>(sample_time_us >> 32);
+  for (uint32_t i = 0; i < layout.plane_count; i++) {
+    const ImageStreamPlane& plane = layout.planes[i];
+    uint32_t* plane_fields = fields + 6 + i * 5;
+    plane_fields[0] =
+        static_cast<uint32_t>(kImageStreamHeaderSize) + plane.offset;
+    plane_fields[1] = plane.bytes_per_row;
+    plane_fields[2] = plane.bytes_per_pixel;
+    plane_fields[3] = plane.width;
+    plane_fields[4] = plane.height;
+  }
+
+  for (size_t i = 0; i < kImageStreamHeaderSize / 4; i++) {
+    WriteUint32(fields[i], dst + i * 4);
+  }
+}
+
+bool ImageStreamConverter::Convert(const FrameFormat& format,
+                                   const FrameBufferView& src, uint32_t width,
+                                   uint32_t height,
+                                   const ImageStreamFrameLayout& layout,
+                                   uint8_t* dst) {
+  assert(dst);
+  FramePlanes planes;
+  if (!IsImageStreamFormatSupported(format.pixel_format, layout.format) ||
+      !GetFramePlanes(format, src, width, height, &planes)) {
+    return false;
+  }
+  const ptrdiff_t stride = planes.stride;
+
+  switch (layout.format) {
+    case ImageStreamFormat::kRGBA:
+    case ImageStreamFormat::kBGRA: {
+      if (layout.width != width || layout.height != height) {
+        return layout.format == ImageStreamFormat::kRGBA
+                   ? ScaleFrameToRGBA(format, src, width, height, dst,
+                                      layout.width, layout.height, false,
+                                      &scaler_)
+                   : ScaleFrameToBGRA(format, src, width, height, dst,
+                                      layout.width, layout.height, false,
+                                      &scaler_);
+      }
+      if (layout.format == ImageStreamFormat::kRGBA) {
+        return ConvertFrameToRGBA(format, src, dst, width, height, false);
+      }
+
+      // BGRA rows are converted to RGBA one at a time, and swapped back
+      // while they are still in the cache.
+      const YuvColorSpace& color_space = format.color_space;
+      const PixelFormat pixel_format = format.pixel_format;
+      WritePixels(
+          [&planes, &color_space, pixel_format, stride, width](
+              uint32_t y, uint8_t* buffer) {
+            switch (pixel_format) {
+              case PixelFormat::kRGB32:
+                ConvertRGB32ToRGBA(planes.rows + stride * y, planes.stride,
+                                   buffer, width, 1, false);
+                break;
+              case PixelFormat::kNV12:
+                ConvertNV12ToRGBA(planes.rows + stride * y, planes.stride,
+                                  planes.chroma_rows + stride * (y / 2),
+                                  planes.stride, buffer, width, 1, color_space,
+                                  false);
+                break;
+              case PixelFormat::kYUY2:
+                ConvertYUY2ToRGBA(planes.rows + stride * y, planes.stride,
+                                  buffer, width, 1, color_space, false);
+                break;
+              case PixelFormat::kMJPG:
+                break;
+            }
+            return static_cast<const uint8_t*>(buffer);
+          },
+          width, height, layout, dst);
+      return true;
+    }
+    case ImageStreamFormat::kNV12:
+    case ImageStreamFormat::kLuma: {
+      // Luma samples of YUV frames are passed through unchanged.
+      FrameScaler::RowReader read_luma;
+      switch (format.pixel_format) {
+        case PixelFormat::kRGB32:
+          read_luma = [&planes, stride, width](uint32_t y, uint8_t* buffer) {
+            const uint8_t* row = planes.rows + stride * y;
+            for (uint32_t x = 0; x < width; x++) {
+              const uint8_t* pixel = row + x * kBytesPerPixel;
+              buffer[x] = GetLuma(pixel[2], pixel[1], pixel[0]);
+            }
+            return static_cast<const uint8_t*>(buffer);
+          };
+          break;
+        case PixelFormat::kNV12:
+          read_luma = [&planes, stride](uint32_t y, uint8_t*) {
+            return planes.rows + stride * y;
+          };
+          break;
+        case PixelFormat::kYUY2:
+          read_luma = [&planes, stride, width](uint32_t y, uint8_t* buffer) {
+            const uint8_t* row = planes.rows + stride * y;
+            for (uint32_t x = 0; x < width; x++) {
+              buffer[x] = row[x * 2];
+            }
+            return static_cast<const uint8_t*>(buffer);
+          };
+          break;
+        case PixelFormat::kMJPG:
+          return false;
+      }
+      WritePlane(read_luma, 1, width, height, layout.planes[0], dst);
+      if (layout.format == ImageStreamFormat::kLuma) {
+        return true;
+      }
+
+      // Chroma rows hold one U and V pair per two pixels of two rows.
+      const uint32_t chroma_width = (width + 1) / 2;
+      const uint32_t chroma_height = (height + 1) / 2;
+      FrameScaler::RowReader read_chroma;
+      if (format.pixel_format == PixelFormat::kNV12) {
+        read_chroma = [&planes, stride](uint32_t y, uint8_t*) {
+          return planes.chroma_rows + stride * y;
+        };
+      } else {
+        // YUY2 chroma is only subsampled horizontally, so each chroma row
+        // averages two rows of the frame.
+        read_chroma = [&planes, stride, height, chroma_width](
+                          uint32_t y, uint8_t* buffer) {
+          const uint8_t* top = planes.rows + stride * (y * 2);
+          const uint8_t* bottom =
+              planes.rows + stride * std::min(y * 2 + 1, height - 1);
+          for (uint32_t x = 0; x < chroma_width; x++) {
+            buffer[x * 2] = static_cast<uint8_t>(
+                (top[x * 4 + 1] + bottom[x * 4 + 1] + 1) / 2);
+            buffer[x * 2 + 1] = static_cast<uint8_t>(
+                (top[x * 4 + 3] + bottom[x * 4 + 3] + 1) / 2);
+          }
+          return static_cast<const uint8_t*>(buffer);
+        };
+      }
+      WritePlane(read_chroma, 2, chroma_width, chroma_height, layout.planes[1],
+                 dst + layout.planes[1].offset);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ImageStreamConverter::ConvertRGBA(const uint8_t* src, uint32_t width,
+                                       uint32_t height,
+                                       const ImageStreamFrameLayout& layout,
+                                       uint8_t* dst) {
+  assert(src && dst);
+  const size_t row_size = static_cast<size_t>(width) * kBytesPerPixel;
+  switch (layout.format) {
+    case ImageStreamFormat::kRGBA:
+    case ImageStreamFormat::kBGRA:
+      if (layout.width != width || layout.height != height) {
+        if (layout.width > width || layout.height > height ||
+            layout.width * kMaxScaleDenominator < width ||
+            layout.height * kMaxScaleDenominator < height) {
+          return false;
+        }
+        scaler_.Scale(
+            [src, row_size](uint32_t y, uint8_t*) { return src + row_size * y; },
+            layout.format == ImageStreamFormat::kRGBA ? SourcePixelOrder::kRGBA
+                                                      : SourcePixelOrder::kBGRA,
+            width, height, dst, layout.width, layout.height,
+            GetScaleFilter(width, height, layout.width, layout.height), false);
+        return true;
+      }
+      if (layout.format == ImageStreamFormat::kRGBA) {
+        memcpy(dst, src, row_size * height);
+      } else {
+        // Swapping red and blue is the same operation in both directions.
+        ConvertRGB32ToRGBA(src, static_cast<int32_t>(row_size), dst, width,
+                           height, false);
+      }
+      return true;
+    case ImageStreamFormat::kLuma:
+      if (layout.width > width || layout.height > height) {
+        return false;
+      }
+      WritePlane(
+          [src, row_size, width](uint32_t y, uint8_t* buffer) {
+            const uint8_t* row = src + row_size * y;
+            for (uint32_t x = 0; x < width; x++) {
+              const uint8_t* pixel = row + x * kBytesPerPixel;
+              buffer[x] = GetLuma(pixel[0], pixel[1], pixel[2]);
+            }
+            return static_cast<const uint8_t*>(buffer);
+          },
+          1, width, height, layout.planes[0], dst);
+      return true;
+    case ImageStreamFormat::kNV12:
+      return false;
+  }
+  return false;
+}
+
+void ImageStreamConverter::WritePixels(const FrameScaler::RowReader& read_row,
+                                       uint32_t width, uint32_t height,
+                                       const ImageStreamFrameLayout& layout,
+                                       uint8_t* dst) {
+  const size_t row_size = static_cast<size_t>(width) * kBytesPerPixel;
+  row_buffer_.resize(row_size);
+  for (uint32_t y = 0; y < height; y++) {
+    const uint8_t* row = read_row(y, row_buffer_.data());
+    ConvertRGB32ToRGBA(row, static_cast<int32_t>(row_size),
+                       dst + layout.planes[0].bytes_per_row * y, width, 1,
+                       false);
+  }
+}
+
+void ImageStreamConverter::WritePlane(const FrameScaler::RowReader& read_row,
+                                      uint32_t channels, uint32_t src_width,
+                                      uint32_t src_height,
+                                      const ImageStreamPlane& plane,
+                                      uint8_t* dst) {
+  assert(plane.width <= src_width && plane.height <= src_height);
+  const size_t src_row_size = static_cast<size_t>(src_width) * channels;
+  row_buffer_.resize(src_row_size);
+
+  if (plane.width == src_width && plane.height == src_height) {
+    for (uint32_t y = 0; y < src_height; y++) {
+      memcpy(dst + static_cast<size_t>(plane.bytes_per_row) * y,
+             read_row(y, row_buffer_.data()), src_row_size);
+    }
+    return;
+  }
+
+  // Each output sample averages the box of source samples it covers. Boxes
+  // differ by at most one sample in size, so the result is close to an area
+  // average without fractional weights.
+  row_sums_.resize(src_row_size);
+  for (uint32_t dst_y = 0; dst_y < plane.height; dst_y++) {
+    const uint32_t y_begin = static_cast<uint32_t>(
+        static_cast<uint64_t>(dst_y) * src_height / plane.height);
+    const uint32_t y_end = static_cast<uint32_t>(
+        static_cast<uint64_t>(dst_y + 1) * src_height / plane.height);
+    std::fill(row_sums_.begin(), row_sums_.end(), 0);
+    for (uint32_t y = y_begin; y < y_end; y++) {
+      const uint8_t* row = read_row(y, row_buffer_.data());
+      for (size_t i = 0; i < src_row_size; i++) {
+        row_sums_[i] += row[i];
+      }
+    }
+
+    uint8_t* dst_row = dst + static_cast<size_t>(plane.bytes_per_row) * dst_y;
+    for (uint32_t dst_x = 0; dst_x < plane.width; dst_x++) {
+      const uint32_t x_begin = static_cast<uint32_t>(
+          static_cast<uint64_t>(dst_x) * src_width / plane.width);
+      const uint32_t x_end = static_cast<uint32_t>(
+          static_cast<uint64_t>(dst_x + 1) * src_width / plane.width);
+      const uint64_t area =
+          static_cast<uint64_t>(x_end - x_begin) * (y_end - y_begin);
+      for (uint32_t c = 0; c < channels; c++) {
+        uint64_t sum = 0;
+        for (uint32_t x = x_begin; x < x_end; x++) {
+          sum += row_sums_[x * channels + c];
+        }
+        dst_row[dst_x * channels + c] =
+            static_cast<uint8_t>((sum + area / 2) / area);
+      }
+    }
+  }
+}
+
+ImageStreamGate::ImageStreamGate(const ImageStreamOptions& options)
+    : credits_(std::max<uint32_t>(options.max_pending_frames, 1)) {
+  if (options.max_frame_rate > 0) {
+    frame_interval_us_ =
+        static_cast<uint64_t>(std::llround(1000000.0 / options.max_frame_rate));
+  }
+}
+
+bool ImageStreamGate::TryAcquire(uint64_t sample_time_us) {
+  const int64_t time_us = static_cast<int64_t>(sample_time_us);
+  const int64_t interval_us = static_cast<int64_t>(frame_interval_us_);
+
+  // Frames a little early are still sent, so that a camera running at the
+  // maximum frame rate is not halved by jitter in its timestamps.
+  if (next_frame_time_us_ >= 0 &&
+      time_us + interval_us / 4 < next_frame_time_us_) {
+    throttled_frames_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Only this thread takes credits, so the credit cannot be taken between
+  // the check and the decrement.
+  if (credits_.load(std::memory_order_acquire) == 0) {
+    dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  credits_.fetch_sub(1, std::memory_order_acq_rel);
+
+  // After a gap, such as while waiting for credits, the schedule restarts
+  // from this frame instead of sending a burst to catch up.
+  if (next_frame_time_us_ < 0 ||
+      time_us >= next_frame_time_us_ + interval_us) {
+    next_frame_time_us_ = time_us + interval_us;
+  } else {
+    next_frame_time_us_ += interval_us;
+  }
+  return true;
+}
+
+void ImageStreamGate::Release() {
+  credits_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+}  // namespace camera_windows
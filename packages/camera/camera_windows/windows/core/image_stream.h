@@ -0,0 +1,216 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_IMAGE_STREAM_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_IMAGE_STREAM_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "frame_buffer_view.h"
+#include "frame_conversion.h"
+#include "frame_scaler.h"
+
+namespace camera_windows {
+
+// Pixel formats of image stream frames.
+enum class ImageStreamFormat {
+  // Packed RGBA pixels.
+  kRGBA = 0,
+  // Packed BGRA pixels.
+  kBGRA = 1,
+  // A luma plane followed by an interleaved chroma plane at half the
+  // resolution. Width and height are always even.
+  kNV12 = 2,
+  // The luma plane of the frame only.
+  kLuma = 3,
+};
+
+// Options of an image stream.
+struct ImageStreamOptions {
+  ImageStreamFormat format = ImageStreamFormat::kRGBA;
+
+  // Largest frame size to send. Frames are scaled down to fit, keeping their
+  // aspect ratio, and are never scaled up. 0 means no limit.
+  uint32_t max_width = 0;
+  uint32_t max_height = 0;
+
+  // Highest number of frames to send per second, or 0 to send every frame.
+  double max_frame_rate = 0;
+
+  // Number of frames that may be on their way to Dart at the same time.
+  uint32_t max_pending_frames = 1;
+};
+
+// Returns true if frames of |pixel_format| can be sent in |format|.
+//
+// MJPEG frames are decoded to RGBA first, so they can be sent as RGBA, BGRA
+// or luma. NV12 frames need YUV frames.
+bool IsImageStreamFormatSupported(PixelFormat pixel_format,
+                                  ImageStreamFormat format);
+
+// Gets the size of the image stream frames sent for camera frames of
+// |width| x |height| pixels.
+//
+// Returns false if the camera frame is empty.
+bool GetImageStreamFrameSize(const ImageStreamOptions& options, uint32_t width,
+                             uint32_t height, uint32_t* stream_width,
+                             uint32_t* stream_height);
+
+// Layout of one plane of an image stream frame.
+struct ImageStreamPlane {
+  // Byte offset of the plane from the start of the pixel data.
+  uint32_t offset = 0;
+  uint32_t bytes_per_row = 0;
+  uint32_t bytes_per_pixel = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  // Returns the size of the plane in bytes.
+  size_t GetSize() const { return static_cast<size_t>(bytes_per_row) * height; }
+};
+
+// Layout of the pixel data of an image stream frame. Planes are packed
+// without padding, one after the other.
+struct ImageStreamFrameLayout {
+  ImageStreamFormat format = ImageStreamFormat::kRGBA;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t plane_count = 0;
+  ImageStreamPlane planes[2];
+  // Size of the pixel data of all planes in bytes.
+  size_t size = 0;
+};
+
+// Returns the layout of frames of |width| x |height| pixels in |format|.
+ImageStreamFrameLayout GetImageStreamFrameLayout(ImageStreamFormat format,
+                                                 uint32_t width,
+                                                 uint32_t height);
+
+// Size of the header in front of the pixel data of image stream messages.
+//
+// The header is made of little-endian 32-bit fields: format, width, height,
+// plane count, the presentation time in microseconds as two fields (low
+// bits first), and for each of two planes its offset from the start of the
+// message, bytes per row, bytes per pixel, width and height. Unused plane
+// fields are 0.
+constexpr size_t kImageStreamHeaderSize = 64;
+
+// Writes the header of a message carrying a frame of |layout|, presented at
+// |sample_time_us|, to the first |kImageStreamHeaderSize| bytes of |dst|.
+void WriteImageStreamHeader(const ImageStreamFrameLayout& layout,
+                            uint64_t sample_time_us, uint8_t* dst);
+
+// Converts camera frames to image stream frames.
+//
+// Frames are converted straight into the caller's buffer, so that the
+// pixels are written once on their way to the message sent to Dart. The
+// converter keeps scratch buffers between frames, and is only used by the
+// capture thread.
+class ImageStreamConverter {
+ public:
+  ImageStreamConverter() {}
+  virtual ~ImageStreamConverter() = default;
+
+  // Prevent copying.
+  ImageStreamConverter(ImageStreamConverter const&) = delete;
+  ImageStreamConverter& operator=(ImageStreamConverter const&) = delete;
+
+  // Converts a camera frame of |width| x |height| pixels to a frame of
+  // |layout|, written to |dst|.
+  //
+  // Returns false without writing to |dst| if |src| does not contain a
+  // complete frame, or if the format of |layout| is not supported for
+  // |format|.
+  bool Convert(const FrameFormat& format, const FrameBufferView& src,
+               uint32_t width, uint32_t height,
+               const ImageStreamFrameLayout& layout, uint8_t* dst);
+
+  // Converts packed RGBA pixels, such as decoded MJPEG frames, to a frame of
+  // |layout|, written to |dst|.
+  //
+  // Returns false without writing to |dst| if the format of |layout| is
+  // NV12.
+  bool ConvertRGBA(const uint8_t* src, uint32_t width, uint32_t height,
+                   const ImageStreamFrameLayout& layout, uint8_t* dst);
+
+ private:
+  // Writes packed 32-bit pixels read as RGBA rows with |read_row| to the
+  // plane of a frame of |layout|, swapping red and blue for BGRA frames.
+  void WritePixels(const FrameScaler::RowReader& read_row, uint32_t width,
+                   uint32_t height, const ImageStreamFrameLayout& layout,
+                   uint8_t* dst);
+
+  // Writes |src_width| x |src_height| samples of |channels| bytes, read with
+  // |read_row|, to |plane|, averaging boxes of source samples when scaling
+  // down.
+  void WritePlane(const FrameScaler::RowReader& read_row, uint32_t channels,
+                  uint32_t src_width, uint32_t src_height,
+                  const ImageStreamPlane& plane, uint8_t* dst);
+
+  FrameScaler scaler_;
+
+  // One row of converted source samples.
+  std::vector<uint8_t> row_buffer_;
+
+  // Sums of the source rows of a box, one per source byte.
+  std::vector<uint32_t> row_sums_;
+};
+
+// Decides which camera frames are sent to an image stream.
+//
+// Frames are sent no faster than the maximum frame rate, and only while
+// fewer than the maximum number of pending frames are on their way to Dart.
+// Each sent frame takes a credit that Dart returns once it has received the
+// frame. Without credits, frames are dropped before they are converted,
+// instead of queuing up behind a slow isolate.
+//
+// |TryAcquire| is only called by the capture thread, while |Release| may be
+// called from any thread.
+class ImageStreamGate {
+ public:
+  explicit ImageStreamGate(const ImageStreamOptions& options);
+  virtual ~ImageStreamGate() = default;
+
+  // Prevent copying.
+  ImageStreamGate(ImageStreamGate const&) = delete;
+  ImageStreamGate& operator=(ImageStreamGate const&) = delete;
+
+  // Returns true, and takes a credit, if the frame presented at
+  // |sample_time_us| should be sent.
+  bool TryAcquire(uint64_t sample_time_us);
+
+  // Returns the credit of a frame that Dart has received, or that could not
+  // be sent.
+  void Release();
+
+  // Returns the number of frames skipped to keep to the maximum frame rate.
+  uint64_t GetThrottledFrameCount() const {
+    return throttled_frames_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the number of frames dropped because too many frames were
+  // pending.
+  uint64_t GetDroppedFrameCount() const {
+    return dropped_frames_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Minimum time between sent frames, or 0 without a maximum frame rate.
+  uint64_t frame_interval_us_ = 0;
+
+  // Presentation time from which the next frame may be sent, or -1 before
+  // the first frame.
+  int64_t next_frame_time_us_ = -1;
+
+  std::atomic<uint32_t> credits_;
+  std::atomic<uint64_t> throttled_frames_ = 0;
+  std::atomic<uint64_t> dropped_frames_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_IMAGE_STREAM_H_
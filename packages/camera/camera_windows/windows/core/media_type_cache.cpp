@@ -0,0 +1,197 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media_type_cache.h"
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+namespace camera_windows {
+
+namespace {
+
+// Changing the serialized form requires a new header, which makes older
+// data be ignored.
+constexpr char kHeader[] = "camera_windows media types 1";
+
+constexpr char kDeviceTag[] = "device";
+constexpr char kPreviewTag[] = "preview";
+constexpr char kRecordTag[] = "record";
+
+// Written instead of a pixel format for subtypes the plugin does not
+// handle itself.
+constexpr int kNoPixelFormat = -1;
+
+// Larger streams are treated as malformed data.
+constexpr size_t kMaxMediaTypesPerStream = 4096;
+constexpr size_t kMaxStringLength = 4096;
+
+// Strings are written as their length, a colon and their bytes, so that
+// they may contain any character.
+void WriteString(std::ostream& out, const std::string& value) {
+  out << value.size() << ':' << value;
+}
+
+bool ReadString(std::istream& in, std::string* value) {
+  size_t length = 0;
+  char separator = 0;
+  if (!(in >> length) || !in.get(separator) || separator != ':' ||
+      length > kMaxStringLength) {
+    return false;
+  }
+  value->resize(length);
+  return length == 0 || in.read(&(*value)[0], length);
+}
+
+void WriteStream(std::ostream& out, const char* tag,
+                 const StreamCapabilities& stream) {
+  out << tag << ' ' << stream.media_types.size() << '\n';
+  for (size_t i = 0; i < stream.media_types.size(); i++) {
+    const MediaTypeInfo& info = stream.media_types[i];
+    int pixel_format = info.has_pixel_format
+                           ? static_cast<int>(info.pixel_format)
+                           : kNoPixelFormat;
+    out << stream.native_indices[i] << ' ' << info.width << ' '
+        << info.height << ' ' << info.frame_rate << ' ' << pixel_format
+        << '\n';
+  }
+}
+
+bool ReadStream(std::istream& in, const char* tag,
+                StreamCapabilities* stream) {
+  std::string read_tag;
+  size_t count = 0;
+  if (!(in >> read_tag >> count) || read_tag != tag ||
+      count > kMaxMediaTypesPerStream) {
+    return false;
+  }
+  stream->media_types.resize(count);
+  stream->native_indices.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    MediaTypeInfo& info = stream->media_types[i];
+    int pixel_format = kNoPixelFormat;
+    if (!(in >> stream->native_indices[i] >> info.width >> info.height >>
+          info.frame_rate >> pixel_format)) {
+      return false;
+    }
+    if (pixel_format == kNoPixelFormat) {
+      info.has_pixel_format = false;
+    } else if (pixel_format >= 0 &&
+               pixel_format <= static_cast<int>(PixelFormat::kMJPG)) {
+      info.has_pixel_format = true;
+      info.pixel_format = static_cast<PixelFormat>(pixel_format);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+MediaTypeCache::MediaTypeCache(size_t max_entries)
+    : max_entries_(max_entries > 0 ? max_entries : 1) {}
+
+std::list<MediaTypeCache::Entry>::iterator MediaTypeCache::FindEntry(
+    const std::string& device_id) {
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->device_id == device_id) {
+      return it;
+    }
+  }
+  return entries_.end();
+}
+
+bool MediaTypeCache::Find(const std::string& device_id,
+                          const std::string& fingerprint,
+                          DeviceCapabilities* capabilities) {
+  auto it = FindEntry(device_id);
+  if (it == entries_.end()) {
+    return false;
+  }
+  if (it->capabilities.fingerprint != fingerprint) {
+    // The driver or firmware changed, so the media types must be read again.
+    entries_.erase(it);
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it);
+  *capabilities = it->capabilities;
+  return true;
+}
+
+void MediaTypeCache::Store(const std::string& device_id,
+                           DeviceCapabilities capabilities) {
+  auto it = FindEntry(device_id);
+  if (it != entries_.end()) {
+    entries_.erase(it);
+  }
+  entries_.push_front({device_id, std::move(capabilities)});
+  while (entries_.size() > max_entries_) {
+    entries_.pop_back();
+  }
+}
+
+bool MediaTypeCache::Remove(const std::string& device_id) {
+  auto it = FindEntry(device_id);
+  if (it == entries_.end()) {
+    return false;
+  }
+  entries_.erase(it);
+  return true;
+}
+
+std::string MediaTypeCache::Serialize() const {
+  std::ostringstream out;
+  // Enough digits for frame rates to be read back unchanged.
+  out << std::setprecision(std::numeric_limits<float>::max_digits10);
+  out << kHeader << '\n';
+  for (const Entry& entry : entries_) {
+    out << kDeviceTag << ' ';
+    WriteString(out, entry.device_id);
+    out << ' ';
+    WriteString(out, entry.capabilities.fingerprint);
+    out << '\n';
+    WriteStream(out, kPreviewTag, entry.capabilities.preview);
+    WriteStream(out, kRecordTag, entry.capabilities.record);
+  }
+  return out.str();
+}
+
+bool MediaTypeCache::Deserialize(const std::string& data) {
+  entries_.clear();
+
+  std::istringstream in(data);
+  std::string header;
+  if (!std::getline(in, header) || header != kHeader) {
+    return false;
+  }
+
+  std::list<Entry> entries;
+  std::string tag;
+  while (in >> tag) {
+    Entry entry;
+    char separator = 0;
+    if (tag != kDeviceTag || !in.get(separator) ||
+        !ReadString(in, &entry.device_id) || !in.get(separator) ||
+        !ReadString(in, &entry.capabilities.fingerprint) ||
+        !ReadStream(in, kPreviewTag, &entry.capabilities.preview) ||
+        !ReadStream(in, kRecordTag, &entry.capabilities.record)) {
+      return false;
+    }
+    entries.push_back(std::move(entry));
+  }
+  if (!in.eof()) {
+    return false;
+  }
+
+  while (entries.size() > max_entries_) {
+    entries.pop_back();
+  }
+  entries_ = std::move(entries);
+  return true;
+}
+
+}  // namespace camera_windows
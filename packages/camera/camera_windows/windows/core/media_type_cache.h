@@ -0,0 +1,94 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MEDIA_TYPE_CACHE_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MEDIA_TYPE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "media_type_selection.h"
+
+namespace camera_windows {
+
+// Media types offered by one stream of a capture device.
+struct StreamCapabilities {
+  std::vector<MediaTypeInfo> media_types;
+
+  // Index of each entry of |media_types| in the native media types of the
+  // stream, as passed to GetAvailableDeviceMediaType.
+  std::vector<uint32_t> native_indices;
+};
+
+// Media types offered by the preview and record streams of a device.
+struct DeviceCapabilities {
+  // Identifies the driver and firmware the media types were read from.
+  // Entries are only used while the fingerprint of the device is unchanged.
+  std::string fingerprint;
+
+  StreamCapabilities preview;
+  StreamCapabilities record;
+};
+
+// Cache of the media types of capture devices, keyed by device id.
+//
+// Reading every native media type of a device takes tens of milliseconds
+// for devices with many media types, so the media types are read once per
+// driver and firmware version, and kept across sessions in serialized form.
+// Not thread safe.
+class MediaTypeCache {
+ public:
+  // Least recently used devices are dropped beyond this number of entries.
+  static constexpr size_t kDefaultMaxEntries = 32;
+
+  explicit MediaTypeCache(size_t max_entries = kDefaultMaxEntries);
+  virtual ~MediaTypeCache() = default;
+
+  // Prevent copying.
+  MediaTypeCache(MediaTypeCache const&) = delete;
+  MediaTypeCache& operator=(MediaTypeCache const&) = delete;
+
+  // Copies the cached media types of |device_id| to |capabilities| and
+  // returns true if they were read with the given |fingerprint|. Entries
+  // with another fingerprint are dropped.
+  bool Find(const std::string& device_id, const std::string& fingerprint,
+            DeviceCapabilities* capabilities);
+
+  // Caches the media types of |device_id|, replacing any previous entry.
+  void Store(const std::string& device_id, DeviceCapabilities capabilities);
+
+  // Drops the entry of |device_id|, if any. Returns true if it existed.
+  bool Remove(const std::string& device_id);
+
+  // Returns the number of cached devices.
+  size_t GetSize() const { return entries_.size(); }
+
+  // Writes all entries to a string, most recently used first.
+  std::string Serialize() const;
+
+  // Replaces all entries with the ones of |data|, as written by |Serialize|.
+  // Returns false, leaving the cache empty, if |data| is malformed or was
+  // written by another version of the cache.
+  bool Deserialize(const std::string& data);
+
+ private:
+  struct Entry {
+    std::string device_id;
+    DeviceCapabilities capabilities;
+  };
+
+  std::list<Entry>::iterator FindEntry(const std::string& device_id);
+
+  size_t max_entries_;
+
+  // Ordered from most to least recently used.
+  std::list<Entry> entries_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MEDIA_TYPE_CACHE_H_
@@ -0,0 +1,174 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media_type_selection.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace camera_windows {
+
+namespace {
+
+uint64_t GetFrameArea(const MediaTypeInfo& media_type) {
+  return static_cast<uint64_t>(media_type.width) * media_type.height;
+}
+
+bool IsAcceptable(const MediaTypeInfo& media_type, uint32_t max_height,
+                  float minimum_frame_rate) {
+  return media_type.width > 0 && media_type.height > 0 &&
+         media_type.height <= max_height &&
+         media_type.frame_rate >= minimum_frame_rate;
+}
+
+}  // namespace
+
+int GetPixelFormatPreference(const MediaTypeInfo& media_type) {
+  if (!media_type.has_pixel_format) {
+    return 0;
+  }
+  switch (media_type.pixel_format) {
+    case PixelFormat::kNV12:
+      return 4;
+    case PixelFormat::kYUY2:
+      return 3;
+    case PixelFormat::kRGB32:
+      return 2;
+    case PixelFormat::kMJPG:
+      return 1;
+  }
+  return 0;
+}
+
+int FindBestMediaTypeIndex(const std::vector<MediaTypeInfo>& media_types,
+                           uint32_t max_height,
+                           float minimum_accepted_framerate) {
+  int best_index = -1;
+  uint32_t best_width = 0;
+  uint32_t best_height = 0;
+  float best_framerate = 0.f;
+  int best_preference = -1;
+
+  for (size_t i = 0; i < media_types.size(); i++) {
+    const MediaTypeInfo& media_type = media_types[i];
+    if (media_type.frame_rate < minimum_accepted_framerate ||
+        media_type.height > max_height) {
+      continue;
+    }
+
+    // Cameras often offer the same frame size and rate in several
+    // subtypes, such as YUY2 and MJPG.
+    const int preference = GetPixelFormatPreference(media_type);
+    const bool same_size_and_rate = best_width == media_type.width &&
+                                    best_height == media_type.height &&
+                                    best_framerate == media_type.frame_rate;
+    if (best_width < media_type.width || best_height < media_type.height ||
+        best_framerate < media_type.frame_rate ||
+        (same_size_and_rate && best_preference < preference)) {
+      best_index = static_cast<int>(i);
+      best_width = media_type.width;
+      best_height = media_type.height;
+      best_framerate = media_type.frame_rate;
+      best_preference = preference;
+    }
+  }
+
+  return best_index;
+}
+
+float GetPixelFormatCost(const MediaTypeInfo& media_type,
+                         const MediaTypePreferences& preferences) {
+  float cost = preferences.other_cost;
+  if (media_type.has_pixel_format) {
+    switch (media_type.pixel_format) {
+      case PixelFormat::kNV12:
+        cost = preferences.nv12_cost;
+        break;
+      case PixelFormat::kYUY2:
+        cost = preferences.yuy2_cost;
+        break;
+      case PixelFormat::kRGB32:
+        cost = preferences.rgb32_cost;
+        break;
+      case PixelFormat::kMJPG:
+        cost = preferences.mjpg_cost;
+        break;
+    }
+  }
+  return std::clamp(cost, 0.f, 1.f);
+}
+
+float ScoreMediaType(const MediaTypeInfo& media_type,
+                     const MediaTypePreferences& preferences,
+                     uint64_t largest_frame_area) {
+  const uint64_t area = GetFrameArea(media_type);
+  uint64_t target_area = static_cast<uint64_t>(preferences.target_width) *
+                         preferences.target_height;
+  if (target_area == 0) {
+    target_area = largest_frame_area;
+  }
+  if (area == 0 || target_area == 0) {
+    return 0.f;
+  }
+
+  // The exponents make frames of a quarter of the target width and height
+  // score as well as half the preferred frame rate, and frames larger than
+  // the target lose half as much as smaller ones.
+  const double size_ratio =
+      static_cast<double>(area) / static_cast<double>(target_area);
+  const double size_score = size_ratio <= 1.0
+                                ? std::pow(size_ratio, 0.25)
+                                : std::pow(1.0 / size_ratio, 0.125);
+
+  double frame_rate_score = 1.0;
+  if (preferences.preferred_frame_rate > 0.f) {
+    frame_rate_score =
+        std::min(media_type.frame_rate, preferences.preferred_frame_rate) /
+        preferences.preferred_frame_rate;
+  }
+
+  const double format_score =
+      1.0 - GetPixelFormatCost(media_type, preferences);
+  return static_cast<float>(size_score * frame_rate_score * format_score);
+}
+
+int FindBestMediaTypeIndex(const std::vector<MediaTypeInfo>& media_types,
+                           uint32_t max_height,
+                           const MediaTypePreferences& preferences) {
+  uint64_t largest_frame_area = 0;
+  for (const MediaTypeInfo& media_type : media_types) {
+    if (IsAcceptable(media_type, max_height, preferences.minimum_frame_rate)) {
+      largest_frame_area =
+          std::max(largest_frame_area, GetFrameArea(media_type));
+    }
+  }
+
+  int best_index = -1;
+  float best_score = -1.f;
+  for (size_t i = 0; i < media_types.size(); i++) {
+    const MediaTypeInfo& media_type = media_types[i];
+    if (!IsAcceptable(media_type, max_height,
+                      preferences.minimum_frame_rate)) {
+      continue;
+    }
+
+    const float score =
+        ScoreMediaType(media_type, preferences, largest_frame_area);
+    bool better = score > best_score;
+    if (score == best_score) {
+      const MediaTypeInfo& best = media_types[best_index];
+      better = GetFrameArea(media_type) > GetFrameArea(best) ||
+               (GetFrameArea(media_type) == GetFrameArea(best) &&
+                media_type.frame_rate > best.frame_rate);
+    }
+    if (better) {
+      best_index = static_cast<int>(i);
+      best_score = score;
+    }
+  }
+
+  return best_index;
+}
+
+}  // namespace camera_windows
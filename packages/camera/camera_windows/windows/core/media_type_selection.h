@@ -0,0 +1,100 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MEDIA_TYPE_SELECTION_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MEDIA_TYPE_SELECTION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_conversion.h"
+
+namespace camera_windows {
+
+// Media types slower than this are skipped, unless apps choose another
+// minimum frame rate in |MediaTypePreferences|.
+constexpr float kDefaultMinimumFrameRate = 15.f;
+
+// Frame size, rate and format of a media type offered by a capture source.
+struct MediaTypeInfo {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  float frame_rate = 0.f;
+
+  // False for subtypes the plugin does not handle itself, which are
+  // converted by Media Foundation.
+  bool has_pixel_format = false;
+  PixelFormat pixel_format = PixelFormat::kRGB32;
+};
+
+// Ranks the pixel format of |media_type| for media types of the same frame
+// size and rate. Uncompressed formats are converted to RGBA in a single pass,
+// while MJPEG frames must be decoded first.
+int GetPixelFormatPreference(const MediaTypeInfo& media_type);
+
+// Returns the index of the media type with the largest frame size and
+// highest frame rate in |media_types|, or -1 if none qualifies.
+//
+// Media types taller than |max_height| or slower than
+// |minimum_accepted_framerate| are skipped. Among media types of the same
+// frame size and rate, the preferred pixel format wins.
+//
+// Used without |MediaTypePreferences|, so that apps that do not pass them
+// keep the media types that earlier versions chose. It shares the minimum
+// frame rate of the preferences, but does not score media types.
+int FindBestMediaTypeIndex(
+    const std::vector<MediaTypeInfo>& media_types, uint32_t max_height,
+    float minimum_accepted_framerate = kDefaultMinimumFrameRate);
+
+// Preferences of apps for the media type of a camera, used to score media
+// types instead of taking the largest and fastest one.
+struct MediaTypePreferences {
+  // Frame size to aim for, or zero for the largest frame size. Smaller frame
+  // sizes lose detail, and score lower than larger ones of the same ratio,
+  // which only cost time to scale down.
+  uint32_t target_width = 0;
+  uint32_t target_height = 0;
+
+  // Media types slower than this are never chosen.
+  float minimum_frame_rate = kDefaultMinimumFrameRate;
+
+  // Frame rate to aim for. Faster media types score no better.
+  float preferred_frame_rate = 30.f;
+
+  // Share of the score lost to the cost of handling each pixel format,
+  // between 0 and 1. |other_cost| applies to subtypes that are converted by
+  // Media Foundation.
+  float nv12_cost = 0.f;
+  float yuy2_cost = 0.05f;
+  float rgb32_cost = 0.1f;
+  float mjpg_cost = 0.2f;
+  float other_cost = 0.3f;
+};
+
+// Returns the cost of the pixel format of |media_type|, clamped to [0, 1].
+float GetPixelFormatCost(const MediaTypeInfo& media_type,
+                         const MediaTypePreferences& preferences);
+
+// Scores |media_type| between 0 and 1, as the product of its frame size,
+// frame rate and pixel format scores.
+//
+// Without a target frame size in |preferences|, frame sizes are scored
+// against |largest_frame_area|.
+float ScoreMediaType(const MediaTypeInfo& media_type,
+                     const MediaTypePreferences& preferences,
+                     uint64_t largest_frame_area);
+
+// Returns the index of the media type with the best score in |media_types|,
+// or -1 if none qualifies.
+//
+// Media types taller than |max_height| or slower than the minimum frame
+// rate of |preferences| are skipped. Among media types of the same score,
+// the larger frame size wins, then the higher frame rate.
+int FindBestMediaTypeIndex(const std::vector<MediaTypeInfo>& media_types,
+                           uint32_t max_height,
+                           const MediaTypePreferences& preferences);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MEDIA_TYPE_SELECTION_H_
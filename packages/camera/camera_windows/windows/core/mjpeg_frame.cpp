@@ -0,0 +1,192 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mjpeg_frame.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace camera_windows {
+
+namespace {
+
+constexpr uint8_t kMarkerPrefix = 0xFF;
+constexpr uint8_t kStartOfImage = 0xD8;
+constexpr uint8_t kStartOfScan = 0xDA;
+constexpr uint8_t kDefineHuffmanTable = 0xC4;
+constexpr uint8_t kTemporary = 0x01;
+constexpr uint8_t kFirstRestart = 0xD0;
+constexpr uint8_t kLastRestart = 0xD7;
+
+// Default Huffman tables of ITU-T T.81, Annex K.3, as a complete DHT marker
+// segment. Each table is its class and id, the number of codes of each
+// length from 1 to 16 bits, and the symbols in order of increasing length.
+const uint8_t kDefaultHuffmanTables[] = {
+    0xFF, 0xC4, 0x01, 0xA2,
+    // Luminance DC coefficients.
+    0x00, 0x00, 0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0A, 0x0B,
+    // Luminance AC coefficients.
+    0x10, 0x00, 0x02, 0x01, 0x03, 0x03, 0x02, 0x04, 0x03, 0x05, 0x05, 0x04,
+    0x04, 0x00, 0x00, 0x01, 0x7D, 0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05,
+    0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14,
+    0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1,
+    0xF0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19,
+    0x1A, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38,
+    0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54,
+    0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84,
+    0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+    0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA,
+    0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4,
+    0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+    0xD8, 0xD9, 0xDA, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9,
+    0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA,
+    // Chrominance DC coefficients.
+    0x01, 0x00, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0A, 0x0B,
+    // Chrominance AC coefficients.
+    0x11, 0x00, 0x02, 0x01, 0x02, 0x04, 0x04, 0x03, 0x04, 0x07, 0x05, 0x04,
+    0x04, 0x00, 0x01, 0x02, 0x77, 0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05,
+    0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32,
+    0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52,
+    0xF0, 0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1,
+    0x17, 0x18, 0x19, 0x1A, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53,
+    0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67,
+    0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82,
+    0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95,
+    0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8,
+    0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2,
+    0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5,
+    0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8,
+    0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA,
+};
+
+static_assert(sizeof(kDefaultHuffmanTables) == 0x01A2 + 2,
+              "DHT segment length must match its contents");
+
+// Returns true for the start of frame markers SOF0 to SOF15. The other
+// markers of that range define Huffman tables (DHT), arithmetic coding
+// conditions (DAC) or are reserved (JPG).
+bool IsStartOfFrame(uint8_t marker) {
+  return marker >= 0xC0 && marker <= 0xCF && marker != kDefineHuffmanTable &&
+         marker != 0xC8 && marker != 0xCC;
+}
+
+// Reads a big-endian 16-bit value.
+uint32_t ReadUint16(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 8) | data[1];
+}
+
+}  // namespace
+
+bool ParseJpegFrameInfo(const uint8_t* data, size_t size,
+                        JpegFrameInfo* info) {
+  assert(info);
+  if (!data || size < 4 || data[0] != kMarkerPrefix ||
+      data[1] != kStartOfImage) {
+    return false;
+  }
+
+  JpegFrameInfo result;
+  bool has_frame_header = false;
+  size_t offset = 2;
+  while (offset + 1 < size) {
+    if (data[offset] != kMarkerPrefix) {
+      // Only markers are allowed between segments.
+      return false;
+    }
+    const size_t marker_offset = offset;
+    // Any marker may be preceded by fill bytes.
+    while (offset < size && data[offset] == kMarkerPrefix) {
+      offset++;
+    }
+    if (offset >= size) {
+      return false;
+    }
+    const uint8_t marker = data[offset++];
+
+    if (marker == kStartOfScan) {
+      if (!has_frame_header) {
+        return false;
+      }
+      result.scan_offset = marker_offset;
+      *info = result;
+      return true;
+    }
+    if (marker == kTemporary ||
+        (marker >= kFirstRestart && marker <= kLastRestart)) {
+      // Markers without a segment.
+      continue;
+    }
+
+    // The segment length includes the two length bytes.
+    if (offset + 2 > size) {
+      return false;
+    }
+    const uint32_t length = ReadUint16(data + offset);
+    if (length < 2 || offset + length > size) {
+      return false;
+    }
+    const uint8_t* segment = data + offset + 2;
+
+    if (marker == kDefineHuffmanTable) {
+      result.has_huffman_tables = true;
+    } else if (IsStartOfFrame(marker)) {
+      // Sample precision, height, width and component count.
+      if (length < 8) {
+        return false;
+      }
+      result.height = ReadUint16(segment + 1);
+      result.width = ReadUint16(segment + 3);
+      result.component_count = segment[5];
+      has_frame_header = true;
+    }
+    offset += length;
+  }
+  return false;
+}
+
+void InsertDefaultHuffmanTables(const uint8_t* data, size_t size,
+                                const JpegFrameInfo& info,
+                                std::vector<uint8_t>* output) {
+  assert(data && output);
+  assert(info.scan_offset <= size);
+
+  output->resize(size + sizeof(kDefaultHuffmanTables));
+  uint8_t* out = output->data();
+  std::copy(data, data + info.scan_offset, out);
+  out += info.scan_offset;
+  std::copy(std::begin(kDefaultHuffmanTables), std::end(kDefaultHuffmanTables),
+            out);
+  out += sizeof(kDefaultHuffmanTables);
+  std::copy(data + info.scan_offset, data + size, out);
+}
+
+uint32_t GetJpegScaleDenominator(uint32_t frame_width, uint32_t frame_height,
+                                 uint32_t target_width,
+                                 uint32_t target_height) {
+  if (target_width == 0 || target_height == 0) {
+    return 1;
+  }
+
+  // Ordered from the smallest to the largest decoded size.
+  const uint32_t denominators[] = {8, 4, 2};
+  for (uint32_t denominator : denominators) {
+    // Scaled sizes are rounded up, like in the decoders.
+    const uint32_t scaled_width = (frame_width + denominator - 1) / denominator;
+    const uint32_t scaled_height =
+        (frame_height + denominator - 1) / denominator;
+    if (scaled_width >= target_width && scaled_height >= target_height) {
+      return denominator;
+    }
+  }
+  return 1;
+}
+
+}  // namespace camera_windows
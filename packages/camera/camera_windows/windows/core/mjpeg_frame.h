@@ -0,0 +1,57 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MJPEG_FRAME_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MJPEG_FRAME_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace camera_windows {
+
+// Header fields of a single MJPEG frame, which is a complete JPEG image.
+struct JpegFrameInfo {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t component_count = 0;
+
+  // False if the image relies on the default Huffman tables. Many USB
+  // cameras leave them out of MJPEG frames to save bandwidth.
+  bool has_huffman_tables = false;
+
+  // Byte offset of the start of scan marker.
+  size_t scan_offset = 0;
+};
+
+// Reads the markers of the JPEG image in |data| up to its first scan.
+//
+// Returns false if |data| does not start with a JPEG image, or if the frame
+// header or the start of scan marker is missing.
+bool ParseJpegFrameInfo(const uint8_t* data, size_t size,
+                        JpegFrameInfo* info);
+
+// Copies the JPEG image in |data| to |output|, with the default Huffman
+// tables of the JPEG standard (ITU-T T.81, Annex K.3) inserted right before
+// the first scan, as expected by stand-alone JPEG decoders.
+//
+// |info| must have been parsed from |data|.
+void InsertDefaultHuffmanTables(const uint8_t* data, size_t size,
+                                const JpegFrameInfo& info,
+                                std::vector<uint8_t>* output);
+
+// Returns the largest scaling denominator of 1, 2, 4 or 8 with which a frame
+// of |frame_width| x |frame_height| pixels can be decoded while still
+// covering |target_width| x |target_height| pixels.
+//
+// JPEG decoders scale by these factors within the inverse DCT, which is much
+// cheaper than decoding at full size and scaling afterwards. Returns 1 if the
+// target size is unknown.
+uint32_t GetJpegScaleDenominator(uint32_t frame_width, uint32_t frame_height,
+                                 uint32_t target_width,
+                                 uint32_t target_height);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_MJPEG_FRAME_H_
@@ -0,0 +1,371 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pixel_conversion.h"
+
+#include <cassert>
+#include <cstddef>
+
+#include "simd_utils.h"
+
+namespace camera_windows {
+
+namespace {
+
+constexpr uint32_t kBytesPerPixel = 4;
+constexpr uint32_t kRGB24BytesPerPixel = 3;
+
+// Converts a single row of |width| pixels.
+using ConvertRowFunction = void (*)(const uint8_t* src, uint8_t* dst,
+                                    uint32_t width);
+
+// Converts one BGRX pixel to RGBA.
+inline void ConvertPixel(const uint8_t* src, uint8_t* dst) {
+  dst[0] = src[2];
+  dst[1] = src[1];
+  dst[2] = src[0];
+  dst[3] = 255;
+}
+
+// Converts pixels from |begin| up to the end of the row.
+//
+// Used by the vectorized kernels for the pixels left over after the last full
+// vector.
+template <bool kMirror>
+inline void ConvertRowTail(const uint8_t* src, uint8_t* dst, uint32_t begin,
+                           uint32_t width) {
+  for (uint32_t x = begin; x < width; x++) {
+    uint32_t dst_x = kMirror ? (width - 1 - x) : x;
+    ConvertPixel(src + x * kBytesPerPixel, dst + dst_x * kBytesPerPixel);
+  }
+}
+
+template <bool kMirror>
+void ConvertRowScalar(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  ConvertRowTail<kMirror>(src, dst, 0, width);
+}
+
+// Converts one BGR pixel to RGBA.
+inline void ConvertRGB24Pixel(const uint8_t* src, uint8_t* dst) {
+  dst[0] = src[2];
+  dst[1] = src[1];
+  dst[2] = src[0];
+  dst[3] = 255;
+}
+
+// Converts BGR pixels from |begin| up to the end of the row.
+template <bool kMirror>
+inline void ConvertRGB24RowTail(const uint8_t* src, uint8_t* dst,
+                                uint32_t begin, uint32_t width) {
+  for (uint32_t x = begin; x < width; x++) {
+    uint32_t dst_x = kMirror ? (width - 1 - x) : x;
+    ConvertRGB24Pixel(src + x * kRGB24BytesPerPixel,
+                      dst + dst_x * kBytesPerPixel);
+  }
+}
+
+template <bool kMirror>
+void ConvertRGB24RowScalar(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  ConvertRGB24RowTail<kMirror>(src, dst, 0, width);
+}
+
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+
+template <bool kMirror>
+CAMERA_WINDOWS_TARGET("ssse3")
+void ConvertRowSSSE3(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  // Swaps the B and R bytes of each pixel, and when mirroring also reverses
+  // the order of the four pixels in the vector.
+  const __m128i shuffle =
+      kMirror ? _mm_setr_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1,
+                              0, 3)
+              : _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13,
+                              12, 15);
+  constexpr uint32_t kPixelsPerVector = 4;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    __m128i pixels = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + x * kBytesPerPixel));
+    pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha);
+    uint32_t dst_x = kMirror ? (width - x - kPixelsPerVector) : x;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + dst_x * kBytesPerPixel),
+                     pixels);
+  }
+  ConvertRowTail<kMirror>(src, dst, x, width);
+}
+
+template <bool kMirror>
+CAMERA_WINDOWS_TARGET("avx2")
+void ConvertRowAVX2(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+  // Byte shuffles only work within 128-bit lanes, so the pixel order is
+  // reversed across the whole register with a 32-bit permute first.
+  const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  const __m256i swizzle =
+      _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2,
+                       1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  constexpr uint32_t kPixelsPerVector = 8;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    __m256i pixels = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(src + x * kBytesPerPixel));
+    if constexpr (kMirror) {
+      pixels = _mm256_permutevar8x32_epi32(pixels, reverse);
+    }
+    pixels = _mm256_or_si256(_mm256_shuffle_epi8(pixels, swizzle), alpha);
+    uint32_t dst_x = kMirror ? (width - x - kPixelsPerVector) : x;
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dst + dst_x * kBytesPerPixel), pixels);
+  }
+  ConvertRowTail<kMirror>(src, dst, x, width);
+}
+
+template <bool kMirror>
+CAMERA_WINDOWS_TARGET("ssse3")
+void ConvertRGB24RowSSSE3(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+  // Spreads the four BGR pixels in the low 12 bytes over four RGBA pixels,
+  // swapping B and R, and when mirroring also reversing the pixel order.
+  // Negative indices clear the alpha bytes.
+  const __m128i shuffle =
+      kMirror ? _mm_setr_epi8(11, 10, 9, -1, 8, 7, 6, -1, 5, 4, 3, -1, 2, 1, 0,
+                              -1)
+              : _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10,
+                              9, -1);
+  constexpr uint32_t kPixelsPerVector = 4;
+  // Each load reads 16 bytes but only uses 12, so the loop leaves enough
+  // pixels to the tail to never read past the end of the row.
+  constexpr uint32_t kPixelsPerLoad = 6;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerLoad <= width; x += kPixelsPerVector) {
+    __m128i pixels = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + x * kRGB24BytesPerPixel));
+    pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha);
+    uint32_t dst_x = kMirror ? (width - x - kPixelsPerVector) : x;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + dst_x * kBytesPerPixel),
+                     pixels);
+  }
+  ConvertRGB24RowTail<kMirror>(src, dst, x, width);
+}
+
+#if defined(_MSC_VER)
+
+bool CpuSupportsSSSE3() {
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;
+}
+
+bool CpuSupportsAVX2() {
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+
+  // The OS must also save the YMM registers on context switches.
+  __cpuid(info, 1);
+  const bool os_uses_xsave = (info[2] & (1 << 27)) != 0;
+  const bool cpu_has_avx = (info[2] & (1 << 28)) != 0;
+  if (!os_uses_xsave || !cpu_has_avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+}
+
+#else
+
+bool CpuSupportsSSSE3() { return __builtin_cpu_supports("ssse3"); }
+
+bool CpuSupportsAVX2() { return __builtin_cpu_supports("avx2"); }
+
+#endif  // defined(_MSC_VER)
+
+#endif  // defined(CAMERA_WINDOWS_ARCH_X86)
+
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+
+// Reverses the order of all 16 bytes in |v|.
+inline uint8x16_t ReverseBytes(uint8x16_t v) {
+  v = vrev64q_u8(v);
+  return vextq_u8(v, v, 8);
+}
+
+template <bool kMirror>
+void ConvertRowNEON(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  const uint8x16_t alpha = vdupq_n_u8(255);
+  constexpr uint32_t kPixelsPerVector = 16;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    // De-interleaves the B, G, R and X planes of 16 pixels.
+    uint8x16x4_t bgrx = vld4q_u8(src + x * kBytesPerPixel);
+    uint8x16x4_t rgba;
+    rgba.val[0] = kMirror ? ReverseBytes(bgrx.val[2]) : bgrx.val[2];
+    rgba.val[1] = kMirror ? ReverseBytes(bgrx.val[1]) : bgrx.val[1];
+    rgba.val[2] = kMirror ? ReverseBytes(bgrx.val[0]) : bgrx.val[0];
+    rgba.val[3] = alpha;
+    uint32_t dst_x = kMirror ? (width - x - kPixelsPerVector) : x;
+    vst4q_u8(dst + dst_x * kBytesPerPixel, rgba);
+  }
+  ConvertRowTail<kMirror>(src, dst, x, width);
+}
+
+template <bool kMirror>
+void ConvertRGB24RowNEON(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  const uint8x16_t alpha = vdupq_n_u8(255);
+  constexpr uint32_t kPixelsPerVector = 16;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    // De-interleaves the B, G and R planes of 16 pixels.
+    uint8x16x3_t bgr = vld3q_u8(src + x * kRGB24BytesPerPixel);
+    uint8x16x4_t rgba;
+    rgba.val[0] = kMirror ? ReverseBytes(bgr.val[2]) : bgr.val[2];
+    rgba.val[1] = kMirror ? ReverseBytes(bgr.val[1]) : bgr.val[1];
+    rgba.val[2] = kMirror ? ReverseBytes(bgr.val[0]) : bgr.val[0];
+    rgba.val[3] = alpha;
+    uint32_t dst_x = kMirror ? (width - x - kPixelsPerVector) : x;
+    vst4q_u8(dst + dst_x * kBytesPerPixel, rgba);
+  }
+  ConvertRGB24RowTail<kMirror>(src, dst, x, width);
+}
+
+#endif  // defined(CAMERA_WINDOWS_ARCH_ARM64)
+
+// Returns the row kernel implementing |path|.
+ConvertRowFunction GetConvertRowFunction(PixelConversionPath path,
+                                         bool mirror) {
+  switch (path) {
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    case PixelConversionPath::kSSSE3:
+      return mirror ? ConvertRowSSSE3<true> : ConvertRowSSSE3<false>;
+    case PixelConversionPath::kAVX2:
+      return mirror ? ConvertRowAVX2<true> : ConvertRowAVX2<false>;
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      return mirror ? ConvertRowNEON<true> : ConvertRowNEON<false>;
+#endif
+    case PixelConversionPath::kScalar:
+    default:
+      return mirror ? ConvertRowScalar<true> : ConvertRowScalar<false>;
+  }
+}
+
+// Returns the BGR row kernel implementing |path|.
+ConvertRowFunction GetConvertRGB24RowFunction(PixelConversionPath path,
+                                              bool mirror) {
+  switch (path) {
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    // A 256-bit kernel would spend most of its time moving pixels across
+    // 128-bit lanes, so AVX2 CPUs use the SSSE3 kernel.
+    case PixelConversionPath::kSSSE3:
+    case PixelConversionPath::kAVX2:
+      return mirror ? ConvertRGB24RowSSSE3<true> : ConvertRGB24RowSSSE3<false>;
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      return mirror ? ConvertRGB24RowNEON<true> : ConvertRGB24RowNEON<false>;
+#endif
+    case PixelConversionPath::kScalar:
+    default:
+      return mirror ? ConvertRGB24RowScalar<true>
+                    : ConvertRGB24RowScalar<false>;
+  }
+}
+
+// Converts |height| rows with |convert_row|.
+void ConvertRows(ConvertRowFunction convert_row, const uint8_t* src,
+                 int32_t src_stride, uint8_t* dst, uint32_t width,
+                 uint32_t height) {
+  const size_t row_size = static_cast<size_t>(width) * kBytesPerPixel;
+  for (uint32_t y = 0; y < height; y++) {
+    convert_row(src + static_cast<ptrdiff_t>(y) * src_stride,
+                dst + y * row_size, width);
+  }
+}
+
+PixelConversionPath DetectPreferredPixelConversionPath() {
+  // Ordered from fastest to slowest.
+  const PixelConversionPath candidates[] = {
+      PixelConversionPath::kAVX2,
+      PixelConversionPath::kNEON,
+      PixelConversionPath::kSSSE3,
+  };
+  for (PixelConversionPath path : candidates) {
+    if (IsPixelConversionPathSupported(path)) {
+      return path;
+    }
+  }
+  return PixelConversionPath::kScalar;
+}
+
+}  // namespace
+
+bool IsPixelConversionPathSupported(PixelConversionPath path) {
+  switch (path) {
+    case PixelConversionPath::kScalar:
+      return true;
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    case PixelConversionPath::kSSSE3:
+      return CpuSupportsSSSE3();
+    case PixelConversionPath::kAVX2:
+      return CpuSupportsAVX2();
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      // NEON is a mandatory part of ARMv8-A.
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+PixelConversionPath GetPreferredPixelConversionPath() {
+  static const PixelConversionPath preferred_path =
+      DetectPreferredPixelConversionPath();
+  return preferred_path;
+}
+
+void ConvertRGB32ToRGBA(const uint8_t* src, int32_t src_stride, uint8_t* dst,
+                        uint32_t width, uint32_t height, bool mirror) {
+  ConvertRGB32ToRGBAWithPath(GetPreferredPixelConversionPath(), src,
+                             src_stride, dst, width, height, mirror);
+}
+
+void ConvertRGB32ToRGBAWithPath(PixelConversionPath path, const uint8_t* src,
+                                int32_t src_stride, uint8_t* dst,
+                                uint32_t width, uint32_t height, bool mirror) {
+  assert(IsPixelConversionPathSupported(path));
+  assert(src && dst);
+
+  ConvertRows(GetConvertRowFunction(path, mirror), src, src_stride, dst,
+              width, height);
+}
+
+void ConvertRGB24ToRGBA(const uint8_t* src, int32_t src_stride, uint8_t* dst,
+                        uint32_t width, uint32_t height, bool mirror) {
+  ConvertRGB24ToRGBAWithPath(GetPreferredPixelConversionPath(), src,
+                             src_stride, dst, width, height, mirror);
+}
+
+void ConvertRGB24ToRGBAWithPath(PixelConversionPath path, const uint8_t* src,
+                                int32_t src_stride, uint8_t* dst,
+                                uint32_t width, uint32_t height, bool mirror) {
+  assert(IsPixelConversionPathSupported(path));
+  assert(src && dst);
+
+  ConvertRows(GetConvertRGB24RowFunction(path, mirror), src, src_stride, dst,
+              width, height);
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,75 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PIXEL_CONVERSION_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PIXEL_CONVERSION_H_
+
+#include <cstdint>
+
+namespace camera_windows {
+
+// Implementations available for the pixel conversion kernels.
+//
+// Only the scalar path is available on every CPU. The fastest supported path
+// is selected at runtime by |GetPreferredPixelConversionPath|.
+enum class PixelConversionPath {
+  // Portable C++ implementation.
+  kScalar,
+  // x86 SSSE3 byte shuffles, 4 pixels per instruction.
+  kSSSE3,
+  // x86 AVX2 byte shuffles, 8 pixels per instruction.
+  kAVX2,
+  // ARM NEON interleaved loads and stores, 16 pixels per instruction.
+  kNEON,
+};
+
+// Returns true if |path| is compiled in and supported by the current CPU.
+bool IsPixelConversionPathSupported(PixelConversionPath path);
+
+// Returns the fastest conversion path supported by the current CPU.
+//
+// The CPU is probed only once; later calls return the cached result.
+PixelConversionPath GetPreferredPixelConversionPath();
+
+// Converts MFVideoFormat_RGB32 pixels to Flutter desktop pixel buffer pixels.
+//
+// Reads |width| * |height| BGRX pixels from |src| and writes the same number
+// of RGBA pixels to |dst|, in a single pass. The alpha channel is always set
+// to 255. If |mirror| is true, each row is flipped horizontally.
+//
+// |src| points to the top row, and |src_stride| is the byte offset between
+// the starts of consecutive source rows. It may be larger than a row, for
+// padded buffers, or negative, for bottom-up buffers. Rows of |dst| are
+// packed without padding.
+//
+// |src| and |dst| must not overlap.
+void ConvertRGB32ToRGBA(const uint8_t* src, int32_t src_stride, uint8_t* dst,
+                        uint32_t width, uint32_t height, bool mirror);
+
+// Same as |ConvertRGB32ToRGBA|, but uses the given conversion |path| instead
+// of the preferred one. Exists for testing and benchmarking purposes.
+//
+// |path| must be supported by the current CPU.
+void ConvertRGB32ToRGBAWithPath(PixelConversionPath path, const uint8_t* src,
+                                int32_t src_stride, uint8_t* dst,
+                                uint32_t width, uint32_t height, bool mirror);
+
+// Converts MFVideoFormat_RGB24 pixels, which are also the pixels of
+// GUID_WICPixelFormat24bppBGR images, to Flutter desktop pixel buffer pixels.
+//
+// Same as |ConvertRGB32ToRGBA|, but reads 3 bytes per BGR source pixel.
+void ConvertRGB24ToRGBA(const uint8_t* src, int32_t src_stride, uint8_t* dst,
+                        uint32_t width, uint32_t height, bool mirror);
+
+// Same as |ConvertRGB24ToRGBA|, but uses the given conversion |path| instead
+// of the preferred one. Exists for testing and benchmarking purposes.
+//
+// |path| must be supported by the current CPU.
+void ConvertRGB24ToRGBAWithPath(PixelConversionPath path, const uint8_t* src,
+                                int32_t src_stride, uint8_t* dst,
+                                uint32_t width, uint32_t height, bool mirror);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PIXEL_CONVERSION_H_
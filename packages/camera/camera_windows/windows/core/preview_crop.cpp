@@ -0,0 +1,89 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "preview_crop.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace camera_windows {
+
+namespace {
+
+// Tolerance for crop rectangles computed by the app, whose edges may land
+// just past the frame through rounding.
+constexpr double kCropEpsilon = 1e-9;
+
+// Gets the even-aligned pixel range of |start| to |start| + |length|, in
+// fractions of |size| pixels. Returns the first pixel, and the number of
+// pixels in |count|.
+uint32_t GetPixelRange(double start, double length, uint32_t size,
+                       uint32_t* count) {
+  const double end = std::clamp(start + length, 0.0, 1.0);
+  start = std::clamp(start, 0.0, 1.0);
+  uint32_t first =
+      static_cast<uint32_t>(std::floor(start * size)) & ~uint32_t{1};
+  first = std::min(first, size > 2 ? (size - 2) & ~uint32_t{1} : 0);
+  uint32_t last = static_cast<uint32_t>(std::ceil(end * size));
+  last = std::min((last + 1) & ~uint32_t{1}, size);
+  // At least one pair of pixels, or the whole of a one pixel frame.
+  last = std::max(last, std::min(first + 2, size));
+  *count = last - first;
+  return first;
+}
+
+}  // namespace
+
+bool IsValidPreviewCrop(const PreviewCrop& crop) {
+  // Written so that NaN fails every comparison.
+  return crop.left >= 0.0 && crop.top >= 0.0 && crop.width > 0.0 &&
+         crop.height > 0.0 && crop.left + crop.width <= 1.0 + kCropEpsilon &&
+         crop.top + crop.height <= 1.0 + kCropEpsilon && crop.zoom >= 1.0 &&
+         std::isfinite(crop.zoom);
+}
+
+double GetMaxPreviewZoom(uint32_t frame_height) {
+  return std::max(
+      static_cast<double>(frame_height) / kMinPreviewZoomHeight, 1.0);
+}
+
+bool GetPreviewCropRegion(uint32_t width, uint32_t height,
+                          const PreviewCrop& crop, bool mirror,
+                          FrameRegion* region) {
+  assert(IsValidPreviewCrop(crop));
+  const double visible_width = crop.width / crop.zoom;
+  const double visible_height = crop.height / crop.zoom;
+  double left = crop.left + (crop.width - visible_width) / 2;
+  const double top = crop.top + (crop.height - visible_height) / 2;
+  if (mirror) {
+    left = 1.0 - left - visible_width;
+  }
+
+  FrameRegion visible;
+  visible.x = GetPixelRange(left, visible_width, width, &visible.width);
+  visible.y = GetPixelRange(top, visible_height, height, &visible.height);
+  if (visible.width == width && visible.height == height) {
+    return false;
+  }
+  *region = visible;
+  return true;
+}
+
+FrameSize GetUncroppedFrameSize(FrameSize visible_size,
+                                const PreviewCrop& crop) {
+  if (visible_size.width == 0 || visible_size.height == 0) {
+    return visible_size;
+  }
+  // Tiny crop rectangles ask for huge frames, which the preview size
+  // policy caps at the preview size of the resolution preset.
+  const double max_size = std::numeric_limits<uint32_t>::max();
+  const double width = visible_size.width * crop.zoom / crop.width;
+  const double height = visible_size.height * crop.zoom / crop.height;
+  return {static_cast<uint32_t>(std::min(std::ceil(width), max_size)),
+          static_cast<uint32_t>(std::min(std::ceil(height), max_size))};
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,66 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_CROP_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_CROP_H_
+
+#include <cstdint>
+
+#include "frame_conversion.h"
+#include "preview_size_policy.h"
+
+namespace camera_windows {
+
+// Fewest rows of camera frames the preview can be zoomed in to. Beyond
+// this, Flutter mostly scales up blurred pixels.
+constexpr uint32_t kMinPreviewZoomHeight = 120;
+
+// Part of the frames shown in the preview of a camera.
+//
+// The crop rectangle is in fractions of the frame size, as the preview is
+// shown, so it follows a mirrored preview. The zoom factor then narrows the
+// rectangle around its center. The default shows whole frames.
+struct PreviewCrop {
+  double left = 0.0;
+  double top = 0.0;
+  double width = 1.0;
+  double height = 1.0;
+  double zoom = 1.0;
+
+  bool operator==(const PreviewCrop& other) const {
+    return left == other.left && top == other.top && width == other.width &&
+           height == other.height && zoom == other.zoom;
+  }
+  bool operator!=(const PreviewCrop& other) const { return !(*this == other); }
+};
+
+// Returns true if the crop rectangle of |crop| is not empty and lies within
+// the frame, and its zoom factor is finite and at least 1.
+bool IsValidPreviewCrop(const PreviewCrop& crop);
+
+// Returns the largest zoom factor of the preview of frames of
+// |frame_height| rows, which shows |kMinPreviewZoomHeight| of them. Returns 1
+// for frames that are not taller, or whose height is unknown.
+double GetMaxPreviewZoom(uint32_t frame_height);
+
+// Gets the region of a frame of |width| x |height| pixels shown by |crop|,
+// which must be valid. If |mirror| is true, the preview is mirrored, so the
+// region is mirrored too.
+//
+// The region is widened to even rows and columns, so that it does not
+// split the chroma samples of YUV frames. Returns false if the region is the
+// whole frame, which is then converted as usual.
+bool GetPreviewCropRegion(uint32_t width, uint32_t height,
+                          const PreviewCrop& crop, bool mirror,
+                          FrameRegion* region);
+
+// Returns the size whole frames need so that the region shown by |crop|
+// covers |visible_size|, the size Flutter requests for the preview texture.
+// An empty size is returned as is.
+FrameSize GetUncroppedFrameSize(FrameSize visible_size,
+                                const PreviewCrop& crop);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_CROP_H_
@@ -0,0 +1,93 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "preview_size_policy.h"
+
+#include <cassert>
+
+namespace camera_windows {
+
+namespace {
+
+// Candidate sizes below the full size, as fractions of the full size, from
+// largest to smallest.
+struct ScaleFactor {
+  uint32_t numerator;
+  uint32_t denominator;
+};
+const ScaleFactor kScaleFactors[] = {{3, 4}, {1, 2}, {3, 8}, {1, 4}};
+
+// Scales |size| by |factor|, rounding up to even dimensions as required by
+// subsampled YUV formats.
+uint32_t ScaleDimension(uint32_t size, const ScaleFactor& factor) {
+  const uint64_t scaled =
+      (static_cast<uint64_t>(size) * factor.numerator + factor.denominator -
+       1) /
+      factor.denominator;
+  return static_cast<uint32_t>((scaled + 1) & ~uint64_t{1});
+}
+
+uint64_t GetArea(FrameSize size) {
+  return static_cast<uint64_t>(size.width) * size.height;
+}
+
+}  // namespace
+
+FrameSize PreviewSizePolicy::GetCoveringSize(FrameSize requested_size,
+                                             double headroom) const {
+  const double width = requested_size.width * headroom;
+  const double height = requested_size.height * headroom;
+
+  FrameSize covering_size = full_size_;
+  for (const ScaleFactor& factor : kScaleFactors) {
+    FrameSize size;
+    size.width = ScaleDimension(full_size_.width, factor);
+    size.height = ScaleDimension(full_size_.height, factor);
+    if (size.width < width || size.height < height) {
+      break;
+    }
+    covering_size = size;
+  }
+  return covering_size;
+}
+
+bool PreviewSizePolicy::Update(FrameSize requested_size, Clock::time_point now,
+                               FrameSize* next_size) {
+  assert(next_size);
+  if (requested_size.width == 0 || requested_size.height == 0) {
+    return false;
+  }
+
+  // Grows as soon as the current size is too small, but only shrinks if the
+  // smaller size still has headroom.
+  FrameSize target_size = GetCoveringSize(requested_size, 1.0);
+  Clock::duration delay = kGrowDelay;
+  if (GetArea(target_size) <= GetArea(current_size_)) {
+    target_size = GetCoveringSize(requested_size, kShrinkHeadroom);
+    delay = kShrinkDelay;
+    if (GetArea(target_size) >= GetArea(current_size_)) {
+      has_pending_size_ = false;
+      return false;
+    }
+  }
+
+  if (!has_pending_size_ || pending_size_ != target_size) {
+    // Restarts the delay whenever the request moves to another candidate.
+    has_pending_size_ = true;
+    pending_size_ = target_size;
+    pending_since_ = now;
+    return false;
+  }
+
+  if (now - pending_since_ < delay) {
+    return false;
+  }
+
+  has_pending_size_ = false;
+  current_size_ = target_size;
+  *next_size = target_size;
+  return true;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,79 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_SIZE_POLICY_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_SIZE_POLICY_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace camera_windows {
+
+// Size of a frame, in pixels.
+struct FrameSize {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  bool operator==(const FrameSize& other) const {
+    return width == other.width && height == other.height;
+  }
+  bool operator!=(const FrameSize& other) const { return !(*this == other); }
+};
+
+// Picks the size of preview frames from the size Flutter requests for the
+// preview texture.
+//
+// Candidate sizes are fractions of the full preview size of the resolution
+// preset, so the aspect ratio is kept and the preset is never exceeded. The
+// policy follows the smallest candidate that covers the requested size, but
+// only once the request has settled: shrinking waits longer than growing,
+// and needs some headroom below the requested size, so that window resizes
+// and animations do not reconfigure the preview on every frame.
+class PreviewSizePolicy {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Time a larger candidate must be requested before growing.
+  static constexpr Clock::duration kGrowDelay = std::chrono::milliseconds(200);
+
+  // Time a smaller candidate must be requested before shrinking.
+  static constexpr Clock::duration kShrinkDelay = std::chrono::seconds(1);
+
+  // Factor by which a smaller candidate must exceed the requested size
+  // before shrinking to it.
+  static constexpr double kShrinkHeadroom = 1.25;
+
+  // Starts at |full_size|, the preview size of the resolution preset.
+  explicit PreviewSizePolicy(FrameSize full_size)
+      : full_size_(full_size), current_size_(full_size) {}
+  virtual ~PreviewSizePolicy() = default;
+
+  // Returns the size the preview is expected to have.
+  FrameSize GetCurrentSize() const { return current_size_; }
+
+  // Takes the texture size requested at |now|. An empty size means that
+  // Flutter has not requested the texture yet.
+  //
+  // Returns true if the preview should switch to a new size, which is then
+  // returned in |next_size| and becomes the current size.
+  bool Update(FrameSize requested_size, Clock::time_point now,
+              FrameSize* next_size);
+
+ private:
+  // Returns the smallest candidate with room for |requested_size| scaled by
+  // |headroom|, or the full size if none is large enough.
+  FrameSize GetCoveringSize(FrameSize requested_size, double headroom) const;
+
+  FrameSize full_size_;
+  FrameSize current_size_;
+
+  // Candidate waiting for the request to settle.
+  bool has_pending_size_ = false;
+  FrameSize pending_size_;
+  Clock::time_point pending_since_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_SIZE_POLICY_H_
@@ -0,0 +1,174 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "preview_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace camera_windows {
+
+namespace {
+
+// The latency baseline rises by this fraction of each latency, so that a
+// steady drift between the camera and system clocks fades out within about
+// a thousand samples, while short hitches still stand out.
+constexpr int64_t kLatencyBaselineRise = 1024;
+
+// Returns the index of the highest set bit of |value|, which must not be 0.
+uint32_t GetHighestBit(uint64_t value) {
+  uint32_t bit = 0;
+  for (uint32_t shift = 32; shift > 0; shift /= 2) {
+    if (value >> shift) {
+      value >>= shift;
+      bit += shift;
+    }
+  }
+  return bit;
+}
+
+// Returns the bucket of |value|. Values below 4 have a bucket each, and each
+// following power of two is split into four buckets.
+size_t GetBucket(uint64_t value, size_t bucket_count) {
+  if (value < 4) {
+    return static_cast<size_t>(value);
+  }
+  const uint32_t bit = GetHighestBit(value);
+  const size_t sub_bucket = static_cast<size_t>((value >> (bit - 2)) & 3);
+  return std::min<size_t>(4 * (bit - 1) + sub_bucket, bucket_count - 1);
+}
+
+// Returns the middle of the values of |bucket|.
+uint64_t GetBucketValue(size_t bucket) {
+  if (bucket < 4) {
+    return bucket;
+  }
+  const uint32_t bit = static_cast<uint32_t>(bucket / 4 + 1);
+  const uint64_t sub_bucket = bucket % 4;
+  const uint64_t width = uint64_t{1} << (bit - 2);
+  return (4 + sub_bucket) * width + width / 2;
+}
+
+uint64_t ToMicroseconds(PreviewStats::Clock::duration duration) {
+  const int64_t us =
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  return us > 0 ? static_cast<uint64_t>(us) : 0;
+}
+
+}  // namespace
+
+void DurationHistogram::Record(uint64_t duration_us) {
+  buckets_[GetBucket(duration_us, kBucketCount)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+uint64_t DurationHistogram::GetCount() const {
+  uint64_t count = 0;
+  for (const std::atomic<uint32_t>& bucket : buckets_) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+uint64_t DurationHistogram::GetPercentile(double percentile) const {
+  // Buckets may change while they are read, which only shifts the result by
+  // the durations recorded meanwhile.
+  std::array<uint32_t, kBucketCount> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  const double clamped = std::clamp(percentile, 0.0, 100.0);
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * total)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return GetBucketValue(i);
+    }
+  }
+  return GetBucketValue(kBucketCount - 1);
+}
+
+void DurationHistogram::Reset() {
+  for (std::atomic<uint32_t>& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void PreviewStats::OnFrameDelivered(uint64_t sample_time_us,
+                                    Clock::time_point delivery_time) {
+  frames_delivered_.fetch_add(1, std::memory_order_relaxed);
+  const int64_t offset_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          delivery_time.time_since_epoch())
+          .count() -
+      static_cast<int64_t>(sample_time_us);
+  if (last_sample_time_us_ >= 0 &&
+      sample_time_us > static_cast<uint64_t>(last_sample_time_us_)) {
+    frame_intervals_.Record(sample_time_us -
+                            static_cast<uint64_t>(last_sample_time_us_));
+    if (offset_us < delivery_offset_us_) {
+      delivery_offset_us_ = offset_us;
+    }
+    const int64_t latency_us = offset_us - delivery_offset_us_;
+    scheduling_latencies_.Record(static_cast<uint64_t>(latency_us));
+    delivery_offset_us_ += latency_us / kLatencyBaselineRise;
+  } else {
+    // The first sample, or a restarted stream, sets the baseline.
+    delivery_offset_us_ = offset_us;
+    scheduling_latencies_.Record(0);
+  }
+  last_sample_time_us_ = static_cast<int64_t>(sample_time_us);
+}
+
+void PreviewStats::OnFrameConverted(Clock::duration conversion_time) {
+  conversion_times_.Record(ToMicroseconds(conversion_time));
+}
+
+void PreviewStats::OnFrameFailed() {
+  frames_failed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PreviewStats::OnFrameRendered(Clock::duration latency,
+                                   Clock::duration capture_latency) {
+  frames_rendered_.fetch_add(1, std::memory_order_relaxed);
+  capture_to_texture_times_.Record(ToMicroseconds(latency));
+  capture_latencies_.Record(ToMicroseconds(capture_latency));
+}
+
+void PreviewStats::OnFrameReleased(Clock::duration hold_time) {
+  texture_hold_times_.Record(ToMicroseconds(hold_time));
+}
+
+PreviewStatsSnapshot PreviewStats::GetSnapshot(uint64_t frames_dropped) const {
+  PreviewStatsSnapshot snapshot;
+  snapshot.frames_delivered = frames_delivered_.load(std::memory_order_relaxed);
+  snapshot.frames_failed = frames_failed_.load(std::memory_order_relaxed);
+  snapshot.frames_dropped = frames_dropped;
+  snapshot.frames_rendered = frames_rendered_.load(std::memory_order_relaxed);
+  snapshot.frame_interval_p50_us = frame_intervals_.GetPercentile(50);
+  snapshot.frame_interval_p99_us = frame_intervals_.GetPercentile(99);
+  snapshot.scheduling_latency_p50_us = scheduling_latencies_.GetPercentile(50);
+  snapshot.scheduling_latency_p99_us = scheduling_latencies_.GetPercentile(99);
+  snapshot.conversion_time_p50_us = conversion_times_.GetPercentile(50);
+  snapshot.conversion_time_p99_us = conversion_times_.GetPercentile(99);
+  snapshot.capture_to_texture_p50_us =
+      capture_to_texture_times_.GetPercentile(50);
+  snapshot.capture_to_texture_p99_us =
+      capture_to_texture_times_.GetPercentile(99);
+  snapshot.capture_latency_p50_us = capture_latencies_.GetPercentile(50);
+  snapshot.capture_latency_p99_us = capture_latencies_.GetPercentile(99);
+  snapshot.texture_hold_time_p50_us = texture_hold_times_.GetPercentile(50);
+  snapshot.texture_hold_time_p99_us = texture_hold_times_.GetPercentile(99);
+  return snapshot;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,155 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_STATS_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace camera_windows {
+
+// Histogram of durations in microseconds.
+//
+// Recording is a single relaxed atomic increment, so durations can be
+// recorded from any thread without locks. Each power of two is split into
+// four buckets, so percentiles are accurate to within 1/8 of their value.
+class DurationHistogram {
+ public:
+  DurationHistogram() { Reset(); }
+  virtual ~DurationHistogram() = default;
+
+  // Prevent copying.
+  DurationHistogram(DurationHistogram const&) = delete;
+  DurationHistogram& operator=(DurationHistogram const&) = delete;
+
+  // Adds a duration of |duration_us| microseconds.
+  void Record(uint64_t duration_us);
+
+  // Returns the number of recorded durations.
+  uint64_t GetCount() const;
+
+  // Returns the duration below which |percentile| percent of the recorded
+  // durations fall, or 0 if nothing was recorded.
+  uint64_t GetPercentile(double percentile) const;
+
+  // Clears all recorded durations.
+  void Reset();
+
+ private:
+  // Four buckets for each of 0 to 2^38 microseconds.
+  static constexpr size_t kBucketCount = 4 * 39;
+
+  std::array<std::atomic<uint32_t>, kBucketCount> buckets_;
+};
+
+// Point-in-time copy of the preview statistics of a camera.
+//
+// Durations are in microseconds.
+struct PreviewStatsSnapshot {
+  // Samples handed to the preview.
+  uint64_t frames_delivered = 0;
+  // Samples that could not be converted or decoded.
+  uint64_t frames_failed = 0;
+  // Converted frames replaced by newer frames before Flutter took them.
+  uint64_t frames_dropped = 0;
+  // Converted frames taken by Flutter for rendering.
+  uint64_t frames_rendered = 0;
+  // Samples skipped before they were read, to keep to the preview frame
+  // rate limit.
+  uint64_t frames_skipped = 0;
+
+  // Time between the presentation times of consecutive samples, as set by
+  // the camera.
+  uint64_t frame_interval_p50_us = 0;
+  uint64_t frame_interval_p99_us = 0;
+  // Time by which samples reached the preview later than their
+  // presentation times predict, compared to the earliest sample. Grows
+  // when the thread processing samples is held up.
+  uint64_t scheduling_latency_p50_us = 0;
+  uint64_t scheduling_latency_p99_us = 0;
+  // Time to convert or decode a sample into a texture frame.
+  uint64_t conversion_time_p50_us = 0;
+  uint64_t conversion_time_p99_us = 0;
+  // Time from the delivery of a sample until Flutter takes its frame.
+  uint64_t capture_to_texture_p50_us = 0;
+  uint64_t capture_to_texture_p99_us = 0;
+  // Time from the capture of a sample by the camera until Flutter takes its
+  // frame, including the buffering before the sample is delivered.
+  uint64_t capture_latency_p50_us = 0;
+  uint64_t capture_latency_p99_us = 0;
+  // Time Flutter holds a texture frame before releasing it.
+  uint64_t texture_hold_time_p50_us = 0;
+  uint64_t texture_hold_time_p99_us = 0;
+};
+
+// Collects counters and timings of the preview pipeline of a camera.
+//
+// The capture thread reports delivered and converted frames, while the
+// texture callback reports rendered and released frames. Reporting only
+// uses relaxed atomics, and is cheap enough to stay enabled.
+class PreviewStats {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  PreviewStats() {}
+  virtual ~PreviewStats() = default;
+
+  // Prevent copying.
+  PreviewStats(PreviewStats const&) = delete;
+  PreviewStats& operator=(PreviewStats const&) = delete;
+
+  // Reports a sample with presentation time |sample_time_us| handed to the
+  // preview at |delivery_time|. Only called by one thread at a time.
+  void OnFrameDelivered(uint64_t sample_time_us,
+                        Clock::time_point delivery_time);
+
+  // Same as above, with the sample delivered now.
+  void OnFrameDelivered(uint64_t sample_time_us) {
+    OnFrameDelivered(sample_time_us, Clock::now());
+  }
+
+  // Reports a sample converted into a texture frame in |conversion_time|.
+  void OnFrameConverted(Clock::duration conversion_time);
+
+  // Reports a sample that could not be converted.
+  void OnFrameFailed();
+
+  // Reports a texture frame taken by Flutter |latency| after its sample was
+  // delivered, and |capture_latency| after the camera captured it.
+  void OnFrameRendered(Clock::duration latency,
+                       Clock::duration capture_latency);
+
+  // Reports a texture frame released by Flutter after |hold_time|.
+  void OnFrameReleased(Clock::duration hold_time);
+
+  // Returns the current statistics. |frames_dropped| is counted by the
+  // frame mailbox and is passed in by the caller.
+  PreviewStatsSnapshot GetSnapshot(uint64_t frames_dropped) const;
+
+ private:
+  std::atomic<uint64_t> frames_delivered_ = 0;
+  std::atomic<uint64_t> frames_failed_ = 0;
+  std::atomic<uint64_t> frames_rendered_ = 0;
+
+  // Presentation time of the previous sample, or -1 before the first one.
+  int64_t last_sample_time_us_ = -1;
+  // Smallest difference between the delivery and presentation times of the
+  // samples so far, rising slowly so that drift between the clocks of the
+  // camera and the system is not counted as latency.
+  int64_t delivery_offset_us_ = 0;
+
+  DurationHistogram frame_intervals_;
+  DurationHistogram scheduling_latencies_;
+  DurationHistogram conversion_times_;
+  DurationHistogram capture_to_texture_times_;
+  DurationHistogram capture_latencies_;
+  DurationHistogram texture_hold_times_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_PREVIEW_STATS_H_
@@ -0,0 +1,33 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "recording_timer.h"
+
+namespace camera_windows {
+
+void RecordingTimer::Start(int64_t max_duration_ms) {
+  max_duration_ms_ = max_duration_ms;
+  start_timestamp_us_ = -1;
+  duration_us_ = 0;
+}
+
+void RecordingTimer::Update(uint64_t timestamp_us) {
+  if (start_timestamp_us_ < 0) {
+    start_timestamp_us_ = static_cast<int64_t>(timestamp_us);
+  }
+
+  // Timestamps from before the start are ignored instead of wrapping
+  // around.
+  const uint64_t start_us = static_cast<uint64_t>(start_timestamp_us_);
+  if (timestamp_us >= start_us) {
+    duration_us_ = timestamp_us - start_us;
+  }
+}
+
+bool RecordingTimer::HasReachedMaxDuration() const {
+  return max_duration_ms_ > 0 &&
+         duration_us_ >= static_cast<uint64_t>(max_duration_ms_) * 1000;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,46 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_RECORDING_TIMER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_RECORDING_TIMER_H_
+
+#include <cstdint>
+
+namespace camera_windows {
+
+// Tracks the duration of a video recording from capture timestamps.
+//
+// The first timestamp after |Start| marks the start of the recording, so the
+// duration does not depend on how long the capture engine takes to start.
+class RecordingTimer {
+ public:
+  RecordingTimer() {}
+  virtual ~RecordingTimer() = default;
+
+  // Starts timing a new recording. A negative |max_duration_ms| means the
+  // recording has no maximum duration.
+  void Start(int64_t max_duration_ms);
+
+  // Stops timing and clears the duration.
+  void Reset() { Start(-1); }
+
+  // Calculates the recording duration from the capture timestamp
+  // |timestamp_us|, in microseconds.
+  void Update(uint64_t timestamp_us);
+
+  // Returns the duration of the recording in microseconds.
+  uint64_t GetDuration() const { return duration_us_; }
+
+  // Returns true if the recording has a maximum duration and has reached it.
+  bool HasReachedMaxDuration() const;
+
+ private:
+  int64_t max_duration_ms_ = -1;
+  int64_t start_timestamp_us_ = -1;
+  uint64_t duration_us_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_RECORDING_TIMER_H_
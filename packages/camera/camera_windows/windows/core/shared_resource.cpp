@@ -0,0 +1,99 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "shared_resource.h"
+
+#include <cassert>
+#include <utility>
+
+namespace camera_windows {
+
+SharedResource::SharedResource(CreateFunction create, DestroyFunction destroy,
+                               Clock::duration idle_timeout)
+    : create_(std::move(create)),
+      destroy_(std::move(destroy)),
+      idle_timeout_(idle_timeout) {
+  assert(create_ && destroy_);
+}
+
+SharedResource::~SharedResource() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    assert(ref_count_ == 0);
+    stopping_ = true;
+  }
+  idle_changed_.notify_all();
+  if (idle_thread_.joinable()) {
+    idle_thread_.join();
+  }
+  if (created_) {
+    destroy_();
+  }
+}
+
+bool SharedResource::Acquire() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (!created_) {
+    if (!create_()) {
+      return false;
+    }
+    created_ = true;
+    create_count_++;
+  }
+  ref_count_++;
+  return true;
+}
+
+void SharedResource::Release() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    assert(ref_count_ > 0);
+    if (--ref_count_ > 0) {
+      return;
+    }
+    if (idle_timeout_ <= Clock::duration::zero()) {
+      destroy_();
+      created_ = false;
+      return;
+    }
+    idle_deadline_ = Clock::now() + idle_timeout_;
+    if (!idle_thread_.joinable()) {
+      idle_thread_ = std::thread([this]() { RunIdleTimer(); });
+    }
+  }
+  idle_changed_.notify_all();
+}
+
+size_t SharedResource::GetRefCount() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return ref_count_;
+}
+
+bool SharedResource::IsCreated() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return created_;
+}
+
+uint64_t SharedResource::GetCreateCount() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return create_count_;
+}
+
+void SharedResource::RunIdleTimer() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (!created_ || ref_count_ > 0) {
+      idle_changed_.wait(lock);
+    } else if (Clock::now() < idle_deadline_) {
+      // The resource may be acquired, or released again with a later
+      // deadline, in the meantime, so the state is checked again on wake up.
+      idle_changed_.wait_until(lock, idle_deadline_);
+    } else {
+      destroy_();
+      created_ = false;
+    }
+  }
+}
+
+}  // namespace camera_windows
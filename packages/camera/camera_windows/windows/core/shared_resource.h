@@ -0,0 +1,92 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_SHARED_RESOURCE_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_SHARED_RESOURCE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace camera_windows {
+
+// A reference-counted resource that is expensive to create, such as a
+// graphics device shared by all cameras.
+//
+// The resource is created by the first |Acquire|, and kept while it is
+// acquired. Once the last reference is released, it is kept for
+// |idle_timeout| more, so that closing a camera and opening another reuses
+// it, and is then destroyed on a background thread. A timeout of zero
+// destroys it as soon as it is released.
+//
+// The create and destroy functions are called with a lock held, so they
+// never run concurrently, and must not call back into the resource. All
+// methods may be called from any thread.
+class SharedResource {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Creates the resource, and returns false if it could not be created.
+  using CreateFunction = std::function<bool()>;
+
+  // Destroys the resource created by the last successful |CreateFunction|.
+  using DestroyFunction = std::function<void()>;
+
+  SharedResource(CreateFunction create, DestroyFunction destroy,
+                 Clock::duration idle_timeout);
+
+  // Destroys the resource if it still exists. It must not be acquired.
+  virtual ~SharedResource();
+
+  // Prevent copying.
+  SharedResource(SharedResource const&) = delete;
+  SharedResource& operator=(SharedResource const&) = delete;
+
+  // Adds a reference to the resource, creating it if it does not exist.
+  //
+  // Returns false, without adding a reference, if the resource could not be
+  // created.
+  bool Acquire();
+
+  // Releases a reference added by a successful |Acquire|.
+  void Release();
+
+  // Returns the number of references to the resource.
+  size_t GetRefCount() const;
+
+  // Returns true if the resource exists.
+  bool IsCreated() const;
+
+  // Returns the number of times the resource was created.
+  uint64_t GetCreateCount() const;
+
+ private:
+  // Destroys the resource once it has been idle for the timeout, until the
+  // resource is destroyed. Runs on |idle_thread_|.
+  void RunIdleTimer();
+
+  CreateFunction create_;
+  DestroyFunction destroy_;
+  const Clock::duration idle_timeout_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_changed_;
+  size_t ref_count_ = 0;
+  bool created_ = false;
+  bool stopping_ = false;
+  uint64_t create_count_ = 0;
+  // Time at which the unreferenced resource is destroyed.
+  Clock::time_point idle_deadline_;
+
+  // Started on the first release with a timeout.
+  std::thread idle_thread_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_SHARED_RESOURCE_H_
@@ -0,0 +1,34 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_SIMD_UTILS_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_SIMD_UTILS_H_
+
+// Architecture detection and intrinsics headers for the pixel kernels.
+//
+// Defines CAMERA_WINDOWS_ARCH_X86 or CAMERA_WINDOWS_ARCH_ARM64 for the target
+// architecture, and CAMERA_WINDOWS_TARGET for kernels that use instruction
+// sets newer than the compiler baseline.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+    defined(__i386__)
+#define CAMERA_WINDOWS_ARCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define CAMERA_WINDOWS_ARCH_ARM64 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only allow intrinsics inside functions compiled for the
+// matching instruction set. MSVC allows them everywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define CAMERA_WINDOWS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CAMERA_WINDOWS_TARGET(isa)
+#endif
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_SIMD_UTILS_H_
@@ -0,0 +1,114 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "strip_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+
+namespace camera_windows {
+
+// Strips of a |ParallelFor| call, shared with the helpers that run them.
+//
+// Helpers may only get to a job after the call returned, so the job is
+// reference counted, but |run_strip| is only used while strips are left to
+// claim, which is always before the call returns.
+struct StripPool::Job {
+  const StripFunction* run_strip = nullptr;
+  uint32_t row_count = 0;
+  uint32_t strip_count = 0;
+  // Rows of each strip, a multiple of the row alignment.
+  uint32_t strip_rows = 0;
+
+  std::atomic<uint32_t> next_strip = 0;
+
+  std::mutex mutex;
+  std::condition_variable strips_done;
+  uint32_t completed_strips = 0;
+};
+
+StripPool::StripPool(size_t helper_count) : helper_count_(helper_count) {
+  if (helper_count_ > 0) {
+    helpers_ = std::make_unique<WorkerPool>(helper_count_);
+  }
+}
+
+void StripPool::ParallelFor(uint32_t row_count, uint32_t min_strip_rows,
+                            uint32_t row_alignment,
+                            const StripFunction& run_strip) {
+  if (row_count == 0) {
+    return;
+  }
+  row_alignment = std::max(row_alignment, 1u);
+  min_strip_rows = std::max(min_strip_rows, 1u);
+
+  // Splits the rows evenly, rounding strips up to the alignment.
+  const uint64_t max_strips =
+      static_cast<uint64_t>(helper_count_ + 1) * kStripsPerThread;
+  const uint32_t wanted_strips = static_cast<uint32_t>(
+      std::min<uint64_t>(max_strips, row_count / min_strip_rows));
+  if (!helpers_ || wanted_strips <= 1) {
+    run_strip(0, row_count);
+    return;
+  }
+  uint32_t strip_rows = (row_count + wanted_strips - 1) / wanted_strips;
+  strip_rows = (strip_rows + row_alignment - 1) / row_alignment * row_alignment;
+  const uint32_t strip_count = (row_count + strip_rows - 1) / strip_rows;
+  if (strip_count <= 1) {
+    run_strip(0, row_count);
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->run_strip = &run_strip;
+  job->row_count = row_count;
+  job->strip_count = strip_count;
+  job->strip_rows = strip_rows;
+
+  // The calling thread runs strips too, so one fewer helper is needed.
+  const size_t helpers = std::min<size_t>(helper_count_, strip_count - 1);
+  for (size_t i = 0; i < helpers; i++) {
+    helpers_->Post([job]() { RunStrips(job.get()); });
+  }
+  RunStrips(job.get());
+
+  // Strips claimed by helpers may still be running.
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->strips_done.wait(
+      lock, [&job]() { return job->completed_strips == job->strip_count; });
+}
+
+// static
+void StripPool::RunStrips(Job* job) {
+  uint32_t completed = 0;
+  while (true) {
+    const uint32_t strip = job->next_strip.fetch_add(1);
+    if (strip >= job->strip_count) {
+      break;
+    }
+    const uint32_t begin = strip * job->strip_rows;
+    const uint32_t end = std::min(begin + job->strip_rows, job->row_count);
+    (*job->run_strip)(begin, end);
+    completed++;
+  }
+  if (completed == 0) {
+    return;
+  }
+
+  bool done = false;
+  {
+    const std::lock_guard<std::mutex> lock(job->mutex);
+    job->completed_strips += completed;
+    assert(job->completed_strips <= job->strip_count);
+    done = job->completed_strips == job->strip_count;
+  }
+  if (done) {
+    job->strips_done.notify_one();
+  }
+}
+
+}  // namespace camera_windows
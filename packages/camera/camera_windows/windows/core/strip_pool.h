@@ -0,0 +1,68 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_STRIP_POOL_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_STRIP_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "worker_pool.h"
+
+namespace camera_windows {
+
+// Splits work on the rows of a frame into horizontal strips, and runs them
+// in parallel on a bounded set of helper threads.
+//
+// The thread that calls |ParallelFor| runs strips itself, and helpers only
+// pick up strips that are still left when they get to them. A pool shared
+// by several cameras therefore caps the threads converting frames, while
+// each camera keeps converting its own frames when the helpers are busy
+// with those of another camera.
+class StripPool {
+ public:
+  // Runs the rows from |begin| up to, but not including, |end|.
+  using StripFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+  // Strips queued for each thread that may run them, so that threads that
+  // start late or run slowly can be evened out.
+  static constexpr uint32_t kStripsPerThread = 2;
+
+  // Starts |helper_count| helper threads. Without helpers, strips run on
+  // the calling thread only.
+  explicit StripPool(size_t helper_count);
+
+  // Joins the helper threads. No |ParallelFor| call may be running.
+  virtual ~StripPool() = default;
+
+  // Prevent copying.
+  StripPool(StripPool const&) = delete;
+  StripPool& operator=(StripPool const&) = delete;
+
+  // Runs |run_strip| over rows 0 to |row_count| in strips of at least
+  // |min_strip_rows| rows, starting at multiples of |row_alignment|, and
+  // returns once every strip has run. May be called from several threads
+  // at once.
+  void ParallelFor(uint32_t row_count, uint32_t min_strip_rows,
+                   uint32_t row_alignment, const StripFunction& run_strip);
+
+  // Returns the number of helper threads.
+  size_t GetHelperCount() const { return helper_count_; }
+
+ private:
+  struct Job;
+
+  // Runs unclaimed strips of |job| until none are left.
+  static void RunStrips(Job* job);
+
+  const size_t helper_count_;
+  // Null without helpers.
+  std::unique_ptr<WorkerPool> helpers_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_STRIP_POOL_H_
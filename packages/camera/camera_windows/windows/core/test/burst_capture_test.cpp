@@ -0,0 +1,168 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "burst_capture.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kWidth = 8;
+constexpr uint32_t kHeight = 4;
+
+// Frame interval of a 30 fps camera.
+constexpr uint64_t kFrameIntervalUs = 33333;
+
+// RGB32 frame whose bytes all hold |value|.
+struct TestFrame {
+  explicit TestFrame(uint8_t value)
+      : pixels(static_cast<size_t>(kWidth) * kHeight * 4, value) {
+    view.scanline0 = pixels.data();
+    view.buffer_start = pixels.data();
+    view.buffer_length = static_cast<uint32_t>(pixels.size());
+  }
+
+  std::vector<uint8_t> pixels;
+  FrameBufferView view;
+};
+
+// Records the frames taken by a burst.
+struct TakenFrames {
+  BurstCapture::FrameCallback GetCallback() {
+    return [this](uint32_t index, FrameRef frame) {
+      indices.push_back(index);
+      sample_times_us.push_back(frame->sample_time_us);
+      if (keep_frames) {
+        frames.push_back(std::move(frame));
+      }
+    };
+  }
+
+  bool keep_frames = false;
+  std::vector<uint32_t> indices;
+  std::vector<uint64_t> sample_times_us;
+  std::vector<FrameRef> frames;
+};
+
+// Sends |count| frames of a 30 fps camera to |burst|, starting at frame
+// |first|.
+void SendFrames(BurstCapture* burst, uint32_t first, uint32_t count) {
+  for (uint32_t i = first; i < first + count; i++) {
+    TestFrame frame(static_cast<uint8_t>(i));
+    burst->OnFrame(FrameFormat(), frame.view, kWidth, kHeight,
+                   i * kFrameIntervalUs);
+  }
+}
+
+}  // namespace
+
+TEST(BurstCapture, TakesConsecutiveFramesWithoutInterval) {
+  TakenFrames taken;
+  BurstCapture burst(3, 0, 4, taken.GetCallback());
+
+  SendFrames(&burst, 0, 5);
+
+  EXPECT_EQ(taken.indices, (std::vector<uint32_t>{0, 1, 2}));
+  EXPECT_EQ(taken.sample_times_us,
+            (std::vector<uint64_t>{0, kFrameIntervalUs, 2 * kFrameIntervalUs}));
+  EXPECT_TRUE(burst.IsComplete());
+  EXPECT_EQ(burst.GetTakenFrameCount(), 3u);
+}
+
+TEST(BurstCapture, TakesFramesAtInterval) {
+  TakenFrames taken;
+  BurstCapture burst(3, 100000, 4, taken.GetCallback());
+
+  SendFrames(&burst, 0, 10);
+
+  // Every third frame of a 30 fps camera, despite rounding of the frame
+  // times below the interval.
+  EXPECT_EQ(taken.sample_times_us,
+            (std::vector<uint64_t>{0, 3 * kFrameIntervalUs,
+                                   6 * kFrameIntervalUs}));
+}
+
+TEST(BurstCapture, KeepsIntervalShorterThanFrameInterval) {
+  TakenFrames taken;
+  BurstCapture burst(3, 10000, 4, taken.GetCallback());
+
+  SendFrames(&burst, 0, 3);
+
+  EXPECT_EQ(taken.indices.size(), 3u);
+}
+
+TEST(BurstCapture, CopiesFrames) {
+  TakenFrames taken;
+  taken.keep_frames = true;
+  BurstCapture burst(1, 0, 1, taken.GetCallback());
+
+  TestFrame frame(42);
+  ASSERT_TRUE(
+      burst.OnFrame(FrameFormat(), frame.view, kWidth, kHeight, 1234));
+
+  ASSERT_EQ(taken.frames.size(), 1u);
+  const FrameRef& copy = taken.frames[0];
+  EXPECT_EQ(copy->content, FrameContent::kCaptured);
+  EXPECT_EQ(copy->width, kWidth);
+  EXPECT_EQ(copy->height, kHeight);
+  EXPECT_EQ(copy->sample_time_us, 1234u);
+  EXPECT_EQ(copy->GetData()[0], 42);
+}
+
+TEST(BurstCapture, DelaysFramesWhilePoolIsInUse) {
+  TakenFrames taken;
+  taken.keep_frames = true;
+  BurstCapture burst(3, 0, 2, taken.GetCallback());
+
+  // Both pooled frames are still being encoded.
+  SendFrames(&burst, 0, 4);
+  EXPECT_EQ(taken.indices, (std::vector<uint32_t>{0, 1}));
+  EXPECT_EQ(burst.GetDelayedFrameCount(), 2u);
+  EXPECT_FALSE(burst.IsComplete());
+
+  // The burst carries on with the next frame once one is released.
+  taken.frames.clear();
+  SendFrames(&burst, 4, 1);
+  EXPECT_EQ(taken.indices, (std::vector<uint32_t>{0, 1, 2}));
+  EXPECT_EQ(taken.sample_times_us.back(), 4 * kFrameIntervalUs);
+  EXPECT_TRUE(burst.IsComplete());
+}
+
+TEST(BurstCapture, DoesNotCatchUpAfterDelay) {
+  TakenFrames taken;
+  taken.keep_frames = true;
+  BurstCapture burst(3, 2 * kFrameIntervalUs, 1, taken.GetCallback());
+
+  SendFrames(&burst, 0, 4);
+  EXPECT_EQ(taken.indices.size(), 1u);
+
+  // The second frame is taken late; the third is due one interval later.
+  taken.frames.clear();
+  SendFrames(&burst, 4, 1);
+  taken.frames.clear();
+  SendFrames(&burst, 5, 3);
+  EXPECT_EQ(taken.sample_times_us,
+            (std::vector<uint64_t>{0, 4 * kFrameIntervalUs,
+                                   6 * kFrameIntervalUs}));
+}
+
+TEST(BurstCapture, SkipsIncompleteFrames) {
+  TakenFrames taken;
+  BurstCapture burst(1, 0, 1, taken.GetCallback());
+
+  TestFrame frame(1);
+  frame.view.buffer_length = 4;
+  EXPECT_FALSE(burst.OnFrame(FrameFormat(), frame.view, kWidth, kHeight, 0));
+  EXPECT_EQ(burst.GetTakenFrameCount(), 0u);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,62 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "device_list_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+TEST(DeviceListCache, MissesUntilUpdated) {
+  DeviceListCache cache;
+  std::vector<std::string> names;
+
+  EXPECT_FALSE(cache.GetDeviceNames(&names));
+  EXPECT_EQ(cache.GetMissCount(), 1u);
+
+  cache.Update({"Front camera <id1>", "Virtual camera <id2>"});
+  ASSERT_TRUE(cache.GetDeviceNames(&names));
+  EXPECT_EQ(names, (std::vector<std::string>{"Front camera <id1>",
+                                             "Virtual camera <id2>"}));
+  EXPECT_EQ(cache.GetHitCount(), 1u);
+}
+
+TEST(DeviceListCache, CachesEmptyList) {
+  DeviceListCache cache;
+  cache.Update({});
+
+  std::vector<std::string> names = {"stale"};
+  EXPECT_TRUE(cache.GetDeviceNames(&names));
+  EXPECT_TRUE(names.empty());
+}
+
+TEST(DeviceListCache, DeviceChangesInvalidateList) {
+  DeviceListCache cache;
+  cache.Update({"Front camera <id1>"});
+
+  EXPECT_TRUE(cache.OnDevicesChanged());
+
+  std::vector<std::string> names;
+  EXPECT_FALSE(cache.GetDeviceNames(&names));
+}
+
+TEST(DeviceListCache, ReportsSeriesOfChangesOnce) {
+  DeviceListCache cache;
+
+  // A device arriving is reported for each of its interfaces.
+  EXPECT_TRUE(cache.OnDevicesChanged());
+  EXPECT_FALSE(cache.OnDevicesChanged());
+  EXPECT_FALSE(cache.OnDevicesChanged());
+
+  // Changes are reported again once the list has been enumerated.
+  cache.Update({"Front camera <id1>"});
+  EXPECT_TRUE(cache.OnDevicesChanged());
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,72 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_buffer_view.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+TEST(FrameBufferView, PackedRowsUseRowSizeAsStride) {
+  std::vector<uint8_t> buffer(40);
+  FrameBufferView view;
+  view.scanline0 = buffer.data();
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+
+  EXPECT_EQ(view.GetStride(20), 20);
+  EXPECT_TRUE(view.Contains(20, 2));
+  EXPECT_FALSE(view.Contains(20, 3));
+  EXPECT_FALSE(view.Contains(24, 2));
+}
+
+TEST(FrameBufferView, ContainsPaddedRows) {
+  // Three rows of 20 bytes with a pitch of 32 bytes. The last row does not
+  // need to be followed by padding.
+  std::vector<uint8_t> buffer(32 * 2 + 20);
+  FrameBufferView view;
+  view.scanline0 = buffer.data();
+  view.stride = 32;
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+
+  EXPECT_EQ(view.GetStride(20), 32);
+  EXPECT_TRUE(view.Contains(20, 3));
+  EXPECT_TRUE(view.Contains(32, 2));
+  EXPECT_FALSE(view.Contains(20, 4));
+  // Rows wider than the pitch would overlap.
+  EXPECT_FALSE(view.Contains(36, 2));
+}
+
+TEST(FrameBufferView, ContainsBottomUpRows) {
+  // Three rows of 20 bytes with a pitch of 24 bytes, where the top row is
+  // stored last.
+  std::vector<uint8_t> buffer(24 * 3);
+  FrameBufferView view;
+  view.scanline0 = buffer.data() + 24 * 2;
+  view.stride = -24;
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+
+  EXPECT_TRUE(view.Contains(20, 3));
+  EXPECT_TRUE(view.Contains(24, 3));
+  EXPECT_FALSE(view.Contains(20, 4));
+
+  // The top row must be followed by a full row.
+  view.buffer_length = 24 * 2 + 16;
+  EXPECT_FALSE(view.Contains(20, 3));
+}
+
+TEST(FrameBufferView, EmptyViewContainsNothing) {
+  FrameBufferView view;
+
+  EXPECT_FALSE(view.Contains(4, 1));
+}
+
+}  // namespace test
+}  // namespace camera_windows
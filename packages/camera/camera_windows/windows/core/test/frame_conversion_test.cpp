@@ -0,0 +1,360 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_conversion.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "pixel_conversion.h"
+#include "yuv_conversion.h"
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Returns a view of the whole |buffer|, with rows starting at |scanline0|.
+FrameBufferView CreateView(const std::vector<uint8_t>& buffer,
+                           const uint8_t* scanline0, int32_t stride) {
+  FrameBufferView view;
+  view.scanline0 = scanline0;
+  view.stride = stride;
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+  return view;
+}
+
+// Returns |size| bytes with a repeating, non-uniform pattern.
+std::vector<uint8_t> CreatePattern(size_t size) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  return data;
+}
+
+// Scales a packed RGBA frame with |scaler|.
+std::vector<uint8_t> ScaleRGBAFrame(const std::vector<uint8_t>& frame,
+                                    uint32_t width, uint32_t height,
+                                    uint32_t dst_width, uint32_t dst_height,
+                                    bool mirror) {
+  std::vector<uint8_t> scaled(dst_width * dst_height * 4);
+  FrameScaler scaler;
+  scaler.Scale(
+      [&frame, width](uint32_t y, uint8_t*) {
+        return frame.data() + static_cast<size_t>(y) * width * 4;
+      },
+      SourcePixelOrder::kRGBA, width, height, scaled.data(), dst_width,
+      dst_height, GetScaleFilter(width, height, dst_width, dst_height),
+      mirror);
+  return scaled;
+}
+
+// Copies |region| out of a packed RGBA frame |width| pixels wide, flipping
+// each row if |mirror| is true.
+std::vector<uint8_t> CropRGBAFrame(const std::vector<uint8_t>& frame,
+                                   uint32_t width, const FrameRegion& region,
+                                   bool mirror) {
+  std::vector<uint8_t> cropped;
+  for (uint32_t y = region.y; y < region.y + region.height; y++) {
+    for (uint32_t i = 0; i < region.width; i++) {
+      const uint32_t x = region.x + (mirror ? region.width - 1 - i : i);
+      const uint8_t* pixel = frame.data() + (static_cast<size_t>(y) * width +
+                                             x) * 4;
+      cropped.insert(cropped.end(), pixel, pixel + 4);
+    }
+  }
+  return cropped;
+}
+
+}  // namespace
+
+TEST(FrameConversion, ConvertsRGB32Frame) {
+  const uint32_t width = 6;
+  const uint32_t height = 3;
+  const std::vector<uint8_t> buffer = CreatePattern(width * height * 4);
+
+  std::vector<uint8_t> expected(buffer.size());
+  ConvertRGB32ToRGBA(buffer.data(), width * 4, expected.data(), width, height,
+                     true);
+
+  // Packed rows are described with a zero stride.
+  std::vector<uint8_t> converted(buffer.size());
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kRGB32;
+  EXPECT_TRUE(ConvertFrameToRGBA(format, CreateView(buffer, buffer.data(), 0),
+                                 converted.data(), width, height, true));
+  EXPECT_EQ(converted, expected);
+}
+
+TEST(FrameConversion, ConvertsLargeFramesInStripsLikeSerially) {
+  // Three strips of 334 rows, so NV12 strips start on even rows, and the
+  // odd last row shares its chroma row with no other.
+  const uint32_t width = 1024;
+  const uint32_t height = 1001;
+  const uint32_t chroma_height = (height + 1) / 2;
+  StripPool pool(3);
+
+  for (PixelFormat pixel_format :
+       {PixelFormat::kRGB32, PixelFormat::kNV12, PixelFormat::kYUY2}) {
+    FrameFormat format;
+    format.pixel_format = pixel_format;
+    uint32_t row_size = width * 4;
+    if (pixel_format == PixelFormat::kNV12) {
+      row_size = width;
+    } else if (pixel_format == PixelFormat::kYUY2) {
+      row_size = width * 2;
+    }
+    const int32_t stride = static_cast<int32_t>(row_size + 32);
+    const uint32_t rows =
+        pixel_format == PixelFormat::kNV12 ? height + chroma_height : height;
+    const std::vector<uint8_t> buffer = CreatePattern(stride * rows);
+    const FrameBufferView view = CreateView(buffer, buffer.data(), stride);
+
+    std::vector<uint8_t> expected(width * height * 4);
+    ASSERT_TRUE(ConvertFrameToRGBA(format, view, expected.data(), width,
+                                   height, true));
+    std::vector<uint8_t> converted(width * height * 4);
+    ASSERT_TRUE(ConvertFrameToRGBA(format, view, converted.data(), width,
+                                   height, true, &pool));
+    EXPECT_EQ(converted, expected);
+  }
+}
+
+TEST(FrameConversion, ConvertsNV12FrameWithPaddedRows) {
+  const uint32_t width = 10;
+  const uint32_t height = 4;
+  const int32_t stride = 16;
+  // Four luma rows followed by two chroma rows.
+  const std::vector<uint8_t> buffer = CreatePattern(stride * (height + 2));
+
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kNV12;
+  format.color_space = {YuvMatrix::kBT709, YuvRange::kFull};
+
+  std::vector<uint8_t> expected(width * height * 4);
+  ConvertNV12ToRGBA(buffer.data(), stride, buffer.data() + stride * height,
+                    stride, expected.data(), width, height,
+                    format.color_space, false);
+
+  std::vector<uint8_t> converted(expected.size());
+  EXPECT_TRUE(ConvertFrameToRGBA(format,
+                                 CreateView(buffer, buffer.data(), stride),
+                                 converted.data(), width, height, false));
+  EXPECT_EQ(converted, expected);
+}
+
+TEST(FrameConversion, ConvertsYUY2Frame) {
+  const uint32_t width = 12;
+  const uint32_t height = 2;
+  const std::vector<uint8_t> buffer = CreatePattern(width * height * 2);
+
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kYUY2;
+
+  std::vector<uint8_t> expected(width * height * 4);
+  ConvertYUY2ToRGBA(buffer.data(), width * 2, expected.data(), width, height,
+                    format.color_space, false);
+
+  std::vector<uint8_t> converted(expected.size());
+  EXPECT_TRUE(ConvertFrameToRGBA(format, CreateView(buffer, buffer.data(), 0),
+                                 converted.data(), width, height, false));
+  EXPECT_EQ(converted, expected);
+}
+
+TEST(FrameConversion, ScalesNV12FrameLikeConvertThenScale) {
+  const uint32_t width = 20;
+  const uint32_t height = 10;
+  const int32_t stride = 24;
+  const std::vector<uint8_t> buffer = CreatePattern(stride * (height + 5));
+
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kNV12;
+  const FrameBufferView view = CreateView(buffer, buffer.data(), stride);
+
+  std::vector<uint8_t> converted(width * height * 4);
+  ASSERT_TRUE(ConvertFrameToRGBA(format, view, converted.data(), width,
+                                 height, false));
+
+  // Box and bilinear filtering.
+  FrameScaler scaler;
+  for (uint32_t dst_width : {6u, 15u}) {
+    const uint32_t dst_height = dst_width / 2;
+    std::vector<uint8_t> scaled(dst_width * dst_height * 4);
+    EXPECT_TRUE(ScaleFrameToRGBA(format, view, width, height, scaled.data(),
+                                 dst_width, dst_height, true, &scaler));
+    EXPECT_EQ(scaled, ScaleRGBAFrame(converted, width, height, dst_width,
+                                     dst_height, true));
+  }
+}
+
+TEST(FrameConversion, ScalesBottomUpRGB32Frame) {
+  const uint32_t width = 9;
+  const uint32_t height = 6;
+  const int32_t stride = -static_cast<int32_t>(width * 4);
+  const std::vector<uint8_t> buffer = CreatePattern(width * height * 4);
+  const FrameBufferView view =
+      CreateView(buffer, buffer.data() + width * 4 * (height - 1), stride);
+
+  FrameFormat format;
+  std::vector<uint8_t> converted(width * height * 4);
+  ASSERT_TRUE(ConvertFrameToRGBA(format, view, converted.data(), width,
+                                 height, false));
+
+  FrameScaler scaler;
+  std::vector<uint8_t> scaled(4 * 3 * 4);
+  EXPECT_TRUE(ScaleFrameToRGBA(format, view, width, height, scaled.data(), 4,
+                               3, false, &scaler));
+  EXPECT_EQ(scaled, ScaleRGBAFrame(converted, width, height, 4, 3, false));
+}
+
+TEST(FrameConversion, RejectsUnsupportedScales) {
+  const uint32_t width = 32;
+  const uint32_t height = 16;
+  const std::vector<uint8_t> buffer = CreatePattern(width * height * 4);
+  std::vector<uint8_t> scaled(width * 2 * height * 4);
+  const FrameBufferView view = CreateView(buffer, buffer.data(), 0);
+
+  FrameFormat format;
+  FrameScaler scaler;
+  EXPECT_FALSE(ScaleFrameToRGBA(format, view, width, height, scaled.data(),
+                                width * 2, height, false, &scaler));
+  EXPECT_FALSE(ScaleFrameToRGBA(format, view, width, height, scaled.data(),
+                                width / 16, height / 2, false, &scaler));
+  EXPECT_TRUE(ScaleFrameToRGBA(format, view, width, height, scaled.data(),
+                               width / 8, height / 8, false, &scaler));
+}
+
+TEST(FrameConversion, ConvertsFrameRegionLikeCroppedFrame) {
+  const uint32_t width = 16;
+  const uint32_t height = 10;
+  const FrameRegion region = {4, 2, 8, 6};
+  StripPool pool(1);
+  FrameScaler scaler;
+
+  for (PixelFormat pixel_format :
+       {PixelFormat::kRGB32, PixelFormat::kNV12, PixelFormat::kYUY2}) {
+    FrameFormat format;
+    format.pixel_format = pixel_format;
+    const int32_t stride = 80;
+    const std::vector<uint8_t> buffer = CreatePattern(stride * height * 2);
+    const FrameBufferView view = CreateView(buffer, buffer.data(), stride);
+
+    std::vector<uint8_t> converted(width * height * 4);
+    ASSERT_TRUE(ConvertFrameToRGBA(format, view, converted.data(), width,
+                                   height, false));
+
+    for (bool mirror : {false, true}) {
+      const std::vector<uint8_t> cropped =
+          CropRGBAFrame(converted, width, region, mirror);
+      std::vector<uint8_t> region_rgba(region.width * region.height * 4);
+      EXPECT_TRUE(ConvertFrameRegionToRGBA(
+          format, view, width, height, region, region_rgba.data(),
+          region.width, region.height, mirror, nullptr, &pool));
+      EXPECT_EQ(region_rgba, cropped);
+
+      // The region is scaled in the same pass.
+      std::vector<uint8_t> scaled(4 * 3 * 4);
+      EXPECT_TRUE(ConvertFrameRegionToRGBA(format, view, width, height,
+                                           region, scaled.data(), 4, 3,
+                                           mirror, &scaler, nullptr));
+      EXPECT_EQ(scaled, ScaleRGBAFrame(CropRGBAFrame(converted, width,
+                                                     region, false),
+                                       region.width, region.height, 4, 3,
+                                       mirror));
+    }
+  }
+}
+
+TEST(FrameConversion, RejectsInvalidFrameRegions) {
+  const uint32_t width = 8;
+  const uint32_t height = 4;
+  const std::vector<uint8_t> buffer = CreatePattern(width * height * 4);
+  const FrameBufferView view = CreateView(buffer, buffer.data(), 0);
+  std::vector<uint8_t> converted(width * height * 4, 0xCD);
+  const std::vector<uint8_t> untouched = converted;
+  FrameScaler scaler;
+
+  FrameFormat rgb32;
+  FrameFormat nv12;
+  nv12.pixel_format = PixelFormat::kNV12;
+  FrameFormat yuy2;
+  yuy2.pixel_format = PixelFormat::kYUY2;
+
+  // Outside the frame.
+  EXPECT_FALSE(ConvertFrameRegionToRGBA(rgb32, view, width, height,
+                                        {4, 0, 6, 2}, converted.data(), 6, 2,
+                                        false, &scaler, nullptr));
+  EXPECT_FALSE(ConvertFrameRegionToRGBA(rgb32, view, width, height,
+                                        {0, 0, 0, 2}, converted.data(), 0, 2,
+                                        false, &scaler, nullptr));
+  // Splitting chroma samples.
+  EXPECT_FALSE(ConvertFrameRegionToRGBA(yuy2, view, width, height,
+                                        {1, 0, 4, 2}, converted.data(), 4, 2,
+                                        false, &scaler, nullptr));
+  EXPECT_FALSE(ConvertFrameRegionToRGBA(nv12, view, width, height,
+                                        {0, 1, 4, 2}, converted.data(), 4, 2,
+                                        false, &scaler, nullptr));
+  // Scaled up, or scaled without a scaler.
+  EXPECT_FALSE(ConvertFrameRegionToRGBA(rgb32, view, width, height,
+                                        {0, 0, 2, 2}, converted.data(), 4, 4,
+                                        false, &scaler, nullptr));
+  EXPECT_FALSE(ConvertFrameRegionToRGBA(rgb32, view, width, height,
+                                        {0, 0, 4, 4}, converted.data(), 2, 2,
+                                        false, nullptr, nullptr));
+
+  EXPECT_EQ(converted, untouched);
+
+  // RGB32 regions may start at any pixel.
+  EXPECT_TRUE(ConvertFrameRegionToRGBA(rgb32, view, width, height,
+                                       {3, 1, 5, 3}, converted.data(), 5, 3,
+                                       false, &scaler, nullptr));
+}
+
+TEST(FrameConversion, RejectsIncompleteFrames) {
+  const uint32_t width = 8;
+  const uint32_t height = 4;
+  std::vector<uint8_t> converted(width * height * 4, 0xCD);
+  const std::vector<uint8_t> untouched = converted;
+
+  // The NV12 chroma plane is missing.
+  const std::vector<uint8_t> luma_only = CreatePattern(width * height);
+  FrameFormat nv12;
+  nv12.pixel_format = PixelFormat::kNV12;
+  EXPECT_FALSE(ConvertFrameToRGBA(nv12,
+                                  CreateView(luma_only, luma_only.data(), 0),
+                                  converted.data(), width, height, false));
+
+  // Bottom-up NV12 frames do not exist.
+  const std::vector<uint8_t> nv12_frame = CreatePattern(width * height * 2);
+  EXPECT_FALSE(ConvertFrameToRGBA(
+      nv12,
+      CreateView(nv12_frame, nv12_frame.data() + width * (height - 1),
+                 -static_cast<int32_t>(width)),
+      converted.data(), width, height, false));
+
+  // The RGB32 frame is one row short.
+  const std::vector<uint8_t> short_frame =
+      CreatePattern(width * (height - 1) * 4);
+  FrameFormat rgb32;
+  EXPECT_FALSE(
+      ConvertFrameToRGBA(rgb32, CreateView(short_frame, short_frame.data(), 0),
+                         converted.data(), width, height, false));
+
+  // Compressed frames are decoded instead.
+  FrameFormat mjpg;
+  mjpg.pixel_format = PixelFormat::kMJPG;
+  const std::vector<uint8_t> mjpg_frame = CreatePattern(width * height * 4);
+  EXPECT_FALSE(
+      ConvertFrameToRGBA(mjpg, CreateView(mjpg_frame, mjpg_frame.data(), 0),
+                         converted.data(), width, height, false));
+
+  EXPECT_EQ(converted, untouched);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,186 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_mailbox.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Frame used by the stress tests. Every element holds the frame sequence
+// number, so a frame that is read while being written is detected.
+using TestFrame = std::vector<uint64_t>;
+
+constexpr size_t kTestFrameSize = 4096;
+
+struct StressTestResult {
+  uint64_t published = 0;
+  uint64_t dropped = 0;
+  uint64_t taken = 0;
+  bool torn_frame_seen = false;
+  bool out_of_order_frame_seen = false;
+};
+
+// Runs one producer and one consumer thread against a mailbox.
+//
+// The producer publishes |frame_count| frames, sleeping |producer_delay|
+// between frames. The consumer polls for frames every |consumer_delay| until
+// the producer is done.
+StressTestResult RunStressTest(uint64_t frame_count,
+                               std::chrono::microseconds producer_delay,
+                               std::chrono::microseconds consumer_delay) {
+  FrameMailbox<TestFrame> mailbox;
+  std::atomic<bool> producer_done = false;
+  StressTestResult result;
+
+  std::thread producer([&]() {
+    for (uint64_t sequence = 1; sequence <= frame_count; sequence++) {
+      TestFrame& frame = mailbox.GetWriteSlot();
+      frame.assign(kTestFrameSize, sequence);
+      mailbox.Publish();
+      if (producer_delay.count() > 0) {
+        std::this_thread::sleep_for(producer_delay);
+      }
+    }
+    producer_done = true;
+  });
+
+  std::thread consumer([&]() {
+    uint64_t last_sequence = 0;
+    auto take_frame = [&]() {
+      if (!mailbox.TakeNewest()) {
+        return false;
+      }
+      const TestFrame& frame = mailbox.GetReadSlot();
+      if (frame.size() != kTestFrameSize) {
+        result.torn_frame_seen = true;
+        return true;
+      }
+      const uint64_t sequence = frame.front();
+      for (uint64_t value : frame) {
+        if (value != sequence) {
+          result.torn_frame_seen = true;
+          break;
+        }
+      }
+      if (sequence <= last_sequence) {
+        result.out_of_order_frame_seen = true;
+      }
+      last_sequence = sequence;
+      result.taken++;
+      return true;
+    };
+
+    while (!producer_done) {
+      take_frame();
+      if (consumer_delay.count() > 0) {
+        std::this_thread::sleep_for(consumer_delay);
+      }
+    }
+    // Takes the last frame, if it is still pending.
+    take_frame();
+  });
+
+  producer.join();
+  consumer.join();
+
+  result.published = mailbox.GetPublishedFrameCount();
+  result.dropped = mailbox.GetDroppedFrameCount();
+  return result;
+}
+
+}  // namespace
+
+TEST(FrameMailbox, TakeNewestReturnsFalseBeforeFirstPublish) {
+  FrameMailbox<int> mailbox;
+
+  EXPECT_FALSE(mailbox.TakeNewest());
+  EXPECT_EQ(mailbox.GetPublishedFrameCount(), 0u);
+  EXPECT_EQ(mailbox.GetDroppedFrameCount(), 0u);
+}
+
+TEST(FrameMailbox, TakeNewestReturnsLatestFrameAndCountsDroppedFrames) {
+  FrameMailbox<int> mailbox;
+
+  for (int frame = 1; frame <= 3; frame++) {
+    mailbox.GetWriteSlot() = frame;
+    mailbox.Publish();
+  }
+
+  ASSERT_TRUE(mailbox.TakeNewest());
+  EXPECT_EQ(mailbox.GetReadSlot(), 3);
+  EXPECT_EQ(mailbox.GetPublishedFrameCount(), 3u);
+  EXPECT_EQ(mailbox.GetDroppedFrameCount(), 2u);
+
+  // The read slot keeps the taken frame until a new one is published.
+  EXPECT_FALSE(mailbox.TakeNewest());
+  EXPECT_EQ(mailbox.GetReadSlot(), 3);
+
+  mailbox.GetWriteSlot() = 4;
+  mailbox.Publish();
+  ASSERT_TRUE(mailbox.TakeNewest());
+  EXPECT_EQ(mailbox.GetReadSlot(), 4);
+  EXPECT_EQ(mailbox.GetDroppedFrameCount(), 2u);
+}
+
+TEST(FrameMailbox, PublishNeverHandsOutTheReadSlot) {
+  FrameMailbox<int> mailbox;
+
+  mailbox.GetWriteSlot() = 1;
+  mailbox.Publish();
+  ASSERT_TRUE(mailbox.TakeNewest());
+  const int* read_slot = &mailbox.GetReadSlot();
+
+  // However often the producer publishes, it must not write to the slot the
+  // consumer is reading from.
+  for (int frame = 2; frame < 10; frame++) {
+    EXPECT_NE(&mailbox.GetWriteSlot(), read_slot);
+    mailbox.GetWriteSlot() = frame;
+    mailbox.Publish();
+  }
+  EXPECT_EQ(mailbox.GetReadSlot(), 1);
+}
+
+TEST(FrameMailbox, StressTestWithFastProducer) {
+  const StressTestResult result = RunStressTest(
+      2000, std::chrono::microseconds(0), std::chrono::microseconds(200));
+
+  EXPECT_FALSE(result.torn_frame_seen);
+  EXPECT_FALSE(result.out_of_order_frame_seen);
+  EXPECT_EQ(result.published, 2000u);
+  EXPECT_GT(result.dropped, 0u);
+  EXPECT_EQ(result.taken + result.dropped, result.published);
+}
+
+TEST(FrameMailbox, StressTestWithFastConsumer) {
+  const StressTestResult result = RunStressTest(
+      500, std::chrono::microseconds(200), std::chrono::microseconds(0));
+
+  EXPECT_FALSE(result.torn_frame_seen);
+  EXPECT_FALSE(result.out_of_order_frame_seen);
+  EXPECT_EQ(result.published, 500u);
+  EXPECT_EQ(result.taken + result.dropped, result.published);
+}
+
+TEST(FrameMailbox, StressTestWithoutDelays) {
+  const StressTestResult result = RunStressTest(
+      20000, std::chrono::microseconds(0), std::chrono::microseconds(0));
+
+  EXPECT_FALSE(result.torn_frame_seen);
+  EXPECT_FALSE(result.out_of_order_frame_seen);
+  EXPECT_EQ(result.published, 20000u);
+  EXPECT_EQ(result.taken + result.dropped, result.published);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,75 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_pacer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_conversion.h"
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+constexpr uint32_t kWidth = 1920;
+constexpr uint32_t kHeight = 1080;
+// Frames delivered per second by the synthetic camera.
+constexpr int kCameraFrameRate = 60;
+
+// Runs one second of a synthetic 60 fps 1080p NV12 camera through the
+// preview path, pacing frames to state.range(0) fps (0 for no limit) and
+// converting each processed frame to RGBA, mirrored like the preview.
+void BM_PacePreviewFrames(benchmark::State& state) {
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kNV12;
+  const std::vector<uint8_t> source(
+      static_cast<size_t>(kWidth) * kHeight * 3 / 2, 0x80);
+  std::vector<uint8_t> destination(static_cast<size_t>(kWidth) * kHeight * 4);
+  FrameBufferView view;
+  view.scanline0 = source.data();
+  view.buffer_start = source.data();
+  view.buffer_length = static_cast<uint32_t>(source.size());
+
+  FramePacer pacer;
+  pacer.SetMaxFrameRate(static_cast<double>(state.range(0)));
+  uint64_t sample_time_us = 0;
+  int64_t converted_frames = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < kCameraFrameRate; i++) {
+      sample_time_us += 1000000 / kCameraFrameRate;
+      if (!pacer.ShouldProcessFrame(sample_time_us)) {
+        continue;
+      }
+      if (!ConvertFrameToRGBA(format, view, destination.data(), kWidth,
+                              kHeight, true)) {
+        state.SkipWithError("Failed to convert frame");
+        return;
+      }
+      converted_frames++;
+      benchmark::DoNotOptimize(destination.data());
+      benchmark::ClobberMemory();
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * kCameraFrameRate);
+  state.counters["converted_fps"] = benchmark::Counter(
+      static_cast<double>(converted_frames) / state.iterations());
+}
+
+BENCHMARK(BM_PacePreviewFrames)
+    ->ArgName("max_fps")
+    ->Arg(0)
+    ->Arg(30)
+    ->Arg(15)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,138 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_pacer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Returns the sample times of |count| frames of a camera running at
+// |frame_rate|, with timestamps off by up to |jitter_us|.
+std::vector<uint64_t> CreateSampleTimes(double frame_rate, int count,
+                                        int64_t jitter_us) {
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int64_t> jitter(-jitter_us, jitter_us);
+  std::vector<uint64_t> times;
+  for (int i = 0; i < count; i++) {
+    const int64_t time_us =
+        1000000 + static_cast<int64_t>(i * 1000000.0 / frame_rate);
+    times.push_back(static_cast<uint64_t>(time_us + jitter(random)));
+  }
+  return times;
+}
+
+// Returns the sample times of the frames the pacer processes.
+std::vector<uint64_t> Pace(FramePacer* pacer,
+                           const std::vector<uint64_t>& times) {
+  std::vector<uint64_t> processed;
+  for (uint64_t time_us : times) {
+    if (pacer->ShouldProcessFrame(time_us)) {
+      processed.push_back(time_us);
+    }
+  }
+  return processed;
+}
+
+}  // namespace
+
+TEST(FramePacer, ProcessesEveryFrameWithoutLimit) {
+  FramePacer pacer;
+  const std::vector<uint64_t> times = CreateSampleTimes(60, 120, 0);
+
+  EXPECT_EQ(Pace(&pacer, times).size(), times.size());
+  EXPECT_EQ(pacer.GetSkippedFrameCount(), 0u);
+}
+
+TEST(FramePacer, HalvesFrameRateOfJitteryCamera) {
+  FramePacer pacer;
+  pacer.SetMaxFrameRate(30);
+  // Two seconds of a 60 fps camera with timestamps off by up to 2 ms.
+  const std::vector<uint64_t> times = CreateSampleTimes(60, 120, 2000);
+
+  const std::vector<uint64_t> processed = Pace(&pacer, times);
+
+  EXPECT_EQ(processed.size(), 60u);
+  EXPECT_EQ(pacer.GetSkippedFrameCount(), 60u);
+  for (size_t i = 1; i < processed.size(); i++) {
+    const uint64_t interval_us = processed[i] - processed[i - 1];
+    EXPECT_GE(interval_us, 33333u - 4000u);
+    EXPECT_LE(interval_us, 33333u + 4000u);
+  }
+}
+
+TEST(FramePacer, KeepsAverageRateForUnevenRatios) {
+  FramePacer pacer;
+  pacer.SetMaxFrameRate(24);
+  // Ten seconds of a 60 fps camera.
+  const std::vector<uint64_t> times = CreateSampleTimes(60, 600, 1000);
+
+  const size_t processed = Pace(&pacer, times).size();
+
+  // Frames only fall on the 24 fps schedule every 2.5 frames, so frames are
+  // processed at the first one past each slot, with at most a frame of
+  // difference over the whole run.
+  EXPECT_GE(processed, 199u);
+  EXPECT_LE(processed, 241u);
+}
+
+TEST(FramePacer, DoesNotHalveCameraRunningAtLimit) {
+  FramePacer pacer;
+  pacer.SetMaxFrameRate(30);
+  const std::vector<uint64_t> times = CreateSampleTimes(29.97, 90, 3000);
+
+  EXPECT_EQ(Pace(&pacer, times).size(), times.size());
+}
+
+TEST(FramePacer, RestartsScheduleAfterGap) {
+  FramePacer pacer;
+  pacer.SetMaxFrameRate(10);
+
+  EXPECT_TRUE(pacer.ShouldProcessFrame(1000000));
+  EXPECT_FALSE(pacer.ShouldProcessFrame(1050000));
+  // No frames arrive for a second; the next ones are not processed as a
+  // burst to catch up.
+  EXPECT_TRUE(pacer.ShouldProcessFrame(2100000));
+  EXPECT_FALSE(pacer.ShouldProcessFrame(2133000));
+  EXPECT_FALSE(pacer.ShouldProcessFrame(2166000));
+  EXPECT_TRUE(pacer.ShouldProcessFrame(2200000));
+}
+
+TEST(FramePacer, RestartsScheduleWhenSampleTimesGoBack) {
+  FramePacer pacer;
+  pacer.SetMaxFrameRate(10);
+
+  EXPECT_TRUE(pacer.ShouldProcessFrame(5000000));
+  // A restarted preview stream starts again from low sample times.
+  EXPECT_TRUE(pacer.ShouldProcessFrame(0));
+  EXPECT_FALSE(pacer.ShouldProcessFrame(33000));
+  EXPECT_TRUE(pacer.ShouldProcessFrame(100000));
+}
+
+TEST(FramePacer, AppliesNewLimitFromNextFrame) {
+  FramePacer pacer;
+  pacer.SetMaxFrameRate(10);
+  EXPECT_EQ(pacer.GetFrameInterval(), 100000u);
+
+  EXPECT_TRUE(pacer.ShouldProcessFrame(1000000));
+  EXPECT_FALSE(pacer.ShouldProcessFrame(1033000));
+
+  pacer.SetMaxFrameRate(0);
+  EXPECT_EQ(pacer.GetFrameInterval(), 0u);
+  EXPECT_TRUE(pacer.ShouldProcessFrame(1066000));
+  EXPECT_TRUE(pacer.ShouldProcessFrame(1100000));
+
+  pacer.SetMaxFrameRate(-1);
+  EXPECT_EQ(pacer.GetFrameInterval(), 0u);
+}
+
+}  // namespace test
+}  // namespace camera_windows
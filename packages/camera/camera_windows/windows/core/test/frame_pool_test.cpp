@@ -0,0 +1,268 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+TEST(FramePool, AcquiredFrameIsUniqueWithDefaultMetadata) {
+  FramePool pool;
+
+  FrameRef frame = pool.Acquire(64);
+
+  ASSERT_TRUE(frame);
+  EXPECT_TRUE(frame.IsUnique());
+  EXPECT_EQ(frame->GetSize(), 64u);
+  EXPECT_EQ(frame->content, FrameContent::kRGBA);
+  EXPECT_EQ(frame->width, 0u);
+  EXPECT_EQ(frame->sample_time_us, 0u);
+  EXPECT_FALSE(frame->mirrored);
+  EXPECT_EQ(pool.GetFramesInUse(), 1u);
+}
+
+TEST(FramePool, SharedFrameReturnsToPoolWithLastReference) {
+  FramePool pool;
+  FrameRef frame = pool.Acquire(16);
+  PooledFrame* writable = frame.GetMutable();
+  writable->width = 4;
+  writable->height = 1;
+  writable->stride = 16;
+  writable->sample_time_us = 1234;
+  writable->GetData()[0] = 42;
+
+  FrameRef preview = frame;
+  FrameRef stream = frame;
+  frame.reset();
+
+  EXPECT_FALSE(preview.IsUnique());
+  EXPECT_EQ(preview.get(), stream.get());
+  EXPECT_EQ(stream->sample_time_us, 1234u);
+  EXPECT_EQ(stream->GetData()[0], 42);
+  EXPECT_EQ(pool.GetFramesInUse(), 1u);
+
+  preview.reset();
+  EXPECT_TRUE(stream.IsUnique());
+  EXPECT_EQ(pool.GetFramesInUse(), 1u);
+
+  stream.reset();
+  EXPECT_EQ(pool.GetFramesInUse(), 0u);
+}
+
+TEST(FramePool, MovedReferenceKeepsCount) {
+  FramePool pool;
+  FrameRef frame = pool.Acquire(16);
+
+  FrameRef moved = std::move(frame);
+  FrameRef assigned;
+  assigned = moved;
+
+  EXPECT_FALSE(frame);
+  EXPECT_EQ(moved.get(), assigned.get());
+  EXPECT_FALSE(moved.IsUnique());
+  moved.reset();
+  EXPECT_TRUE(assigned.IsUnique());
+  assigned.reset();
+  EXPECT_EQ(pool.GetFramesInUse(), 0u);
+}
+
+TEST(FramePool, ReleasedBufferIsReused) {
+  FramePool pool;
+  const uint8_t* data = nullptr;
+  {
+    FrameRef frame = pool.Acquire(1024);
+    data = frame->GetData();
+  }
+
+  FrameRef frame = pool.Acquire(512);
+
+  EXPECT_EQ(frame->GetData(), data);
+  EXPECT_EQ(frame->GetSize(), 512u);
+  EXPECT_EQ(pool.GetFrameCount(), 1u);
+}
+
+TEST(FramePool, SteadyStateDoesNotAllocate) {
+  FramePool pool;
+  std::vector<FrameRef> held;
+  // Three frames in flight at a time, as in the preview mailbox.
+  for (int i = 0; i < 3; i++) {
+    held.push_back(pool.Acquire(4096));
+  }
+  held.clear();
+  const uint64_t allocations = pool.GetAllocationCount();
+
+  for (int i = 0; i < 100; i++) {
+    held.push_back(pool.Acquire(4096));
+    if (held.size() == 3) {
+      held.erase(held.begin());
+    }
+  }
+
+  EXPECT_EQ(pool.GetAllocationCount(), allocations);
+  EXPECT_EQ(pool.GetFrameCount(), 3u);
+}
+
+TEST(FramePool, GrowingModeCreatesFramesWhenNoneIsFree) {
+  FramePool pool;
+
+  FrameRef first = pool.Acquire(8);
+  FrameRef second = pool.Acquire(8);
+
+  ASSERT_TRUE(second);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(pool.GetFrameCount(), 2u);
+  EXPECT_EQ(pool.GetExhaustedCount(), 0u);
+}
+
+TEST(FramePool, FixedSizeModeAllocatesUpFront) {
+  FramePool pool(3, 4096);
+
+  EXPECT_EQ(pool.GetFrameCount(), 3u);
+  EXPECT_EQ(pool.GetAllocationCount(), 3u);
+
+  std::vector<FrameRef> frames;
+  for (int i = 0; i < 3; i++) {
+    frames.push_back(pool.Acquire(4096));
+    ASSERT_TRUE(frames.back());
+  }
+  EXPECT_EQ(pool.GetAllocationCount(), 3u);
+}
+
+TEST(FramePool, FixedSizeModeFailsWhenExhausted) {
+  FramePool pool(2, 16);
+  FrameRef first = pool.Acquire(16);
+  FrameRef second = pool.Acquire(16);
+
+  FrameRef third = pool.Acquire(16);
+
+  EXPECT_FALSE(third);
+  EXPECT_EQ(pool.GetExhaustedCount(), 1u);
+  EXPECT_EQ(pool.GetFrameCount(), 2u);
+
+  first.reset();
+  EXPECT_TRUE(pool.Acquire(16));
+}
+
+TEST(FramePool, FixedSizeModeGrowsBuffersOnlyOnce) {
+  FramePool pool(1, 16);
+
+  pool.Acquire(64);
+  pool.Acquire(64);
+  pool.Acquire(32);
+
+  EXPECT_EQ(pool.GetAllocationCount(), 2u);
+}
+
+TEST(FramePool, FramesOutlivePool) {
+  auto pool = std::make_unique<FramePool>();
+  FrameRef frame = pool->Acquire(16);
+  frame.GetMutable()->GetData()[15] = 7;
+  FrameRef copy = frame;
+
+  pool.reset();
+
+  EXPECT_EQ(copy->GetData()[15], 7);
+  frame.reset();
+  copy.reset();
+}
+
+TEST(FramePool, ReferencesCanBeReleasedOnOtherThreads) {
+  FramePool pool(4, 256);
+  constexpr int kFrameCount = 2000;
+
+  for (int i = 0; i < kFrameCount; i++) {
+    FrameRef frame;
+    while (!(frame = pool.Acquire(256))) {
+      std::this_thread::yield();
+    }
+    frame.GetMutable()->sample_time_us = i;
+    FrameRef copy = frame;
+    std::thread release([copy = std::move(copy)]() mutable { copy.reset(); });
+    frame.reset();
+    release.join();
+  }
+
+  EXPECT_EQ(pool.GetFramesInUse(), 0u);
+  EXPECT_EQ(pool.GetFrameCount(), 4u);
+}
+
+TEST(FramePool, CopiesPaddedNV12FrameWithoutPadding) {
+  constexpr uint32_t kWidth = 4;
+  constexpr uint32_t kHeight = 2;
+  constexpr int32_t kStride = 8;
+  FramePool pool;
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kNV12;
+  FrameRef frame;
+  // Two luma rows and one chroma row, each padded to the stride.
+  std::vector<uint8_t> buffer = {
+      10, 11, 12, 13, 0, 0, 0, 0,  //
+      20, 21, 22, 23, 0, 0, 0, 0,  //
+      50, 51, 52, 53, 0, 0, 0, 0,  //
+  };
+  FrameBufferView view;
+  view.scanline0 = buffer.data();
+  view.stride = kStride;
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+
+  ASSERT_TRUE(CopyCapturedFrame(format, view, kWidth, kHeight, &pool, &frame));
+  EXPECT_EQ(frame->content, FrameContent::kCaptured);
+  EXPECT_EQ(frame->stride, 4);
+  EXPECT_EQ(std::vector<uint8_t>(frame->GetData(),
+                                 frame->GetData() + frame->GetSize()),
+            std::vector<uint8_t>({10, 11, 12, 13, 20, 21, 22, 23, 50, 51, 52,
+                                  53}));
+}
+
+TEST(FramePool, CopiesBottomUpRGB32FrameTopDown) {
+  std::vector<uint8_t> buffer = {
+      2, 2, 2, 2,  // Row 1.
+      1, 1, 1, 1,  // Row 0.
+  };
+  FrameBufferView view;
+  view.scanline0 = buffer.data() + 4;
+  view.stride = -4;
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+  FramePool pool;
+  FrameRef frame;
+
+  ASSERT_TRUE(CopyCapturedFrame(FrameFormat(), view, 1, 2, &pool, &frame));
+
+  const FrameBufferView copy = GetFrameBufferView(*frame);
+  EXPECT_EQ(copy.stride, 4);
+  EXPECT_EQ(copy.scanline0[0], 1);
+  EXPECT_EQ(copy.scanline0[4], 2);
+  EXPECT_TRUE(copy.Contains(4, 2));
+}
+
+TEST(FramePool, CopiesCompressedFrameAsAWhole) {
+  std::vector<uint8_t> jpeg = {0xFF, 0xD8, 1, 2, 3, 0xFF, 0xD9};
+  FrameBufferView view;
+  view.buffer_start = jpeg.data();
+  view.buffer_length = static_cast<uint32_t>(jpeg.size());
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kMJPG;
+  FramePool pool;
+  FrameRef frame;
+
+  ASSERT_TRUE(CopyCapturedFrame(format, view, 640, 480, &pool, &frame));
+
+  EXPECT_EQ(frame->GetSize(), jpeg.size());
+  EXPECT_EQ(frame->stride, 0);
+  EXPECT_EQ(frame->captured_format.pixel_format, PixelFormat::kMJPG);
+  EXPECT_EQ(frame->GetData()[4], 3);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,98 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_processing_thread.h"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+TEST(FrameProcessingThread, RunsFramesOnItsOwnThread) {
+  std::thread::id start_thread;
+  std::thread::id frame_thread;
+  std::thread::id stop_thread;
+  {
+    FrameProcessingThread thread(
+        [&]() { start_thread = std::this_thread::get_id(); },
+        [&]() { stop_thread = std::this_thread::get_id(); });
+    std::promise<void> processed;
+    EXPECT_TRUE(thread.PostFrame([&]() {
+      frame_thread = std::this_thread::get_id();
+      processed.set_value();
+    }));
+    processed.get_future().wait();
+  }
+
+  EXPECT_NE(frame_thread, std::this_thread::get_id());
+  EXPECT_EQ(start_thread, frame_thread);
+  EXPECT_EQ(stop_thread, frame_thread);
+}
+
+TEST(FrameProcessingThread, ReplacesWaitingFrameWithNewerOne) {
+  std::mutex mutex;
+  std::vector<std::string> processed;
+  auto record = [&](std::string name) {
+    return [&, name]() {
+      const std::lock_guard<std::mutex> lock(mutex);
+      processed.push_back(name);
+    };
+  };
+
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<void> blocked;
+  {
+    FrameProcessingThread thread(nullptr, nullptr);
+    // Holds the thread up, as a slow conversion would.
+    thread.PostFrame([&]() {
+      blocked.set_value();
+      released.wait();
+    });
+    blocked.get_future().wait();
+
+    EXPECT_TRUE(thread.PostFrame(record("frame 1")));
+    EXPECT_FALSE(thread.PostFrame(record("frame 2")));
+    // Tasks are never dropped, and frames posted after a task wait for it.
+    thread.PostTask(record("format change"));
+    EXPECT_TRUE(thread.PostFrame(record("frame 3")));
+    EXPECT_FALSE(thread.PostFrame(record("frame 4")));
+    EXPECT_EQ(thread.GetReplacedFrameCount(), 2u);
+    release.set_value();
+  }
+
+  EXPECT_EQ(processed, (std::vector<std::string>{"frame 2", "format change",
+                                                 "frame 4"}));
+}
+
+TEST(FrameProcessingThread, ReleasesReplacedFrames) {
+  auto resource = std::make_shared<int>(0);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<void> blocked;
+
+  FrameProcessingThread thread(nullptr, nullptr);
+  thread.PostFrame([&]() {
+    blocked.set_value();
+    released.wait();
+  });
+  blocked.get_future().wait();
+
+  thread.PostFrame([resource]() {});
+  EXPECT_EQ(resource.use_count(), 2);
+  thread.PostFrame([]() {});
+  // The replaced frame no longer holds its sample.
+  EXPECT_EQ(resource.use_count(), 1);
+  release.set_value();
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,203 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_scaler.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_conversion.h"
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Returns the size of a frame of |width| x |height| pixels in |pixel_format|.
+size_t GetFrameSize(PixelFormat pixel_format, uint32_t width,
+                    uint32_t height) {
+  const size_t pixels = static_cast<size_t>(width) * height;
+  switch (pixel_format) {
+    case PixelFormat::kNV12:
+      return pixels * 3 / 2;
+    case PixelFormat::kYUY2:
+      return pixels * 2;
+    default:
+      return pixels * 4;
+  }
+}
+
+// Returns a view of the whole packed frame in |buffer|.
+FrameBufferView CreateView(const std::vector<uint8_t>& buffer) {
+  FrameBufferView view;
+  view.scanline0 = buffer.data();
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+  return view;
+}
+
+// Scales a frame of state.range(0) x state.range(1) pixels down to
+// state.range(2) x state.range(3) RGBA pixels in a single pass, mirrored
+// like the preview, with the row kernels of |path|.
+void BM_ScaleFrameWithPath(benchmark::State& state, PixelFormat pixel_format,
+                           PixelConversionPath path) {
+  if (!IsPixelConversionPathSupported(path)) {
+    state.SkipWithError("Conversion path not supported by this CPU");
+    return;
+  }
+
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  const uint32_t dst_width = static_cast<uint32_t>(state.range(2));
+  const uint32_t dst_height = static_cast<uint32_t>(state.range(3));
+
+  FrameFormat format;
+  format.pixel_format = pixel_format;
+  const std::vector<uint8_t> source(GetFrameSize(pixel_format, width, height),
+                                    0x80);
+  std::vector<uint8_t> destination(static_cast<size_t>(dst_width) *
+                                   dst_height * 4);
+  FrameScaler scaler(path);
+
+  for (auto _ : state) {
+    if (!ScaleFrameToRGBA(format, CreateView(source), width, height,
+                          destination.data(), dst_width, dst_height, true,
+                          &scaler)) {
+      state.SkipWithError("Failed to scale frame");
+      return;
+    }
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Same as |BM_ScaleFrameWithPath|, with the row kernels picked for the
+// current CPU.
+void BM_ScaleFrame(benchmark::State& state, PixelFormat pixel_format) {
+  BM_ScaleFrameWithPath(state, pixel_format, GetPreferredPixelConversionPath());
+}
+
+// Same as |BM_ScaleFrame|, but converts the frame to RGBA at full size first
+// and scales the converted frame.
+void BM_ConvertThenScaleFrame(benchmark::State& state,
+                              PixelFormat pixel_format) {
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  const uint32_t dst_width = static_cast<uint32_t>(state.range(2));
+  const uint32_t dst_height = static_cast<uint32_t>(state.range(3));
+
+  FrameFormat format;
+  format.pixel_format = pixel_format;
+  const std::vector<uint8_t> source(GetFrameSize(pixel_format, width, height),
+                                    0x80);
+  std::vector<uint8_t> converted(static_cast<size_t>(width) * height * 4);
+  std::vector<uint8_t> destination(static_cast<size_t>(dst_width) *
+                                   dst_height * 4);
+  const ScaleFilter filter =
+      GetScaleFilter(width, height, dst_width, dst_height);
+  FrameScaler scaler;
+
+  for (auto _ : state) {
+    if (!ConvertFrameToRGBA(format, CreateView(source), converted.data(),
+                            width, height, true)) {
+      state.SkipWithError("Failed to convert frame");
+      return;
+    }
+    scaler.Scale(
+        [&converted, width](uint32_t y, uint8_t*) {
+          return converted.data() + static_cast<size_t>(y) * width * 4;
+        },
+        SourcePixelOrder::kRGBA, width, height, destination.data(), dst_width,
+        dst_height, filter, false);
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Converts the center of a 4K UHD frame, zoomed in state.range(0) times, for
+// a 1280x720 texture, like the preview. Only the visible region is read, so
+// the time follows the number of visible pixels.
+void BM_ConvertZoomedFrame(benchmark::State& state, PixelFormat pixel_format) {
+  const uint32_t width = 3840;
+  const uint32_t height = 2160;
+  const uint32_t zoom = static_cast<uint32_t>(state.range(0));
+  FrameRegion region;
+  region.width = width / zoom;
+  region.height = height / zoom;
+  region.x = (width - region.width) / 2 & ~uint32_t{1};
+  region.y = (height - region.height) / 2 & ~uint32_t{1};
+  uint32_t dst_width = region.width;
+  uint32_t dst_height = region.height;
+  GetScaledFrameSize(region.width, region.height, 1280, 720, &dst_width,
+                     &dst_height);
+
+  FrameFormat format;
+  format.pixel_format = pixel_format;
+  const std::vector<uint8_t> source(GetFrameSize(pixel_format, width, height),
+                                    0x80);
+  std::vector<uint8_t> destination(static_cast<size_t>(dst_width) *
+                                   dst_height * 4);
+  FrameScaler scaler;
+
+  for (auto _ : state) {
+    if (!ConvertFrameRegionToRGBA(format, CreateView(source), width, height,
+                                  region, destination.data(), dst_width,
+                                  dst_height, true, &scaler, nullptr)) {
+      state.SkipWithError("Failed to convert frame region");
+      return;
+    }
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 4K UHD to 720p and 1080p to 360p with the box filter, and 1080p to 720p
+// with the bilinear filter.
+void ScaledFrameSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height", "dst_width", "dst_height"});
+  benchmark->Args({3840, 2160, 1280, 720});
+  benchmark->Args({1920, 1080, 640, 360});
+  benchmark->Args({1920, 1080, 1280, 720});
+}
+
+BENCHMARK_CAPTURE(BM_ScaleFrame, RGB32, PixelFormat::kRGB32)
+    ->Apply(ScaledFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertThenScaleFrame, RGB32, PixelFormat::kRGB32)
+    ->Apply(ScaledFrameSizes);
+BENCHMARK_CAPTURE(BM_ScaleFrame, NV12, PixelFormat::kNV12)
+    ->Apply(ScaledFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertThenScaleFrame, NV12, PixelFormat::kNV12)
+    ->Apply(ScaledFrameSizes);
+BENCHMARK_CAPTURE(BM_ScaleFrame, YUY2, PixelFormat::kYUY2)
+    ->Apply(ScaledFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertThenScaleFrame, YUY2, PixelFormat::kYUY2)
+    ->Apply(ScaledFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertZoomedFrame, NV12, PixelFormat::kNV12)
+    ->ArgName("zoom")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+BENCHMARK_CAPTURE(BM_ConvertZoomedFrame, YUY2, PixelFormat::kYUY2)
+    ->ArgName("zoom")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+BENCHMARK_CAPTURE(BM_ScaleFrameWithPath, RGB32_Scalar, PixelFormat::kRGB32,
+                  PixelConversionPath::kScalar)
+    ->Apply(ScaledFrameSizes);
+
+}  // namespace
+
+}  // namespace test
+}  // namespace camera_windows
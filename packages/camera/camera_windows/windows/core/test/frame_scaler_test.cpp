@@ -0,0 +1,204 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "frame_scaler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Returns a reader of the rows of a packed frame of 4-byte pixels.
+FrameScaler::RowReader CreateRowReader(const std::vector<uint8_t>& frame,
+                                       uint32_t width) {
+  return [&frame, width](uint32_t y, uint8_t*) {
+    return frame.data() + static_cast<size_t>(y) * width * 4;
+  };
+}
+
+}  // namespace
+
+TEST(FrameScaler, ScalesToCoverTargetSize) {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  // Same aspect ratio.
+  ASSERT_TRUE(GetScaledFrameSize(3840, 2160, 1280, 720, &width, &height));
+  EXPECT_EQ(width, 1280u);
+  EXPECT_EQ(height, 720u);
+
+  // Wider and taller targets keep the aspect ratio of the frame, rounding
+  // up.
+  ASSERT_TRUE(GetScaledFrameSize(1920, 1080, 640, 100, &width, &height));
+  EXPECT_EQ(width, 640u);
+  EXPECT_EQ(height, 360u);
+  ASSERT_TRUE(GetScaledFrameSize(1920, 1080, 100, 361, &width, &height));
+  EXPECT_EQ(width, 642u);
+  EXPECT_EQ(height, 361u);
+
+  // Tiny targets are scaled the rest of the way by Flutter.
+  ASSERT_TRUE(GetScaledFrameSize(3840, 2160, 160, 90, &width, &height));
+  EXPECT_EQ(width, 480u);
+  EXPECT_EQ(height, 270u);
+}
+
+TEST(FrameScaler, DoesNotScaleCloseToFrameSize) {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  // Unknown texture size.
+  EXPECT_FALSE(GetScaledFrameSize(1920, 1080, 0, 0, &width, &height));
+  // Larger than 3/4 of the frame.
+  EXPECT_FALSE(GetScaledFrameSize(1920, 1080, 1441, 500, &width, &height));
+  EXPECT_FALSE(GetScaledFrameSize(1920, 1080, 3840, 2160, &width, &height));
+  EXPECT_TRUE(GetScaledFrameSize(1920, 1080, 1440, 810, &width, &height));
+}
+
+TEST(FrameScaler, FitsFrameInsideMaximumSize) {
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  EXPECT_TRUE(GetFittedFrameSize(1920, 1080, 640, 640, &width, &height));
+  EXPECT_EQ(width, 640u);
+  EXPECT_EQ(height, 360u);
+
+  // Only the height is limited.
+  EXPECT_TRUE(GetFittedFrameSize(1920, 1080, 0, 540, &width, &height));
+  EXPECT_EQ(width, 960u);
+  EXPECT_EQ(height, 540u);
+
+  // Never scaled up.
+  EXPECT_TRUE(GetFittedFrameSize(640, 480, 1280, 0, &width, &height));
+  EXPECT_EQ(width, 640u);
+  EXPECT_EQ(height, 480u);
+
+  // Sides are at least one pixel.
+  EXPECT_TRUE(GetFittedFrameSize(4000, 2, 100, 0, &width, &height));
+  EXPECT_EQ(width, 100u);
+  EXPECT_EQ(height, 1u);
+
+  EXPECT_FALSE(GetFittedFrameSize(0, 480, 100, 100, &width, &height));
+}
+
+TEST(FrameScaler, UsesBoxFilterBelowHalfSize) {
+  EXPECT_EQ(GetScaleFilter(1920, 1080, 1280, 720), ScaleFilter::kBilinear);
+  EXPECT_EQ(GetScaleFilter(1920, 1080, 961, 541), ScaleFilter::kBilinear);
+  EXPECT_EQ(GetScaleFilter(1920, 1080, 960, 540), ScaleFilter::kBox);
+  EXPECT_EQ(GetScaleFilter(3840, 2160, 1280, 720), ScaleFilter::kBox);
+}
+
+TEST(FrameScaler, BoxFilterAveragesCoveredPixels) {
+  // 4x2 pixels scaled to 2x1; each output pixel averages 2x2 pixels.
+  const std::vector<uint8_t> frame = {
+      0,  0,  0,  0, 10, 20, 30, 0, 100, 0, 0, 0, 200, 0, 0, 0,  //
+      20, 40, 60, 0, 30, 60, 90, 0, 100, 0, 0, 0, 201, 0, 0, 0,
+  };
+  std::vector<uint8_t> scaled(2 * 4);
+
+  FrameScaler scaler;
+  scaler.Scale(CreateRowReader(frame, 4), SourcePixelOrder::kRGBA, 4, 2,
+               scaled.data(), 2, 1, ScaleFilter::kBox, false);
+  EXPECT_EQ(scaled, std::vector<uint8_t>({15, 30, 45, 255, 150, 0, 0, 255}));
+}
+
+TEST(FrameScaler, BilinearFilterInterpolatesBetweenPixels) {
+  // 3x1 pixels scaled to 2x1 samples at 1/4 and 3/4 of the frame, between
+  // pixel centers.
+  const std::vector<uint8_t> frame = {
+      0, 0, 0, 0, 100, 100, 100, 0, 200, 200, 200, 0,
+  };
+  std::vector<uint8_t> scaled(2 * 4);
+
+  FrameScaler scaler;
+  scaler.Scale(CreateRowReader(frame, 3), SourcePixelOrder::kRGBA, 3, 1,
+               scaled.data(), 2, 1, ScaleFilter::kBilinear, false);
+  EXPECT_EQ(scaled, std::vector<uint8_t>({25, 25, 25, 255, 175, 175, 175,
+                                          255}));
+}
+
+TEST(FrameScaler, KeepsUniformFramesUniform) {
+  const uint32_t width = 37;
+  const uint32_t height = 23;
+  std::vector<uint8_t> frame(width * height * 4);
+  for (size_t i = 0; i < frame.size(); i += 4) {
+    frame[i] = 12;
+    frame[i + 1] = 34;
+    frame[i + 2] = 56;
+    frame[i + 3] = 78;
+  }
+
+  FrameScaler scaler;
+  for (ScaleFilter filter : {ScaleFilter::kBilinear, ScaleFilter::kBox}) {
+    for (uint32_t dst_width : {5u, 10u, 30u, 37u}) {
+      const uint32_t dst_height = std::max(dst_width * height / width, 1u);
+      std::vector<uint8_t> scaled(dst_width * dst_height * 4);
+      scaler.Scale(CreateRowReader(frame, width), SourcePixelOrder::kRGBA,
+                   width, height, scaled.data(), dst_width, dst_height, filter,
+                   false);
+      for (size_t i = 0; i < scaled.size(); i += 4) {
+        ASSERT_EQ(scaled[i], 12);
+        ASSERT_EQ(scaled[i + 1], 34);
+        ASSERT_EQ(scaled[i + 2], 56);
+        ASSERT_EQ(scaled[i + 3], 255);
+      }
+    }
+  }
+}
+
+TEST(FrameScaler, SIMDPathsMatchScalarPath) {
+  // Odd sizes cover the scalar tails of the row kernels.
+  const uint32_t width = 67;
+  const uint32_t height = 41;
+  std::vector<uint8_t> frame(width * height * 4);
+  for (size_t i = 0; i < frame.size(); i++) {
+    frame[i] = static_cast<uint8_t>(i * 131 + i / 7);
+  }
+
+  FrameScaler scalar_scaler(PixelConversionPath::kScalar);
+  for (PixelConversionPath path :
+       {PixelConversionPath::kSSSE3, PixelConversionPath::kAVX2,
+        PixelConversionPath::kNEON}) {
+    if (!IsPixelConversionPathSupported(path)) {
+      continue;
+    }
+    FrameScaler scaler(path);
+    for (ScaleFilter filter : {ScaleFilter::kBilinear, ScaleFilter::kBox}) {
+      for (uint32_t dst_width : {10u, 33u, 50u}) {
+        const uint32_t dst_height = dst_width * height / width;
+        std::vector<uint8_t> expected(dst_width * dst_height * 4);
+        std::vector<uint8_t> scaled(expected.size());
+        scalar_scaler.Scale(CreateRowReader(frame, width),
+                            SourcePixelOrder::kBGRA, width, height,
+                            expected.data(), dst_width, dst_height, filter,
+                            true);
+        scaler.Scale(CreateRowReader(frame, width), SourcePixelOrder::kBGRA,
+                     width, height, scaled.data(), dst_width, dst_height,
+                     filter, true);
+        EXPECT_EQ(scaled, expected);
+      }
+    }
+  }
+}
+
+TEST(FrameScaler, SwapsChannelsAndMirrorsOutput) {
+  // Two BGRX pixels kept at full size.
+  const std::vector<uint8_t> frame = {1, 2, 3, 0, 4, 5, 6, 0};
+  std::vector<uint8_t> scaled(2 * 4);
+
+  FrameScaler scaler;
+  for (ScaleFilter filter : {ScaleFilter::kBilinear, ScaleFilter::kBox}) {
+    scaler.Scale(CreateRowReader(frame, 2), SourcePixelOrder::kBGRA, 2, 1,
+                 scaled.data(), 2, 1, filter, true);
+    EXPECT_EQ(scaled, std::vector<uint8_t>({6, 5, 4, 255, 3, 2, 1, 255}));
+  }
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,372 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "image_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_conversion.h"
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Returns a view of the whole packed |buffer|.
+FrameBufferView CreateView(const std::vector<uint8_t>& buffer) {
+  FrameBufferView view;
+  view.scanline0 = buffer.data();
+  view.buffer_start = buffer.data();
+  view.buffer_length = static_cast<uint32_t>(buffer.size());
+  return view;
+}
+
+// Returns |size| bytes with a repeating, non-uniform pattern.
+std::vector<uint8_t> CreatePattern(size_t size) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  return data;
+}
+
+// Reads a little-endian 32-bit field of a message header.
+uint32_t ReadField(const std::vector<uint8_t>& header, size_t index) {
+  const uint8_t* field = header.data() + index * 4;
+  return field[0] | field[1] << 8 | field[2] << 16 |
+         static_cast<uint32_t>(field[3]) << 24;
+}
+
+}  // namespace
+
+TEST(ImageStream, FitsFramesInsideMaximumSize) {
+  ImageStreamOptions options;
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  EXPECT_TRUE(GetImageStreamFrameSize(options, 1280, 720, &width, &height));
+  EXPECT_EQ(width, 1280u);
+  EXPECT_EQ(height, 720u);
+
+  options.max_width = 320;
+  options.max_height = 320;
+  EXPECT_TRUE(GetImageStreamFrameSize(options, 1280, 720, &width, &height));
+  EXPECT_EQ(width, 320u);
+  EXPECT_EQ(height, 180u);
+
+  // Frames are never scaled up.
+  options.max_width = 4000;
+  options.max_height = 4000;
+  EXPECT_TRUE(GetImageStreamFrameSize(options, 1280, 720, &width, &height));
+  EXPECT_EQ(width, 1280u);
+  EXPECT_EQ(height, 720u);
+
+  EXPECT_FALSE(GetImageStreamFrameSize(options, 0, 720, &width, &height));
+}
+
+TEST(ImageStream, LimitsFrameSizeToFormat) {
+  ImageStreamOptions options;
+  options.max_width = 101;
+  options.max_height = 101;
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  // NV12 frames have even sides.
+  options.format = ImageStreamFormat::kNV12;
+  EXPECT_TRUE(GetImageStreamFrameSize(options, 640, 480, &width, &height));
+  EXPECT_EQ(width, 100u);
+  EXPECT_EQ(height, 74u);
+
+  // RGBA frames are scaled down by at most 8 on each side.
+  options.format = ImageStreamFormat::kRGBA;
+  options.max_width = 64;
+  EXPECT_TRUE(GetImageStreamFrameSize(options, 1920, 1080, &width, &height));
+  EXPECT_EQ(width, 240u);
+  EXPECT_EQ(height, 135u);
+
+  // Luma frames may be scaled down further.
+  options.format = ImageStreamFormat::kLuma;
+  EXPECT_TRUE(GetImageStreamFrameSize(options, 1920, 1080, &width, &height));
+  EXPECT_EQ(width, 64u);
+  EXPECT_EQ(height, 36u);
+}
+
+TEST(ImageStream, SupportsNV12OnlyForYuvFrames) {
+  EXPECT_TRUE(IsImageStreamFormatSupported(PixelFormat::kNV12,
+                                           ImageStreamFormat::kNV12));
+  EXPECT_TRUE(IsImageStreamFormatSupported(PixelFormat::kYUY2,
+                                           ImageStreamFormat::kNV12));
+  EXPECT_FALSE(IsImageStreamFormatSupported(PixelFormat::kRGB32,
+                                            ImageStreamFormat::kNV12));
+  EXPECT_FALSE(IsImageStreamFormatSupported(PixelFormat::kMJPG,
+                                            ImageStreamFormat::kNV12));
+  EXPECT_TRUE(IsImageStreamFormatSupported(PixelFormat::kMJPG,
+                                           ImageStreamFormat::kLuma));
+}
+
+TEST(ImageStream, WritesHeaderWithPlaneLayout) {
+  const ImageStreamFrameLayout layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kNV12, 8, 6);
+  EXPECT_EQ(layout.size, 8u * 6 + 8 * 3);
+
+  std::vector<uint8_t> header(kImageStreamHeaderSize, 0xFF);
+  WriteImageStreamHeader(layout, 0x123456789Au, header.data());
+
+  EXPECT_EQ(ReadField(header, 0), 2u);
+  EXPECT_EQ(ReadField(header, 1), 8u);
+  EXPECT_EQ(ReadField(header, 2), 6u);
+  EXPECT_EQ(ReadField(header, 3), 2u);
+  EXPECT_EQ(ReadField(header, 4), 0x3456789Au);
+  EXPECT_EQ(ReadField(header, 5), 0x12u);
+  // Luma plane.
+  EXPECT_EQ(ReadField(header, 6), kImageStreamHeaderSize);
+  EXPECT_EQ(ReadField(header, 7), 8u);
+  EXPECT_EQ(ReadField(header, 8), 1u);
+  EXPECT_EQ(ReadField(header, 9), 8u);
+  EXPECT_EQ(ReadField(header, 10), 6u);
+  // Chroma plane.
+  EXPECT_EQ(ReadField(header, 11), kImageStreamHeaderSize + 48);
+  EXPECT_EQ(ReadField(header, 12), 8u);
+  EXPECT_EQ(ReadField(header, 13), 2u);
+  EXPECT_EQ(ReadField(header, 14), 4u);
+  EXPECT_EQ(ReadField(header, 15), 3u);
+}
+
+TEST(ImageStream, ConvertsRGB32FrameToRGBAAndBGRA) {
+  const uint32_t width = 5;
+  const uint32_t height = 3;
+  const std::vector<uint8_t> frame = CreatePattern(width * height * 4);
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kRGB32;
+  ImageStreamConverter converter;
+
+  const ImageStreamFrameLayout rgba_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kRGBA, width, height);
+  std::vector<uint8_t> rgba(rgba_layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), width, height,
+                                rgba_layout, rgba.data()));
+  std::vector<uint8_t> expected(rgba_layout.size);
+  ASSERT_TRUE(ConvertFrameToRGBA(format, CreateView(frame), expected.data(),
+                                 width, height, false));
+  EXPECT_EQ(rgba, expected);
+
+  const ImageStreamFrameLayout bgra_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kBGRA, width, height);
+  std::vector<uint8_t> bgra(bgra_layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), width, height,
+                                bgra_layout, bgra.data()));
+  for (size_t i = 0; i < bgra.size(); i += 4) {
+    EXPECT_EQ(bgra[i], frame[i]);
+    EXPECT_EQ(bgra[i + 1], frame[i + 1]);
+    EXPECT_EQ(bgra[i + 2], frame[i + 2]);
+    EXPECT_EQ(bgra[i + 3], 255);
+  }
+}
+
+TEST(ImageStream, ScalesBGRALikeRGBA) {
+  const uint32_t width = 32;
+  const uint32_t height = 24;
+  const std::vector<uint8_t> frame = CreatePattern(width * height * 2);
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kYUY2;
+  ImageStreamConverter converter;
+
+  const ImageStreamFrameLayout rgba_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kRGBA, 12, 9);
+  std::vector<uint8_t> rgba(rgba_layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), width, height,
+                                rgba_layout, rgba.data()));
+  const ImageStreamFrameLayout bgra_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kBGRA, 12, 9);
+  std::vector<uint8_t> bgra(bgra_layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), width, height,
+                                bgra_layout, bgra.data()));
+
+  for (size_t i = 0; i < rgba.size(); i += 4) {
+    EXPECT_EQ(bgra[i], rgba[i + 2]);
+    EXPECT_EQ(bgra[i + 1], rgba[i + 1]);
+    EXPECT_EQ(bgra[i + 2], rgba[i]);
+    EXPECT_EQ(bgra[i + 3], rgba[i + 3]);
+  }
+}
+
+TEST(ImageStream, PassesNV12PlanesThrough) {
+  const uint32_t width = 6;
+  const uint32_t height = 4;
+  const std::vector<uint8_t> frame = CreatePattern(width * height * 3 / 2);
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kNV12;
+  ImageStreamConverter converter;
+
+  const ImageStreamFrameLayout layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kNV12, width, height);
+  std::vector<uint8_t> nv12(layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), width, height,
+                                layout, nv12.data()));
+  EXPECT_EQ(nv12, frame);
+
+  const ImageStreamFrameLayout luma_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kLuma, width, height);
+  std::vector<uint8_t> luma(luma_layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), width, height,
+                                luma_layout, luma.data()));
+  EXPECT_EQ(luma, std::vector<uint8_t>(frame.begin(),
+                                       frame.begin() + width * height));
+}
+
+TEST(ImageStream, ConvertsYUY2FrameToNV12) {
+  // Two rows of two macropixels: Y0 U Y1 V.
+  const std::vector<uint8_t> frame = {
+      10, 100, 20, 200, 30, 50,  40, 60,   //
+      50, 110, 60, 210, 70, 150, 80, 161,  //
+  };
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kYUY2;
+  ImageStreamConverter converter;
+
+  const ImageStreamFrameLayout layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kNV12, 4, 2);
+  std::vector<uint8_t> nv12(layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), 4, 2, layout,
+                                nv12.data()));
+
+  const std::vector<uint8_t> expected = {
+      10, 20, 30, 40, 50, 60, 70, 80,  // Luma.
+      105, 205, 100, 111,              // Chroma, averaged over both rows.
+  };
+  EXPECT_EQ(nv12, expected);
+}
+
+TEST(ImageStream, AveragesLumaWhenScalingDown) {
+  const uint32_t width = 4;
+  const uint32_t height = 2;
+  const std::vector<uint8_t> frame = {
+      0,  10, 20, 30,  // Luma.
+      40, 50, 60, 70,  //
+      128, 128, 128, 128,  // Chroma.
+  };
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kNV12;
+  ImageStreamConverter converter;
+
+  const ImageStreamFrameLayout layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kLuma, 2, 1);
+  std::vector<uint8_t> luma(layout.size);
+  ASSERT_TRUE(converter.Convert(format, CreateView(frame), width, height,
+                                layout, luma.data()));
+
+  EXPECT_EQ(luma, std::vector<uint8_t>({25, 45}));
+}
+
+TEST(ImageStream, RejectsUnsupportedConversions) {
+  const std::vector<uint8_t> frame = CreatePattern(4 * 4 * 4);
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kRGB32;
+  ImageStreamConverter converter;
+  const ImageStreamFrameLayout layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kNV12, 4, 4);
+  std::vector<uint8_t> dst(layout.size);
+
+  EXPECT_FALSE(
+      converter.Convert(format, CreateView(frame), 4, 4, layout, dst.data()));
+  EXPECT_FALSE(converter.ConvertRGBA(frame.data(), 4, 4, layout, dst.data()));
+
+  // Incomplete frames.
+  const ImageStreamFrameLayout rgba_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kRGBA, 4, 5);
+  std::vector<uint8_t> rgba(rgba_layout.size);
+  EXPECT_FALSE(converter.Convert(format, CreateView(frame), 4, 5, rgba_layout,
+                                 rgba.data()));
+}
+
+TEST(ImageStream, ConvertsDecodedRGBAFrames) {
+  const uint32_t width = 16;
+  const uint32_t height = 8;
+  std::vector<uint8_t> frame = CreatePattern(width * height * 4);
+  ImageStreamConverter converter;
+
+  const ImageStreamFrameLayout rgba_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kRGBA, width, height);
+  std::vector<uint8_t> rgba(rgba_layout.size);
+  ASSERT_TRUE(converter.ConvertRGBA(frame.data(), width, height, rgba_layout,
+                                    rgba.data()));
+  EXPECT_EQ(rgba, frame);
+
+  const ImageStreamFrameLayout bgra_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kBGRA, width, height);
+  std::vector<uint8_t> bgra(bgra_layout.size);
+  ASSERT_TRUE(converter.ConvertRGBA(frame.data(), width, height, bgra_layout,
+                                    bgra.data()));
+  EXPECT_EQ(bgra[0], frame[2]);
+  EXPECT_EQ(bgra[2], frame[0]);
+  EXPECT_EQ(bgra[3], 255);
+
+  // A uniform gray frame keeps its luma when scaled down.
+  std::fill(frame.begin(), frame.end(), 90);
+  const ImageStreamFrameLayout luma_layout =
+      GetImageStreamFrameLayout(ImageStreamFormat::kLuma, 5, 3);
+  std::vector<uint8_t> luma(luma_layout.size);
+  ASSERT_TRUE(converter.ConvertRGBA(frame.data(), width, height, luma_layout,
+                                    luma.data()));
+  EXPECT_EQ(luma, std::vector<uint8_t>(5 * 3, 90));
+}
+
+TEST(ImageStreamGate, DropsFramesWithoutCredits) {
+  ImageStreamOptions options;
+  options.max_pending_frames = 2;
+  ImageStreamGate gate(options);
+
+  EXPECT_TRUE(gate.TryAcquire(0));
+  EXPECT_TRUE(gate.TryAcquire(33333));
+  EXPECT_FALSE(gate.TryAcquire(66666));
+  EXPECT_EQ(gate.GetDroppedFrameCount(), 1u);
+
+  gate.Release();
+  EXPECT_TRUE(gate.TryAcquire(100000));
+  EXPECT_FALSE(gate.TryAcquire(133333));
+  EXPECT_EQ(gate.GetDroppedFrameCount(), 2u);
+  EXPECT_EQ(gate.GetThrottledFrameCount(), 0u);
+}
+
+TEST(ImageStreamGate, KeepsToMaximumFrameRate) {
+  ImageStreamOptions options;
+  options.max_frame_rate = 15;
+  options.max_pending_frames = 100;
+  ImageStreamGate gate(options);
+
+  // A 30 fps camera with some jitter sends every other frame.
+  const uint64_t times_us[] = {0,      34000,  66000,  99000,
+                               134000, 166000, 201000, 233000};
+  int sent = 0;
+  for (uint64_t time_us : times_us) {
+    if (gate.TryAcquire(time_us)) {
+      sent++;
+    }
+  }
+  EXPECT_EQ(sent, 4);
+  EXPECT_EQ(gate.GetThrottledFrameCount(), 4u);
+}
+
+TEST(ImageStreamGate, DoesNotBurstAfterGap) {
+  ImageStreamOptions options;
+  options.max_frame_rate = 30;
+  ImageStreamGate gate(options);
+
+  EXPECT_TRUE(gate.TryAcquire(0));
+  // Dart takes a while to return the credit.
+  EXPECT_FALSE(gate.TryAcquire(33333));
+  EXPECT_FALSE(gate.TryAcquire(66666));
+  gate.Release();
+  EXPECT_TRUE(gate.TryAcquire(100000));
+  gate.Release();
+  // The schedule restarted at the last sent frame.
+  EXPECT_FALSE(gate.TryAcquire(110000));
+  EXPECT_TRUE(gate.TryAcquire(133333));
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,165 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media_type_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+MediaTypeInfo CreateMediaType(uint32_t width, uint32_t height,
+                              float frame_rate) {
+  MediaTypeInfo info;
+  info.width = width;
+  info.height = height;
+  info.frame_rate = frame_rate;
+  return info;
+}
+
+MediaTypeInfo CreateMediaType(uint32_t width, uint32_t height,
+                              float frame_rate, PixelFormat pixel_format) {
+  MediaTypeInfo info = CreateMediaType(width, height, frame_rate);
+  info.has_pixel_format = true;
+  info.pixel_format = pixel_format;
+  return info;
+}
+
+DeviceCapabilities CreateCapabilities(const std::string& fingerprint) {
+  DeviceCapabilities capabilities;
+  capabilities.fingerprint = fingerprint;
+  capabilities.preview.media_types = {
+      CreateMediaType(640, 480, 30.f, PixelFormat::kYUY2),
+      CreateMediaType(1920, 1080, 29.97f, PixelFormat::kMJPG),
+  };
+  capabilities.preview.native_indices = {0, 3};
+  capabilities.record.media_types = {
+      CreateMediaType(1280, 720, 7.5f),
+  };
+  capabilities.record.native_indices = {5};
+  return capabilities;
+}
+
+void ExpectSameMediaTypes(const StreamCapabilities& actual,
+                          const StreamCapabilities& expected) {
+  ASSERT_EQ(actual.media_types.size(), expected.media_types.size());
+  EXPECT_EQ(actual.native_indices, expected.native_indices);
+  for (size_t i = 0; i < expected.media_types.size(); i++) {
+    const MediaTypeInfo& a = actual.media_types[i];
+    const MediaTypeInfo& e = expected.media_types[i];
+    EXPECT_EQ(a.width, e.width);
+    EXPECT_EQ(a.height, e.height);
+    EXPECT_EQ(a.frame_rate, e.frame_rate);
+    EXPECT_EQ(a.has_pixel_format, e.has_pixel_format);
+    if (e.has_pixel_format) {
+      EXPECT_EQ(a.pixel_format, e.pixel_format);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(MediaTypeCache, FindsStoredCapabilitiesWithSameFingerprint) {
+  MediaTypeCache cache;
+  cache.Store("camera", CreateCapabilities("driver 1"));
+
+  DeviceCapabilities capabilities;
+  ASSERT_TRUE(cache.Find("camera", "driver 1", &capabilities));
+  EXPECT_EQ(capabilities.fingerprint, "driver 1");
+  ExpectSameMediaTypes(capabilities.preview,
+                       CreateCapabilities("").preview);
+  EXPECT_FALSE(cache.Find("other camera", "driver 1", &capabilities));
+}
+
+TEST(MediaTypeCache, DropsCapabilitiesWhenFingerprintChanges) {
+  MediaTypeCache cache;
+  cache.Store("camera", CreateCapabilities("driver 1"));
+
+  DeviceCapabilities capabilities;
+  EXPECT_FALSE(cache.Find("camera", "driver 2", &capabilities));
+  EXPECT_EQ(cache.GetSize(), 0u);
+  EXPECT_FALSE(cache.Find("camera", "driver 1", &capabilities));
+}
+
+TEST(MediaTypeCache, RemovesCapabilities) {
+  MediaTypeCache cache;
+  cache.Store("camera", CreateCapabilities("driver 1"));
+
+  EXPECT_TRUE(cache.Remove("camera"));
+  EXPECT_FALSE(cache.Remove("camera"));
+  DeviceCapabilities capabilities;
+  EXPECT_FALSE(cache.Find("camera", "driver 1", &capabilities));
+}
+
+TEST(MediaTypeCache, DropsLeastRecentlyUsedDevices) {
+  MediaTypeCache cache(2);
+  cache.Store("a", CreateCapabilities("1"));
+  cache.Store("b", CreateCapabilities("1"));
+
+  DeviceCapabilities capabilities;
+  ASSERT_TRUE(cache.Find("a", "1", &capabilities));
+  cache.Store("c", CreateCapabilities("1"));
+
+  EXPECT_EQ(cache.GetSize(), 2u);
+  EXPECT_TRUE(cache.Find("a", "1", &capabilities));
+  EXPECT_FALSE(cache.Find("b", "1", &capabilities));
+  EXPECT_TRUE(cache.Find("c", "1", &capabilities));
+}
+
+TEST(MediaTypeCache, SerializesAllEntries) {
+  MediaTypeCache cache;
+  // Ids and fingerprints may contain spaces, colons and line breaks.
+  const std::string device_id = "\\\\?\\usb#vid_046d&pid_085c#6&1 2:3\n";
+  cache.Store(device_id, CreateCapabilities("10.0.1 USB\\VID_046D&REV_0013"));
+  cache.Store("", CreateCapabilities(""));
+
+  MediaTypeCache restored;
+  ASSERT_TRUE(restored.Deserialize(cache.Serialize()));
+  EXPECT_EQ(restored.GetSize(), 2u);
+
+  DeviceCapabilities capabilities;
+  ASSERT_TRUE(restored.Find(device_id, "10.0.1 USB\\VID_046D&REV_0013",
+                            &capabilities));
+  const DeviceCapabilities expected = CreateCapabilities("");
+  ExpectSameMediaTypes(capabilities.preview, expected.preview);
+  ExpectSameMediaTypes(capabilities.record, expected.record);
+  EXPECT_TRUE(restored.Find("", "", &capabilities));
+}
+
+TEST(MediaTypeCache, SerializesEmptyCache) {
+  MediaTypeCache cache;
+  MediaTypeCache restored;
+  restored.Store("camera", CreateCapabilities("1"));
+
+  EXPECT_TRUE(restored.Deserialize(cache.Serialize()));
+  EXPECT_EQ(restored.GetSize(), 0u);
+}
+
+TEST(MediaTypeCache, RejectsMalformedData) {
+  MediaTypeCache cache;
+  cache.Store("camera", CreateCapabilities("1"));
+  const std::string data = cache.Serialize();
+
+  MediaTypeCache restored;
+  EXPECT_FALSE(restored.Deserialize(""));
+  EXPECT_FALSE(restored.Deserialize("camera_windows media types 0\n"));
+  EXPECT_FALSE(restored.Deserialize(data.substr(0, data.size() - 4)));
+  EXPECT_FALSE(restored.Deserialize(data + "device 1:x"));
+  EXPECT_EQ(restored.GetSize(), 0u);
+
+  std::string bad_format = data;
+  bad_format.replace(bad_format.rfind(' '), std::string::npos, " 9\n");
+  EXPECT_FALSE(restored.Deserialize(bad_format));
+  EXPECT_EQ(restored.GetSize(), 0u);
+
+  EXPECT_TRUE(restored.Deserialize(data));
+  EXPECT_EQ(restored.GetSize(), 1u);
+}
+
+}  // namespace test
+}  // namespace camera_windows
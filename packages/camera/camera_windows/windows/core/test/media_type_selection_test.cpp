@@ -0,0 +1,259 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media_type_selection.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+MediaTypeInfo CreateMediaType(uint32_t width, uint32_t height,
+                              float frame_rate) {
+  MediaTypeInfo info;
+  info.width = width;
+  info.height = height;
+  info.frame_rate = frame_rate;
+  return info;
+}
+
+MediaTypeInfo CreateMediaType(uint32_t width, uint32_t height,
+                              float frame_rate, PixelFormat pixel_format) {
+  MediaTypeInfo info = CreateMediaType(width, height, frame_rate);
+  info.has_pixel_format = true;
+  info.pixel_format = pixel_format;
+  return info;
+}
+
+// The capability tables below follow the media types reported by common
+// kinds of cameras, in the order they list them.
+
+// A 1080p USB webcam, which only reaches 30 fps at large frame sizes with
+// MJPEG.
+std::vector<MediaTypeInfo> GetHdWebcamMediaTypes() {
+  return {
+      CreateMediaType(640, 480, 30.f, PixelFormat::kYUY2),
+      CreateMediaType(1280, 720, 10.f, PixelFormat::kYUY2),
+      CreateMediaType(1920, 1080, 5.f, PixelFormat::kYUY2),
+      CreateMediaType(2304, 1536, 2.f, PixelFormat::kYUY2),
+      CreateMediaType(640, 480, 30.f, PixelFormat::kMJPG),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kMJPG),
+      CreateMediaType(1920, 1080, 30.f, PixelFormat::kMJPG),
+  };
+}
+
+// A 4K USB webcam, which offers NV12 up to 1080p.
+std::vector<MediaTypeInfo> GetUhdWebcamMediaTypes() {
+  return {
+      CreateMediaType(3840, 2160, 15.f, PixelFormat::kMJPG),
+      CreateMediaType(1920, 1080, 60.f, PixelFormat::kMJPG),
+      CreateMediaType(1920, 1080, 30.f, PixelFormat::kNV12),
+      CreateMediaType(1280, 720, 60.f, PixelFormat::kNV12),
+      CreateMediaType(640, 480, 30.f, PixelFormat::kYUY2),
+  };
+}
+
+// An integrated laptop camera.
+std::vector<MediaTypeInfo> GetLaptopCameraMediaTypes() {
+  return {
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kNV12),
+      CreateMediaType(960, 540, 30.f, PixelFormat::kNV12),
+      CreateMediaType(640, 480, 30.f, PixelFormat::kNV12),
+      CreateMediaType(640, 360, 30.f, PixelFormat::kNV12),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kMJPG),
+      CreateMediaType(1280, 720, 30.f),
+  };
+}
+
+}  // namespace
+
+TEST(MediaTypeSelection, PicksLargestFrameSizeWithinMaxHeight) {
+  const std::vector<MediaTypeInfo> media_types = {
+      CreateMediaType(640, 480, 30.f, PixelFormat::kYUY2),
+      CreateMediaType(1920, 1080, 30.f, PixelFormat::kMJPG),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kYUY2),
+  };
+
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff), 1);
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 720), 2);
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 480), 0);
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 240), -1);
+}
+
+TEST(MediaTypeSelection, SkipsSlowFrameRates) {
+  const std::vector<MediaTypeInfo> media_types = {
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kNV12),
+      CreateMediaType(1920, 1080, 5.f, PixelFormat::kNV12),
+  };
+
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff), 0);
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, 5.f), 1);
+  EXPECT_EQ(FindBestMediaTypeIndex({}, 0xffffffff), -1);
+}
+
+TEST(MediaTypeSelection, SharesMinimumFrameRateWithPreferences) {
+  std::vector<MediaTypeInfo> media_types = {
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kNV12),
+      CreateMediaType(1920, 1080, kDefaultMinimumFrameRate,
+                      PixelFormat::kNV12),
+  };
+  MediaTypePreferences preferences;
+  preferences.preferred_frame_rate = kDefaultMinimumFrameRate;
+
+  // Without preferences, the selection of earlier versions is kept, and
+  // larger frames are taken down to the minimum frame rate.
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff), 1);
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 1);
+
+  media_types[1].frame_rate = kDefaultMinimumFrameRate - 0.5f;
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff), 0);
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 0);
+}
+
+TEST(MediaTypeSelection, KeepsEarlierSelectionWithoutPreferences) {
+  const std::vector<MediaTypeInfo> media_types = GetUhdWebcamMediaTypes();
+
+  // Each media type that is larger or faster than the one before is taken,
+  // so 1080p at 60 fps follows 4K at 15 fps. Preferences score media types
+  // instead.
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff), 1);
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff,
+                                   MediaTypePreferences()),
+            2);
+}
+
+TEST(MediaTypeSelection, PrefersUncompressedFormatsOfSameSizeAndRate) {
+  const std::vector<MediaTypeInfo> media_types = {
+      CreateMediaType(1280, 720, 30.f),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kMJPG),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kRGB32),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kNV12),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kYUY2),
+  };
+
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff), 3);
+
+  // A higher frame rate wins over the pixel format.
+  std::vector<MediaTypeInfo> faster_media_types = media_types;
+  faster_media_types.push_back(
+      CreateMediaType(1280, 720, 60.f, PixelFormat::kMJPG));
+  EXPECT_EQ(FindBestMediaTypeIndex(faster_media_types, 0xffffffff), 5);
+}
+
+TEST(MediaTypeSelection, RanksPixelFormats) {
+  EXPECT_GT(GetPixelFormatPreference(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kNV12)),
+            GetPixelFormatPreference(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kYUY2)));
+  EXPECT_GT(GetPixelFormatPreference(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kYUY2)),
+            GetPixelFormatPreference(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kRGB32)));
+  EXPECT_GT(GetPixelFormatPreference(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kRGB32)),
+            GetPixelFormatPreference(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kMJPG)));
+  EXPECT_GT(GetPixelFormatPreference(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kMJPG)),
+            GetPixelFormatPreference(CreateMediaType(0, 0, 0.f)));
+}
+
+TEST(MediaTypeSelection, ScoresHdWebcamMediaTypes) {
+  const std::vector<MediaTypeInfo> media_types = GetHdWebcamMediaTypes();
+  MediaTypePreferences preferences;
+
+  // YUY2 only reaches 5 fps at 1080p, so MJPEG is decoded instead.
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 6);
+
+  preferences.target_width = 1280;
+  preferences.target_height = 720;
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 5);
+}
+
+TEST(MediaTypeSelection, AvoidsCostlyPixelFormats) {
+  const std::vector<MediaTypeInfo> media_types = GetHdWebcamMediaTypes();
+  MediaTypePreferences preferences;
+  preferences.minimum_frame_rate = 1.f;
+  preferences.mjpg_cost = 0.9f;
+
+  // Smaller YUY2 frames at full rate win over slow large YUY2 frames and
+  // over decoding MJPEG.
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 0);
+}
+
+TEST(MediaTypeSelection, PrefersFrameRateOverSlowLargeFrames) {
+  const std::vector<MediaTypeInfo> media_types = GetUhdWebcamMediaTypes();
+  MediaTypePreferences preferences;
+
+  // 4K at 15 fps loses to 1080p at 30 fps, which needs no decoding.
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 2);
+
+  preferences.preferred_frame_rate = 60.f;
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 3);
+
+  preferences.mjpg_cost = 0.f;
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 1);
+
+  // The resolution preset still limits the frame height.
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 480, preferences), 4);
+}
+
+TEST(MediaTypeSelection, ScoresLaptopCameraMediaTypes) {
+  const std::vector<MediaTypeInfo> media_types = GetLaptopCameraMediaTypes();
+  MediaTypePreferences preferences;
+  preferences.target_width = 1920;
+  preferences.target_height = 1080;
+
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 0);
+
+  preferences.target_width = 640;
+  preferences.target_height = 360;
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 3);
+
+  preferences.minimum_frame_rate = 60.f;
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), -1);
+  EXPECT_EQ(FindBestMediaTypeIndex({}, 0xffffffff, MediaTypePreferences()),
+            -1);
+}
+
+TEST(MediaTypeSelection, BreaksScoreTiesByFrameSizeAndRate) {
+  const std::vector<MediaTypeInfo> media_types = {
+      CreateMediaType(640, 480, 30.f, PixelFormat::kNV12),
+      CreateMediaType(640, 480, 60.f, PixelFormat::kNV12),
+      CreateMediaType(1280, 720, 30.f, PixelFormat::kNV12),
+  };
+  MediaTypePreferences preferences;
+  preferences.target_width = 1;
+  preferences.target_height = 1;
+  preferences.preferred_frame_rate = 0.f;
+
+  // Every frame is far larger than the target, and frame rates are not
+  // scored.
+  EXPECT_GT(ScoreMediaType(media_types[0], preferences, 0),
+            ScoreMediaType(media_types[2], preferences, 0));
+  EXPECT_EQ(ScoreMediaType(media_types[0], preferences, 0),
+            ScoreMediaType(media_types[1], preferences, 0));
+  EXPECT_EQ(FindBestMediaTypeIndex(media_types, 0xffffffff, preferences), 1);
+}
+
+TEST(MediaTypeSelection, ClampsPixelFormatCosts) {
+  MediaTypePreferences preferences;
+  preferences.nv12_cost = -1.f;
+  preferences.other_cost = 2.f;
+
+  EXPECT_EQ(GetPixelFormatCost(
+                CreateMediaType(0, 0, 0.f, PixelFormat::kNV12), preferences),
+            0.f);
+  EXPECT_EQ(GetPixelFormatCost(CreateMediaType(0, 0, 0.f), preferences), 1.f);
+  EXPECT_EQ(ScoreMediaType(CreateMediaType(640, 480, 30.f), preferences,
+                           640 * 480),
+            0.f);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,126 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mjpeg_frame.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "pixel_conversion.h"
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Creates an MJPEG frame of |width| x |height| pixels without Huffman
+// tables, as sent by most USB cameras. The scan data is filler of the size
+// cameras typically produce, as it is only copied, not decoded.
+std::vector<uint8_t> CreateMjpegFrame(uint32_t width, uint32_t height) {
+  std::vector<uint8_t> frame = {
+      // Start of image, and the AVI1 application data of MJPEG streams.
+      0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x06, 'A', 'V', 'I', '1',
+      // Frame header, three components with 4:2:2 chroma subsampling.
+      0xFF, 0xC0, 0x00, 0x11, 0x08, static_cast<uint8_t>(height >> 8),
+      static_cast<uint8_t>(height), static_cast<uint8_t>(width >> 8),
+      static_cast<uint8_t>(width), 0x03, 0x01, 0x21, 0x00, 0x02, 0x11, 0x01,
+      0x03, 0x11, 0x01,
+      // Start of scan.
+      0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00,
+      0x3F, 0x00};
+  // About 1.5 bits per pixel.
+  frame.resize(frame.size() + static_cast<size_t>(width) * height * 3 / 16,
+               0x5A);
+  frame.push_back(0xFF);
+  frame.push_back(0xD9);
+  return frame;
+}
+
+// Parses an MJPEG frame of state.range(0) x state.range(1) pixels and
+// inserts the default Huffman tables, as done before each decode.
+void BM_PrepareMjpegFrame(benchmark::State& state) {
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  const std::vector<uint8_t> frame = CreateMjpegFrame(width, height);
+  std::vector<uint8_t> output;
+
+  for (auto _ : state) {
+    JpegFrameInfo info;
+    if (!ParseJpegFrameInfo(frame.data(), frame.size(), &info)) {
+      state.SkipWithError("Failed to parse frame");
+      return;
+    }
+    InsertDefaultHuffmanTables(frame.data(), frame.size(), info, &output);
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame.size()));
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Converts the BGR output of the decoder for a frame of state.range(0) x
+// state.range(1) pixels decoded at a scale of 1 / state.range(2), with the
+// given conversion path.
+void BM_ConvertDecodedMjpegFrame(benchmark::State& state,
+                                 PixelConversionPath path) {
+  if (!IsPixelConversionPathSupported(path)) {
+    state.SkipWithError("Conversion path not supported by this CPU");
+    return;
+  }
+
+  const uint32_t scale = static_cast<uint32_t>(state.range(2));
+  const uint32_t width = static_cast<uint32_t>(state.range(0)) / scale;
+  const uint32_t height = static_cast<uint32_t>(state.range(1)) / scale;
+  const size_t pixels = static_cast<size_t>(width) * height;
+
+  std::vector<uint8_t> source(pixels * 3, 0x80);
+  std::vector<uint8_t> destination(pixels * 4);
+
+  for (auto _ : state) {
+    ConvertRGB24ToRGBAWithPath(path, source.data(), width * 3,
+                               destination.data(), width, height, false);
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(destination.size()));
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 1080p and 4K UHD frames.
+void FrameSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height"});
+  benchmark->Args({1920, 1080});
+  benchmark->Args({3840, 2160});
+}
+
+// 1080p and 4K UHD frames, at every scale of the decoder.
+void DecodedFrameSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height", "scale"});
+  for (int scale : {1, 2, 4, 8}) {
+    benchmark->Args({1920, 1080, scale});
+    benchmark->Args({3840, 2160, scale});
+  }
+}
+
+BENCHMARK(BM_PrepareMjpegFrame)->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertDecodedMjpegFrame, Scalar,
+                  PixelConversionPath::kScalar)
+    ->Apply(DecodedFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertDecodedMjpegFrame, SSSE3,
+                  PixelConversionPath::kSSSE3)
+    ->Apply(DecodedFrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertDecodedMjpegFrame, NEON,
+                  PixelConversionPath::kNEON)
+    ->Apply(DecodedFrameSizes);
+
+}  // namespace
+
+}  // namespace test
+}  // namespace camera_windows
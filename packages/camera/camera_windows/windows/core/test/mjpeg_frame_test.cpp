@@ -0,0 +1,142 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mjpeg_frame.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Marker segments of a minimal MJPEG frame, as sent by cameras that omit the
+// Huffman tables. Scan data is not needed for parsing.
+const std::vector<uint8_t> kStartOfImage = {0xFF, 0xD8};
+const std::vector<uint8_t> kApplicationData = {0xFF, 0xE0, 0x00, 0x06,
+                                               'A',  'V',  'I',  '1'};
+// 1280x720 pixels, three components with 4:2:2 chroma subsampling.
+const std::vector<uint8_t> kStartOfFrame = {
+    0xFF, 0xC0, 0x00, 0x11, 0x08, 0x02, 0xD0, 0x05, 0x00, 0x03,
+    0x01, 0x21, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01};
+const std::vector<uint8_t> kHuffmanTable = {
+    0xFF, 0xC4, 0x00, 0x14, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const std::vector<uint8_t> kStartOfScan = {0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01,
+                                           0x00, 0x02, 0x11, 0x03, 0x11, 0x00,
+                                           0x3F, 0x00, 0x12, 0x34, 0xFF, 0xD9};
+
+// Concatenates marker segments into a frame.
+std::vector<uint8_t> CreateFrame(
+    const std::vector<std::vector<uint8_t>>& segments) {
+  std::vector<uint8_t> frame;
+  for (const std::vector<uint8_t>& segment : segments) {
+    frame.insert(frame.end(), segment.begin(), segment.end());
+  }
+  return frame;
+}
+
+}  // namespace
+
+TEST(MjpegFrame, ParsesFrameHeader) {
+  const std::vector<uint8_t> frame = CreateFrame(
+      {kStartOfImage, kApplicationData, kStartOfFrame, kStartOfScan});
+
+  JpegFrameInfo info;
+  ASSERT_TRUE(ParseJpegFrameInfo(frame.data(), frame.size(), &info));
+  EXPECT_EQ(info.width, 1280u);
+  EXPECT_EQ(info.height, 720u);
+  EXPECT_EQ(info.component_count, 3u);
+  EXPECT_FALSE(info.has_huffman_tables);
+  EXPECT_EQ(info.scan_offset, kStartOfImage.size() + kApplicationData.size() +
+                                  kStartOfFrame.size());
+}
+
+TEST(MjpegFrame, DetectsHuffmanTables) {
+  const std::vector<uint8_t> frame = CreateFrame(
+      {kStartOfImage, kHuffmanTable, kStartOfFrame, kStartOfScan});
+
+  JpegFrameInfo info;
+  ASSERT_TRUE(ParseJpegFrameInfo(frame.data(), frame.size(), &info));
+  EXPECT_TRUE(info.has_huffman_tables);
+}
+
+TEST(MjpegFrame, RejectsInvalidFrames) {
+  JpegFrameInfo info;
+
+  // Not a JPEG image.
+  const std::vector<uint8_t> no_image =
+      CreateFrame({kApplicationData, kStartOfFrame, kStartOfScan});
+  EXPECT_FALSE(ParseJpegFrameInfo(no_image.data(), no_image.size(), &info));
+
+  // The scan starts before the frame header.
+  const std::vector<uint8_t> no_frame_header =
+      CreateFrame({kStartOfImage, kStartOfScan, kStartOfFrame});
+  EXPECT_FALSE(ParseJpegFrameInfo(no_frame_header.data(),
+                                  no_frame_header.size(), &info));
+
+  // Truncated within the frame header.
+  const std::vector<uint8_t> frame =
+      CreateFrame({kStartOfImage, kStartOfFrame, kStartOfScan});
+  EXPECT_FALSE(ParseJpegFrameInfo(frame.data(), 10, &info));
+}
+
+TEST(MjpegFrame, InsertsDefaultHuffmanTablesBeforeScan) {
+  const std::vector<uint8_t> frame = CreateFrame(
+      {kStartOfImage, kApplicationData, kStartOfFrame, kStartOfScan});
+  JpegFrameInfo info;
+  ASSERT_TRUE(ParseJpegFrameInfo(frame.data(), frame.size(), &info));
+
+  std::vector<uint8_t> output;
+  InsertDefaultHuffmanTables(frame.data(), frame.size(), info, &output);
+
+  JpegFrameInfo output_info;
+  ASSERT_TRUE(ParseJpegFrameInfo(output.data(), output.size(), &output_info));
+  EXPECT_TRUE(output_info.has_huffman_tables);
+  EXPECT_EQ(output_info.width, info.width);
+  EXPECT_EQ(output_info.height, info.height);
+
+  // Everything else is copied unchanged, and the inserted segment holds two
+  // DC tables of 12 symbols and two AC tables of 162 symbols.
+  const size_t table_size = output.size() - frame.size();
+  EXPECT_EQ(table_size, 2u + 2u + 2 * (17 + 12) + 2 * (17 + 162));
+  EXPECT_EQ(std::vector<uint8_t>(output.begin(),
+                                 output.begin() + info.scan_offset),
+            std::vector<uint8_t>(frame.begin(),
+                                 frame.begin() + info.scan_offset));
+  EXPECT_EQ(std::vector<uint8_t>(output.begin() + info.scan_offset + table_size,
+                                 output.end()),
+            kStartOfScan);
+
+  // Each table lists as many symbols as it has codes.
+  size_t offset = info.scan_offset + 4;
+  for (int table = 0; table < 4; table++) {
+    size_t symbol_count = 0;
+    for (size_t i = 1; i <= 16; i++) {
+      symbol_count += output[offset + i];
+    }
+    EXPECT_EQ(symbol_count, output[offset] & 0xF0 ? 162u : 12u);
+    offset += 17 + symbol_count;
+  }
+  EXPECT_EQ(offset, info.scan_offset + table_size);
+}
+
+TEST(MjpegFrame, ChoosesLargestScaleCoveringTarget) {
+  // Unknown target size.
+  EXPECT_EQ(GetJpegScaleDenominator(1920, 1080, 0, 0), 1u);
+  // Targets larger than half of the frame.
+  EXPECT_EQ(GetJpegScaleDenominator(1920, 1080, 1920, 1080), 1u);
+  EXPECT_EQ(GetJpegScaleDenominator(1920, 1080, 961, 300), 1u);
+  // Scaled sizes are rounded up.
+  EXPECT_EQ(GetJpegScaleDenominator(1920, 1080, 960, 540), 2u);
+  EXPECT_EQ(GetJpegScaleDenominator(3840, 2160, 800, 450), 4u);
+  EXPECT_EQ(GetJpegScaleDenominator(1921, 1081, 241, 136), 8u);
+  EXPECT_EQ(GetJpegScaleDenominator(3840, 2160, 100, 100), 8u);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,66 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pixel_conversion.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Converts a frame of state.range(0) x state.range(1) pixels with the given
+// conversion path. state.range(2) selects mirroring.
+void BM_ConvertRGB32ToRGBA(benchmark::State& state, PixelConversionPath path) {
+  if (!IsPixelConversionPathSupported(path)) {
+    state.SkipWithError("Conversion path not supported by this CPU");
+    return;
+  }
+
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  const bool mirror = state.range(2) != 0;
+  const size_t frame_size = static_cast<size_t>(width) * height * 4;
+
+  std::vector<uint8_t> source(frame_size, 0x80);
+  std::vector<uint8_t> destination(frame_size);
+
+  for (auto _ : state) {
+    ConvertRGB32ToRGBAWithPath(path, source.data(), width * 4,
+                               destination.data(), width, height, mirror);
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(frame_size));
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 1080p and 4K UHD frames, with and without mirroring.
+void FrameSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height", "mirror"});
+  for (int mirror : {0, 1}) {
+    benchmark->Args({1920, 1080, mirror});
+    benchmark->Args({3840, 2160, mirror});
+  }
+}
+
+BENCHMARK_CAPTURE(BM_ConvertRGB32ToRGBA, Scalar, PixelConversionPath::kScalar)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertRGB32ToRGBA, SSSE3, PixelConversionPath::kSSSE3)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertRGB32ToRGBA, AVX2, PixelConversionPath::kAVX2)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertRGB32ToRGBA, NEON, PixelConversionPath::kNEON)
+    ->Apply(FrameSizes);
+
+}  // namespace
+
+}  // namespace test
+}  // namespace camera_windows
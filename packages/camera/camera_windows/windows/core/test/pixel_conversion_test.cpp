@@ -0,0 +1,258 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "pixel_conversion.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+const PixelConversionPath kAllPaths[] = {
+    PixelConversionPath::kScalar,
+    PixelConversionPath::kSSSE3,
+    PixelConversionPath::kAVX2,
+    PixelConversionPath::kNEON,
+};
+
+// Returns |width| * |height| BGRX pixels filled with deterministic noise.
+std::vector<uint8_t> CreateNoiseFrame(uint32_t width, uint32_t height) {
+  std::mt19937 generator(width * 7919 + height);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4);
+  for (uint8_t& value : frame) {
+    value = static_cast<uint8_t>(distribution(generator));
+  }
+  return frame;
+}
+
+}  // namespace
+
+TEST(PixelConversion, ScalarPathIsAlwaysSupported) {
+  EXPECT_TRUE(IsPixelConversionPathSupported(PixelConversionPath::kScalar));
+  EXPECT_TRUE(
+      IsPixelConversionPathSupported(GetPreferredPixelConversionPath()));
+}
+
+TEST(PixelConversion, ConvertRGB32ToRGBAMatchesGoldenOutput) {
+  // Two rows of five BGRX pixels. The X byte must never reach the output.
+  const std::vector<uint8_t> source = {
+      0x01, 0x02, 0x03, 0xAA, 0x11, 0x12, 0x13, 0xAA, 0x21, 0x22,
+      0x23, 0xAA, 0x31, 0x32, 0x33, 0xAA, 0x41, 0x42, 0x43, 0xAA,
+      0x51, 0x52, 0x53, 0x00, 0x61, 0x62, 0x63, 0x00, 0x71, 0x72,
+      0x73, 0x00, 0x81, 0x82, 0x83, 0x00, 0x91, 0x92, 0x93, 0x00,
+  };
+  const std::vector<uint8_t> expected = {
+      0x03, 0x02, 0x01, 0xFF, 0x13, 0x12, 0x11, 0xFF, 0x23, 0x22,
+      0x21, 0xFF, 0x33, 0x32, 0x31, 0xFF, 0x43, 0x42, 0x41, 0xFF,
+      0x53, 0x52, 0x51, 0xFF, 0x63, 0x62, 0x61, 0xFF, 0x73, 0x72,
+      0x71, 0xFF, 0x83, 0x82, 0x81, 0xFF, 0x93, 0x92, 0x91, 0xFF,
+  };
+  const std::vector<uint8_t> expected_mirrored = {
+      0x43, 0x42, 0x41, 0xFF, 0x33, 0x32, 0x31, 0xFF, 0x23, 0x22,
+      0x21, 0xFF, 0x13, 0x12, 0x11, 0xFF, 0x03, 0x02, 0x01, 0xFF,
+      0x93, 0x92, 0x91, 0xFF, 0x83, 0x82, 0x81, 0xFF, 0x73, 0x72,
+      0x71, 0xFF, 0x63, 0x62, 0x61, 0xFF, 0x53, 0x52, 0x51, 0xFF,
+  };
+
+  for (PixelConversionPath path : kAllPaths) {
+    if (!IsPixelConversionPathSupported(path)) {
+      continue;
+    }
+    SCOPED_TRACE(static_cast<int>(path));
+
+    std::vector<uint8_t> converted(source.size());
+    ConvertRGB32ToRGBAWithPath(path, source.data(), 20, converted.data(), 5,
+                               2, false);
+    EXPECT_EQ(converted, expected);
+
+    ConvertRGB32ToRGBAWithPath(path, source.data(), 20, converted.data(), 5,
+                               2, true);
+    EXPECT_EQ(converted, expected_mirrored);
+  }
+}
+
+TEST(PixelConversion, VectorizedPathsMatchScalarPathForAllRowWidths) {
+  // Covers widths below, at, and above every vector size so that the tail
+  // handling of each kernel is exercised.
+  const uint32_t height = 3;
+  for (uint32_t width = 1; width <= 70; width++) {
+    const std::vector<uint8_t> source = CreateNoiseFrame(width, height);
+
+    for (bool mirror : {false, true}) {
+      std::vector<uint8_t> reference(source.size());
+      ConvertRGB32ToRGBAWithPath(PixelConversionPath::kScalar, source.data(),
+                                 width * 4, reference.data(), width, height,
+                                 mirror);
+
+      for (PixelConversionPath path : kAllPaths) {
+        if (!IsPixelConversionPathSupported(path)) {
+          continue;
+        }
+        SCOPED_TRACE(testing::Message() << "path " << static_cast<int>(path)
+                                        << " width " << width << " mirror "
+                                        << mirror);
+
+        std::vector<uint8_t> converted(source.size(), 0xCD);
+        ConvertRGB32ToRGBAWithPath(path, source.data(), width * 4,
+                                   converted.data(), width, height, mirror);
+        EXPECT_EQ(converted, reference);
+      }
+    }
+  }
+}
+
+TEST(PixelConversion, ConvertRGB32ToRGBAUsesPreferredPath) {
+  const uint32_t width = 37;
+  const uint32_t height = 5;
+  const std::vector<uint8_t> source = CreateNoiseFrame(width, height);
+
+  std::vector<uint8_t> reference(source.size());
+  ConvertRGB32ToRGBAWithPath(PixelConversionPath::kScalar, source.data(),
+                             width * 4, reference.data(), width, height, true);
+
+  std::vector<uint8_t> converted(source.size());
+  ConvertRGB32ToRGBA(source.data(), width * 4, converted.data(), width, height,
+                     true);
+  EXPECT_EQ(converted, reference);
+}
+
+TEST(PixelConversion, ConvertRGB32ToRGBAHandlesPaddedRows) {
+  const uint32_t width = 21;
+  const uint32_t height = 4;
+  const uint32_t row_size = width * 4;
+  const uint32_t padding = 44;
+  const std::vector<uint8_t> packed = CreateNoiseFrame(width, height);
+
+  // Copies the rows into a buffer with garbage padding after each row, as
+  // delivered by cameras with aligned pitches.
+  const int32_t stride = row_size + padding;
+  std::vector<uint8_t> padded(static_cast<size_t>(stride) * height, 0xEE);
+  for (uint32_t y = 0; y < height; y++) {
+    std::copy(packed.begin() + y * row_size,
+              packed.begin() + (y + 1) * row_size,
+              padded.begin() + y * stride);
+  }
+
+  for (bool mirror : {false, true}) {
+    std::vector<uint8_t> reference(packed.size());
+    ConvertRGB32ToRGBAWithPath(PixelConversionPath::kScalar, packed.data(),
+                               row_size, reference.data(), width, height,
+                               mirror);
+
+    for (PixelConversionPath path : kAllPaths) {
+      if (!IsPixelConversionPathSupported(path)) {
+        continue;
+      }
+      SCOPED_TRACE(testing::Message() << "path " << static_cast<int>(path)
+                                      << " mirror " << mirror);
+
+      std::vector<uint8_t> converted(packed.size(), 0xCD);
+      ConvertRGB32ToRGBAWithPath(path, padded.data(), stride,
+                                 converted.data(), width, height, mirror);
+      EXPECT_EQ(converted, reference);
+    }
+  }
+}
+
+TEST(PixelConversion, ConvertRGB32ToRGBAHandlesBottomUpRows) {
+  const uint32_t width = 19;
+  const uint32_t height = 5;
+  const uint32_t row_size = width * 4;
+  const uint32_t padding = 12;
+  const std::vector<uint8_t> packed = CreateNoiseFrame(width, height);
+
+  // Stores the rows in reverse order, with padding, so that the top row is
+  // the last one in memory.
+  const uint32_t pitch = row_size + padding;
+  std::vector<uint8_t> bottom_up(static_cast<size_t>(pitch) * height, 0xEE);
+  for (uint32_t y = 0; y < height; y++) {
+    std::copy(packed.begin() + y * row_size,
+              packed.begin() + (y + 1) * row_size,
+              bottom_up.begin() + (height - 1 - y) * pitch);
+  }
+  const uint8_t* scanline0 = bottom_up.data() + (height - 1) * pitch;
+  const int32_t stride = -static_cast<int32_t>(pitch);
+
+  for (bool mirror : {false, true}) {
+    std::vector<uint8_t> reference(packed.size());
+    ConvertRGB32ToRGBAWithPath(PixelConversionPath::kScalar, packed.data(),
+                               row_size, reference.data(), width, height,
+                               mirror);
+
+    for (PixelConversionPath path : kAllPaths) {
+      if (!IsPixelConversionPathSupported(path)) {
+        continue;
+      }
+      SCOPED_TRACE(testing::Message() << "path " << static_cast<int>(path)
+                                      << " mirror " << mirror);
+
+      std::vector<uint8_t> converted(packed.size(), 0xCD);
+      ConvertRGB32ToRGBAWithPath(path, scanline0, stride, converted.data(),
+                                 width, height, mirror);
+      EXPECT_EQ(converted, reference);
+    }
+  }
+}
+
+TEST(PixelConversion, ConvertRGB24ToRGBAMatchesGoldenOutput) {
+  // One row of three BGR pixels.
+  const std::vector<uint8_t> source = {0x01, 0x02, 0x03, 0x11, 0x12,
+                                       0x13, 0x21, 0x22, 0x23};
+  const std::vector<uint8_t> expected = {0x03, 0x02, 0x01, 0xFF, 0x13, 0x12,
+                                         0x11, 0xFF, 0x23, 0x22, 0x21, 0xFF};
+  const std::vector<uint8_t> expected_mirrored = {
+      0x23, 0x22, 0x21, 0xFF, 0x13, 0x12, 0x11, 0xFF, 0x03, 0x02, 0x01, 0xFF};
+
+  std::vector<uint8_t> converted(expected.size());
+  ConvertRGB24ToRGBA(source.data(), 9, converted.data(), 3, 1, false);
+  EXPECT_EQ(converted, expected);
+
+  ConvertRGB24ToRGBA(source.data(), 9, converted.data(), 3, 1, true);
+  EXPECT_EQ(converted, expected_mirrored);
+}
+
+TEST(PixelConversion, RGB24VectorizedPathsMatchScalarPath) {
+  const uint32_t height = 3;
+  for (uint32_t width = 1; width <= 70; width++) {
+    // Reuses the BGRX noise as BGR rows padded to a stride of 4 bytes per
+    // pixel, so that vector loads near the end of a row read the padding.
+    const std::vector<uint8_t> source = CreateNoiseFrame(width, height);
+    const int32_t stride = static_cast<int32_t>(width * 4);
+    // The last row is only |width| * 3 bytes long.
+    const std::vector<uint8_t> trimmed(source.begin(),
+                                       source.end() - width);
+
+    for (bool mirror : {false, true}) {
+      std::vector<uint8_t> reference(source.size());
+      ConvertRGB24ToRGBAWithPath(PixelConversionPath::kScalar, trimmed.data(),
+                                 stride, reference.data(), width, height,
+                                 mirror);
+
+      for (PixelConversionPath path : kAllPaths) {
+        if (!IsPixelConversionPathSupported(path)) {
+          continue;
+        }
+        SCOPED_TRACE(testing::Message() << "path " << static_cast<int>(path)
+                                        << " width " << width << " mirror "
+                                        << mirror);
+
+        std::vector<uint8_t> converted(source.size(), 0xCD);
+        ConvertRGB24ToRGBAWithPath(path, trimmed.data(), stride,
+                                   converted.data(), width, height, mirror);
+        EXPECT_EQ(converted, reference);
+      }
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace camera_windows
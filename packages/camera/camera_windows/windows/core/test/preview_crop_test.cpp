@@ -0,0 +1,104 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "preview_crop.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+void ExpectRegion(const FrameRegion& region, uint32_t x, uint32_t y,
+                  uint32_t width, uint32_t height) {
+  EXPECT_EQ(region.x, x);
+  EXPECT_EQ(region.y, y);
+  EXPECT_EQ(region.width, width);
+  EXPECT_EQ(region.height, height);
+}
+
+}  // namespace
+
+TEST(PreviewCrop, ValidatesCrops) {
+  EXPECT_TRUE(IsValidPreviewCrop(PreviewCrop()));
+  EXPECT_TRUE(IsValidPreviewCrop({0.5, 0.25, 0.5, 0.75, 16.0}));
+  // Edges computed by the app may land just past the frame.
+  EXPECT_TRUE(IsValidPreviewCrop({0.3, 0.0, 0.7 + 1e-12, 1.0, 1.0}));
+
+  EXPECT_FALSE(IsValidPreviewCrop({-0.1, 0.0, 0.5, 0.5, 1.0}));
+  EXPECT_FALSE(IsValidPreviewCrop({0.0, 0.0, 0.0, 0.5, 1.0}));
+  EXPECT_FALSE(IsValidPreviewCrop({0.6, 0.0, 0.5, 0.5, 1.0}));
+  EXPECT_FALSE(IsValidPreviewCrop({0.0, 0.0, 1.0, 1.0, 0.5}));
+  EXPECT_FALSE(IsValidPreviewCrop({0.0, 0.0, 1.0, 1.0, INFINITY}));
+  EXPECT_FALSE(IsValidPreviewCrop({0.0, 0.0, 1.0, 1.0, std::nan("")}));
+}
+
+TEST(PreviewCrop, ShowsWholeFrameByDefault) {
+  FrameRegion region;
+  EXPECT_FALSE(GetPreviewCropRegion(1920, 1080, PreviewCrop(), false, &region));
+  EXPECT_FALSE(GetPreviewCropRegion(1920, 1080, PreviewCrop(), true, &region));
+}
+
+TEST(PreviewCrop, ZoomsAroundCenterOfCrop) {
+  FrameRegion region;
+  PreviewCrop crop;
+  crop.zoom = 2.0;
+  ASSERT_TRUE(GetPreviewCropRegion(1920, 1080, crop, false, &region));
+  ExpectRegion(region, 480, 270, 960, 540);
+
+  // The right half of the frame, zoomed in 4 times.
+  crop = {0.5, 0.0, 0.5, 1.0, 4.0};
+  ASSERT_TRUE(GetPreviewCropRegion(1920, 1080, crop, false, &region));
+  ExpectRegion(region, 1320, 404, 240, 272);
+}
+
+TEST(PreviewCrop, MirrorsCropWithPreview) {
+  // The left quarter of a mirrored preview is the right quarter of frames.
+  const PreviewCrop crop = {0.0, 0.0, 0.25, 1.0, 1.0};
+  FrameRegion region;
+  ASSERT_TRUE(GetPreviewCropRegion(1280, 720, crop, true, &region));
+  ExpectRegion(region, 960, 0, 320, 720);
+  ASSERT_TRUE(GetPreviewCropRegion(1280, 720, crop, false, &region));
+  ExpectRegion(region, 0, 0, 320, 720);
+}
+
+TEST(PreviewCrop, AlignsRegionsToEvenPixels) {
+  // 101 / 3 = 33.67 to 67.33 pixels, widened to 32 to 68.
+  const PreviewCrop crop = {1.0 / 3, 1.0 / 3, 1.0 / 3, 1.0 / 3, 1.0};
+  FrameRegion region;
+  ASSERT_TRUE(GetPreviewCropRegion(101, 101, crop, false, &region));
+  ExpectRegion(region, 32, 32, 36, 36);
+
+  // Slivers at the edge start at an even column within the frame, and run
+  // to the odd last column.
+  const PreviewCrop sliver = {0.999, 0.0, 0.001, 1.0, 8.0};
+  ASSERT_TRUE(GetPreviewCropRegion(101, 101, sliver, false, &region));
+  EXPECT_EQ(region.x, 98u);
+  EXPECT_EQ(region.width, 3u);
+}
+
+TEST(PreviewCrop, DerivesMaxZoomFromFrameHeight) {
+  EXPECT_DOUBLE_EQ(GetMaxPreviewZoom(1080), 1080.0 / kMinPreviewZoomHeight);
+  EXPECT_DOUBLE_EQ(GetMaxPreviewZoom(2160), 2 * GetMaxPreviewZoom(1080));
+  EXPECT_DOUBLE_EQ(GetMaxPreviewZoom(kMinPreviewZoomHeight), 1.0);
+  EXPECT_DOUBLE_EQ(GetMaxPreviewZoom(kMinPreviewZoomHeight / 2), 1.0);
+  EXPECT_DOUBLE_EQ(GetMaxPreviewZoom(0), 1.0);
+}
+
+TEST(PreviewCrop, ScalesRequestedSizeToWholeFrames) {
+  const PreviewCrop crop = {0.0, 0.0, 0.5, 1.0, 2.0};
+  const FrameSize size = GetUncroppedFrameSize({640, 360}, crop);
+  EXPECT_EQ(size.width, 2560u);
+  EXPECT_EQ(size.height, 720u);
+
+  EXPECT_EQ(GetUncroppedFrameSize({0, 0}, crop), FrameSize({0, 0}));
+  EXPECT_EQ(GetUncroppedFrameSize({640, 360}, PreviewCrop()),
+            FrameSize({640, 360}));
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,127 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "preview_size_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+using Clock = PreviewSizePolicy::Clock;
+using std::chrono::milliseconds;
+
+const FrameSize kFullSize = {1920, 1080};
+
+}  // namespace
+
+TEST(PreviewSizePolicy, WaitsForUnknownTextureSize) {
+  PreviewSizePolicy policy(kFullSize);
+  const Clock::time_point start;
+  FrameSize next_size;
+
+  EXPECT_FALSE(policy.Update({0, 0}, start, &next_size));
+  EXPECT_FALSE(policy.Update({0, 0}, start + milliseconds(5000), &next_size));
+  EXPECT_EQ(policy.GetCurrentSize(), kFullSize);
+}
+
+TEST(PreviewSizePolicy, ShrinksAfterRequestSettles) {
+  PreviewSizePolicy policy(kFullSize);
+  const Clock::time_point start;
+  FrameSize next_size;
+
+  // A 360x200 thumbnail fits in 1/4 of the full size with headroom.
+  const FrameSize thumbnail = {360, 200};
+  EXPECT_FALSE(policy.Update(thumbnail, start, &next_size));
+  EXPECT_FALSE(policy.Update(thumbnail, start + milliseconds(999), &next_size));
+  ASSERT_TRUE(policy.Update(thumbnail, start + milliseconds(1000), &next_size));
+  EXPECT_EQ(next_size, FrameSize({480, 270}));
+  EXPECT_EQ(policy.GetCurrentSize(), next_size);
+
+  // Stays there while the request does not change.
+  EXPECT_FALSE(
+      policy.Update(thumbnail, start + milliseconds(5000), &next_size));
+}
+
+TEST(PreviewSizePolicy, GrowsFasterThanItShrinks) {
+  PreviewSizePolicy policy(kFullSize);
+  const Clock::time_point start;
+  FrameSize next_size;
+
+  ASSERT_TRUE(policy.Update({400, 225}, start, &next_size) ||
+              policy.Update({400, 225}, start + milliseconds(1000),
+                            &next_size));
+
+  // Growing to 1280x720 needs the 3/4 size, and only waits for the grow
+  // delay.
+  const Clock::time_point resize = start + milliseconds(2000);
+  EXPECT_FALSE(policy.Update({1280, 720}, resize, &next_size));
+  ASSERT_TRUE(
+      policy.Update({1280, 720}, resize + milliseconds(200), &next_size));
+  EXPECT_EQ(next_size, FrameSize({1440, 810}));
+}
+
+TEST(PreviewSizePolicy, KeepsSizeWithinHeadroom) {
+  PreviewSizePolicy policy(kFullSize);
+  const Clock::time_point start;
+  FrameSize next_size;
+
+  // 900x500 fits in the 960x540 half size, but without enough headroom to
+  // shrink to it; the 3/4 size is used instead.
+  EXPECT_FALSE(policy.Update({900, 500}, start, &next_size));
+  ASSERT_TRUE(
+      policy.Update({900, 500}, start + milliseconds(1000), &next_size));
+  EXPECT_EQ(next_size, FrameSize({1440, 810}));
+
+  // Jitter around the request never reconfigures the preview.
+  for (int i = 0; i < 100; i++) {
+    const FrameSize jitter = {900u + (i % 3) * 10, 500u + (i % 2) * 8};
+    EXPECT_FALSE(policy.Update(
+        jitter, start + milliseconds(1100 + i * 100), &next_size));
+  }
+  EXPECT_EQ(policy.GetCurrentSize(), FrameSize({1440, 810}));
+}
+
+TEST(PreviewSizePolicy, RestartsDelayWhileRequestChanges) {
+  PreviewSizePolicy policy(kFullSize);
+  const Clock::time_point start;
+  FrameSize next_size;
+
+  // A shrinking animation passes through several candidates; the preview is
+  // only reconfigured once it ends.
+  EXPECT_FALSE(policy.Update({1000, 560}, start, &next_size));
+  EXPECT_FALSE(
+      policy.Update({700, 390}, start + milliseconds(600), &next_size));
+  EXPECT_FALSE(
+      policy.Update({300, 170}, start + milliseconds(1200), &next_size));
+  EXPECT_FALSE(
+      policy.Update({300, 170}, start + milliseconds(2100), &next_size));
+  ASSERT_TRUE(
+      policy.Update({300, 170}, start + milliseconds(2200), &next_size));
+  EXPECT_EQ(next_size, FrameSize({480, 270}));
+}
+
+TEST(PreviewSizePolicy, NeverExceedsFullSize) {
+  PreviewSizePolicy policy(kFullSize);
+  const Clock::time_point start;
+  FrameSize next_size;
+
+  ASSERT_TRUE(policy.Update({400, 225}, start, &next_size) ||
+              policy.Update({400, 225}, start + milliseconds(1000),
+                            &next_size));
+
+  // A texture larger than the preset grows back to the full size only.
+  EXPECT_FALSE(policy.Update({3840, 2160}, start + milliseconds(2000),
+                             &next_size));
+  ASSERT_TRUE(policy.Update({3840, 2160}, start + milliseconds(2200),
+                            &next_size));
+  EXPECT_EQ(next_size, kFullSize);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,148 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "preview_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+using std::chrono::microseconds;
+
+// Expects |value| to be within 1/8 of |expected|.
+void ExpectNear(uint64_t value, uint64_t expected) {
+  EXPECT_GE(value * 8, expected * 7) << value << " vs " << expected;
+  EXPECT_LE(value * 8, expected * 9) << value << " vs " << expected;
+}
+
+}  // namespace
+
+TEST(DurationHistogram, ReturnsZeroWhenEmpty) {
+  DurationHistogram histogram;
+  EXPECT_EQ(histogram.GetCount(), 0u);
+  EXPECT_EQ(histogram.GetPercentile(50), 0u);
+  EXPECT_EQ(histogram.GetPercentile(99), 0u);
+}
+
+TEST(DurationHistogram, KeepsSmallDurationsExact) {
+  DurationHistogram histogram;
+  for (uint64_t i = 0; i < 4; i++) {
+    histogram.Record(i);
+  }
+  EXPECT_EQ(histogram.GetCount(), 4u);
+  EXPECT_EQ(histogram.GetPercentile(0), 0u);
+  EXPECT_EQ(histogram.GetPercentile(50), 1u);
+  EXPECT_EQ(histogram.GetPercentile(100), 3u);
+}
+
+TEST(DurationHistogram, EstimatesPercentiles) {
+  DurationHistogram histogram;
+  // 1 to 1000 milliseconds.
+  for (uint64_t i = 1; i <= 1000; i++) {
+    histogram.Record(i * 1000);
+  }
+
+  EXPECT_EQ(histogram.GetCount(), 1000u);
+  ExpectNear(histogram.GetPercentile(50), 500000);
+  ExpectNear(histogram.GetPercentile(99), 990000);
+  ExpectNear(histogram.GetPercentile(100), 1000000);
+}
+
+TEST(DurationHistogram, ClampsVeryLongDurations) {
+  DurationHistogram histogram;
+  histogram.Record(UINT64_MAX);
+  EXPECT_EQ(histogram.GetCount(), 1u);
+  EXPECT_GT(histogram.GetPercentile(50), uint64_t{1} << 38);
+}
+
+TEST(DurationHistogram, ResetsCounts) {
+  DurationHistogram histogram;
+  histogram.Record(100);
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetCount(), 0u);
+}
+
+TEST(PreviewStats, CountsFramesAndTimings) {
+  PreviewStats stats;
+
+  // 30 fps samples, with one late sample.
+  for (uint64_t i = 0; i < 100; i++) {
+    stats.OnFrameDelivered(1000000 + i * 33333 + (i == 50 ? 20000 : 0));
+    stats.OnFrameConverted(microseconds(2000));
+  }
+  stats.OnFrameFailed();
+  for (int i = 0; i < 90; i++) {
+    stats.OnFrameRendered(microseconds(10000), microseconds(45000));
+    stats.OnFrameReleased(microseconds(500));
+  }
+
+  const PreviewStatsSnapshot snapshot = stats.GetSnapshot(10);
+  EXPECT_EQ(snapshot.frames_delivered, 100u);
+  EXPECT_EQ(snapshot.frames_failed, 1u);
+  EXPECT_EQ(snapshot.frames_dropped, 10u);
+  EXPECT_EQ(snapshot.frames_rendered, 90u);
+  ExpectNear(snapshot.frame_interval_p50_us, 33333);
+  ExpectNear(snapshot.frame_interval_p99_us, 53333);
+  ExpectNear(snapshot.conversion_time_p50_us, 2000);
+  ExpectNear(snapshot.conversion_time_p99_us, 2000);
+  ExpectNear(snapshot.capture_to_texture_p50_us, 10000);
+  ExpectNear(snapshot.capture_latency_p99_us, 45000);
+  ExpectNear(snapshot.texture_hold_time_p99_us, 500);
+}
+
+TEST(PreviewStats, IgnoresBackwardSampleTimes) {
+  PreviewStats stats;
+  stats.OnFrameDelivered(1000000);
+  stats.OnFrameDelivered(500000);
+  stats.OnFrameDelivered(533333);
+
+  const PreviewStatsSnapshot snapshot = stats.GetSnapshot(0);
+  EXPECT_EQ(snapshot.frames_delivered, 3u);
+  ExpectNear(snapshot.frame_interval_p50_us, 33333);
+}
+
+TEST(PreviewStats, MeasuresSchedulingLatency) {
+  PreviewStats stats;
+  const PreviewStats::Clock::time_point start = PreviewStats::Clock::now();
+
+  // 30 fps samples delivered 5 ms after presentation, except for every
+  // tenth sample, which is held up by another 20 ms.
+  for (uint64_t i = 0; i < 200; i++) {
+    const uint64_t sample_time_us = 1000000 + i * 33333;
+    const uint64_t delay_us = 5000 + (i % 10 == 5 ? 20000 : 0);
+    stats.OnFrameDelivered(sample_time_us,
+                           start + microseconds(sample_time_us + delay_us));
+  }
+
+  const PreviewStatsSnapshot snapshot = stats.GetSnapshot(0);
+  EXPECT_EQ(snapshot.scheduling_latency_p50_us, 0u);
+  ExpectNear(snapshot.scheduling_latency_p99_us, 20000);
+}
+
+TEST(PreviewStats, SchedulingLatencyToleratesClockDrift) {
+  PreviewStats stats;
+  const PreviewStats::Clock::time_point start = PreviewStats::Clock::now();
+
+  // The system clock runs 100 ppm faster than the camera clock, so samples
+  // are delivered later and later for an hour.
+  const uint64_t frames = 30 * 3600;
+  for (uint64_t i = 0; i < frames; i++) {
+    const uint64_t sample_time_us = i * 33333;
+    const uint64_t delivery_us = sample_time_us + sample_time_us / 10000;
+    stats.OnFrameDelivered(sample_time_us, start + microseconds(delivery_us));
+  }
+
+  // Without the rising baseline, the median would be 180 ms.
+  const PreviewStatsSnapshot snapshot = stats.GetSnapshot(0);
+  EXPECT_LT(snapshot.scheduling_latency_p99_us, 5000u);
+}
+
+}  // namespace test
+}  // namespace camera_windows
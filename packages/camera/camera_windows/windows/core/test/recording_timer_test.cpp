@@ -0,0 +1,63 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "recording_timer.h"
+
+#include <gtest/gtest.h>
+
+namespace camera_windows {
+namespace test {
+
+TEST(RecordingTimer, MeasuresFromFirstTimestamp) {
+  RecordingTimer timer;
+  timer.Start(-1);
+  EXPECT_EQ(timer.GetDuration(), 0u);
+
+  timer.Update(5000000);
+  EXPECT_EQ(timer.GetDuration(), 0u);
+  timer.Update(5250000);
+  EXPECT_EQ(timer.GetDuration(), 250000u);
+
+  // Earlier timestamps keep the last duration.
+  timer.Update(4000000);
+  EXPECT_EQ(timer.GetDuration(), 250000u);
+}
+
+TEST(RecordingTimer, ReachesMaxDuration) {
+  RecordingTimer timer;
+  timer.Start(1000);
+  timer.Update(100);
+  timer.Update(100 + 999999);
+  EXPECT_FALSE(timer.HasReachedMaxDuration());
+  timer.Update(100 + 1000000);
+  EXPECT_TRUE(timer.HasReachedMaxDuration());
+}
+
+TEST(RecordingTimer, ContinuousRecordingHasNoMaxDuration) {
+  RecordingTimer timer;
+  timer.Start(-1);
+  timer.Update(0);
+  timer.Update(3600000000);
+  EXPECT_FALSE(timer.HasReachedMaxDuration());
+}
+
+TEST(RecordingTimer, RestartsFromNextTimestamp) {
+  RecordingTimer timer;
+  timer.Start(1000);
+  timer.Update(0);
+  timer.Update(2000000);
+  EXPECT_TRUE(timer.HasReachedMaxDuration());
+
+  timer.Reset();
+  EXPECT_EQ(timer.GetDuration(), 0u);
+  EXPECT_FALSE(timer.HasReachedMaxDuration());
+
+  timer.Start(1000);
+  timer.Update(3000000);
+  EXPECT_EQ(timer.GetDuration(), 0u);
+  EXPECT_FALSE(timer.HasReachedMaxDuration());
+}
+
+}  // namespace test
+}  // namespace camera_windows
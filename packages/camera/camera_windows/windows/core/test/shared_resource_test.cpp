@@ -0,0 +1,143 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "shared_resource.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+using std::chrono::hours;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+// Counts the resources created and destroyed by a |SharedResource|.
+struct ResourceCounter {
+  std::unique_ptr<SharedResource> CreateResource(
+      SharedResource::Clock::duration idle_timeout) {
+    return std::make_unique<SharedResource>(
+        [this]() {
+          if (fail_create) {
+            return false;
+          }
+          live_count++;
+          return true;
+        },
+        [this]() { live_count--; }, idle_timeout);
+  }
+
+  bool fail_create = false;
+  std::atomic<int> live_count = 0;
+};
+
+// Waits up to |timeout| for |condition| to hold.
+template <typename Condition>
+bool WaitFor(Condition condition, seconds timeout = seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(SharedResource, CreatesOnFirstAcquire) {
+  ResourceCounter counter;
+  auto resource = counter.CreateResource(hours(1));
+  EXPECT_FALSE(resource->IsCreated());
+
+  EXPECT_TRUE(resource->Acquire());
+  EXPECT_TRUE(resource->Acquire());
+
+  EXPECT_TRUE(resource->IsCreated());
+  EXPECT_EQ(resource->GetRefCount(), 2u);
+  EXPECT_EQ(resource->GetCreateCount(), 1u);
+  EXPECT_EQ(counter.live_count, 1);
+
+  resource->Release();
+  resource->Release();
+}
+
+TEST(SharedResource, DestroysWhenReleasedWithoutTimeout) {
+  ResourceCounter counter;
+  auto resource = counter.CreateResource(milliseconds(0));
+
+  ASSERT_TRUE(resource->Acquire());
+  ASSERT_TRUE(resource->Acquire());
+  resource->Release();
+  EXPECT_EQ(counter.live_count, 1);
+
+  resource->Release();
+  EXPECT_FALSE(resource->IsCreated());
+  EXPECT_EQ(counter.live_count, 0);
+
+  ASSERT_TRUE(resource->Acquire());
+  EXPECT_EQ(resource->GetCreateCount(), 2u);
+  resource->Release();
+}
+
+TEST(SharedResource, KeepsIdleResourceUntilTimeout) {
+  ResourceCounter counter;
+  auto resource = counter.CreateResource(hours(1));
+
+  ASSERT_TRUE(resource->Acquire());
+  resource->Release();
+  EXPECT_TRUE(resource->IsCreated());
+  EXPECT_EQ(resource->GetRefCount(), 0u);
+
+  // Reacquiring the idle resource reuses it.
+  ASSERT_TRUE(resource->Acquire());
+  EXPECT_EQ(resource->GetCreateCount(), 1u);
+  resource->Release();
+
+  // Destroying the owner destroys the idle resource without waiting.
+  resource = nullptr;
+  EXPECT_EQ(counter.live_count, 0);
+}
+
+TEST(SharedResource, DestroysIdleResourceAfterTimeout) {
+  ResourceCounter counter;
+  auto resource = counter.CreateResource(milliseconds(1));
+
+  ASSERT_TRUE(resource->Acquire());
+  resource->Release();
+
+  EXPECT_TRUE(WaitFor([&]() { return !resource->IsCreated(); }));
+  EXPECT_EQ(counter.live_count, 0);
+
+  // The next acquire creates the resource again.
+  ASSERT_TRUE(resource->Acquire());
+  EXPECT_EQ(resource->GetCreateCount(), 2u);
+  EXPECT_EQ(counter.live_count, 1);
+  resource->Release();
+}
+
+TEST(SharedResource, ReportsCreateFailure) {
+  ResourceCounter counter;
+  counter.fail_create = true;
+  auto resource = counter.CreateResource(hours(1));
+
+  EXPECT_FALSE(resource->Acquire());
+  EXPECT_FALSE(resource->IsCreated());
+  EXPECT_EQ(resource->GetRefCount(), 0u);
+
+  counter.fail_create = false;
+  EXPECT_TRUE(resource->Acquire());
+  resource->Release();
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,71 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "strip_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_conversion.h"
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Converts an NV12 frame of state.range(0) x state.range(1) pixels to RGBA,
+// mirrored like the preview, in strips on state.range(2) threads: the
+// calling thread and the helpers of the pool.
+void BM_ConvertNV12FrameInStrips(benchmark::State& state) {
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  const size_t threads = static_cast<size_t>(state.range(2));
+
+  FrameFormat format;
+  format.pixel_format = PixelFormat::kNV12;
+  const std::vector<uint8_t> source(
+      static_cast<size_t>(width) * height * 3 / 2, 0x80);
+  std::vector<uint8_t> destination(static_cast<size_t>(width) * height * 4);
+  FrameBufferView view;
+  view.scanline0 = source.data();
+  view.buffer_start = source.data();
+  view.buffer_length = static_cast<uint32_t>(source.size());
+  StripPool pool(threads - 1);
+
+  for (auto _ : state) {
+    if (!ConvertFrameToRGBA(format, view, destination.data(), width, height,
+                            true, &pool)) {
+      state.SkipWithError("Failed to convert frame");
+      return;
+    }
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 1080p and 4K UHD frames on 1 to 8 threads.
+void StripThreadCounts(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height", "threads"});
+  for (int64_t threads = 1; threads <= 8; threads++) {
+    benchmark->Args({1920, 1080, threads});
+  }
+  for (int64_t threads = 1; threads <= 8; threads++) {
+    benchmark->Args({3840, 2160, threads});
+  }
+}
+
+// Wall time, as the helpers do part of the work.
+BENCHMARK(BM_ConvertNV12FrameInStrips)
+    ->Apply(StripThreadCounts)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+}  // namespace test
+}  // namespace camera_windows
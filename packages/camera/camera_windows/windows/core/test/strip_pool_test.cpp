@@ -0,0 +1,134 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "strip_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+// Runs |pool.ParallelFor| and returns the strips it ran, in row order.
+std::vector<std::pair<uint32_t, uint32_t>> RunStrips(
+    StripPool* pool, uint32_t row_count, uint32_t min_strip_rows,
+    uint32_t row_alignment) {
+  std::mutex mutex;
+  std::set<std::pair<uint32_t, uint32_t>> strips;
+  pool->ParallelFor(row_count, min_strip_rows, row_alignment,
+                    [&](uint32_t begin, uint32_t end) {
+                      const std::lock_guard<std::mutex> lock(mutex);
+                      strips.emplace(begin, end);
+                    });
+  return std::vector<std::pair<uint32_t, uint32_t>>(strips.begin(),
+                                                    strips.end());
+}
+
+}  // namespace
+
+TEST(StripPool, CoversEveryRowOnceInAlignedStrips) {
+  StripPool pool(3);
+  const std::vector<std::pair<uint32_t, uint32_t>> strips =
+      RunStrips(&pool, 1081, 16, 2);
+
+  // Four threads with two strips each.
+  ASSERT_EQ(strips.size(), 8u);
+  uint32_t next_row = 0;
+  for (const auto& [begin, end] : strips) {
+    EXPECT_EQ(begin, next_row);
+    EXPECT_EQ(begin % 2, 0u);
+    EXPECT_GT(end, begin);
+    next_row = end;
+  }
+  EXPECT_EQ(next_row, 1081u);
+}
+
+TEST(StripPool, KeepsStripsAboveMinimumSize) {
+  StripPool pool(7);
+  const std::vector<std::pair<uint32_t, uint32_t>> strips =
+      RunStrips(&pool, 100, 40, 1);
+
+  ASSERT_EQ(strips.size(), 2u);
+  EXPECT_EQ(strips[0], std::make_pair(0u, 50u));
+  EXPECT_EQ(strips[1], std::make_pair(50u, 100u));
+}
+
+TEST(StripPool, RunsSmallWorkOnCallingThread) {
+  StripPool pool(3);
+  const std::thread::id caller = std::this_thread::get_id();
+  int strip_count = 0;
+  pool.ParallelFor(100, 64, 1, [&](uint32_t begin, uint32_t end) {
+    EXPECT_EQ(std::this_thread::get_id(), caller);
+    EXPECT_EQ(begin, 0u);
+    EXPECT_EQ(end, 100u);
+    strip_count++;
+  });
+  EXPECT_EQ(strip_count, 1);
+
+  // Nothing to run.
+  pool.ParallelFor(0, 1, 1, [&](uint32_t, uint32_t) { strip_count++; });
+  EXPECT_EQ(strip_count, 1);
+}
+
+TEST(StripPool, RunsEverythingOnCallingThreadWithoutHelpers) {
+  StripPool pool(0);
+  EXPECT_EQ(pool.GetHelperCount(), 0u);
+  const std::thread::id caller = std::this_thread::get_id();
+  int strip_count = 0;
+  pool.ParallelFor(4000, 1, 1, [&](uint32_t begin, uint32_t end) {
+    EXPECT_EQ(std::this_thread::get_id(), caller);
+    EXPECT_EQ(begin, 0u);
+    EXPECT_EQ(end, 4000u);
+    strip_count++;
+  });
+  EXPECT_EQ(strip_count, 1);
+}
+
+TEST(StripPool, SharesHelpersBetweenConcurrentCallers) {
+  // Three cameras converting frames at once through two helpers.
+  StripPool pool(2);
+  constexpr int kCallers = 3;
+  constexpr int kFrames = 50;
+  constexpr uint32_t kRows = 480;
+  std::atomic<int> completed_frames = 0;
+
+  std::vector<std::thread> callers;
+  for (int i = 0; i < kCallers; i++) {
+    callers.emplace_back([&]() {
+      for (int frame = 0; frame < kFrames; frame++) {
+        std::vector<std::atomic<int>> row_runs(kRows);
+        pool.ParallelFor(kRows, 8, 2, [&](uint32_t begin, uint32_t end) {
+          for (uint32_t row = begin; row < end; row++) {
+            row_runs[row]++;
+          }
+        });
+        // Every row has run exactly once by the time the call returns.
+        bool complete = true;
+        for (const std::atomic<int>& runs : row_runs) {
+          complete = complete && runs == 1;
+        }
+        if (complete) {
+          completed_frames++;
+        }
+      }
+    });
+  }
+  for (std::thread& caller : callers) {
+    caller.join();
+  }
+
+  EXPECT_EQ(completed_frames, kCallers * kFrames);
+}
+
+}  // namespace test
+}  // namespace camera_windows
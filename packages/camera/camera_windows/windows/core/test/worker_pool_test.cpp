@@ -0,0 +1,147 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "worker_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+TEST(WorkerPool, RunsPostedTasksInOrderOnOneThread) {
+  std::vector<int> order;
+  {
+    WorkerPool pool(1);
+    for (int i = 0; i < 10; i++) {
+      pool.Post([&order, i]() { order.push_back(i); });
+    }
+  }
+
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(WorkerPool, DestructorRunsQueuedTasks) {
+  std::atomic<int> count = 0;
+  {
+    WorkerPool pool(2);
+    for (int i = 0; i < 100; i++) {
+      pool.Post([&count]() { count++; });
+    }
+  }
+
+  EXPECT_EQ(count, 100);
+}
+
+TEST(WorkerPool, RunsTasksOnPoolThreads) {
+  std::mutex mutex;
+  std::set<std::thread::id> thread_ids;
+  {
+    WorkerPool pool(3);
+    EXPECT_EQ(pool.GetThreadCount(), 3u);
+    for (int i = 0; i < 30; i++) {
+      pool.Post([&mutex, &thread_ids]() {
+        const std::lock_guard<std::mutex> lock(mutex);
+        thread_ids.insert(std::this_thread::get_id());
+      });
+    }
+  }
+
+  EXPECT_FALSE(thread_ids.empty());
+  EXPECT_EQ(thread_ids.count(std::this_thread::get_id()), 0u);
+}
+
+TEST(WorkerPool, RunsTasksConcurrently) {
+  std::mutex mutex;
+  std::condition_variable arrived;
+  int waiting = 0;
+  bool both_ran = false;
+  {
+    WorkerPool pool(2);
+    for (int i = 0; i < 2; i++) {
+      pool.Post([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        waiting++;
+        arrived.notify_all();
+        both_ran = arrived.wait_for(lock, std::chrono::seconds(10),
+                                    [&]() { return waiting == 2; });
+      });
+    }
+  }
+
+  EXPECT_TRUE(both_ran);
+}
+
+TEST(WorkerPool, CountsPendingTasks) {
+  std::mutex mutex;
+  std::unique_lock<std::mutex> block(mutex);
+  WorkerPool pool(1);
+  pool.Post([&mutex]() { const std::lock_guard<std::mutex> lock(mutex); });
+  pool.Post([]() {});
+
+  EXPECT_EQ(pool.GetPendingTaskCount(), 2u);
+  block.unlock();
+}
+
+TEST(WorkerPool, TasksCanPostTasks) {
+  std::atomic<int> count = 0;
+  {
+    WorkerPool pool(1);
+    pool.Post([&pool, &count]() {
+      count++;
+      pool.Post([&count]() { count++; });
+    });
+  }
+
+  EXPECT_EQ(count, 2);
+}
+
+TEST(WorkerPool, CallsThreadHooksAroundTasksOnEachThread) {
+  // Set by the start hook and cleared by the stop hook of each thread.
+  thread_local bool thread_started = false;
+  std::atomic<int> start_count = 0;
+  std::atomic<int> stop_count = 0;
+  std::atomic<int> tasks_on_started_threads = 0;
+  {
+    WorkerPool pool(
+        3,
+        [&start_count]() {
+          thread_started = true;
+          start_count++;
+        },
+        [&stop_count]() {
+          if (thread_started) {
+            stop_count++;
+          }
+          thread_started = false;
+        });
+    for (int i = 0; i < 30; i++) {
+      pool.Post([&tasks_on_started_threads]() {
+        if (thread_started) {
+          tasks_on_started_threads++;
+        }
+      });
+    }
+  }
+
+  EXPECT_EQ(start_count, 3);
+  EXPECT_EQ(stop_count, 3);
+  EXPECT_EQ(tasks_on_started_threads, 30);
+}
+
+TEST(WorkerPool, ZeroThreadsStartsOneThread) {
+  WorkerPool pool(0);
+
+  EXPECT_EQ(pool.GetThreadCount(), 1u);
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,103 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "yuv_conversion.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+const YuvColorSpace kColorSpace = {YuvMatrix::kBT709, YuvRange::kLimited};
+
+// Converts an NV12 frame of state.range(0) x state.range(1) pixels with the
+// given conversion path. state.range(2) selects mirroring.
+void BM_ConvertNV12ToRGBA(benchmark::State& state, PixelConversionPath path) {
+  if (!IsPixelConversionPathSupported(path)) {
+    state.SkipWithError("Conversion path not supported by this CPU");
+    return;
+  }
+
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  const bool mirror = state.range(2) != 0;
+  const size_t luma_size = static_cast<size_t>(width) * height;
+
+  std::vector<uint8_t> source(luma_size * 3 / 2, 0x80);
+  std::vector<uint8_t> destination(luma_size * 4);
+
+  for (auto _ : state) {
+    ConvertNV12ToRGBAWithPath(path, source.data(), width,
+                              source.data() + luma_size, width,
+                              destination.data(), width, height, kColorSpace,
+                              mirror);
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(destination.size()));
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Converts a YUY2 frame of state.range(0) x state.range(1) pixels with the
+// given conversion path. state.range(2) selects mirroring.
+void BM_ConvertYUY2ToRGBA(benchmark::State& state, PixelConversionPath path) {
+  if (!IsPixelConversionPathSupported(path)) {
+    state.SkipWithError("Conversion path not supported by this CPU");
+    return;
+  }
+
+  const uint32_t width = static_cast<uint32_t>(state.range(0));
+  const uint32_t height = static_cast<uint32_t>(state.range(1));
+  const bool mirror = state.range(2) != 0;
+  const size_t pixels = static_cast<size_t>(width) * height;
+
+  std::vector<uint8_t> source(pixels * 2, 0x80);
+  std::vector<uint8_t> destination(pixels * 4);
+
+  for (auto _ : state) {
+    ConvertYUY2ToRGBAWithPath(path, source.data(), width * 2,
+                              destination.data(), width, height, kColorSpace,
+                              mirror);
+    benchmark::DoNotOptimize(destination.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(destination.size()));
+  state.SetItemsProcessed(state.iterations());
+}
+
+// 1080p and 4K UHD frames, with and without mirroring.
+void FrameSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height", "mirror"});
+  for (int mirror : {0, 1}) {
+    benchmark->Args({1920, 1080, mirror});
+    benchmark->Args({3840, 2160, mirror});
+  }
+}
+
+BENCHMARK_CAPTURE(BM_ConvertNV12ToRGBA, Scalar, PixelConversionPath::kScalar)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertNV12ToRGBA, SSSE3, PixelConversionPath::kSSSE3)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertNV12ToRGBA, NEON, PixelConversionPath::kNEON)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertYUY2ToRGBA, Scalar, PixelConversionPath::kScalar)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertYUY2ToRGBA, SSSE3, PixelConversionPath::kSSSE3)
+    ->Apply(FrameSizes);
+BENCHMARK_CAPTURE(BM_ConvertYUY2ToRGBA, NEON, PixelConversionPath::kNEON)
+    ->Apply(FrameSizes);
+
+}  // namespace
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,248 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "yuv_conversion.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+const PixelConversionPath kAllPaths[] = {
+    PixelConversionPath::kScalar,
+    PixelConversionPath::kSSSE3,
+    PixelConversionPath::kAVX2,
+    PixelConversionPath::kNEON,
+};
+
+const YuvColorSpace kAllColorSpaces[] = {
+    {YuvMatrix::kBT601, YuvRange::kLimited},
+    {YuvMatrix::kBT601, YuvRange::kFull},
+    {YuvMatrix::kBT709, YuvRange::kLimited},
+    {YuvMatrix::kBT709, YuvRange::kFull},
+};
+
+// Converts one pixel with floating point math, straight from the definition
+// of the color space.
+void ConvertPixelReference(uint8_t y, uint8_t u, uint8_t v,
+                           const YuvColorSpace& color_space, uint8_t* rgba) {
+  const bool bt709 = color_space.matrix == YuvMatrix::kBT709;
+  const double kr = bt709 ? 0.2126 : 0.299;
+  const double kb = bt709 ? 0.0722 : 0.114;
+  const double kg = 1.0 - kr - kb;
+
+  double luma = y;
+  double cb = u - 128.0;
+  double cr = v - 128.0;
+  if (color_space.range == YuvRange::kLimited) {
+    luma = (luma - 16.0) * 255.0 / 219.0;
+    cb = cb * 255.0 / 224.0;
+    cr = cr * 255.0 / 224.0;
+  }
+
+  const double r = luma + 2.0 * (1.0 - kr) * cr;
+  const double b = luma + 2.0 * (1.0 - kb) * cb;
+  const double g = (luma - kr * r - kb * b) / kg;
+
+  auto to_byte = [](double value) {
+    return static_cast<uint8_t>(std::clamp(std::lround(value), 0L, 255L));
+  };
+  rgba[0] = to_byte(r);
+  rgba[1] = to_byte(g);
+  rgba[2] = to_byte(b);
+  rgba[3] = 255;
+}
+
+// Returns |size| bytes of deterministic noise.
+std::vector<uint8_t> CreateNoise(size_t size, uint32_t seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8_t> data(size);
+  for (uint8_t& value : data) {
+    value = static_cast<uint8_t>(distribution(generator));
+  }
+  return data;
+}
+
+// Returns the largest difference between two equally sized buffers.
+int MaxDifference(const std::vector<uint8_t>& a,
+                  const std::vector<uint8_t>& b) {
+  int max_difference = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    max_difference = std::max(max_difference, std::abs(a[i] - b[i]));
+  }
+  return max_difference;
+}
+
+}  // namespace
+
+TEST(YuvConversion, ConvertsBlackAndWhite) {
+  // Black and white of limited and full range samples, with neutral chroma.
+  struct {
+    YuvRange range;
+    uint8_t black;
+    uint8_t white;
+  } cases[] = {{YuvRange::kLimited, 16, 235}, {YuvRange::kFull, 0, 255}};
+
+  for (const auto& test_case : cases) {
+    for (YuvMatrix matrix : {YuvMatrix::kBT601, YuvMatrix::kBT709}) {
+      const YuvColorSpace color_space = {matrix, test_case.range};
+      // A 2x1 NV12 frame: two luma samples and one chroma pair.
+      const uint8_t y_plane[] = {test_case.black, test_case.white};
+      const uint8_t uv_plane[] = {128, 128};
+      std::vector<uint8_t> converted(8);
+      ConvertNV12ToRGBA(y_plane, 2, uv_plane, 2, converted.data(), 2, 1,
+                        color_space, false);
+
+      EXPECT_EQ(converted,
+                std::vector<uint8_t>({0, 0, 0, 255, 255, 255, 255, 255}));
+    }
+  }
+}
+
+TEST(YuvConversion, ScalarPathMatchesReference) {
+  // Sweeps a grid over the whole YUV cube, one row of 256 luma values per
+  // chroma pair.
+  const uint32_t width = 256;
+  std::vector<uint8_t> yuy2(width * 2);
+  std::vector<uint8_t> converted(width * 4);
+  std::vector<uint8_t> expected(width * 4);
+
+  for (const YuvColorSpace& color_space : kAllColorSpaces) {
+    int max_difference = 0;
+    for (int u = 0; u < 256; u += 5) {
+      for (int v = 0; v < 256; v += 5) {
+        for (uint32_t x = 0; x < width; x++) {
+          yuy2[x * 2] = static_cast<uint8_t>(x);
+          yuy2[x * 2 + 1] = static_cast<uint8_t>(x % 2 ? v : u);
+          ConvertPixelReference(static_cast<uint8_t>(x),
+                                static_cast<uint8_t>(u),
+                                static_cast<uint8_t>(v), color_space,
+                                expected.data() + x * 4);
+        }
+        ConvertYUY2ToRGBAWithPath(PixelConversionPath::kScalar, yuy2.data(),
+                                  width * 2, converted.data(), width, 1,
+                                  color_space, false);
+        max_difference =
+            std::max(max_difference, MaxDifference(converted, expected));
+      }
+    }
+
+    // Only rounding of values exactly between two integers may differ.
+    EXPECT_LE(max_difference, 1)
+        << "matrix " << static_cast<int>(color_space.matrix) << " range "
+        << static_cast<int>(color_space.range);
+  }
+}
+
+TEST(YuvConversion, NV12VectorizedPathsMatchScalarPath) {
+  // Covers odd frame sizes and widths around every vector size.
+  const uint32_t height = 5;
+  for (uint32_t width = 1; width <= 40; width++) {
+    // Pads the rows of both planes, with the chroma plane following the
+    // luma plane, like in media buffers.
+    const int32_t stride = static_cast<int32_t>(width + 7);
+    const uint32_t chroma_height = (height + 1) / 2;
+    const std::vector<uint8_t> frame =
+        CreateNoise(static_cast<size_t>(stride) * (height + chroma_height),
+                    width);
+    const uint8_t* src_y = frame.data();
+    const uint8_t* src_uv = frame.data() + stride * height;
+
+    for (const YuvColorSpace& color_space : kAllColorSpaces) {
+      for (bool mirror : {false, true}) {
+        std::vector<uint8_t> reference(width * height * 4);
+        ConvertNV12ToRGBAWithPath(PixelConversionPath::kScalar, src_y,
+                                  stride, src_uv, stride, reference.data(),
+                                  width, height, color_space, mirror);
+
+        for (PixelConversionPath path : kAllPaths) {
+          if (!IsPixelConversionPathSupported(path)) {
+            continue;
+          }
+          SCOPED_TRACE(testing::Message()
+                       << "path " << static_cast<int>(path) << " width "
+                       << width << " mirror " << mirror);
+
+          std::vector<uint8_t> converted(reference.size(), 0xCD);
+          ConvertNV12ToRGBAWithPath(path, src_y, stride, src_uv, stride,
+                                    converted.data(), width, height,
+                                    color_space, mirror);
+          EXPECT_EQ(converted, reference);
+        }
+      }
+    }
+  }
+}
+
+TEST(YuvConversion, YUY2VectorizedPathsMatchScalarPath) {
+  const uint32_t height = 3;
+  for (uint32_t width = 1; width <= 40; width++) {
+    const int32_t stride = static_cast<int32_t>((width + 1) / 2 * 4 + 12);
+    const std::vector<uint8_t> frame =
+        CreateNoise(static_cast<size_t>(stride) * height, width);
+
+    for (const YuvColorSpace& color_space : kAllColorSpaces) {
+      for (bool mirror : {false, true}) {
+        std::vector<uint8_t> reference(width * height * 4);
+        ConvertYUY2ToRGBAWithPath(PixelConversionPath::kScalar, frame.data(),
+                                  stride, reference.data(), width, height,
+                                  color_space, mirror);
+
+        for (PixelConversionPath path : kAllPaths) {
+          if (!IsPixelConversionPathSupported(path)) {
+            continue;
+          }
+          SCOPED_TRACE(testing::Message()
+                       << "path " << static_cast<int>(path) << " width "
+                       << width << " mirror " << mirror);
+
+          std::vector<uint8_t> converted(reference.size(), 0xCD);
+          ConvertYUY2ToRGBAWithPath(path, frame.data(), stride,
+                                    converted.data(), width, height,
+                                    color_space, mirror);
+          EXPECT_EQ(converted, reference);
+        }
+      }
+    }
+  }
+}
+
+TEST(YuvConversion, NV12AndYUY2ProduceSameOutput) {
+  // Converts the same 8x2 image stored in both formats. YUY2 has a chroma
+  // pair per row, so both rows use the same chroma samples.
+  const uint32_t width = 8;
+  const uint32_t height = 2;
+  const std::vector<uint8_t> y_plane = CreateNoise(width * height, 1);
+  const std::vector<uint8_t> uv_plane = CreateNoise(width, 2);
+
+  std::vector<uint8_t> yuy2(width * height * 2);
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      yuy2[(y * width + x) * 2] = y_plane[y * width + x];
+      yuy2[(y * width + x) * 2 + 1] = uv_plane[x];
+    }
+  }
+
+  const YuvColorSpace color_space = {YuvMatrix::kBT709, YuvRange::kLimited};
+  std::vector<uint8_t> from_nv12(width * height * 4);
+  std::vector<uint8_t> from_yuy2(width * height * 4);
+  ConvertNV12ToRGBA(y_plane.data(), width, uv_plane.data(), width,
+                    from_nv12.data(), width, height, color_space, true);
+  ConvertYUY2ToRGBA(yuy2.data(), width * 2, from_yuy2.data(), width, height,
+                    color_space, true);
+  EXPECT_EQ(from_nv12, from_yuy2);
+}
+
+}  // namespace test
+}  // namespace camera_windows
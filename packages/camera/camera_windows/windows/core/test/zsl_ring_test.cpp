@@ -0,0 +1,145 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "zsl_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+using Clock = ZslRing::Clock;
+
+constexpr uint32_t kWidth = 8;
+constexpr uint32_t kHeight = 4;
+
+// RGB32 frame whose bytes all hold |value|.
+struct TestFrame {
+  explicit TestFrame(uint8_t value)
+      : pixels(static_cast<size_t>(kWidth) * kHeight * 4, value) {
+    view.scanline0 = pixels.data();
+    view.buffer_start = pixels.data();
+    view.buffer_length = static_cast<uint32_t>(pixels.size());
+  }
+
+  std::vector<uint8_t> pixels;
+  FrameBufferView view;
+};
+
+bool AddTestFrame(ZslRing* ring, uint8_t value, Clock::time_point time) {
+  TestFrame frame(value);
+  return ring->AddFrame(FrameFormat(), frame.view, kWidth, kHeight, value,
+                        time);
+}
+
+}  // namespace
+
+TEST(ZslRing, EmptyRingHasNoFrame) {
+  ZslRing ring(3);
+
+  EXPECT_FALSE(ring.FindClosestFrame(Clock::now()));
+  EXPECT_EQ(ring.GetFrameCount(), 0u);
+}
+
+TEST(ZslRing, KeepsCapturedCopy) {
+  ZslRing ring(3);
+  const Clock::time_point now = Clock::now();
+
+  ASSERT_TRUE(AddTestFrame(&ring, 42, now));
+
+  FrameRef frame = ring.FindClosestFrame(now);
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(frame->content, FrameContent::kCaptured);
+  EXPECT_EQ(frame->captured_format.pixel_format, PixelFormat::kRGB32);
+  EXPECT_EQ(frame->width, kWidth);
+  EXPECT_EQ(frame->height, kHeight);
+  EXPECT_EQ(frame->sample_time_us, 42u);
+  EXPECT_EQ(frame->GetData()[0], 42);
+}
+
+TEST(ZslRing, FindsFrameDeliveredClosestToRequest) {
+  ZslRing ring(3);
+  const Clock::time_point start = Clock::now();
+  AddTestFrame(&ring, 1, start);
+  AddTestFrame(&ring, 2, start + std::chrono::milliseconds(33));
+  AddTestFrame(&ring, 3, start + std::chrono::milliseconds(66));
+
+  EXPECT_EQ(
+      ring.FindClosestFrame(start + std::chrono::milliseconds(40))->GetData()[0],
+      2);
+  EXPECT_EQ(ring.FindClosestFrame(start - std::chrono::seconds(1))
+                ->GetData()[0],
+            1);
+  EXPECT_EQ(ring.FindClosestFrame(start + std::chrono::seconds(1))
+                ->GetData()[0],
+            3);
+}
+
+TEST(ZslRing, ReplacesOldestFrame) {
+  ZslRing ring(2);
+  const Clock::time_point start = Clock::now();
+  AddTestFrame(&ring, 1, start);
+  AddTestFrame(&ring, 2, start + std::chrono::milliseconds(33));
+  AddTestFrame(&ring, 3, start + std::chrono::milliseconds(66));
+
+  EXPECT_EQ(ring.GetFrameCount(), 2u);
+  EXPECT_EQ(ring.FindClosestFrame(start)->GetData()[0], 2);
+}
+
+TEST(ZslRing, HeldFramesStayValid) {
+  ZslRing ring(1);
+  const Clock::time_point start = Clock::now();
+  AddTestFrame(&ring, 1, start);
+
+  FrameRef held = ring.FindClosestFrame(start);
+  AddTestFrame(&ring, 2, start + std::chrono::milliseconds(33));
+
+  EXPECT_EQ(held->GetData()[0], 1);
+  EXPECT_EQ(ring.FindClosestFrame(start)->GetData()[0], 2);
+}
+
+TEST(ZslRing, DropsFramesWhileAllExtraFramesAreHeld) {
+  ZslRing ring(1);
+  const Clock::time_point start = Clock::now();
+  std::vector<FrameRef> held;
+  for (uint8_t i = 1; i <= ZslRing::kExtraFrameCount + 1; i++) {
+    ASSERT_TRUE(AddTestFrame(&ring, i, start));
+    held.push_back(ring.FindClosestFrame(start));
+  }
+
+  EXPECT_FALSE(AddTestFrame(&ring, 10, start));
+  EXPECT_EQ(ring.GetDroppedFrameCount(), 1u);
+
+  held.clear();
+  EXPECT_TRUE(AddTestFrame(&ring, 11, start));
+}
+
+TEST(ZslRing, RejectsIncompleteFrame) {
+  ZslRing ring(1);
+  TestFrame frame(1);
+  frame.view.buffer_length -= 1;
+
+  EXPECT_FALSE(ring.AddFrame(FrameFormat(), frame.view, kWidth, kHeight, 0,
+                             Clock::now()));
+  EXPECT_EQ(ring.GetDroppedFrameCount(), 0u);
+}
+
+TEST(ZslRing, ClearReleasesFrames) {
+  ZslRing ring(2);
+  AddTestFrame(&ring, 1, Clock::now());
+
+  ring.Clear();
+
+  EXPECT_EQ(ring.GetFrameCount(), 0u);
+  EXPECT_FALSE(ring.FindClosestFrame(Clock::now()));
+}
+
+}  // namespace test
+}  // namespace camera_windows
@@ -0,0 +1,79 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "worker_pool.h"
+
+#include <utility>
+
+namespace camera_windows {
+
+WorkerPool::WorkerPool(size_t thread_count,
+                       ThreadHook on_thread_start,
+                       ThreadHook on_thread_stop)
+    : on_thread_start_(std::move(on_thread_start)),
+      on_thread_stop_(std::move(on_thread_stop)) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; i++) {
+    threads_.emplace_back([this]() {
+      if (on_thread_start_) {
+        on_thread_start_();
+      }
+      RunTasks();
+      if (on_thread_stop_) {
+        on_thread_stop_();
+      }
+    });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  task_available_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::Post(std::function<void()> task) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  task_available_.notify_one();
+}
+
+size_t WorkerPool::GetPendingTaskCount() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size() + running_task_count_;
+}
+
+void WorkerPool::RunTasks() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    task_available_.wait(lock,
+                         [this]() { return stopping_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      // Only reached once the pool is stopping.
+      return;
+    }
+    std::function<void()> task = std::move(tasks_.front());
+    tasks_.pop_front();
+    running_task_count_++;
+
+    lock.unlock();
+    task();
+    // Releases whatever the task holds before the count drops.
+    task = nullptr;
+    lock.lock();
+    running_task_count_--;
+  }
+}
+
+}  // namespace camera_windows
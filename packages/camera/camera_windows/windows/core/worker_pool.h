@@ -0,0 +1,70 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_WORKER_POOL_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace camera_windows {
+
+// Runs tasks on a fixed set of background threads.
+//
+// Tasks are started in the order they are posted, and run concurrently when
+// there is more than one thread. The pool is used for work that must not
+// hold up the capture or platform threads, such as encoding photos.
+class WorkerPool {
+ public:
+  // Called on each thread of the pool.
+  using ThreadHook = std::function<void()>;
+
+  // Starts |thread_count| threads, at least one.
+  //
+  // Each thread calls |on_thread_start| before its first task and
+  // |on_thread_stop| after its last one, if they are set, to set up and tear
+  // down per-thread state that tasks rely on.
+  explicit WorkerPool(size_t thread_count, ThreadHook on_thread_start = nullptr,
+                      ThreadHook on_thread_stop = nullptr);
+
+  // Runs the tasks that are still queued, then joins the threads.
+  virtual ~WorkerPool();
+
+  // Prevent copying.
+  WorkerPool(WorkerPool const&) = delete;
+  WorkerPool& operator=(WorkerPool const&) = delete;
+
+  // Queues |task| to run on one of the threads. May be called from any
+  // thread, including from a running task.
+  void Post(std::function<void()> task);
+
+  // Returns the number of tasks that are queued or running.
+  size_t GetPendingTaskCount() const;
+
+  // Returns the number of threads of the pool.
+  size_t GetThreadCount() const { return threads_.size(); }
+
+ private:
+  // Runs tasks until the pool is destroyed and the queue is empty.
+  void RunTasks();
+
+  ThreadHook on_thread_start_;
+  ThreadHook on_thread_stop_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::deque<std::function<void()>> tasks_;
+  size_t running_task_count_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_WORKER_POOL_H_
@@ -0,0 +1,464 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "yuv_conversion.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+
+#include "simd_utils.h"
+
+namespace camera_windows {
+
+namespace {
+
+constexpr uint32_t kBytesPerPixel = 4;
+
+// Conversion coefficients are fixed point numbers with 13 fractional bits.
+// This is the largest precision at which every coefficient still fits into a
+// signed 16-bit integer, which the vectorized kernels multiply with.
+constexpr int kFractionBits = 13;
+constexpr int32_t kOne = 1 << kFractionBits;
+constexpr int32_t kRounding = kOne / 2;
+
+// Fixed point YCbCr to RGB conversion coefficients.
+//
+// Every kernel computes, with exact 32-bit integer arithmetic:
+//   y' = y * (Y - y_offset) + kRounding
+//   R = clamp((y' + r_v * (V - 128)) >> kFractionBits)
+//   G = clamp((y' + g_u * (U - 128) + g_v * (V - 128)) >> kFractionBits)
+//   B = clamp((y' + b_u * (U - 128)) >> kFractionBits)
+// so that all conversion paths produce identical output.
+struct YuvCoefficients {
+  int16_t y_offset;
+  int16_t y;
+  int16_t r_v;
+  int16_t g_u;
+  int16_t g_v;
+  int16_t b_u;
+};
+
+YuvCoefficients GetYuvCoefficients(const YuvColorSpace& color_space) {
+  // Luma weights of the red and blue primaries.
+  const bool bt709 = color_space.matrix == YuvMatrix::kBT709;
+  const double kr = bt709 ? 0.2126 : 0.299;
+  const double kb = bt709 ? 0.0722 : 0.114;
+  const double kg = 1.0 - kr - kb;
+
+  // Limited range samples are expanded to the full [0, 255] range.
+  const bool limited = color_space.range == YuvRange::kLimited;
+  const double y_scale = limited ? 255.0 / 219.0 : 1.0;
+  const double c_scale = limited ? 255.0 / 224.0 : 1.0;
+
+  auto to_fixed = [](double value) {
+    return static_cast<int16_t>(std::lround(value * kOne));
+  };
+
+  YuvCoefficients coefficients;
+  coefficients.y_offset = limited ? 16 : 0;
+  coefficients.y = to_fixed(y_scale);
+  coefficients.r_v = to_fixed(2.0 * (1.0 - kr) * c_scale);
+  coefficients.g_u = to_fixed(-2.0 * kb * (1.0 - kb) / kg * c_scale);
+  coefficients.g_v = to_fixed(-2.0 * kr * (1.0 - kr) / kg * c_scale);
+  coefficients.b_u = to_fixed(2.0 * (1.0 - kb) * c_scale);
+  return coefficients;
+}
+
+// Converts a single row of an NV12 frame.
+using ConvertNV12RowFunction = void (*)(const uint8_t* src_y,
+                                        const uint8_t* src_uv, uint8_t* dst,
+                                        uint32_t width,
+                                        const YuvCoefficients& coefficients);
+
+// Converts a single row of a YUY2 frame.
+using ConvertYUY2RowFunction = void (*)(const uint8_t* src, uint8_t* dst,
+                                        uint32_t width,
+                                        const YuvCoefficients& coefficients);
+
+inline uint8_t ClampToByte(int32_t value) {
+  return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Converts one YUV pixel to RGBA.
+inline void ConvertPixel(int32_t y, int32_t u, int32_t v,
+                         const YuvCoefficients& c, uint8_t* dst) {
+  const int32_t y_term = c.y * (y - c.y_offset) + kRounding;
+  u -= 128;
+  v -= 128;
+  dst[0] = ClampToByte((y_term + c.r_v * v) >> kFractionBits);
+  dst[1] = ClampToByte((y_term + c.g_u * u + c.g_v * v) >> kFractionBits);
+  dst[2] = ClampToByte((y_term + c.b_u * u) >> kFractionBits);
+  dst[3] = 255;
+}
+
+// Converts NV12 pixels from |begin| up to the end of the row.
+template <bool kMirror>
+inline void ConvertNV12RowTail(const uint8_t* src_y, const uint8_t* src_uv,
+                               uint8_t* dst, uint32_t begin, uint32_t width,
+                               const YuvCoefficients& coefficients) {
+  for (uint32_t x = begin; x < width; x++) {
+    const uint8_t* uv = src_uv + (x / 2) * 2;
+    uint32_t dst_x = kMirror ? (width - 1 - x) : x;
+    ConvertPixel(src_y[x], uv[0], uv[1], coefficients,
+                 dst + dst_x * kBytesPerPixel);
+  }
+}
+
+// Converts YUY2 pixels from |begin| up to the end of the row.
+template <bool kMirror>
+inline void ConvertYUY2RowTail(const uint8_t* src, uint8_t* dst,
+                               uint32_t begin, uint32_t width,
+                               const YuvCoefficients& coefficients) {
+  for (uint32_t x = begin; x < width; x++) {
+    // Each 4 byte macropixel holds Y0 U Y1 V.
+    const uint8_t* macropixel = src + (x / 2) * 4;
+    uint32_t dst_x = kMirror ? (width - 1 - x) : x;
+    ConvertPixel(macropixel[(x % 2) * 2], macropixel[1], macropixel[3],
+                 coefficients, dst + dst_x * kBytesPerPixel);
+  }
+}
+
+template <bool kMirror>
+void ConvertNV12RowScalar(const uint8_t* src_y, const uint8_t* src_uv,
+                          uint8_t* dst, uint32_t width,
+                          const YuvCoefficients& coefficients) {
+  ConvertNV12RowTail<kMirror>(src_y, src_uv, dst, 0, width, coefficients);
+}
+
+template <bool kMirror>
+void ConvertYUY2RowScalar(const uint8_t* src, uint8_t* dst, uint32_t width,
+                          const YuvCoefficients& coefficients) {
+  ConvertYUY2RowTail<kMirror>(src, dst, 0, width, coefficients);
+}
+
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+
+// Returns a vector of 32-bit lanes that each hold |low| and |high| as two
+// adjacent 16-bit values, for use with _mm_madd_epi16.
+inline __m128i SetPair(int16_t low, int16_t high) {
+  return _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(low) |
+                                         (static_cast<uint32_t>(high) << 16)));
+}
+
+// Vector constants of the 128-bit kernels.
+struct YuvConstantsSSE {
+  explicit YuvConstantsSSE(const YuvCoefficients& c)
+      : y_offset(_mm_set1_epi16(c.y_offset)),
+        uv_bias(_mm_set1_epi16(128)),
+        y(SetPair(c.y, kRounding)),
+        r(SetPair(0, c.r_v)),
+        g(SetPair(c.g_u, c.g_v)),
+        b(SetPair(c.b_u, 0)) {}
+
+  __m128i y_offset;
+  __m128i uv_bias;
+  // Multiplied with (Y, 1) pairs.
+  __m128i y;
+  // Multiplied with (U, V) pairs.
+  __m128i r;
+  __m128i g;
+  __m128i b;
+};
+
+// Computes one color channel of 8 pixels as saturated 16-bit values.
+//
+// |y_low| and |y_high| hold the luma terms of pixels 0-3 and 4-7, and
+// |chroma| the chroma terms of the 4 chroma pairs.
+CAMERA_WINDOWS_TARGET("ssse3")
+inline __m128i ComputeChannelSSE(__m128i y_low, __m128i y_high,
+                                 __m128i chroma) {
+  // Each chroma pair is shared by two horizontally adjacent pixels.
+  const __m128i chroma_low = _mm_shuffle_epi32(chroma, _MM_SHUFFLE(1, 1, 0, 0));
+  const __m128i chroma_high =
+      _mm_shuffle_epi32(chroma, _MM_SHUFFLE(3, 3, 2, 2));
+  return _mm_packs_epi32(
+      _mm_srai_epi32(_mm_add_epi32(y_low, chroma_low), kFractionBits),
+      _mm_srai_epi32(_mm_add_epi32(y_high, chroma_high), kFractionBits));
+}
+
+// Converts 8 pixels to RGBA.
+//
+// |y| holds 8 luma samples and |uv| 4 interleaved U and V sample pairs, all
+// zero extended to 16 bits. Stores pixels 0-3 in |low| and 4-7 in |high|.
+CAMERA_WINDOWS_TARGET("ssse3")
+inline void ConvertPixelsSSE(__m128i y, __m128i uv, const YuvConstantsSSE& k,
+                             __m128i* low, __m128i* high) {
+  y = _mm_sub_epi16(y, k.y_offset);
+  uv = _mm_sub_epi16(uv, k.uv_bias);
+
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i y_low = _mm_madd_epi16(_mm_unpacklo_epi16(y, ones), k.y);
+  const __m128i y_high = _mm_madd_epi16(_mm_unpackhi_epi16(y, ones), k.y);
+
+  const __m128i r =
+      ComputeChannelSSE(y_low, y_high, _mm_madd_epi16(uv, k.r));
+  const __m128i g =
+      ComputeChannelSSE(y_low, y_high, _mm_madd_epi16(uv, k.g));
+  const __m128i b =
+      ComputeChannelSSE(y_low, y_high, _mm_madd_epi16(uv, k.b));
+
+  const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+  const __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r),
+                                       _mm_packus_epi16(g, g));
+  const __m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), alpha);
+  *low = _mm_unpacklo_epi16(rg, ba);
+  *high = _mm_unpackhi_epi16(rg, ba);
+}
+
+// Stores 8 converted pixels at |x|, or at the mirrored position.
+template <bool kMirror>
+CAMERA_WINDOWS_TARGET("ssse3")
+inline void StorePixelsSSE(uint8_t* dst, uint32_t x, uint32_t width,
+                           __m128i low, __m128i high) {
+  constexpr uint32_t kPixelsPerVector = 8;
+  if constexpr (kMirror) {
+    uint8_t* pixel = dst + (width - x - kPixelsPerVector) * kBytesPerPixel;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel),
+                     _mm_shuffle_epi32(high, _MM_SHUFFLE(0, 1, 2, 3)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel + 4 * kBytesPerPixel),
+                     _mm_shuffle_epi32(low, _MM_SHUFFLE(0, 1, 2, 3)));
+  } else {
+    uint8_t* pixel = dst + x * kBytesPerPixel;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel), low);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel + 4 * kBytesPerPixel),
+                     high);
+  }
+}
+
+template <bool kMirror>
+CAMERA_WINDOWS_TARGET("ssse3")
+void ConvertNV12RowSSE(const uint8_t* src_y, const uint8_t* src_uv,
+                       uint8_t* dst, uint32_t width,
+                       const YuvCoefficients& coefficients) {
+  const YuvConstantsSSE k(coefficients);
+  const __m128i zero = _mm_setzero_si128();
+  constexpr uint32_t kPixelsPerVector = 8;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    // 8 pixels share 4 chroma pairs, which take up the same number of bytes
+    // as the luma samples.
+    const __m128i y = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_y + x)), zero);
+    const __m128i uv = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_uv + x)), zero);
+    __m128i low, high;
+    ConvertPixelsSSE(y, uv, k, &low, &high);
+    StorePixelsSSE<kMirror>(dst, x, width, low, high);
+  }
+  ConvertNV12RowTail<kMirror>(src_y, src_uv, dst, x, width, coefficients);
+}
+
+template <bool kMirror>
+CAMERA_WINDOWS_TARGET("ssse3")
+void ConvertYUY2RowSSE(const uint8_t* src, uint8_t* dst, uint32_t width,
+                       const YuvCoefficients& coefficients) {
+  const YuvConstantsSSE k(coefficients);
+  const __m128i luma_mask = _mm_set1_epi16(0x00FF);
+  constexpr uint32_t kPixelsPerVector = 8;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    // Luma samples are the even bytes, and chroma samples the odd bytes.
+    const __m128i pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+    const __m128i y = _mm_and_si128(pixels, luma_mask);
+    const __m128i uv = _mm_srli_epi16(pixels, 8);
+    __m128i low, high;
+    ConvertPixelsSSE(y, uv, k, &low, &high);
+    StorePixelsSSE<kMirror>(dst, x, width, low, high);
+  }
+  ConvertYUY2RowTail<kMirror>(src, dst, x, width, coefficients);
+}
+
+#endif  // defined(CAMERA_WINDOWS_ARCH_X86)
+
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+
+// Computes one color channel of 4 pixels.
+inline int16x4_t NarrowChannelNEON(int32x4_t value) {
+  return vqshrn_n_s32(value, kFractionBits);
+}
+
+// Converts 8 pixels to RGBA and stores them at |x|, or at the mirrored
+// position.
+//
+// |y8| holds 8 luma samples, and |uv8| 4 interleaved U and V sample pairs.
+template <bool kMirror>
+inline void ConvertPixelsNEON(uint8x8_t y8, uint8x8_t uv8,
+                              const YuvCoefficients& c, uint8_t* dst,
+                              uint32_t x, uint32_t width) {
+  constexpr uint32_t kPixelsPerVector = 8;
+
+  // Duplicates every chroma sample for the two pixels sharing it.
+  const uint8x8x2_t planar = vuzp_u8(uv8, uv8);
+  const uint8x8_t u8 = vzip_u8(planar.val[0], planar.val[0]).val[0];
+  const uint8x8_t v8 = vzip_u8(planar.val[1], planar.val[1]).val[0];
+
+  const int16x8_t y = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y8)),
+                                vdupq_n_s16(c.y_offset));
+  const int16x8_t u =
+      vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), vdupq_n_s16(128));
+  const int16x8_t v =
+      vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), vdupq_n_s16(128));
+
+  const int32x4_t rounding = vdupq_n_s32(kRounding);
+  const int32x4_t y_low = vmlal_n_s16(rounding, vget_low_s16(y), c.y);
+  const int32x4_t y_high = vmlal_n_s16(rounding, vget_high_s16(y), c.y);
+
+  const int16x8_t r = vcombine_s16(
+      NarrowChannelNEON(vmlal_n_s16(y_low, vget_low_s16(v), c.r_v)),
+      NarrowChannelNEON(vmlal_n_s16(y_high, vget_high_s16(v), c.r_v)));
+  const int16x8_t g = vcombine_s16(
+      NarrowChannelNEON(vmlal_n_s16(
+          vmlal_n_s16(y_low, vget_low_s16(u), c.g_u), vget_low_s16(v),
+          c.g_v)),
+      NarrowChannelNEON(vmlal_n_s16(
+          vmlal_n_s16(y_high, vget_high_s16(u), c.g_u), vget_high_s16(v),
+          c.g_v)));
+  const int16x8_t b = vcombine_s16(
+      NarrowChannelNEON(vmlal_n_s16(y_low, vget_low_s16(u), c.b_u)),
+      NarrowChannelNEON(vmlal_n_s16(y_high, vget_high_s16(u), c.b_u)));
+
+  uint8x8x4_t rgba;
+  rgba.val[0] = vqmovun_s16(r);
+  rgba.val[1] = vqmovun_s16(g);
+  rgba.val[2] = vqmovun_s16(b);
+  rgba.val[3] = vdup_n_u8(255);
+  if constexpr (kMirror) {
+    rgba.val[0] = vrev64_u8(rgba.val[0]);
+    rgba.val[1] = vrev64_u8(rgba.val[1]);
+    rgba.val[2] = vrev64_u8(rgba.val[2]);
+  }
+  uint32_t dst_x = kMirror ? (width - x - kPixelsPerVector) : x;
+  vst4_u8(dst + dst_x * kBytesPerPixel, rgba);
+}
+
+template <bool kMirror>
+void ConvertNV12RowNEON(const uint8_t* src_y, const uint8_t* src_uv,
+                        uint8_t* dst, uint32_t width,
+                        const YuvCoefficients& coefficients) {
+  constexpr uint32_t kPixelsPerVector = 8;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    ConvertPixelsNEON<kMirror>(vld1_u8(src_y + x), vld1_u8(src_uv + x),
+                               coefficients, dst, x, width);
+  }
+  ConvertNV12RowTail<kMirror>(src_y, src_uv, dst, x, width, coefficients);
+}
+
+template <bool kMirror>
+void ConvertYUY2RowNEON(const uint8_t* src, uint8_t* dst, uint32_t width,
+                        const YuvCoefficients& coefficients) {
+  constexpr uint32_t kPixelsPerVector = 8;
+
+  uint32_t x = 0;
+  for (; x + kPixelsPerVector <= width; x += kPixelsPerVector) {
+    // De-interleaves the luma samples from the chroma samples.
+    const uint8x8x2_t pixels = vld2_u8(src + x * 2);
+    ConvertPixelsNEON<kMirror>(pixels.val[0], pixels.val[1], coefficients,
+                               dst, x, width);
+  }
+  ConvertYUY2RowTail<kMirror>(src, dst, x, width, coefficients);
+}
+
+#endif  // defined(CAMERA_WINDOWS_ARCH_ARM64)
+
+// Returns the NV12 row kernel implementing |path|.
+ConvertNV12RowFunction GetConvertNV12RowFunction(PixelConversionPath path,
+                                                 bool mirror) {
+  switch (path) {
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    case PixelConversionPath::kSSSE3:
+    case PixelConversionPath::kAVX2:
+      return mirror ? ConvertNV12RowSSE<true> : ConvertNV12RowSSE<false>;
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      return mirror ? ConvertNV12RowNEON<true> : ConvertNV12RowNEON<false>;
+#endif
+    case PixelConversionPath::kScalar:
+    default:
+      return mirror ? ConvertNV12RowScalar<true> : ConvertNV12RowScalar<false>;
+  }
+}
+
+// Returns the YUY2 row kernel implementing |path|.
+ConvertYUY2RowFunction GetConvertYUY2RowFunction(PixelConversionPath path,
+                                                 bool mirror) {
+  switch (path) {
+#if defined(CAMERA_WINDOWS_ARCH_X86)
+    case PixelConversionPath::kSSSE3:
+    case PixelConversionPath::kAVX2:
+      return mirror ? ConvertYUY2RowSSE<true> : ConvertYUY2RowSSE<false>;
+#endif
+#if defined(CAMERA_WINDOWS_ARCH_ARM64)
+    case PixelConversionPath::kNEON:
+      return mirror ? ConvertYUY2RowNEON<true> : ConvertYUY2RowNEON<false>;
+#endif
+    case PixelConversionPath::kScalar:
+    default:
+      return mirror ? ConvertYUY2RowScalar<true> : ConvertYUY2RowScalar<false>;
+  }
+}
+
+}  // namespace
+
+void ConvertNV12ToRGBA(const uint8_t* src_y, int32_t src_y_stride,
+                       const uint8_t* src_uv, int32_t src_uv_stride,
+                       uint8_t* dst, uint32_t width, uint32_t height,
+                       const YuvColorSpace& color_space, bool mirror) {
+  ConvertNV12ToRGBAWithPath(GetPreferredPixelConversionPath(), src_y,
+                            src_y_stride, src_uv, src_uv_stride, dst, width,
+                            height, color_space, mirror);
+}
+
+void ConvertNV12ToRGBAWithPath(PixelConversionPath path, const uint8_t* src_y,
+                               int32_t src_y_stride, const uint8_t* src_uv,
+                               int32_t src_uv_stride, uint8_t* dst,
+                               uint32_t width, uint32_t height,
+                               const YuvColorSpace& color_space, bool mirror) {
+  assert(IsPixelConversionPathSupported(path));
+  assert(src_y && src_uv && dst);
+
+  const YuvCoefficients coefficients = GetYuvCoefficients(color_space);
+  const ConvertNV12RowFunction convert_row =
+      GetConvertNV12RowFunction(path, mirror);
+  const size_t row_size = static_cast<size_t>(width) * kBytesPerPixel;
+  for (uint32_t y = 0; y < height; y++) {
+    // Each chroma row is shared by two luma rows.
+    convert_row(src_y + static_cast<ptrdiff_t>(y) * src_y_stride,
+                src_uv + static_cast<ptrdiff_t>(y / 2) * src_uv_stride,
+                dst + y * row_size, width, coefficients);
+  }
+}
+
+void ConvertYUY2ToRGBA(const uint8_t* src, int32_t src_stride, uint8_t* dst,
+                       uint32_t width, uint32_t height,
+                       const YuvColorSpace& color_space, bool mirror) {
+  ConvertYUY2ToRGBAWithPath(GetPreferredPixelConversionPath(), src,
+                            src_stride, dst, width, height, color_space,
+                            mirror);
+}
+
+void ConvertYUY2ToRGBAWithPath(PixelConversionPath path, const uint8_t* src,
+                               int32_t src_stride, uint8_t* dst,
+                               uint32_t width, uint32_t height,
+                               const YuvColorSpace& color_space, bool mirror) {
+  assert(IsPixelConversionPathSupported(path));
+  assert(src && dst);
+
+  const YuvCoefficients coefficients = GetYuvCoefficients(color_space);
+  const ConvertYUY2RowFunction convert_row =
+      GetConvertYUY2RowFunction(path, mirror);
+  const size_t row_size = static_cast<size_t>(width) * kBytesPerPixel;
+  for (uint32_t y = 0; y < height; y++) {
+    convert_row(src + static_cast<ptrdiff_t>(y) * src_stride,
+                dst + y * row_size, width, coefficients);
+  }
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,85 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_YUV_CONVERSION_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_YUV_CONVERSION_H_
+
+#include <cstdint>
+
+#include "pixel_conversion.h"
+
+namespace camera_windows {
+
+// YCbCr to RGB conversion matrices.
+enum class YuvMatrix {
+  // ITU-R BT.601, used by standard definition video.
+  kBT601,
+  // ITU-R BT.709, used by high definition video.
+  kBT709,
+};
+
+// Value ranges of YCbCr samples.
+enum class YuvRange {
+  // Luma in [16, 235] and chroma in [16, 240].
+  kLimited,
+  // Luma and chroma in [0, 255].
+  kFull,
+};
+
+// Describes how YCbCr samples map to RGB.
+struct YuvColorSpace {
+  YuvMatrix matrix = YuvMatrix::kBT601;
+  YuvRange range = YuvRange::kLimited;
+};
+
+// Converts MFVideoFormat_NV12 pixels to Flutter desktop pixel buffer pixels.
+//
+// Reads |width| * |height| pixels from the luma plane at |src_y| and the
+// interleaved, 2x2 subsampled chroma plane at |src_uv|, and writes RGBA
+// pixels to |dst| in a single pass. The alpha channel is always set to 255.
+// If |mirror| is true, each row is flipped horizontally.
+//
+// Strides are the byte offsets between the starts of consecutive rows of each
+// plane. Rows of |dst| are packed without padding.
+void ConvertNV12ToRGBA(const uint8_t* src_y, int32_t src_y_stride,
+                       const uint8_t* src_uv, int32_t src_uv_stride,
+                       uint8_t* dst, uint32_t width, uint32_t height,
+                       const YuvColorSpace& color_space, bool mirror);
+
+// Same as |ConvertNV12ToRGBA|, but uses the given conversion |path| instead
+// of the preferred one. Exists for testing and benchmarking purposes.
+//
+// The x86 paths share the same 128-bit kernel. |path| must be supported by
+// the current CPU.
+void ConvertNV12ToRGBAWithPath(PixelConversionPath path, const uint8_t* src_y,
+                               int32_t src_y_stride, const uint8_t* src_uv,
+                               int32_t src_uv_stride, uint8_t* dst,
+                               uint32_t width, uint32_t height,
+                               const YuvColorSpace& color_space, bool mirror);
+
+// Converts MFVideoFormat_YUY2 pixels to Flutter desktop pixel buffer pixels.
+//
+// Reads |width| * |height| pixels stored as Y0 U Y1 V macropixels from |src|,
+// and writes RGBA pixels to |dst| in a single pass. The alpha channel is
+// always set to 255. If |mirror| is true, each row is flipped horizontally.
+//
+// |src_stride| is the byte offset between the starts of consecutive source
+// rows. Rows of |dst| are packed without padding.
+void ConvertYUY2ToRGBA(const uint8_t* src, int32_t src_stride, uint8_t* dst,
+                       uint32_t width, uint32_t height,
+                       const YuvColorSpace& color_space, bool mirror);
+
+// Same as |ConvertYUY2ToRGBA|, but uses the given conversion |path| instead
+// of the preferred one. Exists for testing and benchmarking purposes.
+//
+// The x86 paths share the same 128-bit kernel. |path| must be supported by
+// the current CPU.
+void ConvertYUY2ToRGBAWithPath(PixelConversionPath path, const uint8_t* src,
+                               int32_t src_stride, uint8_t* dst,
+                               uint32_t width, uint32_t height,
+                               const YuvColorSpace& color_space, bool mirror);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_YUV_CONVERSION_H_
@@ -0,0 +1,77 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "zsl_ring.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace camera_windows {
+
+ZslRing::ZslRing(size_t frame_count)
+    : pool_(std::max<size_t>(frame_count, 1) + kExtraFrameCount, 0),
+      entries_(std::max<size_t>(frame_count, 1)) {}
+
+bool ZslRing::AddFrame(const FrameFormat& format, const FrameBufferView& source,
+                       uint32_t width, uint32_t height,
+                       uint64_t sample_time_us,
+                       Clock::time_point delivery_time) {
+  // Releases the oldest frame first, so that its memory can be reused for
+  // the copy unless it is still referenced elsewhere.
+  FrameRef oldest;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    oldest = std::move(entries_[next_entry_].frame);
+  }
+  oldest.reset();
+
+  FrameRef frame;
+  if (!CopyCapturedFrame(format, source, width, height, &pool_, &frame)) {
+    return false;
+  }
+  frame.GetMutable()->sample_time_us = sample_time_us;
+
+  const std::lock_guard<std::mutex> lock(mutex_);
+  entries_[next_entry_] = {std::move(frame), delivery_time};
+  next_entry_ = (next_entry_ + 1) % entries_.size();
+  return true;
+}
+
+FrameRef ZslRing::FindClosestFrame(Clock::time_point time) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const Entry* closest = nullptr;
+  Clock::duration closest_distance = Clock::duration::max();
+  for (const Entry& entry : entries_) {
+    if (!entry.frame) {
+      continue;
+    }
+    const Clock::duration distance = entry.delivery_time > time
+                                         ? entry.delivery_time - time
+                                         : time - entry.delivery_time;
+    if (distance < closest_distance) {
+      closest = &entry;
+      closest_distance = distance;
+    }
+  }
+  return closest ? closest->frame : FrameRef();
+}
+
+size_t ZslRing::GetFrameCount() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<size_t>(
+      std::count_if(entries_.begin(), entries_.end(),
+                    [](const Entry& entry) { return !!entry.frame; }));
+}
+
+void ZslRing::Clear() {
+  std::vector<Entry> entries;
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    entries.resize(entries_.size());
+    entries.swap(entries_);
+    next_entry_ = 0;
+  }
+}
+
+}  // namespace camera_windows
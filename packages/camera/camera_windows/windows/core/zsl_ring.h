@@ -0,0 +1,84 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_ZSL_RING_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_ZSL_RING_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "frame_buffer_view.h"
+#include "frame_conversion.h"
+#include "frame_pool.h"
+
+namespace camera_windows {
+
+// Keeps copies of the most recent captured frames, so that a photo can be
+// taken from a frame that was already captured when the photo was requested
+// (zero shutter lag).
+//
+// Frames are copied as the camera delivered them, without conversion, into
+// a fixed-size |FramePool| with room for the ring and for frames that are
+// still referenced elsewhere, for example while being encoded. If all of
+// those are referenced, new frames are dropped and the ring keeps its older
+// frames.
+class ZslRing {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Frames in the pool in addition to the ring itself.
+  static constexpr size_t kExtraFrameCount = 2;
+
+  // Creates a ring of |frame_count| frames, at least one.
+  explicit ZslRing(size_t frame_count);
+  virtual ~ZslRing() = default;
+
+  // Prevent copying.
+  ZslRing(ZslRing const&) = delete;
+  ZslRing& operator=(ZslRing const&) = delete;
+
+  // Copies a captured frame of |width| x |height| pixels, presented at
+  // |sample_time_us| and delivered at |delivery_time|, into the ring in place
+  // of the oldest frame.
+  //
+  // Called from the capture thread. Returns false if |source| does not
+  // contain a complete frame, or if no pooled memory was free.
+  bool AddFrame(const FrameFormat& format, const FrameBufferView& source,
+                uint32_t width, uint32_t height, uint64_t sample_time_us,
+                Clock::time_point delivery_time);
+
+  // Returns the frame delivered closest to |time|, or an empty reference if
+  // the ring is empty. May be called from any thread.
+  FrameRef FindClosestFrame(Clock::time_point time) const;
+
+  // Returns the number of frames in the ring.
+  size_t GetFrameCount() const;
+
+  // Returns the number of frames that were not added because no pooled
+  // memory was free.
+  uint64_t GetDroppedFrameCount() const { return pool_.GetExhaustedCount(); }
+
+  // Releases all frames of the ring.
+  void Clear();
+
+ private:
+  struct Entry {
+    FrameRef frame;
+    Clock::time_point delivery_time;
+  };
+
+  FramePool pool_;
+
+  mutable std::mutex mutex_;
+  // Ring of |frame_count| entries; |next_entry_| is the oldest.
+  std::vector<Entry> entries_;
+  size_t next_entry_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_CORE_ZSL_RING_H_
@@ -0,0 +1,83 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "device_change_notifier.h"
+
+#include <dbt.h>
+#include <flutter/flutter_view.h>
+#include <ks.h>
+#include <ksmedia.h>
+
+#include <cassert>
+#include <utility>
+
+namespace camera_windows {
+
+DeviceChangeNotifier::DeviceChangeNotifier(
+    flutter::PluginRegistrarWindows* registrar, Callback callback)
+    : registrar_(registrar), callback_(std::move(callback)) {
+  assert(registrar_);
+  assert(callback_);
+}
+
+DeviceChangeNotifier::~DeviceChangeNotifier() {
+  if (device_notification_) {
+    UnregisterDeviceNotification(device_notification_);
+  }
+  if (window_proc_id_) {
+    registrar_->UnregisterTopLevelWindowProcDelegate(*window_proc_id_);
+  }
+}
+
+bool DeviceChangeNotifier::Register() {
+  assert(!device_notification_);
+  flutter::FlutterView* view = registrar_->GetView();
+  if (!view) {
+    return false;
+  }
+  HWND window = GetAncestor(view->GetNativeWindow(), GA_ROOT);
+  if (!window) {
+    return false;
+  }
+
+  // Media Foundation enumerates video capture devices from this interface
+  // class on Windows 10 and later.
+  DEV_BROADCAST_DEVICEINTERFACE_W filter = {};
+  filter.dbcc_size = sizeof(filter);
+  filter.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
+  filter.dbcc_classguid = KSCATEGORY_VIDEO_CAMERA;
+  device_notification_ = RegisterDeviceNotificationW(
+      window, &filter, DEVICE_NOTIFY_WINDOW_HANDLE);
+  if (!device_notification_) {
+    return false;
+  }
+
+  window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+      [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+        return HandleWindowProc(hwnd, message, wparam, lparam);
+      });
+  return true;
+}
+
+std::optional<LRESULT> DeviceChangeNotifier::HandleWindowProc(HWND hwnd,
+                                                              UINT message,
+                                                              WPARAM wparam,
+                                                              LPARAM lparam) {
+  if (message != WM_DEVICECHANGE ||
+      (wparam != DBT_DEVICEARRIVAL && wparam != DBT_DEVICEREMOVECOMPLETE)) {
+    return std::nullopt;
+  }
+  // Notifications for other interface classes registered on the window, for
+  // example by other plugins, are delivered to it as well.
+  const auto* header = reinterpret_cast<const DEV_BROADCAST_HDR*>(lparam);
+  if (header && header->dbch_devicetype == DBT_DEVTYP_DEVICEINTERFACE &&
+      reinterpret_cast<const DEV_BROADCAST_DEVICEINTERFACE_W*>(header)
+              ->dbcc_classguid == KSCATEGORY_VIDEO_CAMERA) {
+    callback_();
+  }
+  // Other handlers of the window may be interested in the change too.
+  return std::nullopt;
+}
+
+}  // namespace camera_windows
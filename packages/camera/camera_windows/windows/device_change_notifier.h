@@ -0,0 +1,55 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_DEVICE_CHANGE_NOTIFIER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_DEVICE_CHANGE_NOTIFIER_H_
+
+#include <flutter/plugin_registrar_windows.h>
+#include <windows.h>
+
+#include <functional>
+#include <optional>
+
+namespace camera_windows {
+
+// Notifies when video capture devices are added to or removed from the
+// system.
+//
+// Registers the top-level window of the Flutter view for device interface
+// notifications, and receives them as WM_DEVICECHANGE messages through a
+// window procedure delegate, so the callback runs on the platform thread.
+class DeviceChangeNotifier {
+ public:
+  // Called on the platform thread when a device was added or removed.
+  using Callback = std::function<void()>;
+
+  // Creates a notifier that is not registered for notifications.
+  DeviceChangeNotifier(flutter::PluginRegistrarWindows* registrar,
+                       Callback callback);
+
+  // Unregisters from notifications.
+  virtual ~DeviceChangeNotifier();
+
+  // Prevent copying.
+  DeviceChangeNotifier(DeviceChangeNotifier const&) = delete;
+  DeviceChangeNotifier& operator=(DeviceChangeNotifier const&) = delete;
+
+  // Registers for device notifications. Returns false if the registrar has
+  // no view to receive them, or if registration fails.
+  bool Register();
+
+ private:
+  // Handles the messages of the top-level window.
+  std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message,
+                                          WPARAM wparam, LPARAM lparam);
+
+  flutter::PluginRegistrarWindows* registrar_;
+  Callback callback_;
+  std::optional<int> window_proc_id_;
+  HDEVNOTIFY device_notification_ = nullptr;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_DEVICE_CHANGE_NOTIFIER_H_
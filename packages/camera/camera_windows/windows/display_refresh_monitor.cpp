@@ -0,0 +1,98 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "display_refresh_monitor.h"
+
+#include <flutter/flutter_view.h>
+
+#include <cassert>
+#include <utility>
+
+namespace camera_windows {
+
+namespace {
+
+// Returns the refresh rate of the monitor showing most of |window|, in
+// hertz, or 0 if it is unknown.
+double GetMonitorRefreshRate(HWND window) {
+  HMONITOR monitor = MonitorFromWindow(window, MONITOR_DEFAULTTONEAREST);
+  MONITORINFOEXW monitor_info = {};
+  monitor_info.cbSize = sizeof(monitor_info);
+  if (!monitor || !GetMonitorInfoW(monitor, &monitor_info)) {
+    return 0;
+  }
+
+  DEVMODEW mode = {};
+  mode.dmSize = sizeof(mode);
+  if (!EnumDisplaySettingsW(monitor_info.szDevice, ENUM_CURRENT_SETTINGS,
+                            &mode)) {
+    return 0;
+  }
+  // 0 and 1 stand for the default rate of the display hardware.
+  if (mode.dmDisplayFrequency <= 1) {
+    return 0;
+  }
+  return static_cast<double>(mode.dmDisplayFrequency);
+}
+
+}  // namespace
+
+DisplayRefreshMonitor::DisplayRefreshMonitor(
+    flutter::PluginRegistrarWindows* registrar, Callback callback)
+    : registrar_(registrar), callback_(std::move(callback)) {
+  assert(registrar_);
+  assert(callback_);
+}
+
+DisplayRefreshMonitor::~DisplayRefreshMonitor() {
+  if (window_proc_id_) {
+    registrar_->UnregisterTopLevelWindowProcDelegate(*window_proc_id_);
+  }
+}
+
+bool DisplayRefreshMonitor::Register() {
+  assert(!window_proc_id_);
+  flutter::FlutterView* view = registrar_->GetView();
+  if (!view) {
+    return false;
+  }
+  HWND window = GetAncestor(view->GetNativeWindow(), GA_ROOT);
+  if (!window) {
+    return false;
+  }
+  refresh_rate_ = GetMonitorRefreshRate(window);
+
+  window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+      [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+        return HandleWindowProc(hwnd, message, wparam, lparam);
+      });
+  return true;
+}
+
+std::optional<LRESULT> DisplayRefreshMonitor::HandleWindowProc(HWND hwnd,
+                                                               UINT message,
+                                                               WPARAM wparam,
+                                                               LPARAM lparam) {
+  switch (message) {
+    // Display settings changed, or the window may have been moved to
+    // another monitor.
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+    case WM_EXITSIZEMOVE:
+      UpdateRefreshRate(hwnd);
+      break;
+  }
+  // Other handlers of the window may be interested in the messages too.
+  return std::nullopt;
+}
+
+void DisplayRefreshMonitor::UpdateRefreshRate(HWND window) {
+  const double refresh_rate = GetMonitorRefreshRate(window);
+  if (refresh_rate != refresh_rate_) {
+    refresh_rate_ = refresh_rate;
+    callback_(refresh_rate_);
+  }
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,63 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_DISPLAY_REFRESH_MONITOR_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_DISPLAY_REFRESH_MONITOR_H_
+
+#include <flutter/plugin_registrar_windows.h>
+#include <windows.h>
+
+#include <functional>
+#include <optional>
+
+namespace camera_windows {
+
+// Follows the refresh rate of the display showing the Flutter view.
+//
+// Reads the refresh rate of the monitor of the top-level window, and reads
+// it again when display settings change or the window is moved, through a
+// window procedure delegate, so the callback runs on the platform thread.
+class DisplayRefreshMonitor {
+ public:
+  // Called on the platform thread with the new refresh rate, in hertz, or 0
+  // if it is unknown.
+  using Callback = std::function<void(double refresh_rate)>;
+
+  // Creates a monitor that is not registered for window messages.
+  DisplayRefreshMonitor(flutter::PluginRegistrarWindows* registrar,
+                        Callback callback);
+
+  // Unregisters from window messages.
+  virtual ~DisplayRefreshMonitor();
+
+  // Prevent copying.
+  DisplayRefreshMonitor(DisplayRefreshMonitor const&) = delete;
+  DisplayRefreshMonitor& operator=(DisplayRefreshMonitor const&) = delete;
+
+  // Reads the current refresh rate and registers for window messages.
+  // Returns false if the registrar has no view to follow.
+  bool Register();
+
+  // Returns the refresh rate of the display, in hertz, or 0 if it is
+  // unknown.
+  double GetRefreshRate() const { return refresh_rate_; }
+
+ private:
+  // Handles the messages of the top-level window.
+  std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message,
+                                          WPARAM wparam, LPARAM lparam);
+
+  // Reads the refresh rate of the monitor of |window|, calling the callback
+  // if it changed.
+  void UpdateRefreshRate(HWND window);
+
+  flutter::PluginRegistrarWindows* registrar_;
+  Callback callback_;
+  std::optional<int> window_proc_id_;
+  double refresh_rate_ = 0;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_DISPLAY_REFRESH_MONITOR_H_
@@ -0,0 +1,49 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "file_utils.h"
+
+#include "string_utils.h"
+
+namespace camera_windows {
+
+HRESULT WriteFileContents(const std::string& file_path,
+                          const std::vector<uint8_t>& data) {
+  HANDLE file = CreateFileW(Utf16FromUtf8(file_path).c_str(), GENERIC_WRITE,
+                            0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return HRESULT_FROM_WIN32(GetLastError());
+  }
+
+  DWORD written = 0;
+  HRESULT hr = S_OK;
+  if (!WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &written,
+                 nullptr) ||
+      written != data.size()) {
+    hr = HRESULT_FROM_WIN32(GetLastError());
+  }
+  CloseHandle(file);
+  return hr;
+}
+
+HRESULT ReplaceFileContents(const std::string& file_path,
+                            const std::vector<uint8_t>& data) {
+  // Named after the process, so that processes saving at the same time do
+  // not write to the same temporary file.
+  const std::wstring temp_path = Utf16FromUtf8(
+      file_path + "." + std::to_string(GetCurrentProcessId()));
+  HRESULT hr = WriteFileContents(Utf8FromUtf16(temp_path), data);
+  if (SUCCEEDED(hr) &&
+      !MoveFileExW(temp_path.c_str(), Utf16FromUtf8(file_path).c_str(),
+                   MOVEFILE_REPLACE_EXISTING)) {
+    hr = HRESULT_FROM_WIN32(GetLastError());
+  }
+  if (FAILED(hr)) {
+    DeleteFileW(temp_path.c_str());
+  }
+  return hr;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,28 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_FILE_UTILS_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_FILE_UTILS_H_
+
+#include <windows.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace camera_windows {
+
+// Writes |data| to a new file at |file_path|, replacing any existing file.
+HRESULT WriteFileContents(const std::string& file_path,
+                          const std::vector<uint8_t>& data);
+
+// Writes |data| to a temporary file next to |file_path|, then moves it over
+// |file_path|, so that other processes never read a partially written file.
+// The temporary file is removed on failure.
+HRESULT ReplaceFileContents(const std::string& file_path,
+                            const std::vector<uint8_t>& data);
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_FILE_UTILS_H_
@@ -0,0 +1,111 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "image_stream_handler.h"
+
+#include <cassert>
+#include <utility>
+
+namespace camera_windows {
+
+ImageStreamHandler::ImageStreamHandler(
+    flutter::BinaryMessenger* messenger, const std::string& channel_name,
+    const ImageStreamOptions& options,
+    PlatformTaskRunner* platform_task_runner)
+    : messenger_(messenger),
+      platform_task_runner_(platform_task_runner),
+      channel_name_(channel_name),
+      options_(options),
+      gate_(std::make_shared<ImageStreamGate>(options)) {
+  assert(messenger);
+}
+
+ImageStreamHandler::~ImageStreamHandler() {
+  if (platform_task_runner_) {
+    platform_task_runner_->CancelTasks(this);
+  }
+}
+
+bool ImageStreamHandler::OnFrame(const FrameBufferView& source,
+                                 uint64_t sample_time_us) {
+  if (!gate_->TryAcquire(sample_time_us)) {
+    return false;
+  }
+
+  std::vector<uint8_t> message;
+  {
+    const std::lock_guard<std::mutex> lock(message_mutex_);
+    if (!free_messages_.empty()) {
+      message = std::move(free_messages_.back());
+      free_messages_.pop_back();
+    }
+  }
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+  ImageStreamFrameLayout layout;
+  if (GetImageStreamFrameSize(options_, frame_width_, frame_height_, &width,
+                              &height)) {
+    layout = GetImageStreamFrameLayout(options_.format, width, height);
+    message.resize(kImageStreamHeaderSize + layout.size);
+  }
+  if (layout.size == 0 ||
+      !ConvertFrame(source, layout, message.data() + kImageStreamHeaderSize)) {
+    gate_->Release();
+    const std::lock_guard<std::mutex> lock(message_mutex_);
+    free_messages_.push_back(std::move(message));
+    return false;
+  }
+  WriteImageStreamHeader(layout, sample_time_us, message.data());
+
+  if (!platform_task_runner_) {
+    SendMessage(std::move(message));
+    return true;
+  }
+  // The frame keeps its credit of the gate until Dart has received it, so
+  // frames waiting for the platform thread count against the limit too.
+  platform_task_runner_->PostTask(
+      this, [this, message = std::move(message)]() mutable {
+        SendMessage(std::move(message));
+      });
+  return true;
+}
+
+void ImageStreamHandler::SendMessage(std::vector<uint8_t> message) {
+  // The reply arrives on the platform thread once Dart has received the
+  // frame, or right away if nothing listens on the channel.
+  std::shared_ptr<ImageStreamGate> gate = gate_;
+  messenger_->Send(channel_name_, message.data(), message.size(),
+                   [gate](const uint8_t*, size_t) { gate->Release(); });
+
+  const std::lock_guard<std::mutex> lock(message_mutex_);
+  free_messages_.push_back(std::move(message));
+}
+
+bool ImageStreamHandler::ConvertFrame(const FrameBufferView& source,
+                                      const ImageStreamFrameLayout& layout,
+                                      uint8_t* dst) {
+  if (frame_format_.pixel_format != PixelFormat::kMJPG) {
+    return converter_.Convert(frame_format_, source, frame_width_,
+                              frame_height_, layout, dst);
+  }
+
+  // MJPEG frames are decoded at the smallest scale that still covers the
+  // stream frame, and scaled down the rest of the way.
+  if (!mjpeg_decoder_) {
+    mjpeg_decoder_ = std::make_unique<MjpegDecoder>();
+  }
+  uint32_t decoded_width = 0;
+  uint32_t decoded_height = 0;
+  HRESULT hr = mjpeg_decoder_->Decode(
+      source.buffer_start, source.buffer_length, layout.width, layout.height,
+      false, &decoded_frame_, &decoded_width, &decoded_height);
+  if (FAILED(hr)) {
+    return false;
+  }
+  return converter_.ConvertRGBA(decoded_frame_.data(), decoded_width,
+                                decoded_height, layout, dst);
+}
+
+}  // namespace camera_windows
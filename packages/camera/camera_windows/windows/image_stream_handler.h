@@ -0,0 +1,117 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_IMAGE_STREAM_HANDLER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_IMAGE_STREAM_HANDLER_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "frame_buffer_view.h"
+#include "frame_conversion.h"
+#include "image_stream.h"
+#include "mjpeg_decoder.h"
+#include "platform_task_runner.h"
+
+namespace camera_windows {
+
+// Sends preview frames of a camera to Dart as an image stream.
+//
+// Each frame is converted straight from the locked media buffer into a
+// reused message buffer, behind a small header describing its planes, and
+// handed to the platform thread, which sends it on a binary channel. The
+// engine copies the message once on its way to
+// the Dart isolate, where the planes are read as views of the received bytes
+// without further copies. The Windows embedding has no API to hand over a
+// native buffer without that copy.
+//
+// Dart replies to each message once it has received the frame, which returns
+// the frame's credit to the |ImageStreamGate|. While all credits are taken,
+// frames are dropped before they are converted.
+class ImageStreamHandler {
+ public:
+  // Sends messages through |platform_task_runner|, or right away if it is
+  // null. |platform_task_runner| must outlive the handler.
+  ImageStreamHandler(flutter::BinaryMessenger* messenger,
+                     const std::string& channel_name,
+                     const ImageStreamOptions& options,
+                     PlatformTaskRunner* platform_task_runner = nullptr);
+
+  // Drops the frames that have not been sent yet. Called on the platform
+  // thread.
+  virtual ~ImageStreamHandler();
+
+  // Prevent copying.
+  ImageStreamHandler(ImageStreamHandler const&) = delete;
+  ImageStreamHandler& operator=(ImageStreamHandler const&) = delete;
+
+  // Returns the options of the stream.
+  const ImageStreamOptions& GetOptions() const { return options_; }
+
+  // Updates the format of frames passed to |OnFrame|.
+  void UpdateFrameFormat(const FrameFormat& frame_format) {
+    frame_format_ = frame_format;
+  }
+
+  // Updates the size of frames passed to |OnFrame|.
+  void UpdateFrameSize(uint32_t width, uint32_t height) {
+    frame_width_ = width;
+    frame_height_ = height;
+  }
+
+  // Converts and sends the given locked frame, presented at
+  // |sample_time_us|, if the stream is ready for another frame.
+  //
+  // Called from the capture thread. |source| is only valid for the duration
+  // of the call. Returns true if the frame was handed over to be sent.
+  bool OnFrame(const FrameBufferView& source, uint64_t sample_time_us);
+
+  // Returns the number of frames dropped because Dart had not yet received
+  // the previous frames.
+  uint64_t GetDroppedFrameCount() const {
+    return gate_->GetDroppedFrameCount();
+  }
+
+ private:
+  // Sends |message| on the channel, and keeps its buffer for a later frame.
+  // Called on the platform thread.
+  void SendMessage(std::vector<uint8_t> message);
+
+  // Converts |source| to a frame of |layout| in |dst|.
+  bool ConvertFrame(const FrameBufferView& source,
+                    const ImageStreamFrameLayout& layout, uint8_t* dst);
+
+  flutter::BinaryMessenger* messenger_;
+  PlatformTaskRunner* platform_task_runner_;
+  std::string channel_name_;
+  ImageStreamOptions options_;
+  FrameFormat frame_format_;
+  uint32_t frame_width_ = 0;
+  uint32_t frame_height_ = 0;
+
+  // Shared with the reply handlers of sent messages, which may run after the
+  // stream has been stopped.
+  std::shared_ptr<ImageStreamGate> gate_;
+
+  ImageStreamConverter converter_;
+
+  // Created with the first MJPEG frame.
+  std::unique_ptr<MjpegDecoder> mjpeg_decoder_;
+  std::vector<uint8_t> decoded_frame_;
+
+  // Buffers for the header and pixels of messages, kept between frames as
+  // the engine copies each message when it is sent. Filled on the capture
+  // thread and returned once sent on the platform thread. There are no more
+  // of them than frames the gate lets through at once.
+  std::mutex message_mutex_;
+  std::vector<std::vector<uint8_t>> free_messages_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_IMAGE_STREAM_HANDLER_H_
@@ -0,0 +1,337 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "jpeg_encoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "frame_conversion.h"
+#include "frame_scaler.h"
+#include "mjpeg_frame.h"
+
+namespace camera_windows {
+
+namespace {
+
+// Rows handed to the encoder at a time.
+constexpr uint32_t kStripHeight = 16;
+
+// Room for the headers of an encoded image, on top of its pixels.
+constexpr size_t kHeaderAllowance = 64 * 1024;
+
+// Converts a row of packed RGBA pixels to 24-bit BGR.
+void ConvertRGBAToBGR24Row(const uint8_t* src, uint8_t* dst, uint32_t width) {
+  for (uint32_t x = 0; x < width; x++) {
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = src[0];
+    src += 4;
+    dst += 3;
+  }
+}
+
+}  // namespace
+
+HRESULT JpegEncoder::Encode(const PooledFrame& frame,
+                            const JpegEncodeOptions& options,
+                            std::vector<uint8_t>* dst) {
+  assert(dst);
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if (frame.content != FrameContent::kCaptured ||
+      !GetFittedFrameSize(frame.width, frame.height, options.max_width,
+                          options.max_height, &width, &height)) {
+    return E_INVALIDARG;
+  }
+  const bool scaled = width != frame.width || height != frame.height;
+
+  if (frame.captured_format.pixel_format == PixelFormat::kMJPG) {
+    JpegFrameInfo info;
+    if (!ParseJpegFrameInfo(frame.GetData(), frame.GetSize(), &info)) {
+      return WINCODEC_ERR_BADHEADER;
+    }
+    // Re-encoding is only needed for another quality or size.
+    const bool reencode = scaled || options.quality != kDefaultJpegQuality;
+    std::vector<uint8_t>* jpeg = reencode ? &jpeg_buffer_ : dst;
+    if (info.has_huffman_tables) {
+      jpeg->assign(frame.GetData(), frame.GetData() + frame.GetSize());
+    } else {
+      InsertDefaultHuffmanTables(frame.GetData(), frame.GetSize(), info, jpeg);
+    }
+    if (!reencode) {
+      return S_OK;
+    }
+    return EncodeImage(jpeg_buffer_.data(), jpeg_buffer_.size(), options, dst);
+  }
+
+  rgba_buffer_.resize(static_cast<size_t>(frame.width) * frame.height * 4);
+  if (!ConvertFrameToRGBA(frame.captured_format, GetFrameBufferView(frame),
+                          rgba_buffer_.data(), frame.width, frame.height,
+                          false)) {
+    return E_INVALIDARG;
+  }
+  return EncodeRGBA(rgba_buffer_.data(), frame.width, frame.height, options,
+                    dst);
+}
+
+HRESULT JpegEncoder::EncodeImage(const uint8_t* data, size_t size,
+                                 const JpegEncodeOptions& options,
+                                 std::vector<uint8_t>* dst) {
+  assert(dst);
+  if (!data || size == 0 || size > MAXDWORD) {
+    return E_INVALIDARG;
+  }
+
+  HRESULT hr = InitImagingFactory();
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IWICStream> stream;
+  hr = imaging_factory_->CreateStream(&stream);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = stream->InitializeFromMemory(const_cast<BYTE*>(data),
+                                    static_cast<DWORD>(size));
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IWICBitmapDecoder> decoder;
+  hr = imaging_factory_->CreateDecoderFromStream(
+      stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IWICBitmapFrameDecode> frame;
+  hr = decoder->GetFrame(0, &frame);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  return EncodeSource(frame.Get(), options, dst);
+}
+
+HRESULT JpegEncoder::InitImagingFactory() {
+  if (imaging_factory_) {
+    return S_OK;
+  }
+  return CoCreateInstance(CLSID_WICImagingFactory, nullptr,
+                          CLSCTX_INPROC_SERVER,
+                          IID_PPV_ARGS(&imaging_factory_));
+}
+
+HRESULT JpegEncoder::EncodeRGBA(const uint8_t* rgba, uint32_t width,
+                                uint32_t height,
+                                const JpegEncodeOptions& options,
+                                std::vector<uint8_t>* dst) {
+  HRESULT hr = InitImagingFactory();
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  uint32_t fitted_width = 0;
+  uint32_t fitted_height = 0;
+  GetFittedFrameSize(width, height, options.max_width, options.max_height,
+                     &fitted_width, &fitted_height);
+  if (fitted_width != width || fitted_height != height) {
+    // Wraps the pixels in a bitmap, so the scaler of WIC can read them.
+    ComPtr<IWICBitmap> bitmap;
+    hr = imaging_factory_->CreateBitmapFromMemory(
+        width, height, GUID_WICPixelFormat32bppRGBA, width * 4,
+        width * height * 4, const_cast<BYTE*>(rgba), &bitmap);
+    if (FAILED(hr)) {
+      return hr;
+    }
+    return EncodeSource(bitmap.Get(), options, dst);
+  }
+
+  ComPtr<IWICStream> stream;
+  ComPtr<IWICBitmapEncoder> encoder;
+  ComPtr<IWICBitmapFrameEncode> frame_encode;
+  hr = CreateFrameEncoder(width, height, options.quality, &stream, &encoder,
+                          &frame_encode);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  const UINT stride = width * 3;
+  strip_buffer_.resize(static_cast<size_t>(stride) * kStripHeight);
+  for (uint32_t y = 0; y < height; y += kStripHeight) {
+    const uint32_t rows = std::min(kStripHeight, height - y);
+    for (uint32_t row = 0; row < rows; row++) {
+      ConvertRGBAToBGR24Row(rgba + static_cast<size_t>(width) * 4 * (y + row),
+                            strip_buffer_.data() + stride * row, width);
+    }
+    hr = frame_encode->WritePixels(rows, stride, stride * rows,
+                                   strip_buffer_.data());
+    if (FAILED(hr)) {
+      return hr;
+    }
+  }
+
+  return CommitFrameEncoder(stream.Get(), encoder.Get(), frame_encode.Get(),
+                            dst);
+}
+
+HRESULT JpegEncoder::EncodeSource(IWICBitmapSource* source,
+                                  const JpegEncodeOptions& options,
+                                  std::vector<uint8_t>* dst) {
+  assert(source);
+  UINT width = 0;
+  UINT height = 0;
+  HRESULT hr = source->GetSize(&width, &height);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  uint32_t fitted_width = 0;
+  uint32_t fitted_height = 0;
+  if (!GetFittedFrameSize(width, height, options.max_width, options.max_height,
+                          &fitted_width, &fitted_height)) {
+    return E_INVALIDARG;
+  }
+
+  IWICBitmapSource* scaled_source = source;
+  ComPtr<IWICBitmapScaler> scaler;
+  if (fitted_width != width || fitted_height != height) {
+    hr = imaging_factory_->CreateBitmapScaler(&scaler);
+    if (FAILED(hr)) {
+      return hr;
+    }
+    // Fant interpolation averages the covered pixels, like a box filter.
+    hr = scaler->Initialize(source, fitted_width, fitted_height,
+                            WICBitmapInterpolationModeFant);
+    if (FAILED(hr)) {
+      return hr;
+    }
+    scaled_source = scaler.Get();
+  }
+
+  ComPtr<IWICFormatConverter> converter;
+  hr = imaging_factory_->CreateFormatConverter(&converter);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = converter->Initialize(scaled_source, GUID_WICPixelFormat24bppBGR,
+                             WICBitmapDitherTypeNone, nullptr, 0.0,
+                             WICBitmapPaletteTypeCustom);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IWICStream> stream;
+  ComPtr<IWICBitmapEncoder> encoder;
+  ComPtr<IWICBitmapFrameEncode> frame_encode;
+  hr = CreateFrameEncoder(fitted_width, fitted_height, options.quality,
+                          &stream, &encoder, &frame_encode);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = frame_encode->WriteSource(converter.Get(), nullptr);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  return CommitFrameEncoder(stream.Get(), encoder.Get(), frame_encode.Get(),
+                            dst);
+}
+
+HRESULT JpegEncoder::CreateFrameEncoder(uint32_t width, uint32_t height,
+                                        float quality, IWICStream** stream,
+                                        IWICBitmapEncoder** encoder,
+                                        IWICBitmapFrameEncode** frame_encode) {
+  // Encodes straight into a buffer that is larger than any JPEG image of
+  // this size, so the encoded bytes are only copied once, to the output.
+  const size_t max_size =
+      static_cast<size_t>(width) * height * 4 + kHeaderAllowance;
+  if (encoded_buffer_.size() < max_size) {
+    encoded_buffer_.resize(max_size);
+  }
+
+  HRESULT hr = imaging_factory_->CreateStream(stream);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = (*stream)->InitializeFromMemory(
+      encoded_buffer_.data(), static_cast<DWORD>(encoded_buffer_.size()));
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  hr = imaging_factory_->CreateEncoder(GUID_ContainerFormatJpeg, nullptr,
+                                       encoder);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = (*encoder)->Initialize(*stream, WICBitmapEncoderNoCache);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IPropertyBag2> options;
+  hr = (*encoder)->CreateNewFrame(frame_encode, &options);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  PROPBAG2 option = {};
+  option.pstrName = const_cast<LPOLESTR>(L"ImageQuality");
+  VARIANT value = {};
+  value.vt = VT_R4;
+  value.fltVal = std::clamp(quality, 0.0f, 1.0f);
+  hr = options->Write(1, &option, &value);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  hr = (*frame_encode)->Initialize(options.Get());
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = (*frame_encode)->SetSize(width, height);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  // 24-bit BGR is the native color format of the encoder.
+  WICPixelFormatGUID pixel_format = GUID_WICPixelFormat24bppBGR;
+  hr = (*frame_encode)->SetPixelFormat(&pixel_format);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  if (pixel_format != GUID_WICPixelFormat24bppBGR) {
+    return WINCODEC_ERR_UNSUPPORTEDPIXELFORMAT;
+  }
+  return S_OK;
+}
+
+HRESULT JpegEncoder::CommitFrameEncoder(IWICStream* stream,
+                                        IWICBitmapEncoder* encoder,
+                                        IWICBitmapFrameEncode* frame_encode,
+                                        std::vector<uint8_t>* dst) {
+  HRESULT hr = frame_encode->Commit();
+  if (FAILED(hr)) {
+    return hr;
+  }
+  hr = encoder->Commit();
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ULARGE_INTEGER encoded_size = {};
+  LARGE_INTEGER zero = {};
+  hr = stream->Seek(zero, STREAM_SEEK_CUR, &encoded_size);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  dst->assign(encoded_buffer_.begin(),
+              encoded_buffer_.begin() +
+                  static_cast<ptrdiff_t>(encoded_size.QuadPart));
+  return S_OK;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,112 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_JPEG_ENCODER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_JPEG_ENCODER_H_
+
+#include <wincodec.h>
+#include <wrl/client.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "frame_pool.h"
+
+namespace camera_windows {
+using Microsoft::WRL::ComPtr;
+
+// Default quality of encoded images, from 0 to 1.
+constexpr float kDefaultJpegQuality = 0.9f;
+
+// Options of encoded JPEG images.
+struct JpegEncodeOptions {
+  // Quality of the image, from 0 to 1.
+  float quality = kDefaultJpegQuality;
+
+  // Largest size of the image. Images are scaled down to fit, keeping their
+  // aspect ratio, and are never scaled up. 0 means no limit.
+  uint32_t max_width = 0;
+  uint32_t max_height = 0;
+};
+
+// Encodes captured frames to JPEG images in memory.
+//
+// Frames are encoded by the JPEG encoder of the Windows Imaging Component.
+// Uncompressed frames are converted to RGBA, and handed to the encoder in
+// strips of 24-bit rows. Images that are scaled down, and images in other
+// formats, are read by the encoder through WIC scaling and format
+// conversion instead. The image is encoded into a buffer that keeps its
+// allocation between photos.
+class JpegEncoder {
+ public:
+  JpegEncoder() {}
+  virtual ~JpegEncoder() = default;
+
+  // Prevent copying.
+  JpegEncoder(JpegEncoder const&) = delete;
+  JpegEncoder& operator=(JpegEncoder const&) = delete;
+
+  // Encodes a |kCaptured| frame to a JPEG image in |dst|.
+  //
+  // MJPEG frames are already JPEG images. They are copied as they are, with
+  // the default Huffman tables inserted if the camera left them out, unless
+  // |options| ask for another quality or a smaller size.
+  //
+  // Must be called from a thread that has initialized COM.
+  HRESULT Encode(const PooledFrame& frame, const JpegEncodeOptions& options,
+                 std::vector<uint8_t>* dst);
+
+  // Decodes the image of |size| bytes at |data|, in any format that WIC can
+  // decode, and encodes it to a JPEG image in |dst|.
+  //
+  // Must be called from a thread that has initialized COM.
+  HRESULT EncodeImage(const uint8_t* data, size_t size,
+                      const JpegEncodeOptions& options,
+                      std::vector<uint8_t>* dst);
+
+ private:
+  // Creates the imaging factory on first use.
+  HRESULT InitImagingFactory();
+
+  // Encodes |height| rows of |width| packed RGBA pixels.
+  HRESULT EncodeRGBA(const uint8_t* rgba, uint32_t width, uint32_t height,
+                     const JpegEncodeOptions& options,
+                     std::vector<uint8_t>* dst);
+
+  // Encodes the pixels of |source|, scaled down to fit |options|.
+  HRESULT EncodeSource(IWICBitmapSource* source,
+                       const JpegEncodeOptions& options,
+                       std::vector<uint8_t>* dst);
+
+  // Creates an encoder writing to |encoded_buffer_|, and its frame of
+  // |width| x |height| pixels in the 24-bit BGR format.
+  HRESULT CreateFrameEncoder(uint32_t width, uint32_t height, float quality,
+                             IWICStream** stream, IWICBitmapEncoder** encoder,
+                             IWICBitmapFrameEncode** frame_encode);
+
+  // Commits the written frame and copies the encoded image to |dst|.
+  HRESULT CommitFrameEncoder(IWICStream* stream, IWICBitmapEncoder* encoder,
+                             IWICBitmapFrameEncode* frame_encode,
+                             std::vector<uint8_t>* dst);
+
+  ComPtr<IWICImagingFactory> imaging_factory_;
+
+  // Frame converted to RGBA. Kept to reuse its allocation between photos.
+  std::vector<uint8_t> rgba_buffer_;
+
+  // A strip of rows converted to the pixel format of the encoder.
+  std::vector<uint8_t> strip_buffer_;
+
+  // MJPEG frame completed with Huffman tables before being re-encoded.
+  std::vector<uint8_t> jpeg_buffer_;
+
+  // Output of the encoder, large enough for any image of the frame size.
+  // Kept to reuse its allocation between photos.
+  std::vector<uint8_t> encoded_buffer_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_JPEG_ENCODER_H_
@@ -0,0 +1,92 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media_context.h"
+
+#include <cassert>
+
+namespace camera_windows {
+
+// static
+MediaContext* MediaContext::GetInstance() {
+  static MediaContext* instance = new MediaContext();
+  return instance;
+}
+
+MediaContext::MediaContext()
+    : resource_([this]() { return SUCCEEDED(create_result_ = Create()); },
+                [this]() { Destroy(); }, kIdleTimeout) {}
+
+HRESULT MediaContext::Acquire(ComPtr<IMFDXGIDeviceManager>* device_manager) {
+  assert(device_manager);
+  if (!resource_.Acquire()) {
+    return create_result_;
+  }
+  // The manager is only replaced once every camera has released it.
+  *device_manager = dxgi_device_manager_;
+  return S_OK;
+}
+
+void MediaContext::Release() { resource_.Release(); }
+
+HRESULT MediaContext::Create() {
+  // MFStartup must be called before using Media Foundation.
+  HRESULT hr = MFStartup(MF_VERSION);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  media_foundation_started_ = true;
+
+  // TODO: Use existing ANGLE device
+  hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr,
+                         D3D11_CREATE_DEVICE_VIDEO_SUPPORT, nullptr, 0,
+                         D3D11_SDK_VERSION, &dx11_device_, nullptr, nullptr);
+  if (FAILED(hr)) {
+    Destroy();
+    return hr;
+  }
+
+  // Enable multithread protection, as capture engines of several cameras
+  // use the device from their own threads.
+  ComPtr<ID3D10Multithread> multi_thread;
+  hr = dx11_device_.As(&multi_thread);
+  if (FAILED(hr)) {
+    Destroy();
+    return hr;
+  }
+  multi_thread->SetMultithreadProtected(TRUE);
+
+  hr = MFCreateDXGIDeviceManager(&dx_device_reset_token_,
+                                 dxgi_device_manager_.GetAddressOf());
+  if (FAILED(hr)) {
+    Destroy();
+    return hr;
+  }
+
+  hr = dxgi_device_manager_->ResetDevice(dx11_device_.Get(),
+                                         dx_device_reset_token_);
+  if (FAILED(hr)) {
+    Destroy();
+    return hr;
+  }
+  return S_OK;
+}
+
+void MediaContext::Destroy() {
+  if (dxgi_device_manager_) {
+    dxgi_device_manager_->ResetDevice(dx11_device_.Get(),
+                                      dx_device_reset_token_);
+  }
+  dxgi_device_manager_ = nullptr;
+  dx11_device_ = nullptr;
+
+  // Application should call MFShutdown the same number of times as
+  // MFStartup.
+  if (media_foundation_started_) {
+    MFShutdown();
+    media_foundation_started_ = false;
+  }
+}
+
+}  // namespace camera_windows
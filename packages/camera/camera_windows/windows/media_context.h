@@ -0,0 +1,77 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MEDIA_CONTEXT_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MEDIA_CONTEXT_H_
+
+#include <d3d11.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <windows.h>
+#include <wrl/client.h>
+
+#include <chrono>
+
+#include "shared_resource.h"
+
+namespace camera_windows {
+using Microsoft::WRL::ComPtr;
+
+// Media Foundation and the D3D11 device shared by all cameras of the
+// process.
+//
+// Starting Media Foundation and creating a hardware video device take a
+// noticeable part of opening a camera. The context is created when the
+// first camera acquires it, and is kept for |kIdleTimeout| after the last
+// camera releases it, so switching between cameras, or opening several,
+// creates it once. The device is multithread protected, so capture engines
+// of several cameras may use it at once.
+class MediaContext {
+ public:
+  // How long the context is kept after the last camera released it.
+  static constexpr std::chrono::seconds kIdleTimeout{10};
+
+  // Returns the context of the process, which is never destroyed (see
+  // |CameraPlugin|), as its idle timer is a thread that cannot be joined
+  // while the module is unloaded.
+  static MediaContext* GetInstance();
+
+  // Prevent copying.
+  MediaContext(MediaContext const&) = delete;
+  MediaContext& operator=(MediaContext const&) = delete;
+
+  // Starts Media Foundation and creates the device if needed, and returns
+  // the device manager to pass to capture engines.
+  //
+  // Each successful call must be balanced by a call to |Release|.
+  HRESULT Acquire(ComPtr<IMFDXGIDeviceManager>* device_manager);
+
+  // Releases a context acquired by |Acquire|.
+  void Release();
+
+ private:
+  MediaContext();
+  virtual ~MediaContext() = default;
+
+  // Starts Media Foundation and creates the device and its manager.
+  // Called by |resource_| with its lock held.
+  HRESULT Create();
+
+  // Releases the device and shuts down Media Foundation. Called by
+  // |resource_| with its lock held.
+  void Destroy();
+
+  bool media_foundation_started_ = false;
+  ComPtr<ID3D11Device> dx11_device_;
+  ComPtr<IMFDXGIDeviceManager> dxgi_device_manager_;
+  UINT dx_device_reset_token_ = 0;
+  // Result of the last creation, returned by |Acquire| when it failed.
+  HRESULT create_result_ = S_OK;
+
+  SharedResource resource_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MEDIA_CONTEXT_H_
@@ -0,0 +1,194 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media_type_store.h"
+
+#include <cfgmgr32.h>
+#include <shlobj.h>
+
+// Defines the property keys of devpkey.h in this file.
+#include <initguid.h>
+
+#include <devpkey.h>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "com_heap_ptr.h"
+#include "file_utils.h"
+#include "string_utils.h"
+
+namespace camera_windows {
+
+namespace {
+
+constexpr wchar_t kFolderName[] = L"\\flutter_camera_windows";
+constexpr wchar_t kFileName[] = L"\\media_types.cache";
+
+// Larger files are not written by the store, and are ignored.
+constexpr LONGLONG kMaxFileSize = 16 * 1024 * 1024;
+
+// Reads the first string of a string or string list property, using
+// |get_property| with the signature of CM_Get_DevNode_PropertyW without its
+// first argument.
+template <typename GetProperty>
+bool ReadStringProperty(GetProperty get_property, const DEVPROPKEY& key,
+                        std::wstring* value) {
+  DEVPROPTYPE type = DEVPROP_TYPE_EMPTY;
+  ULONG size = 0;
+  if (get_property(&key, &type, nullptr, &size, 0) != CR_BUFFER_SMALL ||
+      (type != DEVPROP_TYPE_STRING && type != DEVPROP_TYPE_STRING_LIST)) {
+    return false;
+  }
+
+  // One more character keeps the buffer terminated even if the property
+  // is not.
+  std::vector<wchar_t> buffer(size / sizeof(wchar_t) + 1, L'\0');
+  if (get_property(&key, &type, reinterpret_cast<PBYTE>(buffer.data()), &size,
+                   0) != CR_SUCCESS) {
+    return false;
+  }
+  *value = buffer.data();
+  return !value->empty();
+}
+
+std::string GetCacheFilePath() {
+  ComHeapPtr<wchar_t> local_app_data;
+  if (FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_DEFAULT,
+                                  nullptr, &local_app_data))) {
+    return std::string();
+  }
+
+  std::wstring folder = std::wstring(local_app_data) + kFolderName;
+  if (!CreateDirectoryW(folder.c_str(), nullptr) &&
+      GetLastError() != ERROR_ALREADY_EXISTS) {
+    return std::string();
+  }
+  return Utf8FromUtf16(folder + kFileName);
+}
+
+bool ReadFileContents(const std::string& file_path, std::string* data) {
+  HANDLE file = CreateFileW(Utf16FromUtf8(file_path).c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  bool read = false;
+  LARGE_INTEGER size = {};
+  if (GetFileSizeEx(file, &size) && size.QuadPart <= kMaxFileSize) {
+    data->resize(static_cast<size_t>(size.QuadPart));
+    DWORD bytes_read = 0;
+    read = data->empty() ||
+           (ReadFile(file, &(*data)[0], static_cast<DWORD>(data->size()),
+                     &bytes_read, nullptr) &&
+            bytes_read == data->size());
+  }
+  CloseHandle(file);
+  return read;
+}
+
+}  // namespace
+
+// static
+MediaTypeStore* MediaTypeStore::GetInstance() {
+  static MediaTypeStore* instance = new MediaTypeStore();
+  return instance;
+}
+
+// static
+bool MediaTypeStore::GetDeviceFingerprint(const std::string& symbolic_link,
+                                          std::string* fingerprint) {
+  assert(fingerprint);
+  const std::wstring interface_path = Utf16FromUtf8(symbolic_link);
+
+  std::wstring instance_id;
+  if (!ReadStringProperty(
+          [&](const DEVPROPKEY* key, DEVPROPTYPE* type, PBYTE buffer,
+              PULONG size, ULONG flags) {
+            return CM_Get_Device_Interface_PropertyW(
+                interface_path.c_str(), key, type, buffer, size, flags);
+          },
+          DEVPKEY_Device_InstanceId, &instance_id)) {
+    return false;
+  }
+
+  DEVINST device = 0;
+  if (CM_Locate_DevNodeW(&device, &instance_id[0],
+                         CM_LOCATE_DEVNODE_NORMAL) != CR_SUCCESS) {
+    return false;
+  }
+  auto get_device_property = [&](const DEVPROPKEY* key, DEVPROPTYPE* type,
+                                 PBYTE buffer, PULONG size, ULONG flags) {
+    return CM_Get_DevNode_PropertyW(device, key, type, buffer, size, flags);
+  };
+
+  // The first hardware id is the most specific one, which includes the
+  // revision of USB devices.
+  std::wstring driver_version;
+  std::wstring hardware_id;
+  if (!ReadStringProperty(get_device_property, DEVPKEY_Device_DriverVersion,
+                          &driver_version) ||
+      !ReadStringProperty(get_device_property, DEVPKEY_Device_HardwareIds,
+                          &hardware_id)) {
+    return false;
+  }
+
+  *fingerprint = Utf8FromUtf16(driver_version + L" " + hardware_id);
+  return !fingerprint->empty();
+}
+
+bool MediaTypeStore::Find(const std::string& symbolic_link,
+                          const std::string& fingerprint,
+                          DeviceCapabilities* capabilities) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LoadIfNeeded();
+  return cache_.Find(symbolic_link, fingerprint, capabilities);
+}
+
+void MediaTypeStore::Store(const std::string& symbolic_link,
+                           DeviceCapabilities capabilities) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LoadIfNeeded();
+  cache_.Store(symbolic_link, std::move(capabilities));
+  Save();
+}
+
+void MediaTypeStore::Remove(const std::string& symbolic_link) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LoadIfNeeded();
+  if (cache_.Remove(symbolic_link)) {
+    Save();
+  }
+}
+
+void MediaTypeStore::LoadIfNeeded() {
+  if (loaded_) {
+    return;
+  }
+  loaded_ = true;
+
+  file_path_ = GetCacheFilePath();
+  std::string data;
+  if (!file_path_.empty() && ReadFileContents(file_path_, &data)) {
+    // Files of other versions or damaged files are replaced on next save.
+    cache_.Deserialize(data);
+  }
+}
+
+void MediaTypeStore::Save() {
+  if (file_path_.empty()) {
+    return;
+  }
+
+  // Other processes may read the file at any time. A failed save leaves the
+  // previous file in place.
+  const std::string data = cache_.Serialize();
+  ReplaceFileContents(file_path_,
+                      std::vector<uint8_t>(data.begin(), data.end()));
+}
+
+}  // namespace camera_windows
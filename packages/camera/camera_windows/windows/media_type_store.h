@@ -0,0 +1,72 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MEDIA_TYPE_STORE_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MEDIA_TYPE_STORE_H_
+
+#include <windows.h>
+
+#include <mutex>
+#include <string>
+
+#include "media_type_cache.h"
+
+namespace camera_windows {
+
+// Media types of the capture devices of the system, kept in a file of the
+// local application data folder so that they survive the process.
+//
+// Entries are keyed by the symbolic link of the device, and tied to its
+// driver version and hardware id, which includes the firmware revision of
+// USB cameras, so that they are read again after updates. Thread safe.
+class MediaTypeStore {
+ public:
+  // Returns the store of the process, which is never destroyed (see
+  // |CameraPlugin|). Every change is written to the file right away, so
+  // nothing is lost when the process exits.
+  static MediaTypeStore* GetInstance();
+
+  // Reads the driver version and hardware id of the device with the given
+  // |symbolic_link| into |fingerprint|. Returns false if they are not
+  // available, in which case the media types of the device are not cached.
+  static bool GetDeviceFingerprint(const std::string& symbolic_link,
+                                   std::string* fingerprint);
+
+  // Prevent copying.
+  MediaTypeStore(MediaTypeStore const&) = delete;
+  MediaTypeStore& operator=(MediaTypeStore const&) = delete;
+
+  // Copies the stored media types of the device to |capabilities| and
+  // returns true if they were read with the given |fingerprint|.
+  bool Find(const std::string& symbolic_link, const std::string& fingerprint,
+            DeviceCapabilities* capabilities);
+
+  // Stores the media types of the device, and writes them to the file.
+  void Store(const std::string& symbolic_link,
+             DeviceCapabilities capabilities);
+
+  // Drops the media types of the device, which no longer match the media
+  // types it offers.
+  void Remove(const std::string& symbolic_link);
+
+ private:
+  MediaTypeStore() = default;
+  virtual ~MediaTypeStore() = default;
+
+  // Reads the file once, on first use. Called with |mutex_| held.
+  void LoadIfNeeded();
+
+  // Replaces the file with the current entries. Called with |mutex_| held.
+  void Save();
+
+  std::mutex mutex_;
+  bool loaded_ = false;
+  // Empty if the application data folder is not available.
+  std::string file_path_;
+  MediaTypeCache cache_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MEDIA_TYPE_STORE_H_
@@ -0,0 +1,233 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mjpeg_decoder.h"
+
+#include <cassert>
+
+#include "mjpeg_frame.h"
+#include "pixel_conversion.h"
+
+namespace camera_windows {
+
+namespace {
+
+// Returns the size of pixels of |pixel_format|, or 0 if pixels of that
+// format cannot be converted to RGBA.
+uint32_t GetBytesPerPixel(REFWICPixelFormatGUID pixel_format) {
+  if (pixel_format == GUID_WICPixelFormat32bppBGR ||
+      pixel_format == GUID_WICPixelFormat32bppBGRA) {
+    return 4;
+  }
+  if (pixel_format == GUID_WICPixelFormat24bppBGR) {
+    return 3;
+  }
+  return 0;
+}
+
+// Returns the rectangle of an image of |width| x |height| pixels shown by
+// |crop|.
+WICRect GetCropRect(uint32_t width, uint32_t height, const PreviewCrop& crop,
+                    bool mirror) {
+  FrameRegion region = {0, 0, width, height};
+  GetPreviewCropRegion(width, height, crop, mirror, &region);
+  return {static_cast<INT>(region.x), static_cast<INT>(region.y),
+          static_cast<INT>(region.width), static_cast<INT>(region.height)};
+}
+
+}  // namespace
+
+HRESULT MjpegDecoder::Decode(const uint8_t* data, uint32_t data_length,
+                             uint32_t target_width, uint32_t target_height,
+                             bool mirror, std::vector<uint8_t>* dst,
+                             uint32_t* width, uint32_t* height) {
+  assert(data && dst && width && height);
+
+  uint32_t bytes_per_pixel = 0;
+  HRESULT hr = DecodeToBuffer(data, data_length, target_width, target_height,
+                              mirror, PreviewCrop(), width, height,
+                              &bytes_per_pixel);
+  if (FAILED(hr)) {
+    return hr;
+  }
+  dst->resize(static_cast<size_t>(*width) * *height * 4);
+  WriteRGBA(*width, *height, bytes_per_pixel, mirror, dst->data());
+  return S_OK;
+}
+
+HRESULT MjpegDecoder::Decode(const uint8_t* data, uint32_t data_length,
+                             uint32_t target_width, uint32_t target_height,
+                             bool mirror, const PreviewCrop& crop,
+                             FramePool* pool, FrameRef* frame) {
+  assert(data && pool && frame);
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t bytes_per_pixel = 0;
+  HRESULT hr = DecodeToBuffer(data, data_length, target_width, target_height,
+                              mirror, crop, &width, &height,
+                              &bytes_per_pixel);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  *frame = pool->Acquire(static_cast<size_t>(width) * height * 4);
+  if (!*frame) {
+    return E_OUTOFMEMORY;
+  }
+  PooledFrame* rgba = frame->GetMutable();
+  rgba->width = width;
+  rgba->height = height;
+  rgba->stride = static_cast<int32_t>(width * 4);
+  rgba->mirrored = mirror;
+  WriteRGBA(width, height, bytes_per_pixel, mirror, rgba->GetData());
+  return S_OK;
+}
+
+HRESULT MjpegDecoder::DecodeToBuffer(const uint8_t* data,
+                                     uint32_t data_length,
+                                     uint32_t target_width,
+                                     uint32_t target_height, bool mirror,
+                                     const PreviewCrop& crop, uint32_t* width,
+                                     uint32_t* height,
+                                     uint32_t* bytes_per_pixel_out) {
+  JpegFrameInfo info;
+  if (!ParseJpegFrameInfo(data, data_length, &info) || info.width == 0 ||
+      info.height == 0) {
+    return WINCODEC_ERR_BADHEADER;
+  }
+
+  if (!info.has_huffman_tables) {
+    InsertDefaultHuffmanTables(data, data_length, info, &jpeg_buffer_);
+    data = jpeg_buffer_.data();
+    data_length = static_cast<uint32_t>(jpeg_buffer_.size());
+  }
+
+  HRESULT hr = S_OK;
+  if (!imaging_factory_) {
+    hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr,
+                          CLSCTX_INPROC_SERVER,
+                          IID_PPV_ARGS(&imaging_factory_));
+    if (FAILED(hr)) {
+      return hr;
+    }
+  }
+
+  ComPtr<IWICStream> stream;
+  hr = imaging_factory_->CreateStream(&stream);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  // The stream only reads from the buffer.
+  hr = stream->InitializeFromMemory(const_cast<BYTE*>(data), data_length);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IWICBitmapDecoder> decoder;
+  hr = imaging_factory_->CreateDecoder(GUID_ContainerFormatJpeg, nullptr,
+                                       &decoder);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  hr = decoder->Initialize(stream.Get(), WICDecodeMetadataCacheOnDemand);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IWICBitmapFrameDecode> frame;
+  hr = decoder->GetFrame(0, &frame);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  UINT decoded_width = 0;
+  UINT decoded_height = 0;
+  WICRect rect = {};
+  WICPixelFormatGUID pixel_format = GUID_WICPixelFormat32bppBGR;
+  uint32_t bytes_per_pixel = 0;
+
+  // Decodes scaled down, straight to a pixel format that can be converted to
+  // RGBA in a single pass. With a crop or digital zoom, the scale is picked
+  // for the visible region, and only that region is copied out.
+  ComPtr<IWICBitmapSourceTransform> transform;
+  if (SUCCEEDED(frame.As(&transform))) {
+    const WICRect visible = GetCropRect(info.width, info.height, crop, mirror);
+    const uint32_t scale = GetJpegScaleDenominator(
+        visible.Width, visible.Height, target_width, target_height);
+    decoded_width = (info.width + scale - 1) / scale;
+    decoded_height = (info.height + scale - 1) / scale;
+    if (SUCCEEDED(transform->GetClosestSize(&decoded_width, &decoded_height)) &&
+        SUCCEEDED(transform->GetClosestPixelFormat(&pixel_format))) {
+      bytes_per_pixel = GetBytesPerPixel(pixel_format);
+    }
+
+    if (bytes_per_pixel != 0) {
+      rect = GetCropRect(decoded_width, decoded_height, crop, mirror);
+      const UINT stride = rect.Width * bytes_per_pixel;
+      decoded_buffer_.resize(static_cast<size_t>(stride) * rect.Height);
+      hr = transform->CopyPixels(
+          &rect, decoded_width, decoded_height, &pixel_format,
+          WICBitmapTransformRotate0, stride,
+          static_cast<UINT>(decoded_buffer_.size()), decoded_buffer_.data());
+      if (FAILED(hr)) {
+        return hr;
+      }
+    }
+  }
+
+  if (bytes_per_pixel == 0) {
+    // Falls back to decoding at full size through a format converter.
+    hr = frame->GetSize(&decoded_width, &decoded_height);
+    if (FAILED(hr)) {
+      return hr;
+    }
+
+    ComPtr<IWICFormatConverter> converter;
+    hr = imaging_factory_->CreateFormatConverter(&converter);
+    if (FAILED(hr)) {
+      return hr;
+    }
+
+    hr = converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppBGR,
+                               WICBitmapDitherTypeNone, nullptr, 0.0,
+                               WICBitmapPaletteTypeCustom);
+    if (FAILED(hr)) {
+      return hr;
+    }
+
+    bytes_per_pixel = 4;
+    rect = GetCropRect(decoded_width, decoded_height, crop, mirror);
+    const UINT stride = rect.Width * bytes_per_pixel;
+    decoded_buffer_.resize(static_cast<size_t>(stride) * rect.Height);
+    hr = converter->CopyPixels(&rect, stride,
+                               static_cast<UINT>(decoded_buffer_.size()),
+                               decoded_buffer_.data());
+    if (FAILED(hr)) {
+      return hr;
+    }
+  }
+
+  *width = rect.Width;
+  *height = rect.Height;
+  *bytes_per_pixel_out = bytes_per_pixel;
+  return S_OK;
+}
+
+void MjpegDecoder::WriteRGBA(uint32_t width, uint32_t height,
+                             uint32_t bytes_per_pixel, bool mirror,
+                             uint8_t* dst) {
+  const int32_t stride = static_cast<int32_t>(width * bytes_per_pixel);
+  if (bytes_per_pixel == 3) {
+    ConvertRGB24ToRGBA(decoded_buffer_.data(), stride, dst, width, height,
+                       mirror);
+  } else {
+    ConvertRGB32ToRGBA(decoded_buffer_.data(), stride, dst, width, height,
+                       mirror);
+  }
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,82 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MJPEG_DECODER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MJPEG_DECODER_H_
+
+#include <wincodec.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_pool.h"
+#include "preview_crop.h"
+
+namespace camera_windows {
+using Microsoft::WRL::ComPtr;
+
+// Decodes MJPEG preview frames to Flutter desktop pixel buffer pixels.
+//
+// Frames are decoded by the JPEG decoder of the Windows Imaging Component.
+// When the texture is smaller than the frame, the decoder scales the frame
+// down within its inverse DCT, which skips most of the decoding work.
+class MjpegDecoder {
+ public:
+  MjpegDecoder() {}
+  virtual ~MjpegDecoder() = default;
+
+  // Prevent copying.
+  MjpegDecoder(MjpegDecoder const&) = delete;
+  MjpegDecoder& operator=(MjpegDecoder const&) = delete;
+
+  // Decodes the JPEG image in |data| to packed RGBA pixels in |dst|, which is
+  // resized to fit.
+  //
+  // Decodes at 1/2, 1/4 or 1/8 scale if the result still covers
+  // |target_width| x |target_height| pixels, and returns the decoded size in
+  // |width| and |height|. If |mirror| is true, each row is flipped
+  // horizontally.
+  //
+  // Must be called from a thread that has initialized COM.
+  HRESULT Decode(const uint8_t* data, uint32_t data_length,
+                 uint32_t target_width, uint32_t target_height, bool mirror,
+                 std::vector<uint8_t>* dst, uint32_t* width,
+                 uint32_t* height);
+
+  // Same as above, but only decodes the part of the image shown by |crop|,
+  // which must be valid, into an RGBA frame acquired from |pool|, whose size
+  // and mirroring are set. The scale is picked for the cropped region.
+  // Returns E_OUTOFMEMORY if the pool has no free frame.
+  HRESULT Decode(const uint8_t* data, uint32_t data_length,
+                 uint32_t target_width, uint32_t target_height, bool mirror,
+                 const PreviewCrop& crop, FramePool* pool, FrameRef* frame);
+
+ private:
+  // Decodes the part of the JPEG image in |data| shown by |crop| into
+  // |decoded_buffer_|, and returns its size and the size of its pixels.
+  HRESULT DecodeToBuffer(const uint8_t* data, uint32_t data_length,
+                         uint32_t target_width, uint32_t target_height,
+                         bool mirror, const PreviewCrop& crop,
+                         uint32_t* width, uint32_t* height,
+                         uint32_t* bytes_per_pixel);
+
+  // Converts the pixels in |decoded_buffer_| to packed RGBA in |dst|.
+  void WriteRGBA(uint32_t width, uint32_t height, uint32_t bytes_per_pixel,
+                 bool mirror, uint8_t* dst);
+
+  ComPtr<IWICImagingFactory> imaging_factory_;
+
+  // Frame with the default Huffman tables inserted. Kept to reuse its
+  // allocation between frames.
+  std::vector<uint8_t> jpeg_buffer_;
+
+  // Pixels as output by the decoder. Kept to reuse its allocation between
+  // frames.
+  std::vector<uint8_t> decoded_buffer_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_MJPEG_DECODER_H_
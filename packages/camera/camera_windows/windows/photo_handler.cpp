@@ -9,6 +9,7 @@
 #include <wincodec.h>
 
 #include <cassert>
+#include <utility>
 
 #include "capture_engine_listener.h"
 #include "string_utils.h"
@@ -17,7 +18,65 @@ namespace camera_windows {
 
 using Microsoft::WRL::ComPtr;
 
-// Initializes media type for photo capture for jpeg images.
+// Forwards the samples of the photo sink to a |PhotoHandler|, until the
+// handler detaches from it.
+//
+// The photo sink keeps a reference to the callback, which may outlive the
+// handler.
+class PhotoSampleCallback : public IMFCaptureEngineOnSampleCallback {
+ public:
+  explicit PhotoSampleCallback(std::function<void(IMFSample*)> on_sample)
+      : on_sample_(std::move(on_sample)) {}
+
+  // Disallow copy and move.
+  PhotoSampleCallback(const PhotoSampleCallback&) = delete;
+  PhotoSampleCallback& operator=(const PhotoSampleCallback&) = delete;
+
+  // IUnknown
+  STDMETHODIMP_(ULONG) AddRef() { return InterlockedIncrement(&ref_); }
+
+  // IUnknown
+  STDMETHODIMP_(ULONG) Release() {
+    LONG ref = InterlockedDecrement(&ref_);
+    if (ref == 0) {
+      delete this;
+    }
+    return ref;
+  }
+
+  // IUnknown
+  STDMETHODIMP_(HRESULT) QueryInterface(const IID& riid, void** ppv) {
+    *ppv = nullptr;
+    if (riid == IID_IUnknown || riid == IID_IMFCaptureEngineOnSampleCallback) {
+      *ppv = static_cast<IMFCaptureEngineOnSampleCallback*>(this);
+      AddRef();
+      return S_OK;
+    }
+    return E_NOINTERFACE;
+  }
+
+  // IMFCaptureEngineOnSampleCallback
+  STDMETHODIMP_(HRESULT) OnSample(IMFSample* sample) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (on_sample_ && sample) {
+      on_sample_(sample);
+    }
+    return S_OK;
+  }
+
+  // Stops forwarding samples. Waits for a sample that is being forwarded.
+  void Detach() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    on_sample_ = nullptr;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::function<void(IMFSample*)> on_sample_;
+  volatile ULONG ref_ = 0;
+};
+
+// Initializes media type for photo capture for images in |image_format|.
 HRESULT BuildMediaTypeForPhotoCapture(IMFMediaType* src_media_type,
                                       IMFMediaType** photo_media_type,
                                       GUID image_format) {
@@ -49,16 +108,27 @@ HRESULT BuildMediaTypeForPhotoCapture(IMFMediaType* src_media_type,
   return hr;
 }
 
+PhotoHandler::PhotoHandler()
+    : sample_callback_(new PhotoSampleCallback(
+          [this](IMFSample* sample) { OnPhotoSample(sample); })) {}
+
+PhotoHandler::~PhotoHandler() {
+  sample_callback_->Detach();
+}
+
 HRESULT PhotoHandler::InitPhotoSink(IMFCaptureEngine* capture_engine,
-                                    IMFMediaType* base_media_type) {
+                                    IMFMediaType* base_media_type,
+                                    PhotoOutput output) {
   assert(capture_engine);
   assert(base_media_type);
 
   HRESULT hr = S_OK;
 
-  if (photo_sink_) {
+  if (photo_sink_ && output == photo_output_) {
     // If photo sink already exists, only update output filename.
-    hr = photo_sink_->SetOutputFileName(Utf16FromUtf8(file_path_).c_str());
+    if (output == PhotoOutput::kFile) {
+      hr = photo_sink_->SetOutputFileName(Utf16FromUtf8(file_path_).c_str());
+    }
 
     if (FAILED(hr)) {
       photo_sink_ = nullptr;
@@ -68,30 +138,39 @@ HRESULT PhotoHandler::InitPhotoSink(IMFCaptureEngine* capture_engine,
   }
 
   ComPtr<IMFMediaType> photo_media_type;
-  ComPtr<IMFCaptureSink> capture_sink;
 
-  // Get sink with photo type.
-  hr =
-      capture_engine->GetSink(MF_CAPTURE_ENGINE_SINK_TYPE_PHOTO, &capture_sink);
-  if (FAILED(hr)) {
-    return hr;
-  }
+  if (!photo_sink_) {
+    ComPtr<IMFCaptureSink> capture_sink;
 
-  hr = capture_sink.As(&photo_sink_);
-  if (FAILED(hr)) {
-    photo_sink_ = nullptr;
-    return hr;
+    // Get sink with photo type.
+    hr = capture_engine->GetSink(MF_CAPTURE_ENGINE_SINK_TYPE_PHOTO,
+                                 &capture_sink);
+    if (FAILED(hr)) {
+      return hr;
+    }
+
+    hr = capture_sink.As(&photo_sink_);
+    if (FAILED(hr)) {
+      photo_sink_ = nullptr;
+      return hr;
+    }
   }
 
+  // Switching outputs replaces the stream of the sink.
+  photo_output_ = output;
   hr = photo_sink_->RemoveAllStreams();
   if (FAILED(hr)) {
     photo_sink_ = nullptr;
     return hr;
   }
 
+  // In-memory photos are taken as bitmaps, so they are only compressed
+  // once, with the requested quality and size.
   hr = BuildMediaTypeForPhotoCapture(base_media_type,
                                      photo_media_type.GetAddressOf(),
-                                     GUID_ContainerFormatJpeg);
+                                     output == PhotoOutput::kFile
+                                         ? GUID_ContainerFormatJpeg
+                                         : GUID_ContainerFormatBmp);
 
   if (FAILED(hr)) {
     photo_sink_ = nullptr;
@@ -107,7 +186,11 @@ HRESULT PhotoHandler::InitPhotoSink(IMFCaptureEngine* capture_engine,
     return hr;
   }
 
-  hr = photo_sink_->SetOutputFileName(Utf16FromUtf8(file_path_).c_str());
+  if (output == PhotoOutput::kFile) {
+    hr = photo_sink_->SetOutputFileName(Utf16FromUtf8(file_path_).c_str());
+  } else {
+    hr = photo_sink_->SetSampleCallback(sample_callback_.Get());
+  }
   if (FAILED(hr)) {
     photo_sink_ = nullptr;
     return hr;
@@ -125,7 +208,8 @@ HRESULT PhotoHandler::TakePhoto(const std::string& file_path,
 
   file_path_ = file_path;
 
-  HRESULT hr = InitPhotoSink(capture_engine, base_media_type);
+  HRESULT hr =
+      InitPhotoSink(capture_engine, base_media_type, PhotoOutput::kFile);
   if (FAILED(hr)) {
     return hr;
   }
@@ -135,9 +219,87 @@ HRESULT PhotoHandler::TakePhoto(const std::string& file_path,
   return capture_engine->TakePhoto();
 }
 
+HRESULT PhotoHandler::TakePhotoToMemory(const JpegEncodeOptions& options,
+                                        IMFCaptureEngine* capture_engine,
+                                        IMFMediaType* base_media_type,
+                                        PhotoDataCallback callback) {
+  assert(capture_engine);
+  assert(base_media_type);
+  assert(callback);
+
+  file_path_.clear();
+
+  HRESULT hr =
+      InitPhotoSink(capture_engine, base_media_type, PhotoOutput::kMemory);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock(request_mutex_);
+    if (!worker_) {
+      worker_ = std::make_unique<ComWorkerPool>(1);
+    }
+    request_options_ = options;
+    request_callback_ = std::move(callback);
+  }
+
+  photo_state_ = PhotoState::kTakingPhoto;
+
+  return capture_engine->TakePhoto();
+}
+
 void PhotoHandler::OnPhotoTaken() {
   assert(photo_state_ == PhotoState::kTakingPhoto);
   photo_state_ = PhotoState::kIdle;
 }
 
+void PhotoHandler::OnPhotoSample(IMFSample* sample) {
+  assert(sample);
+  JpegEncodeOptions options;
+  PhotoDataCallback callback;
+  WorkerPool* worker = nullptr;
+  {
+    const std::lock_guard<std::mutex> lock(request_mutex_);
+    options = request_options_;
+    callback = std::move(request_callback_);
+    request_callback_ = nullptr;
+    worker = worker_.get();
+  }
+  if (!callback || !worker) {
+    return;
+  }
+
+  // Copies the bitmap out of the sample, so the engine gets its buffer back
+  // before the photo is encoded.
+  std::vector<uint8_t> bitmap;
+  ComPtr<IMFMediaBuffer> buffer;
+  HRESULT hr = sample->ConvertToContiguousBuffer(&buffer);
+  if (SUCCEEDED(hr)) {
+    BYTE* data = nullptr;
+    DWORD max_length = 0;
+    DWORD current_length = 0;
+    hr = buffer->Lock(&data, &max_length, &current_length);
+    if (SUCCEEDED(hr)) {
+      bitmap.assign(data, data + current_length);
+      buffer->Unlock();
+    }
+  }
+  if (FAILED(hr)) {
+    callback(hr, std::vector<uint8_t>());
+    return;
+  }
+
+  worker->Post([this, bitmap = std::move(bitmap), options,
+                callback = std::move(callback)]() {
+    std::vector<uint8_t> jpeg;
+    HRESULT hr =
+        encoder_.EncodeImage(bitmap.data(), bitmap.size(), options, &jpeg);
+    if (FAILED(hr)) {
+      jpeg.clear();
+    }
+    callback(hr, std::move(jpeg));
+  });
+}
+
 }  // namespace camera_windows
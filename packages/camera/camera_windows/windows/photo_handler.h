@@ -9,10 +9,15 @@
 #include <mfcaptureengine.h>
 #include <wrl/client.h>
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "capture_engine_listener.h"
+#include "com_worker_pool.h"
+#include "jpeg_encoder.h"
 
 namespace camera_windows {
 using Microsoft::WRL::ComPtr;
@@ -27,11 +32,30 @@ enum class PhotoState {
   kTakingPhoto,
 };
 
+// Destinations of photos taken by the capture engine.
+enum class PhotoOutput {
+  // The photo sink writes JPEG files.
+  kFile,
+  // The photo sink hands bitmaps to a sample callback, and they are encoded
+  // in memory.
+  kMemory,
+};
+
+class PhotoSampleCallback;
+
 // Handles photo sink initialization and tracks photo capture states.
 class PhotoHandler {
  public:
-  PhotoHandler() {}
-  virtual ~PhotoHandler() = default;
+  // Called from a worker thread with a photo taken by |TakePhotoToMemory|,
+  // which is empty if taking it failed.
+  using PhotoDataCallback =
+      std::function<void(HRESULT hr, std::vector<uint8_t> image)>;
+
+  PhotoHandler();
+
+  // Stops receiving photo samples, and waits for the photos that are being
+  // encoded.
+  virtual ~PhotoHandler();
 
   // Prevent copying.
   PhotoHandler(PhotoHandler const&) = delete;
@@ -51,6 +75,20 @@ class PhotoHandler {
                     IMFCaptureEngine* capture_engine,
                     IMFMediaType* base_media_type);
 
+  // Initializes photo sink for in-memory photos if not initialized and
+  // requests the capture engine to take photo.
+  //
+  // The photo is handed to the sample callback of the sink as an
+  // uncompressed bitmap, which is encoded to JPEG with |options| on a worker
+  // thread, so no file is written. |callback| is called from the worker
+  // thread with the encoded photo.
+  //
+  // Sets photo state to: kTakingPhoto.
+  HRESULT TakePhotoToMemory(const JpegEncodeOptions& options,
+                            IMFCaptureEngine* capture_engine,
+                            IMFMediaType* base_media_type,
+                            PhotoDataCallback callback);
+
   // Set the photo handler recording state to: kIdle.
   void OnPhotoTaken();
 
@@ -65,14 +103,36 @@ class PhotoHandler {
   // Returns the filesystem path of the captured photo.
   std::string GetPhotoPath() const { return file_path_; }
 
+  // Returns the destination of the last requested photo.
+  PhotoOutput GetPhotoOutput() const { return photo_output_; }
+
  private:
-  // Initializes record sink for video file capture.
+  // Initializes photo sink for |output|, or updates its output file if it is
+  // already initialized for files.
   HRESULT InitPhotoSink(IMFCaptureEngine* capture_engine,
-                        IMFMediaType* base_media_type);
+                        IMFMediaType* base_media_type, PhotoOutput output);
+
+  // Encodes a photo sample of the sink. Called from the sample thread of the
+  // capture engine.
+  void OnPhotoSample(IMFSample* sample);
 
   std::string file_path_;
   PhotoState photo_state_ = PhotoState::kNotStarted;
+  PhotoOutput photo_output_ = PhotoOutput::kFile;
   ComPtr<IMFCapturePhotoSink> photo_sink_;
+  ComPtr<PhotoSampleCallback> sample_callback_;
+
+  // Options and callback of the in-memory photo being taken.
+  std::mutex request_mutex_;
+  JpegEncodeOptions request_options_;
+  PhotoDataCallback request_callback_;
+
+  // Only used by the worker thread.
+  JpegEncoder encoder_;
+
+  // Created with the first in-memory photo. Declared last, so that its
+  // thread is joined before the members used by its tasks are destroyed.
+  std::unique_ptr<ComWorkerPool> worker_;
 };
 
 }  // namespace camera_windows
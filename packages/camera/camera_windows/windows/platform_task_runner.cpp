@@ -0,0 +1,108 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "platform_task_runner.h"
+
+#include <flutter/flutter_view.h>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace camera_windows {
+
+PlatformTaskRunnerImpl::PlatformTaskRunnerImpl(
+    flutter::PluginRegistrarWindows* registrar)
+    : registrar_(registrar) {
+  assert(registrar_);
+}
+
+PlatformTaskRunnerImpl::~PlatformTaskRunnerImpl() {
+  if (window_proc_id_) {
+    registrar_->UnregisterTopLevelWindowProcDelegate(*window_proc_id_);
+  }
+}
+
+bool PlatformTaskRunnerImpl::Register() {
+  assert(!window_proc_id_);
+  flutter::FlutterView* view = registrar_->GetView();
+  if (!view) {
+    return false;
+  }
+  HWND window = GetAncestor(view->GetNativeWindow(), GA_ROOT);
+  if (!window) {
+    return false;
+  }
+  // A registered message cannot collide with the messages of the app or of
+  // other plugins.
+  UINT message = RegisterWindowMessageW(L"CameraWindowsPlatformTask");
+  if (!message) {
+    return false;
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    window_ = window;
+    message_ = message;
+  }
+  window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+      [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+        return HandleWindowProc(hwnd, message, wparam, lparam);
+      });
+  return true;
+}
+
+void PlatformTaskRunnerImpl::PostTask(const void* owner, Task task) {
+  assert(task);
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (!window_) {
+    // Not registered; tasks would never run.
+    return;
+  }
+  tasks_.push_back({owner, std::move(task)});
+  if (!message_posted_) {
+    message_posted_ = PostMessageW(window_, message_, 0, 0) != FALSE;
+  }
+}
+
+void PlatformTaskRunnerImpl::CancelTasks(const void* owner) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  tasks_.erase(std::remove_if(tasks_.begin(), tasks_.end(),
+                              [owner](const PendingTask& pending) {
+                                return pending.owner == owner;
+                              }),
+               tasks_.end());
+}
+
+std::optional<LRESULT> PlatformTaskRunnerImpl::HandleWindowProc(
+    HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+  if (!message_ || message != message_) {
+    return std::nullopt;
+  }
+  RunTasks();
+  // Other instances of the plugin may share the window and the message.
+  return std::nullopt;
+}
+
+void PlatformTaskRunnerImpl::RunTasks() {
+  {
+    // Tasks posted from here on post a new message.
+    const std::lock_guard<std::mutex> lock(mutex_);
+    message_posted_ = false;
+  }
+  while (true) {
+    Task task;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front().task);
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,91 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_PLATFORM_TASK_RUNNER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_PLATFORM_TASK_RUNNER_H_
+
+#include <flutter/plugin_registrar_windows.h>
+#include <windows.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+namespace camera_windows {
+
+// Runs tasks posted from other threads on the platform thread, where method
+// results, channel messages and the camera state may be used.
+class PlatformTaskRunner {
+ public:
+  using Task = std::function<void()>;
+
+  PlatformTaskRunner() = default;
+  virtual ~PlatformTaskRunner() = default;
+
+  // Prevent copying.
+  PlatformTaskRunner(PlatformTaskRunner const&) = delete;
+  PlatformTaskRunner& operator=(PlatformTaskRunner const&) = delete;
+
+  // Runs |task| on the platform thread, after the tasks posted before it.
+  // May be called from any thread.
+  //
+  // |owner| identifies the object the task uses, so that its tasks can be
+  // cancelled before it is destroyed.
+  virtual void PostTask(const void* owner, Task task) = 0;
+
+  // Drops the tasks of |owner| that have not run yet. Called on the
+  // platform thread, so that no task of |owner| runs after it returns.
+  virtual void CancelTasks(const void* owner) = 0;
+};
+
+// Runs tasks on the platform thread through messages posted to the
+// top-level window of the Flutter view, which are received through a window
+// procedure delegate.
+class PlatformTaskRunnerImpl : public PlatformTaskRunner {
+ public:
+  // Creates a runner that is not registered for window messages.
+  explicit PlatformTaskRunnerImpl(flutter::PluginRegistrarWindows* registrar);
+
+  // Unregisters from window messages, dropping tasks that have not run.
+  virtual ~PlatformTaskRunnerImpl();
+
+  // Registers for window messages. Returns false if the registrar has no
+  // view to receive them.
+  bool Register();
+
+  // PlatformTaskRunner
+  void PostTask(const void* owner, Task task) override;
+  void CancelTasks(const void* owner) override;
+
+ private:
+  struct PendingTask {
+    const void* owner;
+    Task task;
+  };
+
+  // Handles the messages of the top-level window.
+  std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message,
+                                          WPARAM wparam, LPARAM lparam);
+
+  // Runs the pending tasks, one at a time, so that a task may cancel the
+  // tasks after it.
+  void RunTasks();
+
+  flutter::PluginRegistrarWindows* registrar_;
+  std::optional<int> window_proc_id_;
+  HWND window_ = nullptr;
+  UINT message_ = 0;
+
+  // Guards the pending tasks, which are posted from any thread.
+  std::mutex mutex_;
+  std::deque<PendingTask> tasks_;
+  // Whether a message has been posted that has not been handled yet. At
+  // most one is in the message queue at a time.
+  bool message_posted_ = false;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_PLATFORM_TASK_RUNNER_H_
@@ -18,6 +18,7 @@ using Microsoft::WRL::ComPtr;
 
 // Initializes media type for video preview.
 HRESULT BuildMediaTypeForVideoPreview(IMFMediaType* src_media_type,
+                                      REFGUID subtype,
                                       IMFMediaType** preview_media_type) {
   assert(src_media_type);
   ComPtr<IMFMediaType> new_media_type;
@@ -33,8 +34,8 @@ HRESULT BuildMediaTypeForVideoPreview(IMFMediaType* src_media_type,
     return hr;
   }
 
-  // Changes subtype to MFVideoFormat_RGB32.
-  hr = new_media_type->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_RGB32);
+  // Changes subtype to the requested preview format.
+  hr = new_media_type->SetGUID(MF_MT_SUBTYPE, subtype);
   if (FAILED(hr)) {
     return hr;
   }
@@ -49,6 +50,70 @@ HRESULT BuildMediaTypeForVideoPreview(IMFMediaType* src_media_type,
   return hr;
 }
 
+bool GetPixelFormatForSubtype(REFGUID subtype, PixelFormat* pixel_format) {
+  if (subtype == MFVideoFormat_NV12) {
+    *pixel_format = PixelFormat::kNV12;
+  } else if (subtype == MFVideoFormat_YUY2) {
+    *pixel_format = PixelFormat::kYUY2;
+  } else if (subtype == MFVideoFormat_RGB32) {
+    *pixel_format = PixelFormat::kRGB32;
+  } else if (subtype == MFVideoFormat_MJPG) {
+    *pixel_format = PixelFormat::kMJPG;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Reads the YCbCr color space of given media type.
+//
+// Cameras rarely set the color space attributes. If missing, BT.709 is
+// assumed for HD frame sizes and BT.601 otherwise, with limited range.
+YuvColorSpace GetYuvColorSpace(IMFMediaType* media_type) {
+  UINT32 width = 0;
+  UINT32 height = 0;
+  MFGetAttributeSize(media_type, MF_MT_FRAME_SIZE, &width, &height);
+
+  UINT32 matrix = MFVideoTransferMatrix_Unknown;
+  if (FAILED(media_type->GetUINT32(MF_MT_YUV_MATRIX, &matrix)) ||
+      matrix == MFVideoTransferMatrix_Unknown) {
+    matrix = height >= 720 ? MFVideoTransferMatrix_BT709
+                           : MFVideoTransferMatrix_BT601;
+  }
+
+  UINT32 range = MFNominalRange_Unknown;
+  if (FAILED(media_type->GetUINT32(MF_MT_VIDEO_NOMINAL_RANGE, &range))) {
+    range = MFNominalRange_Unknown;
+  }
+
+  YuvColorSpace color_space;
+  color_space.matrix = matrix == MFVideoTransferMatrix_BT709
+                           ? YuvMatrix::kBT709
+                           : YuvMatrix::kBT601;
+  color_space.range =
+      range == MFNominalRange_0_255 ? YuvRange::kFull : YuvRange::kLimited;
+  return color_space;
+}
+
+HRESULT PreviewHandler::AddPreviewStream(IMFMediaType* base_media_type,
+                                         REFGUID subtype,
+                                         DWORD* preview_sink_stream_index) {
+  ComPtr<IMFMediaType> preview_media_type;
+  HRESULT hr = BuildMediaTypeForVideoPreview(base_media_type, subtype,
+                                             preview_media_type.GetAddressOf());
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  hr = preview_sink_->AddStream(
+      (DWORD)MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_PREVIEW,
+      preview_media_type.Get(), nullptr, preview_sink_stream_index);
+  if (SUCCEEDED(hr)) {
+    preview_media_type_ = preview_media_type;
+  }
+  return hr;
+}
+
 HRESULT PreviewHandler::InitPreviewSink(
     IMFCaptureEngine* capture_engine, IMFMediaType* base_media_type,
     CaptureEngineListener* sample_callback) {
@@ -63,7 +128,6 @@ HRESULT PreviewHandler::InitPreviewSink(
     return hr;
   }
 
-  ComPtr<IMFMediaType> preview_media_type;
   ComPtr<IMFCaptureSink> capture_sink;
 
   // Get sink with preview type.
@@ -85,23 +149,33 @@ HRESULT PreviewHandler::InitPreviewSink(
     return hr;
   }
 
-  hr = BuildMediaTypeForVideoPreview(base_media_type,
-                                     preview_media_type.GetAddressOf());
-
-  if (FAILED(hr)) {
-    preview_sink_ = nullptr;
-    return hr;
+  // Prefers the native subtype of the camera if the plugin can convert it,
+  // so that Media Foundation does not insert a color converter or an MJPEG
+  // decoder in front of the sample callback. Falls back to RGB32 otherwise.
+  DWORD preview_sink_stream_index;
+  GUID native_subtype = GUID_NULL;
+  PixelFormat pixel_format = PixelFormat::kRGB32;
+  hr = E_FAIL;
+  if (SUCCEEDED(base_media_type->GetGUID(MF_MT_SUBTYPE, &native_subtype)) &&
+      GetPixelFormatForSubtype(native_subtype, &pixel_format)) {
+    hr = AddPreviewStream(base_media_type, native_subtype,
+                          &preview_sink_stream_index);
   }
 
-  DWORD preview_sink_stream_index;
-  hr = preview_sink_->AddStream(
-      (DWORD)MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_PREVIEW,
-      preview_media_type.Get(), nullptr, &preview_sink_stream_index);
+  if (FAILED(hr) && native_subtype != MFVideoFormat_RGB32) {
+    pixel_format = PixelFormat::kRGB32;
+    hr = AddPreviewStream(base_media_type, MFVideoFormat_RGB32,
+                          &preview_sink_stream_index);
+  }
 
   if (FAILED(hr)) {
     return hr;
   }
 
+  preview_sink_stream_index_ = preview_sink_stream_index;
+  frame_format_.pixel_format = pixel_format;
+  frame_format_.color_space = GetYuvColorSpace(base_media_type);
+
   hr = preview_sink_->SetSampleCallback(preview_sink_stream_index,
                                         sample_callback);
 
@@ -132,30 +206,138 @@ HRESULT PreviewHandler::StartPreview(IMFCaptureEngine* capture_engine,
 
 HRESULT PreviewHandler::StopPreview(IMFCaptureEngine* capture_engine) {
   if (preview_state_ == PreviewState::kStarting ||
-      preview_state_ == PreviewState::kRunning ||
-      preview_state_ == PreviewState::kPaused) {
+      preview_state_ == PreviewState::kRunning) {
     preview_state_ = PreviewState::kStopping;
     return capture_engine->StopPreview();
   }
+  if (preview_state_ == PreviewState::kPausing ||
+      preview_state_ == PreviewState::kPaused) {
+    // The preview stream is already stopped or stopping.
+    preview_state_ = PreviewState::kStopping;
+    resume_pending_ = false;
+    return S_OK;
+  }
   return E_FAIL;
 }
 
-bool PreviewHandler::PausePreview() {
+HRESULT PreviewHandler::PausePreview(IMFCaptureEngine* capture_engine) {
+  assert(capture_engine);
+  if (preview_state_ == PreviewState::kPausing && resume_pending_) {
+    resume_pending_ = false;
+    return S_OK;
+  }
   if (preview_state_ != PreviewState::kRunning) {
-    return false;
+    return E_FAIL;
   }
-  preview_state_ = PreviewState::kPaused;
-  return true;
+
+  // Check MF_CAPTURE_ENGINE_PREVIEW_STOPPED event handling for response
+  // process.
+  HRESULT hr = capture_engine->StopPreview();
+  if (SUCCEEDED(hr)) {
+    preview_state_ = PreviewState::kPausing;
+  }
+  return hr;
 }
 
-bool PreviewHandler::ResumePreview() {
+HRESULT PreviewHandler::ResumePreview(IMFCaptureEngine* capture_engine) {
+  assert(capture_engine);
+  if (preview_state_ == PreviewState::kPausing) {
+    resume_pending_ = true;
+    return S_OK;
+  }
   if (preview_state_ != PreviewState::kPaused) {
+    return E_FAIL;
+  }
+
+  // The preview sink keeps its streams and sample callback while stopped.
+  HRESULT hr = capture_engine->StartPreview();
+  if (SUCCEEDED(hr)) {
+    preview_state_ = PreviewState::kRunning;
+  }
+  return hr;
+}
+
+bool PreviewHandler::OnPreviewStopped(IMFCaptureEngine* capture_engine) {
+  if (preview_state_ != PreviewState::kPausing) {
     return false;
   }
-  preview_state_ = PreviewState::kRunning;
+
+  preview_state_ = PreviewState::kPaused;
+  if (resume_pending_) {
+    resume_pending_ = false;
+    // Stays paused if the stream cannot be restarted, so that resuming can
+    // be retried.
+    ResumePreview(capture_engine);
+  }
   return true;
 }
 
+HRESULT PreviewHandler::SetFrameSize(uint32_t width, uint32_t height) {
+  if (!preview_sink_ || !preview_media_type_) {
+    return E_FAIL;
+  }
+
+  // Changing the output media type of a running sink needs IMFCaptureSink2.
+  ComPtr<IMFCaptureSink2> preview_sink2;
+  HRESULT hr = preview_sink_.As(&preview_sink2);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  ComPtr<IMFMediaType> media_type;
+  hr = MFCreateMediaType(&media_type);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  hr = preview_media_type_->CopyAllItems(media_type.Get());
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  hr = MFSetAttributeSize(media_type.Get(), MF_MT_FRAME_SIZE, width, height);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  // Stride, sample size and apertures of the camera frame size do not apply
+  // to the new size; the video processor fills them in.
+  media_type->DeleteItem(MF_MT_DEFAULT_STRIDE);
+  media_type->DeleteItem(MF_MT_SAMPLE_SIZE);
+  media_type->DeleteItem(MF_MT_MINIMUM_DISPLAY_APERTURE);
+  media_type->DeleteItem(MF_MT_GEOMETRIC_APERTURE);
+  media_type->DeleteItem(MF_MT_PAN_SCAN_APERTURE);
+
+  return preview_sink2->SetOutputMediaType(preview_sink_stream_index_,
+                                           media_type.Get(), nullptr);
+}
+
+HRESULT PreviewHandler::GetFrameSize(uint32_t* width, uint32_t* height) {
+  assert(width && height);
+  if (!preview_sink_) {
+    return E_FAIL;
+  }
+
+  ComPtr<IMFMediaType> media_type;
+  HRESULT hr = preview_sink_->GetOutputMediaType(preview_sink_stream_index_,
+                                                 &media_type);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  UINT32 frame_width = 0;
+  UINT32 frame_height = 0;
+  hr = MFGetAttributeSize(media_type.Get(), MF_MT_FRAME_SIZE, &frame_width,
+                          &frame_height);
+  if (FAILED(hr)) {
+    return hr;
+  }
+
+  *width = frame_width;
+  *height = frame_height;
+  return hr;
+}
+
 void PreviewHandler::OnPreviewStarted() {
   assert(preview_state_ == PreviewState::kStarting);
   if (preview_state_ == PreviewState::kStarting) {
@@ -13,19 +13,28 @@
 #include <string>
 
 #include "capture_engine_listener.h"
+#include "frame_conversion.h"
 
 namespace camera_windows {
 using Microsoft::WRL::ComPtr;
 
+// Maps a video subtype to a pixel format the plugin converts or decodes in
+// software.
+// Returns false if the subtype is not supported.
+bool GetPixelFormatForSubtype(REFGUID subtype, PixelFormat* pixel_format);
+
 // States the preview handler can be in.
 //
 // When created, the handler starts in |kNotStarted| state and mostly
 // transitions in sequential order of the states. When the preview is running,
-// it can be set to the |kPaused| state and later resumed to |kRunning| state.
+// it can be paused, which stops the preview stream of the capture engine
+// through the |kPausing| state until the engine reports it stopped, and
+// later resumed to |kRunning| state.
 enum class PreviewState {
   kNotStarted,
   kStarting,
   kRunning,
+  kPausing,
   kPaused,
   kStopping
 };
@@ -62,38 +71,79 @@ class PreviewHandler {
   //                  the ongoing recording.
   HRESULT StopPreview(IMFCaptureEngine* capture_engine);
 
-  // Set the preview handler recording state to: paused.
-  bool PausePreview();
+  // Requests capture engine to stop the preview stream, so that no more
+  // samples are captured and converted, while keeping the preview sink to
+  // resume it. Sets preview state to: pausing.
+  //
+  // capture_engine:  A pointer to capture engine instance.
+  HRESULT PausePreview(IMFCaptureEngine* capture_engine);
 
-  // Set the preview handler recording state to: running.
-  bool ResumePreview();
+  // Requests capture engine to restart the preview stream of a paused
+  // preview, without configuring the preview sink again. If the engine has
+  // not yet reported the stream stopped, it is restarted once it does.
+  // Sets preview state to: running.
+  //
+  // capture_engine:  A pointer to capture engine instance.
+  HRESULT ResumePreview(IMFCaptureEngine* capture_engine);
+
+  // Handles the capture engine reporting that the preview stream stopped.
+  //
+  // Returns true if the stream was stopped to pause the preview, in which
+  // case the handler must be kept to resume it.
+  bool OnPreviewStopped(IMFCaptureEngine* capture_engine);
 
   // Set the preview handler recording state to: running.
   void OnPreviewStarted();
 
-  // Returns true if preview state is running or paused.
+  // Returns true if preview state is running, pausing or paused.
   bool IsInitialized() const {
     return preview_state_ == PreviewState::kRunning ||
+           preview_state_ == PreviewState::kPausing ||
            preview_state_ == PreviewState::kPaused;
   }
 
   // Returns true if preview state is running.
   bool IsRunning() const { return preview_state_ == PreviewState::kRunning; }
 
-  // Return true if preview state is paused.
-  bool IsPaused() const { return preview_state_ == PreviewState::kPaused; }
+  // Return true if preview state is pausing or paused.
+  bool IsPaused() const {
+    return preview_state_ == PreviewState::kPausing ||
+           preview_state_ == PreviewState::kPaused;
+  }
 
   // Returns true if preview state is starting.
   bool IsStarting() const { return preview_state_ == PreviewState::kStarting; }
 
+  // Returns the format of the samples delivered to the sample callback.
+  // Only valid after the preview has been started.
+  const FrameFormat& GetFrameFormat() const { return frame_format_; }
+
+  // Requests preview samples of the given size, scaled from the frames of
+  // the camera. Samples keep their previous size until the sample callback
+  // is notified of the format change.
+  HRESULT SetFrameSize(uint32_t width, uint32_t height);
+
+  // Gets the size of the preview samples as currently configured.
+  HRESULT GetFrameSize(uint32_t* width, uint32_t* height);
+
  private:
   // Initializes record sink for video file capture.
   HRESULT InitPreviewSink(IMFCaptureEngine* capture_engine,
                           IMFMediaType* base_media_type,
                           CaptureEngineListener* sample_callback);
 
+  // Adds a preview stream delivering samples of the given subtype.
+  HRESULT AddPreviewStream(IMFMediaType* base_media_type, REFGUID subtype,
+                           DWORD* preview_sink_stream_index);
+
   PreviewState preview_state_ = PreviewState::kNotStarted;
+  // Set when the preview is resumed before the engine reported the stream
+  // of the pause stopped.
+  bool resume_pending_ = false;
   ComPtr<IMFCapturePreviewSink> preview_sink_;
+  ComPtr<IMFMediaType> preview_media_type_;
+  DWORD preview_sink_stream_index_ = 0;
+  FrameFormat frame_format_;
 };
 
 }  // namespace camera_windows
@@ -201,10 +201,8 @@ HRESULT RecordHandler::StartRecord(const std::string& file_path,
   assert(base_media_type);
 
   type_ = max_duration < 0 ? RecordingType::kContinuous : RecordingType::kTimed;
-  max_video_duration_ms_ = max_duration;
+  recording_timer_.Start(max_duration);
   file_path_ = file_path;
-  recording_start_timestamp_us_ = -1;
-  recording_duration_us_ = 0;
 
   HRESULT hr = InitRecordSink(capture_engine, base_media_type);
   if (FAILED(hr)) {
@@ -232,28 +230,16 @@ void RecordHandler::OnRecordStarted() {
 void RecordHandler::OnRecordStopped() {
   if (recording_state_ == RecordState::kStopping) {
     file_path_ = "";
-    recording_start_timestamp_us_ = -1;
-    recording_duration_us_ = 0;
-    max_video_duration_ms_ = -1;
+    recording_timer_.Reset();
     recording_state_ = RecordState::kNotStarted;
     type_ = RecordingType::kNone;
   }
 }
 
-void RecordHandler::UpdateRecordingTime(uint64_t timestamp) {
-  if (recording_start_timestamp_us_ < 0) {
-    recording_start_timestamp_us_ = timestamp;
-  }
-
-  recording_duration_us_ = (timestamp - recording_start_timestamp_us_);
-}
-
 bool RecordHandler::ShouldStopTimedRecording() const {
   return type_ == RecordingType::kTimed &&
          recording_state_ == RecordState::kRunning &&
-         max_video_duration_ms_ > 0 &&
-         recording_duration_us_ >=
-             (static_cast<uint64_t>(max_video_duration_ms_) * 1000);
+         recording_timer_.HasReachedMaxDuration();
 }
 
 }  // namespace camera_windows
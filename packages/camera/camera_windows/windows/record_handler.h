@@ -12,6 +12,8 @@
 #include <memory>
 #include <string>
 
+#include "recording_timer.h"
+
 namespace camera_windows {
 using Microsoft::WRL::ComPtr;
 
@@ -89,10 +91,14 @@ class RecordHandler {
   std::string GetRecordPath() const { return file_path_; }
 
   // Returns the duration of the video recording in microseconds.
-  uint64_t GetRecordedDuration() const { return recording_duration_us_; }
+  uint64_t GetRecordedDuration() const {
+    return recording_timer_.GetDuration();
+  }
 
   // Calculates new recording time from capture timestamp.
-  void UpdateRecordingTime(uint64_t timestamp);
+  void UpdateRecordingTime(uint64_t timestamp) {
+    recording_timer_.Update(timestamp);
+  }
 
   // Returns true if recording time has exceeded the maximum duration for timed
   // recordings.
@@ -104,9 +110,7 @@ class RecordHandler {
                          IMFMediaType* base_media_type);
 
   bool record_audio_ = false;
-  int64_t max_video_duration_ms_ = -1;
-  int64_t recording_start_timestamp_us_ = -1;
-  uint64_t recording_duration_us_ = 0;
+  RecordingTimer recording_timer_;
   std::string file_path_;
   RecordState recording_state_ = RecordState::kNotStarted;
   RecordingType type_ = RecordingType::kNone;
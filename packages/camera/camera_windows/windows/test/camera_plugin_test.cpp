@@ -14,6 +14,7 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "mocks.h"
@@ -53,7 +54,10 @@ void MockInitCamera(MockCamera* camera, bool success) {
       .WillOnce([camera, success](flutter::TextureRegistrar* texture_registrar,
                                   flutter::BinaryMessenger* messenger,
                                   bool record_audio,
-                                  ResolutionPreset resolution_preset) {
+                                  ResolutionPreset resolution_preset,
+                                  const std::optional<MediaTypePreferences>&
+                                      media_type_preferences,
+                                  bool low_latency) {
         assert(camera->pending_result_);
         if (success) {
           camera->pending_result_->Success(EncodableValue(1));
@@ -122,6 +126,57 @@ TEST(CameraPlugin, AvailableCamerasHandlerErrorIfFailsToEnumerateDevices) {
       std::move(result));
 }
 
+TEST(CameraPlugin, AvailableCamerasHandlerCachesDevicesUntilTheyChange) {
+  std::unique_ptr<MockTextureRegistrar> texture_registrar_ =
+      std::make_unique<MockTextureRegistrar>();
+  std::unique_ptr<MockBinaryMessenger> messenger_ =
+      std::make_unique<MockBinaryMessenger>();
+  std::unique_ptr<MockCameraFactory> camera_factory_ =
+      std::make_unique<MockCameraFactory>();
+
+  MockCameraPlugin plugin(texture_registrar_.get(), messenger_.get(),
+                          std::move(camera_factory_));
+  plugin.SetDeviceNotificationsActive(true);
+
+  // Enumerated once before and once after the devices changed.
+  EXPECT_CALL(plugin, EnumerateVideoCaptureDeviceSources)
+      .Times(2)
+      .WillRepeatedly([](IMFActivate*** devices, UINT32* count) {
+        *count = 0U;
+        *devices = static_cast<IMFActivate**>(
+            CoTaskMemAlloc(sizeof(IMFActivate*) * (*count)));
+        return true;
+      });
+
+  // A series of changes is reported to Dart once.
+  EXPECT_CALL(*messenger_,
+              Send(Eq("plugins.flutter.io/camera_windows"), _, _, _))
+      .Times(1);
+
+  for (int i = 0; i < 2; i++) {
+    std::unique_ptr<MockMethodResult> result =
+        std::make_unique<MockMethodResult>();
+    EXPECT_CALL(*result, ErrorInternal).Times(0);
+    EXPECT_CALL(*result, SuccessInternal).Times(1);
+    plugin.HandleMethodCall(
+        flutter::MethodCall("availableCameras",
+                            std::make_unique<EncodableValue>()),
+        std::move(result));
+  }
+
+  plugin.OnVideoCaptureDevicesChanged();
+  plugin.OnVideoCaptureDevicesChanged();
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+  plugin.HandleMethodCall(
+      flutter::MethodCall("availableCameras",
+                          std::make_unique<EncodableValue>()),
+      std::move(result));
+}
+
 TEST(CameraPlugin, CreateHandlerCallsInitCamera) {
   std::unique_ptr<MockMethodResult> result =
       std::make_unique<MockMethodResult>();
@@ -159,6 +214,109 @@ TEST(CameraPlugin, CreateHandlerCallsInitCamera) {
       std::move(result));
 }
 
+TEST(CameraPlugin, CreateHandlerPassesMediaTypePreferencesAndLowLatency) {
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+  std::unique_ptr<MockTextureRegistrar> texture_registrar_ =
+      std::make_unique<MockTextureRegistrar>();
+  std::unique_ptr<MockBinaryMessenger> messenger_ =
+      std::make_unique<MockBinaryMessenger>();
+  std::unique_ptr<MockCameraFactory> camera_factory_ =
+      std::make_unique<MockCameraFactory>();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  EXPECT_CALL(*camera, HasPendingResultByType).WillOnce(Return(false));
+  EXPECT_CALL(*camera, AddPendingResult)
+      .WillOnce([camera = camera.get()](
+                    PendingResultType type,
+                    std::unique_ptr<MethodResult<>> result) {
+        camera->pending_result_ = std::move(result);
+        return true;
+      });
+  EXPECT_CALL(*camera, InitCamera)
+      .Times(1)
+      .WillOnce([camera = camera.get()](
+                    flutter::TextureRegistrar* texture_registrar,
+                    flutter::BinaryMessenger* messenger, bool record_audio,
+                    ResolutionPreset resolution_preset,
+                    const std::optional<MediaTypePreferences>&
+                        media_type_preferences,
+                    bool low_latency) {
+        EXPECT_TRUE(low_latency);
+        EXPECT_TRUE(media_type_preferences.has_value());
+        EXPECT_EQ(media_type_preferences->target_width, 1280u);
+        EXPECT_EQ(media_type_preferences->target_height, 720u);
+        EXPECT_EQ(media_type_preferences->preferred_frame_rate, 60.f);
+        EXPECT_EQ(media_type_preferences->mjpg_cost, 0.5f);
+        // Values that are not passed keep their defaults.
+        EXPECT_EQ(media_type_preferences->minimum_frame_rate,
+                  MediaTypePreferences().minimum_frame_rate);
+        camera->pending_result_->Success(EncodableValue(1));
+        return true;
+      });
+
+  camera_factory_->pending_camera_ = std::move(camera);
+
+  EXPECT_CALL(*camera_factory_, CreateCamera(MOCK_DEVICE_ID));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal(Pointee(EncodableValue(1))));
+
+  CameraPlugin plugin(texture_registrar_.get(), messenger_.get(),
+                      std::move(camera_factory_));
+  EncodableMap args = {
+      {EncodableValue("cameraName"), EncodableValue(MOCK_CAMERA_NAME)},
+      {EncodableValue("resolutionPreset"), EncodableValue(nullptr)},
+      {EncodableValue("enableAudio"), EncodableValue(true)},
+      {EncodableValue("mediaTypePreferences"),
+       EncodableValue(EncodableMap({
+           {EncodableValue("targetWidth"), EncodableValue(1280)},
+           {EncodableValue("targetHeight"), EncodableValue(720)},
+           {EncodableValue("preferredFrameRate"), EncodableValue(60.0)},
+           {EncodableValue("mjpgCost"), EncodableValue(0.5)},
+       }))},
+      {EncodableValue("lowLatency"), EncodableValue(true)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("create",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, CreateHandlerErrorOnInvalidMediaTypePreferences) {
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+  std::unique_ptr<MockTextureRegistrar> texture_registrar_ =
+      std::make_unique<MockTextureRegistrar>();
+  std::unique_ptr<MockBinaryMessenger> messenger_ =
+      std::make_unique<MockBinaryMessenger>();
+  std::unique_ptr<MockCameraFactory> camera_factory_ =
+      std::make_unique<MockCameraFactory>();
+
+  EXPECT_CALL(*camera_factory_, CreateCamera).Times(0);
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  CameraPlugin plugin(texture_registrar_.get(), messenger_.get(),
+                      std::move(camera_factory_));
+  EncodableMap args = {
+      {EncodableValue("cameraName"), EncodableValue(MOCK_CAMERA_NAME)},
+      {EncodableValue("resolutionPreset"), EncodableValue(nullptr)},
+      {EncodableValue("enableAudio"), EncodableValue(true)},
+      {EncodableValue("mediaTypePreferences"),
+       EncodableValue(EncodableMap({
+           {EncodableValue("minFrameRate"), EncodableValue(-1.0)},
+       }))},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("create",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
 TEST(CameraPlugin, CreateHandlerErrorOnInvalidDeviceId) {
   std::unique_ptr<MockMethodResult> result =
       std::make_unique<MockMethodResult>();
@@ -473,6 +631,161 @@ TEST(CameraPlugin, TakePictureHandlerCallsTakePictureWithPath) {
       std::move(initialize_result));
 }
 
+TEST(CameraPlugin, TakePictureToMemoryHandlerCallsTakePictureWithOptions) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> initialize_result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera,
+              HasPendingResultByType(Eq(PendingResultType::kTakePicture)))
+      .Times(1)
+      .WillOnce(Return(false));
+
+  EXPECT_CALL(*camera, AddPendingResult(Eq(PendingResultType::kTakePicture), _))
+      .Times(1)
+      .WillOnce([cam = camera.get()](PendingResultType type,
+                                     std::unique_ptr<MethodResult<>> result) {
+        cam->pending_result_ = std::move(result);
+        return true;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        assert(cam->pending_result_);
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, TakePictureToMemory)
+      .Times(1)
+      .WillOnce([cam = camera.get()](const JpegEncodeOptions& options) {
+        EXPECT_FLOAT_EQ(options.quality, 0.5f);
+        EXPECT_EQ(options.max_width, 640u);
+        EXPECT_EQ(options.max_height, 0u);
+        assert(cam->pending_result_);
+        return cam->pending_result_->Success();
+      });
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*initialize_result, ErrorInternal).Times(0);
+  EXPECT_CALL(*initialize_result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("quality"), EncodableValue(0.5)},
+      {EncodableValue("maxWidth"), EncodableValue(640)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("takePictureToMemory",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(initialize_result));
+}
+
+TEST(CameraPlugin, TakePictureToMemoryHandlerErrorOnInvalidQuality) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> initialize_result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId).Times(0);
+  EXPECT_CALL(*camera, AddPendingResult).Times(0);
+  EXPECT_CALL(*capture_controller, TakePictureToMemory).Times(0);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*initialize_result, ErrorInternal).Times(1);
+  EXPECT_CALL(*initialize_result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("quality"), EncodableValue(1.5)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("takePictureToMemory",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(initialize_result));
+}
+
+TEST(CameraPlugin, TakePictureToMemoryHandlerErrorOnOversizedMaxWidth) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> initialize_result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId).Times(0);
+  EXPECT_CALL(*camera, AddPendingResult).Times(0);
+  EXPECT_CALL(*capture_controller, TakePictureToMemory).Times(0);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*initialize_result, ErrorInternal).Times(1);
+  EXPECT_CALL(*initialize_result, SuccessInternal).Times(0);
+
+  // A width that does not fit in 32 bits is rejected rather than truncated.
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("maxWidth"),
+       EncodableValue(static_cast<int64_t>(UINT32_MAX) + 1)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("takePictureToMemory",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(initialize_result));
+}
+
 TEST(CameraPlugin, TakePictureHandlerErrorOnInvalidCameraId) {
   int64_t mock_camera_id = 1234;
   int64_t missing_camera_id = 5678;
@@ -1051,5 +1364,898 @@ TEST(CameraPlugin, PausePreviewHandlerErrorOnInvalidCameraId) {
       std::move(initialize_result));
 }
 
+TEST(CameraPlugin, GetPreviewStatsHandlerReturnsPreviewStats) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, GetPreviewStats)
+      .Times(1)
+      .WillOnce([](PreviewStatsSnapshot* stats) {
+        stats->frames_delivered = 300;
+        stats->frames_dropped = 12;
+        stats->frames_skipped = 150;
+        stats->scheduling_latency_p99_us = 2300;
+        stats->capture_latency_p99_us = 52000;
+        stats->conversion_time_p99_us = 4100;
+        return true;
+      });
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal)
+      .Times(1)
+      .WillOnce([](const EncodableValue* value) {
+        const auto* stats = std::get_if<EncodableMap>(value);
+        ASSERT_TRUE(stats);
+        EXPECT_EQ(stats->at(EncodableValue("framesDelivered")),
+                  EncodableValue(int64_t{300}));
+        EXPECT_EQ(stats->at(EncodableValue("framesDropped")),
+                  EncodableValue(int64_t{12}));
+        EXPECT_EQ(stats->at(EncodableValue("framesSkipped")),
+                  EncodableValue(int64_t{150}));
+        EXPECT_EQ(stats->at(EncodableValue("schedulingLatencyP99")),
+                  EncodableValue(int64_t{2300}));
+        EXPECT_EQ(stats->at(EncodableValue("captureLatencyP99")),
+                  EncodableValue(int64_t{52000}));
+        EXPECT_EQ(stats->at(EncodableValue("conversionTimeP99")),
+                  EncodableValue(int64_t{4100}));
+      });
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("getPreviewStats",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, GetPreviewStatsHandlerErrorIfPreviewNotStarted) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, GetPreviewStats)
+      .Times(1)
+      .WillOnce(Return(false));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("getPreviewStats",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, StartImageStreamHandlerStartsStreamWithOptions) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, StartImageStream)
+      .Times(1)
+      .WillOnce([](std::unique_ptr<ImageStreamHandler> handler) {
+        const ImageStreamOptions& options = handler->GetOptions();
+        EXPECT_EQ(options.format, ImageStreamFormat::kNV12);
+        EXPECT_EQ(options.max_width, 640u);
+        EXPECT_EQ(options.max_height, 480u);
+        EXPECT_EQ(options.max_frame_rate, 15.0);
+        EXPECT_EQ(options.max_pending_frames, 2u);
+        return true;
+      });
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockBinaryMessenger messenger;
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          &messenger, std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("format"), EncodableValue(std::string("nv12"))},
+      {EncodableValue("maxWidth"), EncodableValue(640)},
+      {EncodableValue("maxHeight"), EncodableValue(480)},
+      {EncodableValue("maxFrameRate"), EncodableValue(15.0)},
+      {EncodableValue("maxPendingFrames"), EncodableValue(2)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("startImageStream",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, StartImageStreamHandlerErrorOnUnknownFormat) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId).Times(0);
+  EXPECT_CALL(*camera, GetCaptureController).Times(0);
+  EXPECT_CALL(*capture_controller, StartImageStream).Times(0);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockBinaryMessenger messenger;
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          &messenger, std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("format"), EncodableValue(std::string("yuv444"))},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("startImageStream",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, StartImageStreamHandlerErrorOnOversizedMaxWidth) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId).Times(0);
+  EXPECT_CALL(*camera, GetCaptureController).Times(0);
+  EXPECT_CALL(*capture_controller, StartImageStream).Times(0);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockBinaryMessenger messenger;
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          &messenger, std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  // A width that does not fit in 32 bits is rejected rather than truncated.
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("maxWidth"),
+       EncodableValue(static_cast<int64_t>(UINT32_MAX) + 1)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("startImageStream",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, StopImageStreamHandlerStopsStream) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, StopImageStream).Times(1);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("stopImageStream",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetZeroShutterLagHandlerEnablesZeroShutterLag) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, SetZeroShutterLag(true))
+      .Times(1)
+      .WillOnce(Return(true));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("enabled"), EncodableValue(true)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setZeroShutterLag",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetZeroShutterLagHandlerErrorOnPreviewNotStarted) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, SetZeroShutterLag(true))
+      .Times(1)
+      .WillOnce(Return(false));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("enabled"), EncodableValue(true)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setZeroShutterLag",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetPreviewFrameRateLimitHandlerSetsLimitAndDisplayRate) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  // Once for the display change, and once for the method call.
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(2)
+      .WillRepeatedly([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  // The refresh rate of the last display change is passed on to the camera
+  // again with the limit.
+  EXPECT_CALL(*capture_controller, SetDisplayRefreshRate(144.0)).Times(2);
+  EXPECT_CALL(*capture_controller, SetPreviewFrameRateLimit(30.0, true))
+      .Times(1);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  plugin.OnDisplayRefreshRateChanged(144.0);
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("maxFrameRate"), EncodableValue(30.0)},
+      {EncodableValue("matchDisplayRefreshRate"), EncodableValue(true)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setPreviewFrameRateLimit",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetPreviewFrameRateLimitHandlerErrorOnInvalidLimit) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId).Times(0);
+  EXPECT_CALL(*camera, GetCaptureController).Times(0);
+  EXPECT_CALL(*capture_controller, SetPreviewFrameRateLimit).Times(0);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("maxFrameRate"), EncodableValue(-1.0)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setPreviewFrameRateLimit",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetCaptureThreadHandlerSetsDedicatedThread) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, SetCaptureThread(true, uint64_t{0x6}))
+      .Times(1)
+      .WillOnce(Return(true));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("dedicated"), EncodableValue(true)},
+      {EncodableValue("cpuAffinityMask"), EncodableValue(int64_t{0x6})},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setCaptureThread",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetCaptureThreadHandlerErrorOnInvalidAffinityMask) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, SetCaptureThread)
+      .Times(1)
+      .WillOnce(Return(false));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("dedicated"), EncodableValue(true)},
+      {EncodableValue("cpuAffinityMask"), EncodableValue(int64_t{1} << 62)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setCaptureThread",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetPreviewCropHandlerKeepsValuesNotPassed) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  // Only the zoom factor changes.
+  const PreviewCrop current_crop = {0.5, 0.0, 0.5, 1.0, 1.0};
+  PreviewCrop expected_crop = current_crop;
+  expected_crop.zoom = 2.5;
+  EXPECT_CALL(*capture_controller, GetPreviewCrop)
+      .Times(1)
+      .WillOnce(Return(current_crop));
+  EXPECT_CALL(*capture_controller, SetPreviewCrop(Eq(expected_crop)))
+      .Times(1)
+      .WillOnce(Return(true));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("zoom"), EncodableValue(2.5)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setPreviewCrop",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, SetPreviewCropHandlerErrorOnInvalidCrop) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, GetPreviewCrop)
+      .Times(1)
+      .WillOnce(Return(PreviewCrop()));
+  EXPECT_CALL(*capture_controller, SetPreviewCrop)
+      .Times(1)
+      .WillOnce(Return(false));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("left"), EncodableValue(0.75)},
+      {EncodableValue("width"), EncodableValue(0.5)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("setPreviewCrop",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, GetMaxPreviewZoomHandlerFollowsPreviewHeight) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, GetPreviewHeight)
+      .Times(1)
+      .WillOnce(Return(1080));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal)
+      .Times(1)
+      .WillOnce([](const EncodableValue* value) {
+        ASSERT_TRUE(value);
+        EXPECT_EQ(*value, EncodableValue(GetMaxPreviewZoom(1080)));
+      });
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("getMaxPreviewZoom",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, StartBurstHandlerCallsStartBurstWithOptions) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId(Eq(mock_camera_id)))
+      .Times(1)
+      .WillOnce([cam = camera.get()](int64_t camera_id) {
+        return cam->camera_id_ == camera_id;
+      });
+
+  EXPECT_CALL(*camera, GetCaptureController)
+      .Times(1)
+      .WillOnce([cam = camera.get()]() {
+        return cam->capture_controller_.get();
+      });
+
+  EXPECT_CALL(*capture_controller, StartBurst(5, 200, _))
+      .Times(1)
+      .WillOnce(Return(true));
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal).Times(1);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("count"), EncodableValue(5)},
+      {EncodableValue("interval"), EncodableValue(200)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("startBurst",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
+TEST(CameraPlugin, StartBurstHandlerErrorOnInvalidCount) {
+  int64_t mock_camera_id = 1234;
+
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+
+  std::unique_ptr<MockCaptureController> capture_controller =
+      std::make_unique<MockCaptureController>();
+
+  EXPECT_CALL(*camera, HasCameraId).Times(0);
+  EXPECT_CALL(*capture_controller, StartBurst).Times(0);
+
+  camera->camera_id_ = mock_camera_id;
+  camera->capture_controller_ = std::move(capture_controller);
+
+  MockCameraPlugin plugin(std::make_unique<MockTextureRegistrar>().get(),
+                          std::make_unique<MockBinaryMessenger>().get(),
+                          std::make_unique<MockCameraFactory>());
+
+  // Add mocked camera to plugins camera list.
+  plugin.AddCamera(std::move(camera));
+
+  EXPECT_CALL(*result, ErrorInternal).Times(1);
+  EXPECT_CALL(*result, SuccessInternal).Times(0);
+
+  EncodableMap args = {
+      {EncodableValue("cameraId"), EncodableValue(mock_camera_id)},
+      {EncodableValue("count"), EncodableValue(0)},
+  };
+
+  plugin.HandleMethodCall(
+      flutter::MethodCall("startBurst",
+                          std::make_unique<EncodableValue>(EncodableMap(args))),
+      std::move(result));
+}
+
 }  // namespace test
 }  // namespace camera_windows
@@ -53,7 +53,7 @@ TEST(Camera, InitCameraCreatesCaptureController) {
       camera->InitCamera(std::move(capture_controller_factory),
                          std::make_unique<MockTextureRegistrar>().get(),
                          std::make_unique<MockBinaryMessenger>().get(), false,
-                         ResolutionPreset::kAuto);
+                         ResolutionPreset::kAuto, std::nullopt, false);
   EXPECT_TRUE(result);
   EXPECT_TRUE(camera->GetCaptureController() != nullptr);
 }
@@ -84,7 +84,7 @@ TEST(Camera, InitCameraReportsFailure) {
       camera->InitCamera(std::move(capture_controller_factory),
                          std::make_unique<MockTextureRegistrar>().get(),
                          std::make_unique<MockBinaryMessenger>().get(), false,
-                         ResolutionPreset::kAuto);
+                         ResolutionPreset::kAuto, std::nullopt, false);
   EXPECT_FALSE(result);
   EXPECT_TRUE(camera->GetCaptureController() != nullptr);
 }
@@ -428,6 +428,22 @@ TEST(Camera, OnTakePictureSucceededReturnsSuccess) {
   camera->OnTakePictureSucceeded(file_path);
 }
 
+TEST(Camera, OnTakePictureToMemorySucceededReturnsImage) {
+  std::unique_ptr<CameraImpl> camera =
+      std::make_unique<CameraImpl>(MOCK_DEVICE_ID);
+  std::unique_ptr<MockMethodResult> result =
+      std::make_unique<MockMethodResult>();
+
+  const std::vector<uint8_t> image = {0xFF, 0xD8, 0xFF, 0xD9};
+
+  EXPECT_CALL(*result, ErrorInternal).Times(0);
+  EXPECT_CALL(*result, SuccessInternal(Pointee(EncodableValue(image))));
+
+  camera->AddPendingResult(PendingResultType::kTakePicture, std::move(result));
+
+  camera->OnTakePictureToMemorySucceeded(image);
+}
+
 TEST(Camera, TakePictureReportsError) {
   std::unique_ptr<CameraImpl> camera =
       std::make_unique<CameraImpl>(MOCK_DEVICE_ID);
@@ -490,7 +506,8 @@ TEST(Camera, OnVideoRecordSucceededInvokesCameraChannelEvent) {
   // Init camera with mock capture controller factory
   camera->InitCamera(std::move(capture_controller_factory),
                      std::make_unique<MockTextureRegistrar>().get(),
-                     binary_messenger.get(), false, ResolutionPreset::kAuto);
+                     binary_messenger.get(), false, ResolutionPreset::kAuto,
+                     std::nullopt, false);
 
   // Pass camera id for camera
   camera->OnCreateCaptureEngineSucceeded(camera_id);
@@ -501,5 +518,46 @@ TEST(Camera, OnVideoRecordSucceededInvokesCameraChannelEvent) {
   camera = nullptr;
 }
 
+TEST(Camera, OnBurstPictureTakenInvokesCameraChannelEvents) {
+  std::unique_ptr<CameraImpl> camera =
+      std::make_unique<CameraImpl>(MOCK_DEVICE_ID);
+  std::unique_ptr<MockCaptureControllerFactory> capture_controller_factory =
+      std::make_unique<MockCaptureControllerFactory>();
+
+  std::unique_ptr<MockBinaryMessenger> binary_messenger =
+      std::make_unique<MockBinaryMessenger>();
+
+  const std::string file_path = "C:\\temp\\BurstCapture_1.jpeg";
+  const int64_t camera_id = 12345;
+  std::string camera_channel =
+      std::string("plugins.flutter.io/camera_windows/camera") +
+      std::to_string(camera_id);
+
+  EXPECT_CALL(*capture_controller_factory, CreateCaptureController)
+      .Times(1)
+      .WillOnce(
+          []() { return std::make_unique<NiceMock<MockCaptureController>>(); });
+
+  // Burst picture, burst picture failure, burst completion, and camera
+  // closing messages.
+  EXPECT_CALL(*binary_messenger, Send(Eq(camera_channel), _, _, _)).Times(4);
+
+  // Init camera with mock capture controller factory
+  camera->InitCamera(std::move(capture_controller_factory),
+                     std::make_unique<MockTextureRegistrar>().get(),
+                     binary_messenger.get(), false, ResolutionPreset::kAuto,
+                     std::nullopt, false);
+
+  // Pass camera id for camera
+  camera->OnCreateCaptureEngineSucceeded(camera_id);
+
+  camera->OnBurstPictureTaken(0, file_path);
+  camera->OnBurstPictureFailed(1, CameraResult::kError, "Failed");
+  camera->OnBurstCompleted();
+
+  // Dispose camera before message channel.
+  camera = nullptr;
+}
+
 }  // namespace test
 }  // namespace camera_windows
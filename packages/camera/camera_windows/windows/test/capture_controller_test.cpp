@@ -14,8 +14,10 @@
 #include <wrl/client.h>
 
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mocks.h"
 #include "string_utils.h"
@@ -27,12 +29,14 @@ namespace test {
 using Microsoft::WRL::ComPtr;
 using ::testing::_;
 using ::testing::Eq;
+using ::testing::NotNull;
 using ::testing::Return;
 
 void MockInitCaptureController(CaptureControllerImpl* capture_controller,
                                MockTextureRegistrar* texture_registrar,
                                MockCaptureEngine* engine, MockCamera* camera,
-                               int64_t mock_texture_id) {
+                               int64_t mock_texture_id,
+                               bool low_latency = false) {
   ComPtr<MockMediaSource> video_source = new MockMediaSource();
   ComPtr<MockMediaSource> audio_source = new MockMediaSource();
 
@@ -60,7 +64,8 @@ void MockInitCaptureController(CaptureControllerImpl* capture_controller,
   EXPECT_CALL(*engine, Initialize).Times(1);
 
   bool result = capture_controller->InitCaptureDevice(
-      texture_registrar, MOCK_DEVICE_ID, true, ResolutionPreset::kAuto);
+      texture_registrar, MOCK_DEVICE_ID, true, ResolutionPreset::kAuto,
+      std::nullopt, low_latency);
 
   EXPECT_TRUE(result);
 
@@ -73,7 +78,8 @@ void MockInitCaptureController(CaptureControllerImpl* capture_controller,
 void MockAvailableMediaTypes(MockCaptureEngine* engine,
                              MockCaptureSource* capture_source,
                              uint32_t mock_preview_width,
-                             uint32_t mock_preview_height) {
+                             uint32_t mock_preview_height,
+                             GUID mock_preview_subtype = MFVideoFormat_RGB32) {
   EXPECT_CALL(*engine, GetSource)
       .Times(1)
       .WillOnce(
@@ -89,13 +95,14 @@ void MockAvailableMediaTypes(MockCaptureEngine* engine,
           Eq((DWORD)
                  MF_CAPTURE_ENGINE_PREFERRED_SOURCE_STREAM_FOR_VIDEO_PREVIEW),
           _, _))
-      .WillRepeatedly([mock_preview_width, mock_preview_height](
-                          DWORD stream_index, DWORD media_type_index,
-                          IMFMediaType** media_type) {
+      .WillRepeatedly([mock_preview_width, mock_preview_height,
+                       mock_preview_subtype](DWORD stream_index,
+                                             DWORD media_type_index,
+                                             IMFMediaType** media_type) {
         // We give only one media type to loop through
         if (media_type_index != 0) return MF_E_NO_MORE_TYPES;
         *media_type =
-            new FakeMediaType(MFMediaType_Video, MFVideoFormat_RGB32,
+            new FakeMediaType(MFMediaType_Video, mock_preview_subtype,
                               mock_preview_width, mock_preview_height);
         (*media_type)->AddRef();
         return S_OK;
@@ -126,7 +133,9 @@ void MockStartPreview(CaptureControllerImpl* capture_controller,
                       std::unique_ptr<uint8_t[]> mock_source_buffer,
                       uint32_t mock_source_buffer_size,
                       uint32_t mock_preview_width, uint32_t mock_preview_height,
-                      int64_t mock_texture_id) {
+                      int64_t mock_texture_id,
+                      GUID mock_preview_subtype = MFVideoFormat_RGB32,
+                      UINT64 mock_device_timestamp = 0) {
   EXPECT_CALL(*engine, GetSink(MF_CAPTURE_ENGINE_SINK_TYPE_PREVIEW, _))
       .Times(1)
       .WillOnce([src_sink = preview_sink](MF_CAPTURE_ENGINE_SINK_TYPE sink_type,
@@ -137,7 +146,18 @@ void MockStartPreview(CaptureControllerImpl* capture_controller,
       });
 
   EXPECT_CALL(*preview_sink, RemoveAllStreams).Times(1).WillOnce(Return(S_OK));
-  EXPECT_CALL(*preview_sink, AddStream).Times(1).WillOnce(Return(S_OK));
+  // Samples are requested in the native format of the camera.
+  EXPECT_CALL(*preview_sink, AddStream)
+      .Times(1)
+      .WillOnce([mock_preview_subtype](DWORD source_stream_index,
+                                       IMFMediaType* media_type,
+                                       IMFAttributes* attributes,
+                                       DWORD* sink_stream_index) -> HRESULT {
+        GUID subtype = GUID_NULL;
+        EXPECT_TRUE(SUCCEEDED(media_type->GetGUID(MF_MT_SUBTYPE, &subtype)));
+        EXPECT_EQ(subtype, mock_preview_subtype);
+        return S_OK;
+      });
   EXPECT_CALL(*preview_sink, SetSampleCallback)
       .Times(1)
       .WillOnce([sink = preview_sink](
@@ -149,7 +169,7 @@ void MockStartPreview(CaptureControllerImpl* capture_controller,
 
   ComPtr<MockCaptureSource> capture_source = new MockCaptureSource();
   MockAvailableMediaTypes(engine, capture_source.Get(), mock_preview_width,
-                          mock_preview_height);
+                          mock_preview_height, mock_preview_subtype);
 
   EXPECT_CALL(*engine, StartPreview()).Times(1).WillOnce(Return(S_OK));
 
@@ -174,7 +194,7 @@ void MockStartPreview(CaptureControllerImpl* capture_controller,
 
   // SendFake sample
   preview_sink->SendFakeSample(mock_source_buffer.get(),
-                               mock_source_buffer_size);
+                               mock_source_buffer_size, mock_device_timestamp);
 }
 
 void MockPhotoSink(MockCaptureEngine* engine,
@@ -258,7 +278,8 @@ TEST(CaptureController, InitCaptureEngineCanOnlyBeCalledOnce) {
   EXPECT_CALL(*camera, OnCreateCaptureEngineFailed).Times(1);
 
   bool result = capture_controller->InitCaptureDevice(
-      texture_registrar.get(), MOCK_DEVICE_ID, true, ResolutionPreset::kAuto);
+      texture_registrar.get(), MOCK_DEVICE_ID, true, ResolutionPreset::kAuto,
+      std::nullopt, false);
 
   EXPECT_FALSE(result);
 
@@ -299,7 +320,8 @@ TEST(CaptureController, InitCaptureEngineReportsFailure) {
       .Times(1);
 
   bool result = capture_controller->InitCaptureDevice(
-      texture_registrar.get(), MOCK_DEVICE_ID, true, ResolutionPreset::kAuto);
+      texture_registrar.get(), MOCK_DEVICE_ID, true, ResolutionPreset::kAuto,
+      std::nullopt, false);
 
   EXPECT_FALSE(result);
   EXPECT_FALSE(engine->initialized_);
@@ -343,7 +365,8 @@ TEST(CaptureController, InitCaptureEngineReportsAccessDenied) {
       .Times(1);
 
   bool result = capture_controller->InitCaptureDevice(
-      texture_registrar.get(), MOCK_DEVICE_ID, true, ResolutionPreset::kAuto);
+      texture_registrar.get(), MOCK_DEVICE_ID, true, ResolutionPreset::kAuto,
+      std::nullopt, false);
 
   EXPECT_FALSE(result);
   EXPECT_FALSE(engine->initialized_);
@@ -553,6 +576,253 @@ TEST(CaptureController, StartPreviewStartsProcessingSamples) {
   texture_registrar = nullptr;
 }
 
+TEST(CaptureController, StartPreviewConvertsNativeNV12Samples) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  // A 2x2 NV12 frame: four limited range white luma samples followed by one
+  // neutral chroma pair.
+  uint32_t mock_preview_width = 2;
+  uint32_t mock_preview_height = 2;
+  uint32_t mock_sample_size = 6;
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(mock_sample_size);
+  const uint8_t mock_nv12_frame[] = {235, 235, 235, 235, 128, 128};
+  std::copy(mock_nv12_frame, mock_nv12_frame + mock_sample_size,
+            mock_source_buffer.get());
+
+  // Start preview and run preview tests
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), mock_sample_size,
+                   mock_preview_width, mock_preview_height, mock_texture_id,
+                   MFVideoFormat_NV12);
+
+  // Test texture processing
+  EXPECT_TRUE(texture_registrar->texture_);
+  if (texture_registrar->texture_) {
+    auto pixel_buffer_texture =
+        std::get_if<flutter::PixelBufferTexture>(texture_registrar->texture_);
+    EXPECT_TRUE(pixel_buffer_texture);
+
+    if (pixel_buffer_texture) {
+      auto converted_buffer =
+          pixel_buffer_texture->CopyPixelBuffer((size_t)100, (size_t)100);
+
+      EXPECT_TRUE(converted_buffer);
+      if (converted_buffer) {
+        EXPECT_EQ(converted_buffer->height, mock_preview_height);
+        EXPECT_EQ(converted_buffer->width, mock_preview_width);
+
+        FlutterDesktopPixel* converted_buffer_data =
+            (FlutterDesktopPixel*)(converted_buffer->buffer);
+
+        for (uint32_t i = 0; i < mock_preview_width * mock_preview_height;
+             i++) {
+          EXPECT_EQ(converted_buffer_data[i].r, 255);
+          EXPECT_EQ(converted_buffer_data[i].g, 255);
+          EXPECT_EQ(converted_buffer_data[i].b, 255);
+          EXPECT_EQ(converted_buffer_data[i].a, 255);
+        }
+
+        // Call release callback to get mutex lock unlocked.
+        converted_buffer->release_callback(converted_buffer->release_context);
+      }
+      converted_buffer = nullptr;
+    }
+    pixel_buffer_texture = nullptr;
+  }
+
+  capture_controller = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+  texture_registrar = nullptr;
+}
+
+TEST(CaptureController, StartPreviewDecodesNativeMJPGSamples) {
+  // Media Foundation delivers samples on threads with COM initialized, which
+  // the JPEG decoder depends on.
+  HRESULT com_hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  // A white 16x16 JPEG image with 4:2:0 chroma subsampling. Like in the
+  // MJPEG streams of many cameras, the Huffman tables are left out.
+  uint32_t mock_preview_width = 16;
+  uint32_t mock_preview_height = 16;
+  const uint8_t mock_mjpg_frame[] = {
+      0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 0x4A, 0x46, 0x49, 0x46, 0x00, 0x01,
+      0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xFF, 0xDB, 0x00, 0x43,
+      0x00, 0x08, 0x06, 0x06, 0x07, 0x06, 0x05, 0x08, 0x07, 0x07, 0x07, 0x09,
+      0x09, 0x08, 0x0A, 0x0C, 0x14, 0x0D, 0x0C, 0x0B, 0x0B, 0x0C, 0x19, 0x12,
+      0x13, 0x0F, 0x14, 0x1D, 0x1A, 0x1F, 0x1E, 0x1D, 0x1A, 0x1C, 0x1C, 0x20,
+      0x24, 0x2E, 0x27, 0x20, 0x22, 0x2C, 0x23, 0x1C, 0x1C, 0x28, 0x37, 0x29,
+      0x2C, 0x30, 0x31, 0x34, 0x34, 0x34, 0x1F, 0x27, 0x39, 0x3D, 0x38, 0x32,
+      0x3C, 0x2E, 0x33, 0x34, 0x32, 0xFF, 0xDB, 0x00, 0x43, 0x01, 0x09, 0x09,
+      0x09, 0x0C, 0x0B, 0x0C, 0x18, 0x0D, 0x0D, 0x18, 0x32, 0x21, 0x1C, 0x21,
+      0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+      0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+      0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+      0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+      0x32, 0x32, 0xFF, 0xC0, 0x00, 0x11, 0x08, 0x00, 0x10, 0x00, 0x10, 0x03,
+      0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01, 0xFF, 0xDA, 0x00,
+      0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00, 0xF7,
+      0xFA, 0x28, 0xA2, 0x80, 0x3F, 0xFF, 0xD9,
+  };
+  uint32_t mock_sample_size = sizeof(mock_mjpg_frame);
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(mock_sample_size);
+  std::copy(mock_mjpg_frame, mock_mjpg_frame + mock_sample_size,
+            mock_source_buffer.get());
+
+  // Start preview and run preview tests
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), mock_sample_size,
+                   mock_preview_width, mock_preview_height, mock_texture_id,
+                   MFVideoFormat_MJPG);
+
+  // Test texture processing
+  EXPECT_TRUE(texture_registrar->texture_);
+  if (texture_registrar->texture_) {
+    auto pixel_buffer_texture =
+        std::get_if<flutter::PixelBufferTexture>(texture_registrar->texture_);
+    EXPECT_TRUE(pixel_buffer_texture);
+
+    if (pixel_buffer_texture) {
+      auto converted_buffer =
+          pixel_buffer_texture->CopyPixelBuffer((size_t)100, (size_t)100);
+
+      EXPECT_TRUE(converted_buffer);
+      if (converted_buffer) {
+        EXPECT_EQ(converted_buffer->height, mock_preview_height);
+        EXPECT_EQ(converted_buffer->width, mock_preview_width);
+
+        FlutterDesktopPixel* converted_buffer_data =
+            (FlutterDesktopPixel*)(converted_buffer->buffer);
+
+        // Lossy compression may leave white slightly off.
+        for (uint32_t i = 0; i < mock_preview_width * mock_preview_height;
+             i++) {
+          EXPECT_GE(converted_buffer_data[i].r, 250);
+          EXPECT_GE(converted_buffer_data[i].g, 250);
+          EXPECT_GE(converted_buffer_data[i].b, 250);
+          EXPECT_EQ(converted_buffer_data[i].a, 255);
+        }
+
+        // Call release callback to get mutex lock unlocked.
+        converted_buffer->release_callback(converted_buffer->release_context);
+      }
+      converted_buffer = nullptr;
+    }
+    pixel_buffer_texture = nullptr;
+  }
+
+  capture_controller = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+  texture_registrar = nullptr;
+
+  if (SUCCEEDED(com_hr)) {
+    CoUninitialize();
+  }
+}
+
+TEST(CaptureController, StartPreviewFallsBackToRGB32Samples) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  ComPtr<MockCaptureSource> capture_source = new MockCaptureSource();
+  MockAvailableMediaTypes(engine.Get(), capture_source.Get(), 2, 2,
+                          MFVideoFormat_YUY2);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+  EXPECT_CALL(*engine.Get(), GetSink(MF_CAPTURE_ENGINE_SINK_TYPE_PREVIEW, _))
+      .Times(1)
+      .WillOnce([src_sink = preview_sink.Get()](
+                    MF_CAPTURE_ENGINE_SINK_TYPE sink_type,
+                    IMFCaptureSink** target_sink) {
+        *target_sink = src_sink;
+        src_sink->AddRef();
+        return S_OK;
+      });
+  EXPECT_CALL(*preview_sink.Get(), RemoveAllStreams)
+      .Times(1)
+      .WillOnce(Return(S_OK));
+
+  // The native YUY2 stream is rejected, so RGB32 samples are requested
+  // instead.
+  std::vector<GUID> requested_subtypes;
+  EXPECT_CALL(*preview_sink.Get(), AddStream)
+      .Times(2)
+      .WillRepeatedly([&requested_subtypes](DWORD source_stream_index,
+                                            IMFMediaType* media_type,
+                                            IMFAttributes* attributes,
+                                            DWORD* sink_stream_index) {
+        GUID subtype = GUID_NULL;
+        media_type->GetGUID(MF_MT_SUBTYPE, &subtype);
+        requested_subtypes.push_back(subtype);
+        return subtype == MFVideoFormat_RGB32 ? S_OK : MF_E_INVALIDMEDIATYPE;
+      });
+  EXPECT_CALL(*preview_sink.Get(), SetSampleCallback)
+      .Times(1)
+      .WillOnce(Return(S_OK));
+
+  EXPECT_CALL(*engine.Get(), StartPreview()).Times(1).WillOnce(Return(S_OK));
+  // Called by destructor
+  EXPECT_CALL(*engine.Get(), StopPreview()).Times(1).WillOnce(Return(S_OK));
+  EXPECT_CALL(*camera, OnStartPreviewFailed).Times(0);
+
+  capture_controller->StartPreview();
+
+  ASSERT_EQ(requested_subtypes.size(), 2u);
+  EXPECT_EQ(requested_subtypes[0], MFVideoFormat_YUY2);
+  EXPECT_EQ(requested_subtypes[1], MFVideoFormat_RGB32);
+
+  capture_controller = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+  texture_registrar = nullptr;
+}
+
 TEST(CaptureController, ReportsStartPreviewError) {
   ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
   std::unique_ptr<MockCamera> camera =
@@ -1167,6 +1437,64 @@ TEST(CaptureController, TakePictureSuccess) {
   photo_sink = nullptr;
 }
 
+TEST(CaptureController, TakePictureToMemoryUsesSampleCallback) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to take picture
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  ComPtr<MockCaptureSource> capture_source = new MockCaptureSource();
+
+  // Prepare fake media types
+  MockAvailableMediaTypes(engine.Get(), capture_source.Get(), 1, 1);
+
+  ComPtr<MockCapturePhotoSink> photo_sink = new MockCapturePhotoSink();
+
+  // Initialize photo sink with a sample callback instead of a file.
+  EXPECT_CALL(*engine, GetSink(MF_CAPTURE_ENGINE_SINK_TYPE_PHOTO, _))
+      .Times(1)
+      .WillOnce([src_sink = photo_sink.Get()](
+                    MF_CAPTURE_ENGINE_SINK_TYPE sink_type,
+                    IMFCaptureSink** target_sink) {
+        *target_sink = src_sink;
+        src_sink->AddRef();
+        return S_OK;
+      });
+  EXPECT_CALL(*photo_sink, RemoveAllStreams).Times(1).WillOnce(Return(S_OK));
+  EXPECT_CALL(*photo_sink, AddStream).Times(1).WillOnce(Return(S_OK));
+  EXPECT_CALL(*photo_sink, SetOutputFileName).Times(0);
+  EXPECT_CALL(*photo_sink, SetSampleCallback(NotNull()))
+      .Times(1)
+      .WillOnce(Return(S_OK));
+
+  // Request photo
+  EXPECT_CALL(*(engine.Get()), TakePhoto()).Times(1).WillOnce(Return(S_OK));
+  JpegEncodeOptions options;
+  options.quality = 0.5f;
+  capture_controller->TakePictureToMemory(options);
+
+  // The photo is only reported once its sample has been encoded.
+  EXPECT_CALL(*camera, OnTakePictureSucceeded).Times(0);
+  EXPECT_CALL(*camera, OnTakePictureToMemorySucceeded).Times(0);
+  EXPECT_CALL(*camera, OnTakePictureFailed).Times(0);
+  engine->CreateFakeEvent(S_OK, MF_CAPTURE_ENGINE_PHOTO_TAKEN);
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+  photo_sink = nullptr;
+}
+
 TEST(CaptureController, ReportsTakePictureError) {
   ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
   std::unique_ptr<MockCamera> camera =
@@ -1368,11 +1696,30 @@ TEST(CaptureController, PauseResumePreviewSuccess) {
                    texture_registrar.get(), engine.Get(), camera.get(),
                    std::move(mock_source_buffer), 0, 1, 1, mock_texture_id);
 
+  // Pausing stops the preview stream of the capture engine, so that no
+  // samples are captured or converted while paused.
+  EXPECT_CALL(*engine, StopPreview())
+      .Times(1)
+      .WillOnce(Return(S_OK))
+      .RetiresOnSaturation();
   EXPECT_CALL(*camera, OnPausePreviewSucceeded()).Times(1);
   capture_controller->PausePreview();
+  EXPECT_FALSE(capture_controller->IsReadyForSample());
+
+  // The handler is kept once the engine reports the stream stopped.
+  engine->CreateFakeEvent(S_OK, MF_CAPTURE_ENGINE_PREVIEW_STOPPED);
 
+  // Resuming restarts the stream without setting up the preview sink or
+  // reporting a new preview start.
+  EXPECT_CALL(*engine, StartPreview())
+      .Times(1)
+      .WillOnce(Return(S_OK))
+      .RetiresOnSaturation();
+  EXPECT_CALL(*engine, GetSink).Times(0);
+  EXPECT_CALL(*camera, OnStartPreviewSucceeded).Times(0);
   EXPECT_CALL(*camera, OnResumePreviewSucceeded()).Times(1);
   capture_controller->ResumePreview();
+  EXPECT_TRUE(capture_controller->IsReadyForSample());
 
   capture_controller = nullptr;
   texture_registrar = nullptr;
@@ -1380,7 +1727,7 @@ TEST(CaptureController, PauseResumePreviewSuccess) {
   camera = nullptr;
 }
 
-TEST(CaptureController, PausePreviewFailsIfPreviewNotStarted) {
+TEST(CaptureController, ResumePreviewWaitsForPausedStreamToStop) {
   ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
   std::unique_ptr<MockCamera> camera =
       std::make_unique<MockCamera>(MOCK_DEVICE_ID);
@@ -1388,26 +1735,48 @@ TEST(CaptureController, PausePreviewFailsIfPreviewNotStarted) {
       std::make_unique<CaptureControllerImpl>(camera.get());
   std::unique_ptr<MockTextureRegistrar> texture_registrar =
       std::make_unique<MockTextureRegistrar>();
+
   int64_t mock_texture_id = 1234;
 
-  // Initialize capture controller to be able to start preview
   MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
                             engine.Get(), camera.get(), mock_texture_id);
 
-  // Pause preview fails if not started
-  EXPECT_CALL(*camera, OnPausePreviewFailed(Eq(CameraResult::kError),
-                                            Eq("Preview not started")))
-      .Times(1);
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(0);
+
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), 0, 1, 1, mock_texture_id);
 
+  EXPECT_CALL(*engine, StopPreview())
+      .Times(1)
+      .WillOnce(Return(S_OK))
+      .RetiresOnSaturation();
+  EXPECT_CALL(*camera, OnPausePreviewSucceeded()).Times(1);
   capture_controller->PausePreview();
 
+  // The stream is only restarted once the engine reports it stopped.
+  EXPECT_CALL(*engine, StartPreview()).Times(0);
+  EXPECT_CALL(*camera, OnResumePreviewSucceeded()).Times(1);
+  capture_controller->ResumePreview();
+  EXPECT_FALSE(capture_controller->IsReadyForSample());
+
+  EXPECT_CALL(*engine, StartPreview())
+      .Times(1)
+      .WillOnce(Return(S_OK))
+      .RetiresOnSaturation();
+  engine->CreateFakeEvent(S_OK, MF_CAPTURE_ENGINE_PREVIEW_STOPPED);
+  EXPECT_TRUE(capture_controller->IsReadyForSample());
+
   capture_controller = nullptr;
   texture_registrar = nullptr;
   engine = nullptr;
   camera = nullptr;
 }
 
-TEST(CaptureController, ResumePreviewFailsIfPreviewNotStarted) {
+TEST(CaptureController, PausePreviewFailsIfEngineCannotStopPreview) {
   ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
   std::unique_ptr<MockCamera> camera =
       std::make_unique<MockCamera>(MOCK_DEVICE_ID);
@@ -1415,22 +1784,508 @@ TEST(CaptureController, ResumePreviewFailsIfPreviewNotStarted) {
       std::make_unique<CaptureControllerImpl>(camera.get());
   std::unique_ptr<MockTextureRegistrar> texture_registrar =
       std::make_unique<MockTextureRegistrar>();
+
   int64_t mock_texture_id = 1234;
 
-  // Initialize capture controller to be able to start preview
   MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
                             engine.Get(), camera.get(), mock_texture_id);
 
-  // Resume preview fails if not started.
-  EXPECT_CALL(*camera, OnResumePreviewFailed(Eq(CameraResult::kError),
-                                             Eq("Preview not started")))
-      .Times(1);
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
 
-  capture_controller->ResumePreview();
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(0);
 
-  capture_controller = nullptr;
-  texture_registrar = nullptr;
-  engine = nullptr;
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), 0, 1, 1, mock_texture_id);
+
+  EXPECT_CALL(*engine, StopPreview())
+      .Times(1)
+      .WillOnce(Return(E_FAIL))
+      .RetiresOnSaturation();
+  EXPECT_CALL(*camera, OnPausePreviewSucceeded()).Times(0);
+  EXPECT_CALL(*camera, OnPausePreviewFailed(Eq(CameraResult::kError),
+                                            Eq("Failed to pause preview")))
+      .Times(1);
+  capture_controller->PausePreview();
+
+  // The preview keeps running.
+  EXPECT_TRUE(capture_controller->IsReadyForSample());
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, PausePreviewFailsIfPreviewNotStarted) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  // Pause preview fails if not started
+  EXPECT_CALL(*camera, OnPausePreviewFailed(Eq(CameraResult::kError),
+                                            Eq("Preview not started")))
+      .Times(1);
+
+  capture_controller->PausePreview();
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, ResumePreviewFailsIfPreviewNotStarted) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  // Resume preview fails if not started.
+  EXPECT_CALL(*camera, OnResumePreviewFailed(Eq(CameraResult::kError),
+                                             Eq("Preview not started")))
+      .Times(1);
+
+  capture_controller->ResumePreview();
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, PreviewFrameRateLimitSkipsSamplesBeforeReading) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(0);
+
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), 0, 1, 1, mock_texture_id);
+
+  // Every second sample of a 60 fps camera is skipped at 30 fps.
+  capture_controller->SetPreviewFrameRateLimit(30, false);
+  bool draw_preview = false;
+  uint64_t sample_time_us = 1000000;
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(
+        capture_controller->ShouldProcessSample(sample_time_us, &draw_preview),
+        i % 2 == 0);
+    EXPECT_EQ(draw_preview, i % 2 == 0);
+    sample_time_us += 16667;
+  }
+
+  PreviewStatsSnapshot stats;
+  EXPECT_TRUE(capture_controller->GetPreviewStats(&stats));
+  EXPECT_EQ(stats.frames_skipped, 5u);
+
+  // Removing the limit processes every sample again.
+  capture_controller->SetPreviewFrameRateLimit(0, false);
+  EXPECT_TRUE(
+      capture_controller->ShouldProcessSample(sample_time_us, &draw_preview));
+  EXPECT_TRUE(capture_controller->ShouldProcessSample(sample_time_us + 16667,
+                                                      &draw_preview));
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, PreviewFrameRateLimitFollowsDisplayRefreshRate) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(0);
+
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), 0, 1, 1, mock_texture_id);
+
+  // The display only limits previews that follow it.
+  capture_controller->SetDisplayRefreshRate(20);
+  bool draw_preview = false;
+  uint64_t sample_time_us = 1000000;
+  EXPECT_TRUE(
+      capture_controller->ShouldProcessSample(sample_time_us, &draw_preview));
+  EXPECT_TRUE(capture_controller->ShouldProcessSample(sample_time_us + 25000,
+                                                      &draw_preview));
+
+  // A 40 fps camera is paced to a 20 Hz display below the 30 fps limit.
+  capture_controller->SetPreviewFrameRateLimit(30, true);
+  sample_time_us = 2000000;
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(
+        capture_controller->ShouldProcessSample(sample_time_us, &draw_preview),
+        i % 2 == 0);
+    EXPECT_EQ(draw_preview, i % 2 == 0);
+    sample_time_us += 25000;
+  }
+
+  // The limit applies again once the display is faster than it.
+  capture_controller->SetDisplayRefreshRate(144);
+  sample_time_us = 3000000;
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(
+        capture_controller->ShouldProcessSample(sample_time_us, &draw_preview),
+        i % 4 != 2);
+    sample_time_us += 25000;
+  }
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, DedicatedCaptureThreadProcessesSamples) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  // Processors the process cannot use are rejected.
+  DWORD_PTR process_mask = 0;
+  DWORD_PTR system_mask = 0;
+  ASSERT_TRUE(
+      GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask));
+  if (~process_mask != 0) {
+    EXPECT_FALSE(capture_controller->SetCaptureThread(
+        true, static_cast<uint64_t>(~process_mask)));
+  }
+  EXPECT_TRUE(capture_controller->SetCaptureThread(
+      true, static_cast<uint64_t>(process_mask)));
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  // Let's keep these small for mock texture data. Two pixels should be
+  // enough.
+  uint32_t mock_preview_width = 2;
+  uint32_t mock_preview_height = 1;
+  uint32_t pixels_total = mock_preview_width * mock_preview_height;
+  uint32_t data_length = pixels_total * 4;
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(data_length);
+  for (uint32_t i = 0; i < data_length; i++) {
+    mock_source_buffer[i] = static_cast<uint8_t>(i + 1);
+  }
+
+  // The sample is drawn on the capture thread, which is expected to mark
+  // the texture frame available before it is stopped.
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), data_length,
+                   mock_preview_width, mock_preview_height, mock_texture_id);
+
+  // Processing inline again finishes the sample waiting for the thread.
+  EXPECT_TRUE(capture_controller->SetCaptureThread(false, 0));
+
+  PreviewStatsSnapshot stats;
+  EXPECT_TRUE(capture_controller->GetPreviewStats(&stats));
+  EXPECT_EQ(stats.frames_delivered, 1u);
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, QueuedSamplesKeepTheirPreviewPacing) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  uint32_t mock_preview_width = 2;
+  uint32_t mock_preview_height = 1;
+  uint32_t pixels_total = mock_preview_width * mock_preview_height;
+  uint32_t data_length = pixels_total * 4;
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(data_length);
+
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), data_length,
+                   mock_preview_width, mock_preview_height, mock_texture_id);
+
+  // Samples that are not drawn are still read for zero shutter lag photos.
+  capture_controller->SetPreviewFrameRateLimit(30, false);
+  EXPECT_TRUE(capture_controller->SetZeroShutterLag(true));
+
+  // Samples wait for a processing thread that is held up until both samples
+  // have been paced.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  auto thread = std::make_unique<FrameProcessingThread>(nullptr, nullptr);
+  FrameProcessingThread* processing_thread = thread.get();
+  processing_thread->PostTask([released]() { released.wait(); });
+  ComPtr<CaptureEngineListener> listener =
+      new CaptureEngineListener(capture_controller.get());
+  listener->SetProcessingThread(std::move(thread));
+  preview_sink->sample_callback_ = listener;
+
+  // Only the first of two samples of a 60 fps camera is drawn at 30 fps.
+  EXPECT_CALL(*texture_registrar, MarkTextureFrameAvailable(mock_texture_id))
+      .Times(1);
+  std::vector<uint8_t> first_sample(data_length, 0x10);
+  std::vector<uint8_t> second_sample(data_length, 0x20);
+  preview_sink->SendFakeSample(first_sample.data(), data_length, 0, 10000000);
+  // Keeps the second sample from replacing the first one in the queue.
+  processing_thread->PostTask([]() {});
+  preview_sink->SendFakeSample(second_sample.data(), data_length, 0,
+                               10166670);
+
+  // Processing inline again finishes the queued samples.
+  release.set_value();
+  listener->SetProcessingThread(nullptr);
+
+  auto pixel_buffer_texture =
+      std::get_if<flutter::PixelBufferTexture>(texture_registrar->texture_);
+  ASSERT_TRUE(pixel_buffer_texture);
+  auto converted_buffer =
+      pixel_buffer_texture->CopyPixelBuffer((size_t)100, (size_t)100);
+  ASSERT_TRUE(converted_buffer);
+  FlutterDesktopPixel* converted_buffer_data =
+      (FlutterDesktopPixel*)(converted_buffer->buffer);
+  for (uint32_t i = 0; i < pixels_total; i++) {
+    EXPECT_EQ(converted_buffer_data[i].r, 0x10);
+  }
+  converted_buffer->release_callback(converted_buffer->release_context);
+
+  PreviewStatsSnapshot stats;
+  EXPECT_TRUE(capture_controller->GetPreviewStats(&stats));
+  EXPECT_EQ(stats.frames_skipped, 1u);
+
+  listener = nullptr;
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, LowLatencyModeMeasuresCaptureLatency) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller in low-latency mode.
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id,
+                            true);
+
+  ASSERT_TRUE(engine->attributes_);
+  UINT32 low_latency = FALSE;
+  EXPECT_TRUE(SUCCEEDED(
+      engine->attributes_->GetUINT32(MF_LOW_LATENCY, &low_latency)));
+  EXPECT_TRUE(low_latency);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  uint32_t mock_preview_width = 2;
+  uint32_t mock_preview_height = 1;
+  uint32_t data_length = mock_preview_width * mock_preview_height * 4;
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(data_length);
+
+  // A synthetic sample captured by the camera 30 ms before it is delivered.
+  const UINT64 device_timestamp = MFGetSystemTime() - 300000;
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), data_length,
+                   mock_preview_width, mock_preview_height, mock_texture_id,
+                   MFVideoFormat_RGB32, device_timestamp);
+
+  // Flutter takes the frame for rendering.
+  auto pixel_buffer_texture =
+      std::get_if<flutter::PixelBufferTexture>(texture_registrar->texture_);
+  ASSERT_TRUE(pixel_buffer_texture);
+  auto converted_buffer =
+      pixel_buffer_texture->CopyPixelBuffer((size_t)100, (size_t)100);
+  ASSERT_TRUE(converted_buffer);
+  converted_buffer->release_callback(converted_buffer->release_context);
+
+  // The latency is counted from the device timestamp, with the accuracy of
+  // the preview statistics, rather than from the delivery of the sample.
+  PreviewStatsSnapshot stats;
+  EXPECT_TRUE(capture_controller->GetPreviewStats(&stats));
+  EXPECT_EQ(stats.frames_rendered, 1u);
+  EXPECT_GE(stats.capture_latency_p50_us, 30000u * 7 / 8);
+  EXPECT_LT(stats.capture_to_texture_p50_us, stats.capture_latency_p50_us);
+
+  capture_controller = nullptr;
+  texture_registrar = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+}
+
+TEST(CaptureController, PreviewCropConvertsOnlyVisibleRegion) {
+  ComPtr<MockCaptureEngine> engine = new MockCaptureEngine();
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  std::unique_ptr<MockTextureRegistrar> texture_registrar =
+      std::make_unique<MockTextureRegistrar>();
+
+  int64_t mock_texture_id = 1234;
+
+  // Initialize capture controller to be able to start preview
+  MockInitCaptureController(capture_controller.get(), texture_registrar.get(),
+                            engine.Get(), camera.get(), mock_texture_id);
+
+  // Invalid crops are rejected and leave the crop as it was.
+  EXPECT_FALSE(capture_controller->SetPreviewCrop({0.0, 0.0, 1.0, 1.0, 0.5}));
+  EXPECT_FALSE(capture_controller->SetPreviewCrop({0.75, 0.0, 0.5, 1.0, 1.0}));
+  // Zooming in further than the preview frames have rows for.
+  EXPECT_FALSE(
+      capture_controller->SetPreviewCrop({0.0, 0.0, 1.0, 1.0, 1000.0}));
+  EXPECT_EQ(capture_controller->GetPreviewCrop(), PreviewCrop());
+
+  // The left half of the mirrored preview is the right half of frames.
+  const PreviewCrop crop = {0.0, 0.0, 0.5, 1.0, 1.0};
+  EXPECT_TRUE(capture_controller->SetPreviewCrop(crop));
+  EXPECT_EQ(capture_controller->GetPreviewCrop(), crop);
+
+  ComPtr<MockCapturePreviewSink> preview_sink = new MockCapturePreviewSink();
+
+  // A 4x1 RGB32 frame with a different red value for each pixel.
+  uint32_t mock_preview_width = 4;
+  uint32_t mock_preview_height = 1;
+  uint32_t mock_texture_data_size = mock_preview_width * 4;
+  std::unique_ptr<uint8_t[]> mock_source_buffer =
+      std::make_unique<uint8_t[]>(mock_texture_data_size);
+  MFVideoFormatRGB32Pixel* mock_source_buffer_data =
+      (MFVideoFormatRGB32Pixel*)mock_source_buffer.get();
+  for (uint32_t i = 0; i < mock_preview_width; i++) {
+    mock_source_buffer_data[i].r = static_cast<uint8_t>(0x10 * (i + 1));
+  }
+
+  // Start preview and run preview tests
+  MockStartPreview(capture_controller.get(), preview_sink.Get(),
+                   texture_registrar.get(), engine.Get(), camera.get(),
+                   std::move(mock_source_buffer), mock_texture_data_size,
+                   mock_preview_width, mock_preview_height, mock_texture_id);
+
+  EXPECT_TRUE(texture_registrar->texture_);
+  if (texture_registrar->texture_) {
+    auto pixel_buffer_texture =
+        std::get_if<flutter::PixelBufferTexture>(texture_registrar->texture_);
+    EXPECT_TRUE(pixel_buffer_texture);
+
+    if (pixel_buffer_texture) {
+      auto converted_buffer =
+          pixel_buffer_texture->CopyPixelBuffer((size_t)100, (size_t)100);
+
+      EXPECT_TRUE(converted_buffer);
+      if (converted_buffer) {
+        EXPECT_EQ(converted_buffer->width, 2u);
+        EXPECT_EQ(converted_buffer->height, 1u);
+
+        FlutterDesktopPixel* converted_buffer_data =
+            (FlutterDesktopPixel*)(converted_buffer->buffer);
+        EXPECT_EQ(converted_buffer_data[0].r, 0x40);
+        EXPECT_EQ(converted_buffer_data[1].r, 0x30);
+
+        // Call release callback to get mutex lock unlocked.
+        converted_buffer->release_callback(converted_buffer->release_context);
+      }
+      converted_buffer = nullptr;
+    }
+    pixel_buffer_texture = nullptr;
+  }
+
+  capture_controller = nullptr;
+  engine = nullptr;
+  camera = nullptr;
+  texture_registrar = nullptr;
+}
+
+TEST(CaptureController, CancelsPlatformTasksWhenDestroyed) {
+  std::unique_ptr<MockCamera> camera =
+      std::make_unique<MockCamera>(MOCK_DEVICE_ID);
+  std::unique_ptr<CaptureControllerImpl> capture_controller =
+      std::make_unique<CaptureControllerImpl>(camera.get());
+  MockPlatformTaskRunner platform_task_runner;
+  capture_controller->SetPlatformTaskRunner(&platform_task_runner);
+
+  // Photo results posted by the worker threads must not run once the
+  // controller is gone.
+  EXPECT_CALL(platform_task_runner, CancelTasks(capture_controller.get()))
+      .Times(1);
+  capture_controller = nullptr;
   camera = nullptr;
 }
 
@@ -0,0 +1,213 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "mjpeg_decoder.h"
+
+#include <benchmark/benchmark.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace camera_windows {
+namespace test {
+
+namespace {
+
+using Microsoft::WRL::ComPtr;
+
+// Directory of recorded MJPEG frames, one JPEG image per file, used by
+// BM_DecodeRecordedMjpegFrames.
+constexpr char kRecordedFramesVariable[] = "CAMERA_WINDOWS_MJPEG_FRAMES";
+
+// Initializes COM for the benchmark thread, like Media Foundation does for
+// the threads delivering samples.
+class ScopedComInitializer {
+ public:
+  ScopedComInitializer()
+      : hr_(CoInitializeEx(nullptr, COINIT_MULTITHREADED)) {}
+  ~ScopedComInitializer() {
+    if (SUCCEEDED(hr_)) {
+      CoUninitialize();
+    }
+  }
+
+ private:
+  HRESULT hr_;
+};
+
+// Encodes a |width| x |height| image with detail in every block, which keeps
+// the entropy decoder about as busy as a camera image.
+std::vector<uint8_t> EncodeSyntheticFrame(uint32_t width, uint32_t height) {
+  ComPtr<IWICImagingFactory> factory;
+  if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr,
+                              CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory)))) {
+    return {};
+  }
+
+  const UINT stride = width * 4;
+  std::vector<uint8_t> pixels(static_cast<size_t>(stride) * height);
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      uint8_t* pixel = pixels.data() + y * stride + x * 4;
+      pixel[0] = static_cast<uint8_t>(x + y * 3);
+      pixel[1] = static_cast<uint8_t>((x * y) >> 5);
+      pixel[2] = static_cast<uint8_t>(x * 7 ^ y * 13);
+      pixel[3] = 255;
+    }
+  }
+
+  ComPtr<IWICBitmap> bitmap;
+  ComPtr<IStream> stream;
+  ComPtr<IWICBitmapEncoder> encoder;
+  ComPtr<IWICBitmapFrameEncode> frame;
+  WICPixelFormatGUID pixel_format = GUID_WICPixelFormat32bppBGR;
+  if (FAILED(factory->CreateBitmapFromMemory(
+          width, height, GUID_WICPixelFormat32bppBGR, stride,
+          static_cast<UINT>(pixels.size()), pixels.data(), &bitmap)) ||
+      FAILED(CreateStreamOnHGlobal(nullptr, TRUE, &stream)) ||
+      FAILED(factory->CreateEncoder(GUID_ContainerFormatJpeg, nullptr,
+                                    &encoder)) ||
+      FAILED(encoder->Initialize(stream.Get(), WICBitmapEncoderNoCache)) ||
+      FAILED(encoder->CreateNewFrame(&frame, nullptr)) ||
+      FAILED(frame->Initialize(nullptr)) ||
+      FAILED(frame->SetSize(width, height)) ||
+      FAILED(frame->SetPixelFormat(&pixel_format)) ||
+      FAILED(frame->WriteSource(bitmap.Get(), nullptr)) ||
+      FAILED(frame->Commit()) || FAILED(encoder->Commit())) {
+    return {};
+  }
+
+  STATSTG stat = {};
+  if (FAILED(stream->Stat(&stat, STATFLAG_NONAME))) {
+    return {};
+  }
+  std::vector<uint8_t> jpeg(static_cast<size_t>(stat.cbSize.QuadPart));
+  LARGE_INTEGER start = {};
+  ULONG read = 0;
+  if (FAILED(stream->Seek(start, STREAM_SEEK_SET, nullptr)) ||
+      FAILED(stream->Read(jpeg.data(), static_cast<ULONG>(jpeg.size()),
+                          &read)) ||
+      read != jpeg.size()) {
+    return {};
+  }
+  return jpeg;
+}
+
+// Reads all files of the directory named by |kRecordedFramesVariable|.
+std::vector<std::vector<uint8_t>> ReadRecordedFrames() {
+  std::vector<std::vector<uint8_t>> frames;
+  const char* directory = std::getenv(kRecordedFramesVariable);
+  if (!directory) {
+    return frames;
+  }
+
+  std::error_code error;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(directory, error)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    std::ifstream file(entry.path(), std::ios::binary);
+    frames.emplace_back(std::istreambuf_iterator<char>(file),
+                        std::istreambuf_iterator<char>());
+  }
+  return frames;
+}
+
+// Decodes the given frames in turn, with a target size of 1 / state.range(0)
+// of the frame size.
+void DecodeFrames(benchmark::State& state,
+                  const std::vector<std::vector<uint8_t>>& frames,
+                  uint32_t frame_width, uint32_t frame_height) {
+  const uint32_t scale = static_cast<uint32_t>(state.range(0));
+  MjpegDecoder decoder;
+  std::vector<uint8_t> decoded;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  size_t frame_index = 0;
+  int64_t decoded_bytes = 0;
+
+  for (auto _ : state) {
+    const std::vector<uint8_t>& frame = frames[frame_index];
+    frame_index = (frame_index + 1) % frames.size();
+    if (FAILED(decoder.Decode(frame.data(), static_cast<uint32_t>(frame.size()),
+                              frame_width / scale, frame_height / scale, true,
+                              &decoded, &width, &height))) {
+      state.SkipWithError("Failed to decode frame");
+      return;
+    }
+    benchmark::DoNotOptimize(decoded.data());
+    decoded_bytes += static_cast<int64_t>(decoded.size());
+  }
+
+  state.SetBytesProcessed(decoded_bytes);
+  state.SetItemsProcessed(state.iterations());
+  state.counters["decoded_width"] = width;
+  state.counters["decoded_height"] = height;
+}
+
+// Decodes a synthetic frame of state.range(1) x state.range(2) pixels.
+void BM_DecodeSyntheticMjpegFrame(benchmark::State& state) {
+  ScopedComInitializer com_initializer;
+  const uint32_t width = static_cast<uint32_t>(state.range(1));
+  const uint32_t height = static_cast<uint32_t>(state.range(2));
+  const std::vector<std::vector<uint8_t>> frames = {
+      EncodeSyntheticFrame(width, height)};
+  if (frames[0].empty()) {
+    state.SkipWithError("Failed to encode frame");
+    return;
+  }
+  DecodeFrames(state, frames, width, height);
+}
+
+// Decodes the recorded frames, which must all have the same size.
+void BM_DecodeRecordedMjpegFrames(benchmark::State& state) {
+  ScopedComInitializer com_initializer;
+  const std::vector<std::vector<uint8_t>> frames = ReadRecordedFrames();
+  if (frames.empty()) {
+    state.SkipWithError("No recorded frames; set CAMERA_WINDOWS_MJPEG_FRAMES");
+    return;
+  }
+
+  // Reads the frame size by decoding the first frame at full size.
+  MjpegDecoder decoder;
+  std::vector<uint8_t> decoded;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  if (FAILED(decoder.Decode(frames[0].data(),
+                            static_cast<uint32_t>(frames[0].size()), 0, 0,
+                            false, &decoded, &width, &height))) {
+    state.SkipWithError("Failed to decode frame");
+    return;
+  }
+  DecodeFrames(state, frames, width, height);
+}
+
+// Full size, and every scale of the inverse DCT, for 1080p and 4K UHD frames.
+void SyntheticFrameSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"scale", "width", "height"});
+  for (int scale : {1, 2, 4, 8}) {
+    benchmark->Args({scale, 1920, 1080});
+    benchmark->Args({scale, 3840, 2160});
+  }
+}
+
+BENCHMARK(BM_DecodeSyntheticMjpegFrame)->Apply(SyntheticFrameSizes);
+BENCHMARK(BM_DecodeRecordedMjpegFrames)
+    ->ArgName("scale")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8);
+
+}  // namespace
+
+}  // namespace test
+}  // namespace camera_windows
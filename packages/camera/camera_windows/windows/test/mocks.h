@@ -180,8 +180,16 @@ class MockCamera : public Camera {
 
   MOCK_METHOD(void, OnTakePictureSucceeded, (const std::string& file_path),
               (override));
+  MOCK_METHOD(void, OnTakePictureToMemorySucceeded,
+              (const std::vector<uint8_t>& image), (override));
   MOCK_METHOD(void, OnTakePictureFailed,
               (CameraResult result, const std::string& error), (override));
+  MOCK_METHOD(void, OnBurstPictureTaken,
+              (uint32_t index, const std::string& file_path), (override));
+  MOCK_METHOD(void, OnBurstPictureFailed,
+              (uint32_t index, CameraResult result, const std::string& error),
+              (override));
+  MOCK_METHOD(void, OnBurstCompleted, (), (override));
 
   MOCK_METHOD(void, OnVideoRecordSucceeded,
               (const std::string& file_path, int64_t video_duration),
@@ -206,7 +214,10 @@ class MockCamera : public Camera {
   MOCK_METHOD(bool, InitCamera,
               (flutter::TextureRegistrar * texture_registrar,
                flutter::BinaryMessenger* messenger, bool record_audio,
-               ResolutionPreset resolution_preset),
+               ResolutionPreset resolution_preset,
+               const std::optional<MediaTypePreferences>&
+                   media_type_preferences,
+               bool low_latency),
               (override));
 
   std::unique_ptr<CaptureController> capture_controller_;
@@ -229,6 +240,15 @@ class MockCaptureControllerFactory : public CaptureControllerFactory {
               (CaptureControllerListener * listener), (override));
 };
 
+class MockPlatformTaskRunner : public PlatformTaskRunner {
+ public:
+  MockPlatformTaskRunner() = default;
+  virtual ~MockPlatformTaskRunner() = default;
+
+  MOCK_METHOD(void, PostTask, (const void* owner, Task task), (override));
+  MOCK_METHOD(void, CancelTasks, (const void* owner), (override));
+};
+
 class MockCaptureController : public CaptureController {
  public:
   ~MockCaptureController() = default;
@@ -236,7 +256,10 @@ class MockCaptureController : public CaptureController {
   MOCK_METHOD(bool, InitCaptureDevice,
               (flutter::TextureRegistrar * texture_registrar,
                const std::string& device_id, bool record_audio,
-               ResolutionPreset resolution_preset),
+               ResolutionPreset resolution_preset,
+               const std::optional<MediaTypePreferences>&
+                   media_type_preferences,
+               bool low_latency),
               (override));
 
   MOCK_METHOD(uint32_t, GetPreviewWidth, (), (const override));
@@ -251,6 +274,30 @@ class MockCaptureController : public CaptureController {
               (override));
   MOCK_METHOD(void, StopRecord, (), (override));
   MOCK_METHOD(void, TakePicture, (const std::string& file_path), (override));
+  MOCK_METHOD(void, TakePictureToMemory, (const JpegEncodeOptions& options),
+              (override));
+  MOCK_METHOD(bool, GetPreviewStats, (PreviewStatsSnapshot * stats),
+              (const override));
+  MOCK_METHOD(bool, StartImageStream,
+              (std::unique_ptr<ImageStreamHandler> image_stream_handler),
+              (override));
+  MOCK_METHOD(void, StopImageStream, (), (override));
+  MOCK_METHOD(bool, SetZeroShutterLag, (bool enabled), (override));
+  MOCK_METHOD(bool, StartBurst,
+              (uint32_t count, int64_t interval_ms,
+               const std::string& file_path_prefix),
+              (override));
+  MOCK_METHOD(void, StopBurst, (), (override));
+  MOCK_METHOD(void, SetPreviewFrameRateLimit,
+              (double max_frame_rate, bool match_display_refresh_rate),
+              (override));
+  MOCK_METHOD(void, SetDisplayRefreshRate, (double refresh_rate), (override));
+  MOCK_METHOD(bool, SetCaptureThread,
+              (bool dedicated, uint64_t cpu_affinity_mask), (override));
+  MOCK_METHOD(bool, SetPreviewCrop, (const PreviewCrop& crop), (override));
+  MOCK_METHOD(PreviewCrop, GetPreviewCrop, (), (const override));
+  MOCK_METHOD(void, SetPlatformTaskRunner, (PlatformTaskRunner * runner),
+              (override));
 };
 
 // MockCameraPlugin extends CameraPlugin behaviour a bit to allow adding cameras
@@ -283,6 +330,12 @@ class MockCameraPlugin : public CameraPlugin {
   void AddCamera(std::unique_ptr<Camera> camera) {
     cameras_.push_back(std::move(camera));
   }
+
+  // Helper to cache the device list as if device notifications were
+  // received, for testing purposes.
+  void SetDeviceNotificationsActive(bool active) {
+    device_notifications_active_ = active;
+  }
 };
 
 class MockCaptureSource : public IMFCaptureSource {
@@ -516,7 +569,12 @@ class MockCapturePreviewSink : public IMFCapturePreviewSink {
     return E_NOINTERFACE;
   }
 
-  void SendFakeSample(uint8_t* src_buffer, uint32_t size) {
+  // Sends a sample with the given data. A non-zero |device_timestamp|, in
+  // the 100-nanosecond units of MFGetSystemTime, is set as the time the
+  // sample was captured. |sample_time| is the presentation time of the
+  // sample, also in 100-nanosecond units.
+  void SendFakeSample(uint8_t* src_buffer, uint32_t size,
+                      UINT64 device_timestamp = 0, LONGLONG sample_time = 0) {
     assert(sample_callback_);
     ComPtr<IMFSample> sample;
     ComPtr<IMFMediaBuffer> buffer;
@@ -542,6 +600,15 @@ class MockCapturePreviewSink : public IMFCapturePreviewSink {
       hr = sample->AddBuffer(buffer.Get());
     }
 
+    if (SUCCEEDED(hr)) {
+      hr = sample->SetSampleTime(sample_time);
+    }
+
+    if (SUCCEEDED(hr) && device_timestamp != 0) {
+      hr = sample->SetUINT64(MFSampleExtension_DeviceTimestamp,
+                             device_timestamp);
+    }
+
     if (SUCCEEDED(hr)) {
       sample_callback_->OnSample(sample.Get());
     }
@@ -961,6 +1028,7 @@ class MockCaptureEngine : public IMFCaptureEngine {
           EXPECT_TRUE(videoSource);
           // audioSource is allowed to be nullptr;
           callback_ = callback;
+          attributes_ = attributes;
           videoSource_ = reinterpret_cast<IMFMediaSource*>(videoSource);
           audioSource_ = reinterpret_cast<IMFMediaSource*>(audioSource);
           initialized_ = true;
@@ -1019,6 +1087,7 @@ class MockCaptureEngine : public IMFCaptureEngine {
   }
 
   ComPtr<IMFCaptureEngineOnEventCallback> callback_;
+  ComPtr<IMFAttributes> attributes_;
   ComPtr<IMFMediaSource> videoSource_;
   ComPtr<IMFMediaSource> audioSource_;
   volatile ULONG ref_ = 0;
@@ -4,13 +4,43 @@
 
 #include "texture_handler.h"
 
+#include <algorithm>
 #include <cassert>
+#include <thread>
+#include <utility>
+
+#include "frame_conversion.h"
+#include "strip_pool.h"
 
 namespace camera_windows {
 
+namespace {
+
+// Most helper threads converting preview frames, on top of the capture
+// threads of the cameras.
+constexpr size_t kMaxConversionHelpers = 3;
+
+// Returns the pool converting preview frames in strips.
+//
+// The pool is shared by all cameras, so the number of threads converting
+// frames stays the same however many cameras are open. Half of the cores
+// are left to the capture engines and to Flutter. The pool is never
+// destroyed (see |CameraPlugin|), as its helper threads cannot be joined
+// while the module is unloaded.
+StripPool* GetConversionPool() {
+  static StripPool* pool = new StripPool(std::min<size_t>(
+      std::max(std::thread::hardware_concurrency() / 2, 1u) - 1,
+      kMaxConversionHelpers));
+  return pool;
+}
+
+}  // namespace
+
 TextureHandler::~TextureHandler() {
   // Texture might still be processed while destructor is called.
-  // Lock mutex for safe destruction
+  // Lock mutexes for safe destruction, waiting for the frame being converted
+  // and for the pixel buffer handed to Flutter.
+  const std::lock_guard<std::mutex> producer_lock(producer_mutex_);
   const std::lock_guard<std::mutex> lock(buffer_mutex_);
   if (texture_registrar_ && texture_id_ > 0) {
     texture_registrar_->UnregisterTexture(texture_id_);
@@ -37,23 +67,135 @@ int64_t TextureHandler::RegisterTexture() {
   return texture_id_;
 }
 
-bool TextureHandler::UpdateBuffer(uint8_t* data, uint32_t data_length) {
-  // Scoped lock guard.
-  {
-    const std::lock_guard<std::mutex> lock(buffer_mutex_);
-    if (!TextureRegistered()) {
+bool TextureHandler::UpdateBuffer(
+    const FrameBufferView& source, uint64_t sample_time_us,
+    PreviewStats::Clock::time_point capture_time) {
+  const std::lock_guard<std::mutex> lock(producer_mutex_);
+  if (!TextureRegistered()) {
+    return false;
+  }
+
+  const PreviewStats::Clock::time_point delivery_time =
+      PreviewStats::Clock::now();
+  preview_stats_.OnFrameDelivered(sample_time_us, delivery_time);
+
+  // Returns the frame in the write slot to the pool before converting into
+  // a new one, so that its buffer is reused.
+  TextureFrame& slot = frame_mailbox_.GetWriteSlot();
+  slot.frame.reset();
+
+  FrameRef frame;
+  const bool updated = frame_format_.pixel_format == PixelFormat::kMJPG
+                           ? DecodeMjpegFrame(source, &frame)
+                           : ConvertFrame(source, &frame);
+  if (!updated) {
+    preview_stats_.OnFrameFailed();
+    return false;
+  }
+  frame.GetMutable()->sample_time_us = sample_time_us;
+  slot.frame = std::move(frame);
+  slot.delivery_time = delivery_time;
+  slot.capture_time = capture_time;
+  preview_stats_.OnFrameConverted(PreviewStats::Clock::now() - delivery_time);
+  frame_mailbox_.Publish();
+
+  OnBufferUpdated();
+  return true;
+}
+
+void TextureHandler::SetPreviewCrop(const PreviewCrop& crop) {
+  assert(IsValidPreviewCrop(crop));
+  const std::lock_guard<std::mutex> lock(preview_crop_mutex_);
+  preview_crop_ = crop;
+}
+
+PreviewCrop TextureHandler::GetPreviewCrop() const {
+  const std::lock_guard<std::mutex> lock(preview_crop_mutex_);
+  return preview_crop_;
+}
+
+bool TextureHandler::ConvertFrame(const FrameBufferView& source,
+                                  FrameRef* frame) {
+  const uint32_t width = preview_frame_width_;
+  const uint32_t height = preview_frame_height_;
+
+  // Converts the frame to RGBA in a single pass, straight from the locked
+  // media buffer into a pooled frame. Padded and bottom-up frames are
+  // read in place, and YUV frames are converted without an intermediate RGB32
+  // copy. Mirroring is done in software: IMFCapturePreviewSink also
+  // has the SetMirrorState setting, but if enabled, samples will not be
+  // processed.
+  //
+  // If the texture is much smaller than the frame, the frame is scaled down
+  // in the same pass, so that Flutter uploads and scales fewer pixels.
+  // Otherwise large frames are converted in strips on several threads.
+  //
+  // With a crop or digital zoom, only the visible region of the frame is
+  // read, and it is scaled down in the same pass. Regions smaller than the
+  // texture are scaled up by Flutter.
+  FrameRegion region = {0, 0, width, height};
+  const bool cropped = GetPreviewCropRegion(width, height, GetPreviewCrop(),
+                                            mirror_preview_, &region);
+  uint32_t scaled_width = 0;
+  uint32_t scaled_height = 0;
+  const bool scaled = GetScaledFrameSize(
+      region.width, region.height, target_width_.load(), target_height_.load(),
+      &scaled_width, &scaled_height);
+  if (!scaled) {
+    scaled_width = region.width;
+    scaled_height = region.height;
+  }
+
+  FrameRef rgba = frame_pool_.Acquire(static_cast<size_t>(scaled_width) *
+                                      scaled_height * bytes_per_pixel_);
+  if (!rgba) {
+    return false;
+  }
+  PooledFrame* output = rgba.GetMutable();
+  if (scaled && !frame_scaler_) {
+    frame_scaler_ = std::make_unique<FrameScaler>();
+  }
+  if (cropped) {
+    if (!ConvertFrameRegionToRGBA(frame_format_, source, width, height,
+                                  region, output->GetData(), scaled_width,
+                                  scaled_height, mirror_preview_,
+                                  frame_scaler_.get(), GetConversionPool())) {
       return false;
     }
-
-    if (source_buffer_.size() != data_length) {
-      // Update source buffer size.
-      source_buffer_.resize(data_length);
+  } else if (scaled) {
+    if (!ScaleFrameToRGBA(frame_format_, source, width, height,
+                          output->GetData(), scaled_width, scaled_height,
+                          mirror_preview_, frame_scaler_.get())) {
+      return false;
     }
-    std::copy(data, data + data_length, source_buffer_.data());
+  } else if (!ConvertFrameToRGBA(frame_format_, source, output->GetData(),
+                                 width, height, mirror_preview_,
+                                 GetConversionPool())) {
+    return false;
   }
-  OnBufferUpdated();
+  output->width = scaled_width;
+  output->height = scaled_height;
+  output->stride = static_cast<int32_t>(scaled_width * bytes_per_pixel_);
+  output->mirrored = mirror_preview_;
+  *frame = std::move(rgba);
   return true;
-};
+}
+
+bool TextureHandler::DecodeMjpegFrame(const FrameBufferView& source,
+                                      FrameRef* frame) {
+  if (!mjpeg_decoder_) {
+    mjpeg_decoder_ = std::make_unique<MjpegDecoder>();
+  }
+
+  // Compressed frames are not made of rows, so the whole locked buffer is
+  // handed to the decoder. The decoded size may be smaller than the preview
+  // size; Flutter scales the texture to the size of the widget.
+  HRESULT hr = mjpeg_decoder_->Decode(
+      source.buffer_start, source.buffer_length, target_width_.load(),
+      target_height_.load(), mirror_preview_, GetPreviewCrop(), &frame_pool_,
+      frame);
+  return SUCCEEDED(hr);
+}
 
 // Marks texture frame available after buffer is updated.
 void TextureHandler::OnBufferUpdated() {
@@ -64,14 +206,10 @@ void TextureHandler::OnBufferUpdated() {
 
 const FlutterDesktopPixelBuffer* TextureHandler::ConvertPixelBufferForFlutter(
     size_t target_width, size_t target_height) {
-  // TODO: optimize image processing size by adjusting capture size
-  // dynamically to match target_width and target_height.
-  // If target size changes, create new media type for preview and set new
-  // target framesize to MF_MT_FRAME_SIZE attribute.
-  // Size should be kept inside requested resolution preset.
-  // Update output media type with IMFCaptureSink2::SetOutputMediaType method
-  // call and implement IMFCaptureEngineOnSampleCallback2::OnSynchronizedEvent
-  // to detect size changes.
+  // Lets the capture thread convert and decode frames, and the capture
+  // controller pick preview frame sizes, closer to the texture size.
+  target_width_ = static_cast<uint32_t>(target_width);
+  target_height_ = static_cast<uint32_t>(target_height);
 
   // Lock buffer mutex to protect texture processing
   std::unique_lock<std::mutex> buffer_lock(buffer_mutex_);
@@ -79,42 +217,14 @@ const FlutterDesktopPixelBuffer* TextureHandler::ConvertPixelBufferForFlutter(
     return nullptr;
   }
 
-  const uint32_t bytes_per_pixel = 4;
-  const uint32_t pixels_total = preview_frame_width_ * preview_frame_height_;
-  const uint32_t data_size = pixels_total * bytes_per_pixel;
-  if (data_size > 0 && source_buffer_.size() == data_size) {
-    if (dest_buffer_.size() != data_size) {
-      dest_buffer_.resize(data_size);
-    }
-
-    // Map buffers to structs for easier conversion.
-    MFVideoFormatRGB32Pixel* src =
-        reinterpret_cast<MFVideoFormatRGB32Pixel*>(source_buffer_.data());
-    FlutterDesktopPixel* dst =
-        reinterpret_cast<FlutterDesktopPixel*>(dest_buffer_.data());
-
-    for (uint32_t y = 0; y < preview_frame_height_; y++) {
-      for (uint32_t x = 0; x < preview_frame_width_; x++) {
-        uint32_t sp = (y * preview_frame_width_) + x;
-        if (mirror_preview_) {
-          // Software mirror mode.
-          // IMFCapturePreviewSink also has the SetMirrorState setting,
-          // but if enabled, samples will not be processed.
-
-          // Calculates mirrored pixel position.
-          uint32_t tp =
-              (y * preview_frame_width_) + ((preview_frame_width_ - 1) - x);
-          dst[tp].r = src[sp].r;
-          dst[tp].g = src[sp].g;
-          dst[tp].b = src[sp].b;
-          dst[tp].a = 255;
-        } else {
-          dst[sp].r = src[sp].r;
-          dst[sp].g = src[sp].g;
-          dst[sp].b = src[sp].b;
-          dst[sp].a = 255;
-        }
-      }
+  // Without a new frame, the previously taken frame is handed out again.
+  const PreviewStats::Clock::time_point now = PreviewStats::Clock::now();
+  const bool new_frame = frame_mailbox_.TakeNewest();
+  const TextureFrame& frame = frame_mailbox_.GetReadSlot();
+  if (frame.frame) {
+    if (new_frame) {
+      preview_stats_.OnFrameRendered(now - frame.delivery_time,
+                                     now - frame.capture_time);
     }
 
     if (!flutter_desktop_pixel_buffer_) {
@@ -124,21 +234,29 @@ const FlutterDesktopPixelBuffer* TextureHandler::ConvertPixelBufferForFlutter(
       // Unlocks mutex after texture is processed.
       flutter_desktop_pixel_buffer_->release_callback =
           [](void* release_context) {
-            auto mutex = reinterpret_cast<std::mutex*>(release_context);
-            mutex->unlock();
+            auto handler = reinterpret_cast<TextureHandler*>(release_context);
+            handler->OnPixelBufferReleased();
           };
     }
 
-    flutter_desktop_pixel_buffer_->buffer = dest_buffer_.data();
-    flutter_desktop_pixel_buffer_->width = preview_frame_width_;
-    flutter_desktop_pixel_buffer_->height = preview_frame_height_;
+    flutter_desktop_pixel_buffer_->buffer = frame.frame->GetData();
+    flutter_desktop_pixel_buffer_->width = frame.frame->width;
+    flutter_desktop_pixel_buffer_->height = frame.frame->height;
 
-    // Releases unique_lock and set mutex pointer for release context.
-    flutter_desktop_pixel_buffer_->release_context = buffer_lock.release();
+    // Keeps the mutex locked until Flutter releases the pixel buffer.
+    pixel_buffer_taken_time_ = now;
+    buffer_lock.release();
+    flutter_desktop_pixel_buffer_->release_context = this;
 
     return flutter_desktop_pixel_buffer_.get();
   }
   return nullptr;
 }
 
+void TextureHandler::OnPixelBufferReleased() {
+  preview_stats_.OnFrameReleased(PreviewStats::Clock::now() -
+                                 pixel_buffer_taken_time_);
+  buffer_mutex_.unlock();
+}
+
 }  // namespace camera_windows
@@ -7,9 +7,19 @@
 
 #include <flutter/texture_registrar.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
+
+#include "frame_buffer_view.h"
+#include "frame_conversion.h"
+#include "frame_mailbox.h"
+#include "frame_pool.h"
+#include "mjpeg_decoder.h"
+#include "preview_crop.h"
+#include "preview_stats.h"
 
 namespace camera_windows {
 
@@ -41,8 +51,27 @@ class TextureHandler {
   TextureHandler(TextureHandler const&) = delete;
   TextureHandler& operator=(TextureHandler const&) = delete;
 
-  // Updates source data buffer with given data.
-  bool UpdateBuffer(uint8_t* data, uint32_t data_length);
+  // Converts given frame into a texture buffer and publishes it as the newest
+  // preview frame.
+  //
+  // Called from the capture thread, with |source| pointing to the locked
+  // media buffer, |sample_time_us| set to the presentation time of the
+  // sample and |capture_time| to when the camera captured it. Never blocks
+  // on the texture callback; if the previous frame was not yet taken for
+  // rendering, it is replaced and counted as dropped.
+  bool UpdateBuffer(const FrameBufferView& source, uint64_t sample_time_us,
+                    PreviewStats::Clock::time_point capture_time);
+
+  // Returns the number of preview frames that were replaced before Flutter
+  // requested them.
+  uint64_t GetDroppedFrameCount() const {
+    return frame_mailbox_.GetDroppedFrameCount();
+  }
+
+  // Returns the frame counters and timings of the preview.
+  PreviewStatsSnapshot GetPreviewStats() const {
+    return preview_stats_.GetSnapshot(GetDroppedFrameCount());
+  }
 
   // Registers texture and updates given texture_id pointer value.
   int64_t RegisterTexture();
@@ -53,17 +82,61 @@ class TextureHandler {
     preview_frame_height_ = height;
   }
 
+  // Updates the format of frames passed to |UpdateBuffer|.
+  void UpdateFrameFormat(const FrameFormat& frame_format) {
+    frame_format_ = frame_format;
+  }
+
   // Sets software mirror state.
   void SetMirrorPreviewState(bool mirror) { mirror_preview_ = mirror; }
 
+  // Sets the part of frames shown in the texture, which must be valid. The
+  // next frame is converted with it. May be called from any thread.
+  void SetPreviewCrop(const PreviewCrop& crop);
+
+  // Returns the part of frames shown in the texture. May be called from any
+  // thread.
+  PreviewCrop GetPreviewCrop() const;
+
+  // Returns the texture width last requested by Flutter, or 0 if the texture
+  // has not been requested yet.
+  uint32_t GetTargetWidth() const { return target_width_; }
+
+  // Returns the texture height last requested by Flutter, or 0 if the
+  // texture has not been requested yet.
+  uint32_t GetTargetHeight() const { return target_height_; }
+
  private:
+  // Frames in the pool, one for each mailbox slot.
+  static constexpr size_t kFramePoolSize = 3;
+
+  // A converted frame on its way to Flutter.
+  struct TextureFrame {
+    // RGBA pixels.
+    FrameRef frame;
+    // When the sample of the frame reached the texture handler.
+    PreviewStats::Clock::time_point delivery_time;
+    // When the camera captured the sample of the frame.
+    PreviewStats::Clock::time_point capture_time;
+  };
+
   // Informs flutter texture registrar of updated texture.
   void OnBufferUpdated();
 
-  // Converts local pixel buffer to flutter pixel buffer.
+  // Converts an uncompressed frame into a pooled frame.
+  bool ConvertFrame(const FrameBufferView& source, FrameRef* frame);
+
+  // Decodes an MJPEG frame into a pooled frame, scaled down towards the size
+  // last requested by Flutter.
+  bool DecodeMjpegFrame(const FrameBufferView& source, FrameRef* frame);
+
+  // Returns the newest converted frame as flutter pixel buffer.
   const FlutterDesktopPixelBuffer* ConvertPixelBufferForFlutter(size_t width,
                                                                 size_t height);
 
+  // Called by Flutter when it is done with the pixel buffer.
+  void OnPixelBufferReleased();
+
   // Checks if texture registrar, texture id and texture are available.
   bool TextureRegistered() {
     return texture_registrar_ && texture_ && texture_id_ > -1;
@@ -72,18 +145,55 @@ class TextureHandler {
   bool mirror_preview_ = true;
   int64_t texture_id_ = -1;
   uint32_t bytes_per_pixel_ = 4;
-  uint32_t source_buffer_size_ = 0;
   uint32_t preview_frame_width_ = 0;
   uint32_t preview_frame_height_ = 0;
-
-  std::vector<uint8_t> source_buffer_;
-  std::vector<uint8_t> dest_buffer_;
+  FrameFormat frame_format_;
+
+  // Written by the platform thread and read for each frame by the capture
+  // thread.
+  mutable std::mutex preview_crop_mutex_;
+  PreviewCrop preview_crop_;
+
+  // Size of the texture as last requested by Flutter. Written by the texture
+  // callback and read by the capture thread.
+  std::atomic<uint32_t> target_width_ = 0;
+  std::atomic<uint32_t> target_height_ = 0;
+
+  // Created with the first MJPEG frame. Only used by the capture thread.
+  std::unique_ptr<MjpegDecoder> mjpeg_decoder_;
+
+  // Created with the first frame that is scaled down. Only used by the
+  // capture thread.
+  std::unique_ptr<FrameScaler> frame_scaler_;
+
+  // Buffers of converted frames. In fixed-size mode, so that the preview
+  // does not allocate once frames have reached their largest size.
+  FramePool frame_pool_{kFramePoolSize, 0};
+
+  // Hands converted frames from the capture thread to the raster thread. A
+  // frame is only returned to the pool once its slot has been reused, so
+  // the frame handed to Flutter is never written to while it is being
+  // uploaded.
+  FrameMailbox<TextureFrame> frame_mailbox_;
   std::unique_ptr<flutter::TextureVariant> texture_;
   std::unique_ptr<FlutterDesktopPixelBuffer> flutter_desktop_pixel_buffer_ =
       nullptr;
   flutter::TextureRegistrar* texture_registrar_ = nullptr;
 
+  // Held from the texture callback until Flutter releases the pixel buffer.
+  // Never taken by the capture thread.
   std::mutex buffer_mutex_;
+
+  // Held by the capture thread while it converts a frame and marks it
+  // available, so that the destructor waits for it. Never taken by the
+  // texture callback.
+  std::mutex producer_mutex_;
+
+  // When the pixel buffer was last handed to Flutter. Guarded by
+  // |buffer_mutex_|.
+  PreviewStats::Clock::time_point pixel_buffer_taken_time_;
+
+  PreviewStats preview_stats_;
 };
 
 }  // namespace camera_windows
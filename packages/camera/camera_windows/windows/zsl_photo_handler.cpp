@@ -0,0 +1,64 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "zsl_photo_handler.h"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "file_utils.h"
+
+namespace camera_windows {
+
+ZslPhotoHandler::ZslPhotoHandler() : ring_(kFrameCount), worker_(1) {}
+
+void ZslPhotoHandler::OnFrame(const FrameBufferView& source,
+                              uint64_t sample_time_us) {
+  ring_.AddFrame(frame_format_, source, frame_width_, frame_height_,
+                 sample_time_us, ZslRing::Clock::now());
+}
+
+bool ZslPhotoHandler::TakePhoto(const std::string& file_path,
+                                PhotoCallback callback) {
+  assert(callback);
+  return EncodeClosestFrame(
+      JpegEncodeOptions(),
+      [file_path, callback = std::move(callback)](HRESULT hr,
+                                                  std::vector<uint8_t> jpeg) {
+        if (SUCCEEDED(hr)) {
+          hr = WriteFileContents(file_path, jpeg);
+        }
+        callback(hr, file_path);
+      });
+}
+
+bool ZslPhotoHandler::TakePhotoToMemory(const JpegEncodeOptions& options,
+                                        PhotoDataCallback callback) {
+  assert(callback);
+  return EncodeClosestFrame(options, std::move(callback));
+}
+
+bool ZslPhotoHandler::EncodeClosestFrame(const JpegEncodeOptions& options,
+                                         PhotoDataCallback callback) {
+  FrameRef frame = ring_.FindClosestFrame(ZslRing::Clock::now());
+  if (!frame) {
+    return false;
+  }
+
+  // The task holds a reference to the frame, so the ring moves on without
+  // overwriting it while it is encoded.
+  worker_.Post([this, frame = std::move(frame), options,
+                callback = std::move(callback)]() {
+    std::vector<uint8_t> jpeg;
+    HRESULT hr = encoder_.Encode(*frame, options, &jpeg);
+    if (FAILED(hr)) {
+      jpeg.clear();
+    }
+    callback(hr, std::move(jpeg));
+  });
+  return true;
+}
+
+}  // namespace camera_windows
@@ -0,0 +1,112 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_ZSL_PHOTO_HANDLER_H_
+#define PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_ZSL_PHOTO_HANDLER_H_
+
+#include <windows.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "com_worker_pool.h"
+#include "frame_buffer_view.h"
+#include "frame_conversion.h"
+#include "jpeg_encoder.h"
+#include "zsl_ring.h"
+
+namespace camera_windows {
+
+// Takes zero-shutter-lag photos from recent preview frames.
+//
+// Each preview frame is copied, as delivered by the camera, into a small
+// |ZslRing|. A photo is taken from the kept frame delivered closest to the
+// request, so no new frame has to be captured for it: the photo shows the
+// scene at the time of the request, and is ready as soon as it is encoded.
+// Frames are encoded and written on a worker thread, so that neither the
+// capture thread nor the platform thread waits for the encoder.
+//
+// Photos have the size of the preview frames delivered by the camera, which
+// may be smaller than photos taken by the capture engine.
+class ZslPhotoHandler {
+ public:
+  // Called from the worker thread with the result of a photo.
+  using PhotoCallback =
+      std::function<void(HRESULT hr, const std::string& file_path)>;
+
+  // Called from the worker thread with an encoded photo, which is empty if
+  // encoding failed.
+  using PhotoDataCallback =
+      std::function<void(HRESULT hr, std::vector<uint8_t> image)>;
+
+  // Number of frames kept in the ring.
+  static constexpr size_t kFrameCount = 3;
+
+  ZslPhotoHandler();
+
+  // Waits for the photos that are being encoded.
+  virtual ~ZslPhotoHandler() = default;
+
+  // Prevent copying.
+  ZslPhotoHandler(ZslPhotoHandler const&) = delete;
+  ZslPhotoHandler& operator=(ZslPhotoHandler const&) = delete;
+
+  // Updates the format of frames passed to |OnFrame|.
+  void UpdateFrameFormat(const FrameFormat& frame_format) {
+    frame_format_ = frame_format;
+  }
+
+  // Updates the size of frames passed to |OnFrame|.
+  void UpdateFrameSize(uint32_t width, uint32_t height) {
+    frame_width_ = width;
+    frame_height_ = height;
+  }
+
+  // Keeps a copy of the given locked frame, presented at |sample_time_us|.
+  //
+  // Called from the capture thread. |source| is only valid for the duration
+  // of the call.
+  void OnFrame(const FrameBufferView& source, uint64_t sample_time_us);
+
+  // Encodes the kept frame delivered closest to now as a JPEG image, and
+  // writes it to |file_path| on the worker thread. |callback| is called from
+  // the worker thread once the file is written or has failed.
+  //
+  // Returns false if no frame has been kept yet.
+  bool TakePhoto(const std::string& file_path, PhotoCallback callback);
+
+  // Encodes the kept frame delivered closest to now as a JPEG image with
+  // |options|, and passes it to |callback| from the worker thread without
+  // writing it to a file.
+  //
+  // Returns false if no frame has been kept yet.
+  bool TakePhotoToMemory(const JpegEncodeOptions& options,
+                         PhotoDataCallback callback);
+
+ private:
+  // Encodes the kept frame delivered closest to now on the worker thread,
+  // and passes the result to |callback| from the worker thread.
+  //
+  // Returns false if no frame has been kept yet.
+  bool EncodeClosestFrame(const JpegEncodeOptions& options,
+                          PhotoDataCallback callback);
+
+  FrameFormat frame_format_;
+  uint32_t frame_width_ = 0;
+  uint32_t frame_height_ = 0;
+  ZslRing ring_;
+
+  // Only used by the worker thread.
+  JpegEncoder encoder_;
+
+  // Declared last, so that its thread is joined before the members used by
+  // its tasks are destroyed.
+  ComWorkerPool worker_;
+};
+
+}  // namespace camera_windows
+
+#endif  // PACKAGES_CAMERA_CAMERA_WINDOWS_WINDOWS_ZSL_PHOTO_HANDLER_H_